@@ -3,7 +3,6 @@ package NcnnTencent.CloudDetect;
 import android.app.Activity;
 import android.content.Intent;
 import android.graphics.Bitmap;
-import android.graphics.RectF;
 import android.os.Bundle;
 import android.os.Handler;
 import android.os.Looper;
@@ -23,6 +22,7 @@ import android.widget.Toast;
 
 import NcnnTencent.LocalDetect.R;
 import NcnnTencent.common.JniBridge;
+import NcnnTencent.common.Models.DetectResults;
 import NcnnTencent.common.Models.DetectSummary;
 import java.util.Locale;
 
@@ -580,14 +580,22 @@ public class MainCloudActivity extends Activity implements NetworkVideoManager.N
 
     // NetworkVideoCallback 实现
     private boolean firstFrameReceived = false;
+    // 当前显示的帧，被下一帧替换后归还给原生复用池（仅主线程访问）
+    private Bitmap displayedFrame = null;
 
     @Override
-    public void onFrame(Bitmap frame, RectF[] boxes) {
+    public void onFrame(Bitmap frame, DetectResults results) {
+        // results 只在本次回调内有效，先取出需要的数据
+        final int objectCount = results != null ? results.count() : -1;
         // 显示预览画面
         mainHandler.post(() -> {
             try {
                 if (frame != null && !frame.isRecycled()) {
                     imageView.setImageBitmap(frame);
+                    if (displayedFrame != null && displayedFrame != frame) {
+                        networkVideoManager.releaseFrame(displayedFrame);
+                    }
+                    displayedFrame = frame;
                     imageView.setVisibility(View.VISIBLE);
                     surfaceNetworkPreview.setVisibility(View.GONE);
                     tvPreviewPlaceholder.setVisibility(View.GONE);
@@ -599,7 +607,8 @@ public class MainCloudActivity extends Activity implements NetworkVideoManager.N
                         Log.i(TAG, "收到第一帧，视频流正常");
                     }
                 }
-                Log.d(TAG, "收到网络流帧: " + (frame != null ? frame.getWidth() + "x" + frame.getHeight() : "null"));
+                Log.d(TAG, "收到网络流帧: " + (frame != null ? frame.getWidth() + "x" + frame.getHeight() : "null")
+                        + (objectCount >= 0 ? ", 目标数=" + objectCount : ""));
             } catch (Exception e) {
                 Log.e(TAG, "处理帧回调异常", e);
             }
@@ -2,7 +2,6 @@ package NcnnTencent.CloudDetect;
 
 import android.content.Context;
 import android.graphics.Bitmap;
-import android.graphics.RectF;
 import android.os.Handler;
 import android.os.Looper;
 import android.util.Log;
@@ -10,6 +9,8 @@ import android.widget.Toast;
 
 import java.util.concurrent.atomic.AtomicBoolean;
 
+import NcnnTencent.common.Models.DetectResults;
+
 /**
  * 网络视频流管理器
  * 负责从局域网拉取视频流，解码，推理，并回调结果
@@ -23,7 +24,10 @@ public class NetworkVideoManager {
 
     // 回调接口
     public interface NetworkVideoCallback {
-        void onFrame(Bitmap frame, RectF[] boxes);
+        /**
+         * @param results 检测模式下为本路最新的打包结果（只在主线程回调内有效，不要跨帧持有），预览模式为null
+         */
+        void onFrame(Bitmap frame, DetectResults results);
         void onStreamStarted();
         void onStreamStopped();
         void onError(String error);
@@ -35,6 +39,11 @@ public class NetworkVideoManager {
     private Context context;
     private NcnnTencent.common.JniBridge jniBridge;
 
+    // 打包检测结果：只在主线程拉取和读取，跨帧复用
+    private final DetectResults results = new DetectResults();
+    // 结果通道：0=单路网络流，多路流时为 addStream 返回的流ID
+    private int resultChannel = 0;
+
     // 网络流参数
     private String streamUrl;
     private int inputSize;
@@ -52,6 +61,13 @@ public class NetworkVideoManager {
         this.jniBridge = new NcnnTencent.common.JniBridge();
     }
 
+    /**
+     * 设置读取检测结果的通道（多路流时传 addStream 返回的流ID）
+     */
+    public void setResultChannel(int streamId) {
+        this.resultChannel = streamId;
+    }
+
     /**
      * 设置回调接口
      */
@@ -100,7 +116,7 @@ public class NetworkVideoManager {
             }
             // 启动JNI层的网络流处理（可能抛出异常）
             try {
-                jniBridge.startNetworkVideoStream(url, inputSize, modelId, cpuGpu, this);
+                jniBridge.startNetworkVideoStream(url, inputSize, modelId, cpuGpu, this, 0, 0); // 解码线程自动配置
             } catch (Exception e) {
                 Log.e(TAG, "JNI调用异常", e);
                 isStreaming.set(false);
@@ -179,9 +195,11 @@ public class NetworkVideoManager {
 
     /**
      * 处理网络流帧回调（由JNI调用）
+     * boxes 为兼容旧接口保留，默认为null；检测结果在主线程从打包缓冲区拉取
      */
-    public void onNetworkFrameReceived(Bitmap frame, RectF[] boxes) {
+    public void onNetworkFrameReceived(Bitmap frame, android.graphics.RectF[] boxes) {
         if (!isStreaming.get()) {
+            releaseFrame(frame);
             return;
         }
         // 只有检测模式下才统计检测帧数
@@ -201,11 +219,26 @@ public class NetworkVideoManager {
         if (callback != null) {
             mainHandler.post(() -> {
                 try {
-                    callback.onFrame(frame, boxes);
+                    DetectResults frameResults = null;
+                    if (isDetecting.get() && results.update(jniBridge, resultChannel)) {
+                        frameResults = results;
+                    }
+                    callback.onFrame(frame, frameResults);
                 } catch (Exception e) {
                     Log.e(TAG, "回调处理异常", e);
                 }
             });
+        } else {
+            releaseFrame(frame);
+        }
+    }
+
+    /**
+     * 归还不再显示的帧Bitmap给原生复用池
+     */
+    public void releaseFrame(Bitmap frame) {
+        if (frame != null) {
+            jniBridge.releaseFrameBitmap(frame);
         }
     }
 
@@ -2,9 +2,9 @@ package NcnnTencent.CloudDetect.presenter;
 
 import android.content.Context;
 import android.graphics.Bitmap;
-import android.graphics.RectF;
 import NcnnTencent.common.InferenceConfig;
 import NcnnTencent.common.JniBridge;
+import NcnnTencent.common.Models.DetectResults;
 import NcnnTencent.common.Models.DetectSummary;
 import NcnnTencent.common.Models.InferenceModel;
 import NcnnTencent.common.Models.NetworkModel;
@@ -15,7 +15,7 @@ import NcnnTencent.common.Models.NetworkModel;
  */
 public class NetworkPresenter {
     public interface View {
-        void showFrame(Bitmap frame, RectF[] boxes);
+        void showFrame(Bitmap frame, DetectResults results);
         void showStatusMessage(String message);
         void showError(String error);
         void updateConnectionStatus(boolean connected);
@@ -113,14 +113,14 @@ public class NetworkPresenter {
     /**
      * 处理网络帧回调（由JNI调用）
      */
-    public void onNetworkFrameReceived(Bitmap frame, RectF[] boxes) {
+    public void onNetworkFrameReceived(Bitmap frame, DetectResults results) {
         if (isDetecting) {
             DetectSummary summary = inferenceModel.getDetectSummary();
             if (summary != null) {
                 view.updateMonitor(summary);
             }
         }
-        view.showFrame(frame, boxes);
+        view.showFrame(frame, results);
     }
 
     /**
@@ -5,7 +5,6 @@ import android.app.Activity;
 import android.content.Intent;
 import android.content.pm.PackageManager;
 import android.graphics.Bitmap;
-import android.graphics.RectF;
 import android.net.Uri;
 import android.os.Bundle;
 import android.os.Handler;
@@ -349,8 +348,8 @@ public class MainLocalActivity extends Activity implements
                 jniBridge.startFFmpegVideoDetect(videoPath, inputSize,
                         new JniBridge.FFmpegDetectCallback() {
                             @Override
-                            public void onFrame(Bitmap frame, RectF[] boxes) {
-                                presenter.onVideoFrameReceived(frame, boxes);
+                            public void onFrame(Bitmap frame, android.graphics.RectF[] boxes) {
+                                presenter.onVideoFrameReceived(frame);
                             }
                             @Override
                             public void onFinish() {
@@ -360,7 +359,7 @@ public class MainLocalActivity extends Activity implements
                             public void onError(String msg) {
                                 presenter.onVideoDetectError(msg);
                             }
-                        }, assetManager, modelId, deviceType);
+                        }, assetManager, modelId, deviceType, 0, 0); // 解码线程自动配置
             } catch (Exception e) {
                 presenter.onVideoDetectError("FFmpeg视频检测异常: " + e.getMessage());
             }
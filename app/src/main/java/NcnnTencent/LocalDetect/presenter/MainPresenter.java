@@ -2,7 +2,6 @@ package NcnnTencent.LocalDetect.presenter;
 
 import android.content.Context;
 import android.graphics.Bitmap;
-import android.graphics.RectF;
 import android.net.Uri;
 import android.view.Surface;
 import NcnnTencent.common.InferenceConfig;
@@ -162,9 +161,9 @@ public class MainPresenter {
     }
 
     /**
-     * 处理视频检测帧回调
+     * 处理视频检测帧回调（检测框已绘制在帧上，需要结果数据时用 Models.DetectResults 读取 streamId=0）
      */
-    public void onVideoFrameReceived(Bitmap frame, RectF[] boxes) {
+    public void onVideoFrameReceived(Bitmap frame) {
         DetectSummary summary = inferenceModel.getDetectSummary();
         if (summary != null) {
             view.updateMonitor(summary);
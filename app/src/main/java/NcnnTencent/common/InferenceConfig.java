@@ -10,8 +10,11 @@ public class InferenceConfig {
     private int deviceType; // 0=CPU, 1=GPU
     private float threshold;
     private float nmsThreshold;
+    private int nmsMode; // 0=贪心 1=按类别 2=网格分桶 3=Fast-NMS 4=Matrix-NMS
     private boolean trackEnabled;
     private boolean shaderEnabled;
+    private int decodeThreads; // 视频解码线程数，<=0 自动（取小核数）
+    private int decodeThreadType; // 0=自动 1=片并行 2=帧并行 3=帧+片并行
 
     public InferenceConfig() {
         // 默认值
@@ -20,8 +23,11 @@ public class InferenceConfig {
         this.deviceType = 0;
         this.threshold = 0.45f;
         this.nmsThreshold = 0.65f;
+        this.nmsMode = 0;
         this.trackEnabled = false;
         this.shaderEnabled = false;
+        this.decodeThreads = 0;
+        this.decodeThreadType = 0;
     }
     public InferenceConfig(int modelId, int inputSize, int deviceType) {
         this();
@@ -63,6 +69,14 @@ public class InferenceConfig {
         this.nmsThreshold = nmsThreshold;
     }
 
+    public int getNmsMode() {
+        return nmsMode;
+    }
+
+    public void setNmsMode(int nmsMode) {
+        this.nmsMode = nmsMode;
+    }
+
     public boolean isTrackEnabled() {
         return trackEnabled;
     }
@@ -79,6 +93,22 @@ public class InferenceConfig {
         this.shaderEnabled = shaderEnabled;
     }
 
+    public int getDecodeThreads() {
+        return decodeThreads;
+    }
+
+    public void setDecodeThreads(int decodeThreads) {
+        this.decodeThreads = decodeThreads;
+    }
+
+    public int getDecodeThreadType() {
+        return decodeThreadType;
+    }
+
+    public void setDecodeThreadType(int decodeThreadType) {
+        this.decodeThreadType = decodeThreadType;
+    }
+
     public boolean isGpuMode() {
         return deviceType == 1;
     }
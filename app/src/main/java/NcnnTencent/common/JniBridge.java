@@ -3,6 +3,7 @@ package NcnnTencent.common;
 import android.content.res.AssetManager;
 import android.graphics.Bitmap;
 import android.view.Surface;
+import java.nio.ByteBuffer;
 import NcnnTencent.common.Models.DetectSummary;
 
 /**
@@ -16,16 +17,62 @@ public class JniBridge {
 
     // ========== 模型相关 ==========
     /**
-     * 加载模型
+     * 加载模型：在后台线程加载并预热，完成后原子切换，切换期间当前模型继续推理；
+     * 进度通过 isModelReady / getModelReadiness 查询
      * @param assetManager AssetManager
      * @param modelId 模型ID
      * @param deviceType 设备类型 (0=CPU, 1=GPU)
      * @param inputSize 输入尺寸索引
-     * @return 是否加载成功
+     * @return 已有模型时表示请求是否已提交（立即返回）；首次加载会等待完成，返回是否加载成功
      * JNI方法签名：Java_com_tencent_common_JniBridge_loadModel
      */
     public native boolean loadModel(AssetManager assetManager, int modelId, int deviceType, int inputSize);
 
+    /**
+     * 获取当前模型各 Net 的内存池统计之和（加载时预热，Net 被缓存淘汰时释放）
+     * @return blob 池与 workspace 池依次各 5 项 [allocs, misses, liveBytes, pooledBytes, peakBytes]，
+     *         misses 为实际向系统申请内存的次数，两次调用之间的差值即这段时间的分配次数；模型未加载返回 null
+     * JNI方法签名：Java_com_tencent_common_JniBridge_getModelMemoryStats
+     */
+    public native long[] getModelMemoryStats();
+
+    /**
+     * 获取模型 Net 缓存统计（按模型文件和 CPU/GPU 缓存已加载的 Net，切回用过的模型时直接复用）
+     * @return [hits, misses, evictions, entries, inUse, residentBytes, budgetBytes]，
+     *         命中率 = hits / (hits + misses)，residentBytes 为权重与内存池峰值之和的估算
+     * JNI方法签名：Java_com_tencent_common_JniBridge_getNetCacheStats
+     */
+    public native long[] getNetCacheStats();
+
+    /**
+     * 设置 Net 缓存的内存预算，超出时淘汰最久未用且未被使用的 Net（默认 96MB）
+     * @param bytes 预算字节数
+     * JNI方法签名：Java_com_tencent_common_JniBridge_setNetCacheBudget
+     */
+    public native void setNetCacheBudget(long bytes);
+
+    /**
+     * 设置加载模型后的预热次数，下次 loadModel 生效
+     * @param runs 每个输入尺寸的空输入前向次数，第一次为冷启动，其余计入热态耗时；0 表示不预热（默认 3）
+     * JNI方法签名：Java_com_tencent_common_JniBridge_setWarmupRuns
+     */
+    public native void setWarmupRuns(int runs);
+
+    /**
+     * 是否已有加载并预热完成的模型可用（后台切换模型期间仍为 true）
+     * @return 是否就绪
+     * JNI方法签名：Java_com_tencent_common_JniBridge_isModelReady
+     */
+    public native boolean isModelReady();
+
+    /**
+     * 获取模型就绪状态与预热耗时（描述当前正在使用的模型；loading 表示后台有新模型正在加载）
+     * @return [ready(0/1), loading(0/1), loadMs, warmupMs, runs, count]，之后依次 count 组 [w, h, coldMs, warmMs]，
+     *         每组对应一个网络输入尺寸的首次前向耗时与之后的平均前向耗时
+     * JNI方法签名：Java_com_tencent_common_JniBridge_getModelReadiness
+     */
+    public native float[] getModelReadiness();
+
     // ========== 相机相关 ==========
     /**
      * 打开相机
@@ -42,6 +89,41 @@ public class JniBridge {
      */
     public native boolean closeCamera();
 
+    /**
+     * 设置相机采集配置，下次打开相机时生效
+     * 相机不支持的尺寸 / 帧率范围取最接近的，实际结果见 getCameraConfig 或摘要中的 capture 字段
+     * @param width 采集宽度，<= 0 时按当前模型输入边长自动选择
+     * @param height 采集高度
+     * @param fpsMin AE 目标帧率下限
+     * @param fpsMax AE 目标帧率上限
+     * @param maxImages ImageReader 缓冲图像数（至少 2）
+     * JNI方法签名：Java_com_tencent_common_JniBridge_setCameraConfig
+     */
+    public native void setCameraConfig(int width, int height, int fpsMin, int fpsMax, int maxImages);
+
+    /**
+     * 获取当前采集配置
+     * @return [width, height, fpsMin, fpsMax, maxImages]，相机打开后为协商结果
+     * JNI方法签名：Java_com_tencent_common_JniBridge_getCameraConfig
+     */
+    public native int[] getCameraConfig();
+
+    /**
+     * 枚举相机支持的 YUV 输出尺寸
+     * @param facing 相机朝向 (0=前置, 1=后置)
+     * @return [width, height, maxFps] 三元组依次排列，maxFps 为 0 表示未知；找不到相机返回 null
+     * JNI方法签名：Java_com_tencent_common_JniBridge_getCameraStreamConfigs
+     */
+    public native int[] getCameraStreamConfigs(int facing);
+
+    /**
+     * 枚举相机支持的 AE 目标帧率范围
+     * @param facing 相机朝向 (0=前置, 1=后置)
+     * @return [min, max] 二元组依次排列；找不到相机返回 null
+     * JNI方法签名：Java_com_tencent_common_JniBridge_getCameraFpsRanges
+     */
+    public native int[] getCameraFpsRanges(int facing);
+
     /**
      * 设置输出窗口
      * @param surface Surface对象
@@ -65,6 +147,13 @@ public class JniBridge {
      */
     public native void setNms(float nms);
 
+    /**
+     * 设置NMS模式
+     * @param mode 0=贪心 1=按类别 2=网格分桶 3=Fast-NMS 4=Matrix-NMS
+     * JNI方法签名：Java_com_tencent_common_JniBridge_setNmsMode
+     */
+    public native void setNmsMode(int mode);
+
     /**
      * 设置跟踪开关
      * @param enabled 是否启用跟踪
@@ -86,6 +175,15 @@ public class JniBridge {
      */
     public native void setDetectEnabled(boolean enabled);
 
+    /**
+     * 设置相机异步预览开关
+     * 开启后预览每帧立即渲染并叠加最近一次检测结果（按跟踪器运动模型外推到当前帧），
+     * 推理在独立线程只处理最新一帧，预览帧率不再受模型耗时限制
+     * @param enabled 是否启用异步预览
+     * JNI方法签名：Java_com_tencent_common_JniBridge_setAsyncPreview
+     */
+    public native void setAsyncPreview(boolean enabled);
+
     // ========== 推理相关 ==========
     /**
      * 检测图片
@@ -96,6 +194,16 @@ public class JniBridge {
      */
     public native Bitmap detectImage(Bitmap bitmap, int inputSize);
 
+    /**
+     * 批量推理吞吐测试：同一张图复制为 1..maxBatch 张批量推理，需先调用 loadModel
+     * @param bitmap 输入图片
+     * @param maxBatch 最大批大小
+     * @param rounds 每个批大小的测试轮数
+     * @return 长度为 maxBatch 的数组，第 b-1 项为批大小 b 时的吞吐（张/秒），失败返回 null
+     * JNI方法签名：Java_com_tencent_common_JniBridge_benchmarkBatch
+     */
+    public native float[] benchmarkBatch(Bitmap bitmap, int maxBatch, int rounds);
+
     /**
      * 获取检测摘要
      * @return DetectSummary对象
@@ -103,6 +211,61 @@ public class JniBridge {
      */
     public native DetectSummary getDetectSummary();
 
+    /**
+     * 获取最新一帧的打包检测结果（框、置信度、类别、跟踪ID、关键点、掩码），不为每个目标创建对象
+     * 布局见 Models.DetectResults；建议直接使用 Models.DetectResults.update
+     * @param streamId 0=单路画面（相机/本地视频/单路网络流），其它为 addStream 返回的流ID
+     * @param buffer direct ByteBuffer（ByteBuffer.allocateDirect），可跨帧复用
+     * @return 写入字节数；缓冲区不足时返回所需字节数的相反数；尚无结果返回 0
+     * JNI方法签名：Java_com_tencent_common_JniBridge_getDetectResults
+     */
+    public native int getDetectResults(int streamId, ByteBuffer buffer);
+
+    /**
+     * 帧回调（onNetworkFrameReceived / FFmpegDetectCallback.onFrame）是否仍附带逐目标的RectF[]
+     * 默认关闭，回调中boxes为null，检测结果通过 getDetectResults 读取；仅兼容旧代码时开启
+     * @param enabled 是否构建RectF[]
+     * JNI方法签名：Java_com_tencent_common_JniBridge_setLegacyRectFResults
+     */
+    public native void setLegacyRectFResults(boolean enabled);
+
+    // ========== 分阶段耗时追踪 ==========
+
+    /**
+     * 开关分阶段耗时追踪（解码/转换/预处理/前向/候选框/NMS/跟踪/绘制/JNI）
+     * @param enabled true开启记录，false停止记录（已记录的事件保留）
+     * JNI方法签名：Java_com_tencent_common_JniBridge_setTraceEnabled
+     */
+    public native void setTraceEnabled(boolean enabled);
+
+    /**
+     * 清空已记录的追踪事件
+     * JNI方法签名：Java_com_tencent_common_JniBridge_resetTrace
+     */
+    public native void resetTrace();
+
+    /**
+     * 获取各阶段耗时统计
+     * @return 按阶段排布，每阶段5项：次数、均值、p50、p95、p99（单位ms），阶段顺序同getTraceStageNames
+     * JNI方法签名：Java_com_tencent_common_JniBridge_getTraceStats
+     */
+    public native float[] getTraceStats();
+
+    /**
+     * 获取阶段名称
+     * @return 阶段名称数组
+     * JNI方法签名：Java_com_tencent_common_JniBridge_getTraceStageNames
+     */
+    public native String[] getTraceStageNames();
+
+    /**
+     * 导出Chrome trace JSON（可在chrome://tracing或Perfetto中打开）
+     * @param path 输出文件路径
+     * @return 是否成功
+     * JNI方法签名：Java_com_tencent_common_JniBridge_dumpTrace
+     */
+    public native boolean dumpTrace(String path);
+
     // ========== 视频检测相关 ==========
     /**
      * 启动FFmpeg视频检测
@@ -112,6 +275,8 @@ public class JniBridge {
      * @param assetManager AssetManager
      * @param modelId 模型ID
      * @param deviceType 设备类型
+     * @param decodeThreads 解码线程数（<=0 自动，默认取小核数）
+     * @param decodeThreadType 解码并行方式 (0=自动, 1=片并行, 2=帧并行, 3=帧+片并行)
      * JNI方法签名：Java_com_tencent_common_JniBridge_startFFmpegVideoDetect
      */
     public native void startFFmpegVideoDetect(
@@ -120,7 +285,9 @@ public class JniBridge {
             FFmpegDetectCallback callback,
             AssetManager assetManager,
             int modelId,
-            int deviceType
+            int deviceType,
+            int decodeThreads,
+            int decodeThreadType
     );
 
     // ========== 网络流相关 ==========
@@ -130,10 +297,14 @@ public class JniBridge {
      * @param inputSize 输入尺寸
      * @param modelId 模型ID
      * @param deviceType 设备类型
-     * @param callback 回调对象（NetworkVideoManager实例）
+     * @param callback 回调对象（NetworkVideoManager实例）；回调中的Bitmap来自原生复用池，
+     *                 不再显示后调用 releaseFrameBitmap 归还，归还前不会被新画面覆盖；不要recycle
+     * @param decodeThreads 解码线程数（<=0 自动，默认取小核数）
+     * @param decodeThreadType 解码并行方式 (0=自动, 1=片并行, 2=帧并行, 3=帧+片并行)
      * JNI方法签名：Java_com_tencent_common_JniBridge_startNetworkVideoStream
      */
-    public native void startNetworkVideoStream(String url, int inputSize, int modelId, int deviceType, Object callback);
+    public native void startNetworkVideoStream(String url, int inputSize, int modelId, int deviceType, Object callback,
+                                               int decodeThreads, int decodeThreadType);
 
     /**
      * 停止网络视频流
@@ -141,9 +312,107 @@ public class JniBridge {
      */
     public native void stopNetworkVideoStream();
 
+    /**
+     * 归还网络流回调中不再显示的Bitmap，原生侧之后才会把新画面写入它
+     * @param bitmap onNetworkFrameReceived 收到的Bitmap（非复用池的Bitmap直接忽略）
+     * JNI方法签名：Java_com_tencent_common_JniBridge_releaseFrameBitmap
+     */
+    public native void releaseFrameBitmap(Bitmap bitmap);
+
+    /**
+     * 配置网络流流水线模式（解码 -> 推理 -> 渲染 分线程执行），下次启动网络流时生效
+     * @param enabled 是否启用流水线模式（false 时退回单线程串行）
+     * @param queueCapacity 各阶段之间环形队列的容量
+     * @param dropOldest 队列满时是否丢弃最旧帧（false 时阻塞等待下游）
+     * JNI方法签名：Java_com_tencent_common_JniBridge_setNetworkPipeline
+     */
+    public native void setNetworkPipeline(boolean enabled, int queueCapacity, boolean dropOldest);
+
+    /**
+     * 获取网络流流水线统计
+     * @return [解码队列深度, 渲染队列深度, 解码队列丢帧数, 渲染队列丢帧数, 已解码帧, 已推理帧, 已渲染帧]
+     * JNI方法签名：Java_com_tencent_common_JniBridge_getNetworkPipelineStats
+     */
+    public native int[] getNetworkPipelineStats();
+
+    /**
+     * 纯解码吞吐测试（不做格式转换和推理），用于比较不同解码线程配置
+     * @param videoPath 视频路径
+     * @param decodeThreads 解码线程数（<=0 自动）
+     * @param decodeThreadType 解码并行方式 (0=自动, 1=片并行, 2=帧并行, 3=帧+片并行)
+     * @param maxFrames 最多解码帧数（<=0 解码到文件结束）
+     * @return [解码帧数, 耗时(ms), 帧率]，打开失败返回 null
+     * JNI方法签名：Java_com_tencent_common_JniBridge_benchmarkDecode
+     */
+    public native float[] benchmarkDecode(String videoPath, int decodeThreads, int decodeThreadType, int maxFrames);
+
+    // ========== 多路流相关 ==========
+    /**
+     * 添加一路流（多路共享已加载的模型，各路独立跟踪与摘要），需先调用 loadModel
+     * @param url 流地址或本地文件路径
+     * @param callback 回调对象（NetworkVideoManager实例，每路一个）；Bitmap复用规则同startNetworkVideoStream
+     * @param decodeThreads 解码线程数（<=0 自动）
+     * @param decodeThreadType 解码并行方式 (0=自动, 1=片并行, 2=帧并行, 3=帧+片并行)
+     * @return 流ID，失败返回 -1
+     * JNI方法签名：Java_com_tencent_common_JniBridge_addStream
+     */
+    public native int addStream(String url, Object callback, int decodeThreads, int decodeThreadType);
+
+    /**
+     * 停止并移除一路流
+     * @param streamId 流ID
+     * @return 流是否存在
+     * JNI方法签名：Java_com_tencent_common_JniBridge_removeStream
+     */
+    public native boolean removeStream(int streamId);
+
+    /**
+     * 停止并移除所有流
+     * JNI方法签名：Java_com_tencent_common_JniBridge_removeAllStreams
+     */
+    public native void removeAllStreams();
+
+    /**
+     * 设置多路流共享的推理 worker 数量，立即生效
+     * @param count worker 数量（<=0 取默认值 2）
+     * JNI方法签名：Java_com_tencent_common_JniBridge_setStreamWorkers
+     */
+    public native void setStreamWorkers(int count);
+
+    /**
+     * 设置多路流每批最多合并推理的流数（同一模型上并发多个 Extractor），立即生效
+     * @param maxBatch 最大批大小（<=0 取默认值 4，1 表示逐帧推理）
+     * JNI方法签名：Java_com_tencent_common_JniBridge_setStreamBatch
+     */
+    public native void setStreamBatch(int maxBatch);
+
+    /**
+     * 获取当前所有流ID
+     * @return 流ID数组（按添加顺序）
+     * JNI方法签名：Java_com_tencent_common_JniBridge_getStreamIds
+     */
+    public native int[] getStreamIds();
+
+    /**
+     * 获取单路流统计
+     * @param streamId 流ID
+     * @return [已解码帧, 已推理帧, 已回调帧, 覆盖丢帧, 是否运行中(1/0)]，流不存在返回 null
+     * JNI方法签名：Java_com_tencent_common_JniBridge_getStreamStats
+     */
+    public native int[] getStreamStats(int streamId);
+
+    /**
+     * 获取单路流检测摘要
+     * @param streamId 流ID
+     * @return DetectSummary对象，流不存在返回 null
+     * JNI方法签名：Java_com_tencent_common_JniBridge_getStreamSummary
+     */
+    public native DetectSummary getStreamSummary(int streamId);
+
     // ========== 回调接口 ==========
     /**
      * FFmpeg视频检测回调接口
+     * boxes 仅在 setLegacyRectFResults(true) 时非null，检测结果请用 Models.DetectResults 读取（streamId=0）
      */
     public interface FFmpegDetectCallback {
         void onFrame(Bitmap frame, android.graphics.RectF[] boxes);
@@ -4,6 +4,9 @@ import android.content.res.AssetManager;
 import android.graphics.Bitmap;
 import android.view.Surface;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
 /**
  * 数据模型类集合
  * 整合所有数据模型和业务模型，简化项目结构
@@ -21,6 +24,11 @@ public class Models {
         public float inferTimeMs;
         public float fps;
         public String logText;
+        // 相机实际采集配置（协商结果），非相机来源为 0
+        public int captureWidth;
+        public int captureHeight;
+        public int captureFpsMin;
+        public int captureFpsMax;
 
         public DetectSummary(float allTimeMs, float inferTimeMs, float fps, String logText) {
             this.allTimeMs = allTimeMs;
@@ -29,11 +37,95 @@ public class Models {
             this.logText = logText;
         }
 
+        public DetectSummary(float allTimeMs, float inferTimeMs, float fps, String logText,
+                             int captureWidth, int captureHeight, int captureFpsMin, int captureFpsMax) {
+            this(allTimeMs, inferTimeMs, fps, logText);
+            this.captureWidth = captureWidth;
+            this.captureHeight = captureHeight;
+            this.captureFpsMin = captureFpsMin;
+            this.captureFpsMax = captureFpsMax;
+        }
+
         public DetectSummary() {
             this(0, 0, 0, "");
         }
     }
 
+    /**
+     * 打包检测结果（与 JNI 层 result_pack.h 的布局一致）
+     * 整帧结果放在一块可复用的 direct ByteBuffer 中，按下标读取，读取过程不分配对象
+     *
+     * 布局（字节偏移，本机字节序）：
+     * 头部 16 字节：count, recordSize, frameWidth, frameHeight（int32）
+     * 之后 count 条记录，每条 recordSize 字节：
+     *   x1, y1, x2, y2, score（float32），label, trackId, kpOffset, kpCount,
+     *   maskOffset, maskX, maskY, maskWidth, maskHeight（int32）
+     * 关键点每点 12 字节：x, y, prob（float32）
+     * 掩码为框内 uint8（0/1），行主序，maskWidth * maskHeight 字节
+     */
+    public static class DetectResults {
+        private static final int HEADER_SIZE = 16;
+
+        private ByteBuffer buffer;
+
+        public DetectResults(int initialCapacity) {
+            allocate(Math.max(HEADER_SIZE, initialCapacity));
+        }
+
+        public DetectResults() {
+            this(16 * 1024);
+        }
+
+        private void allocate(int capacity) {
+            buffer = ByteBuffer.allocateDirect(capacity).order(ByteOrder.nativeOrder());
+        }
+
+        /**
+         * 拉取最新结果，缓冲区不足时自动扩容一次
+         * @param streamId 0=单路画面，其它为多路流ID
+         * @return 是否有结果
+         */
+        public boolean update(JniBridge jniBridge, int streamId) {
+            int n = jniBridge.getDetectResults(streamId, buffer);
+            if (n < 0) {
+                allocate(-n * 2);
+                n = jniBridge.getDetectResults(streamId, buffer);
+            }
+            if (n <= 0) {
+                buffer.putInt(0, 0);
+                return false;
+            }
+            return true;
+        }
+
+        public ByteBuffer buffer() { return buffer; }
+
+        public int count() { return buffer.getInt(0); }
+        public int frameWidth() { return buffer.getInt(8); }
+        public int frameHeight() { return buffer.getInt(12); }
+
+        private int record(int i) { return HEADER_SIZE + i * buffer.getInt(4); }
+
+        public float x1(int i) { return buffer.getFloat(record(i)); }
+        public float y1(int i) { return buffer.getFloat(record(i) + 4); }
+        public float x2(int i) { return buffer.getFloat(record(i) + 8); }
+        public float y2(int i) { return buffer.getFloat(record(i) + 12); }
+        public float score(int i) { return buffer.getFloat(record(i) + 16); }
+        public int label(int i) { return buffer.getInt(record(i) + 20); }
+        public int trackId(int i) { return buffer.getInt(record(i) + 24); }
+        public int keypointOffset(int i) { return buffer.getInt(record(i) + 28); }
+        public int keypointCount(int i) { return buffer.getInt(record(i) + 32); }
+        public int maskOffset(int i) { return buffer.getInt(record(i) + 36); }
+        public int maskX(int i) { return buffer.getInt(record(i) + 40); }
+        public int maskY(int i) { return buffer.getInt(record(i) + 44); }
+        public int maskWidth(int i) { return buffer.getInt(record(i) + 48); }
+        public int maskHeight(int i) { return buffer.getInt(record(i) + 52); }
+
+        public float keypointX(int i, int k) { return buffer.getFloat(keypointOffset(i) + k * 12); }
+        public float keypointY(int i, int k) { return buffer.getFloat(keypointOffset(i) + k * 12 + 4); }
+        public float keypointProb(int i, int k) { return buffer.getFloat(keypointOffset(i) + k * 12 + 8); }
+    }
+
     // ========== 业务模型 ==========
 
     /**
@@ -130,6 +222,7 @@ public class Models {
             if (config == null) return;
             jniBridge.setThreshold(config.getThreshold());
             jniBridge.setNms(config.getNmsThreshold());
+            jniBridge.setNmsMode(config.getNmsMode());
             jniBridge.setTrackEnabled(config.isTrackEnabled());
             jniBridge.setShaderEnabled(config.isShaderEnabled());
         }
@@ -189,7 +282,9 @@ public class Models {
                     inputSizeInt,
                     config.getModelId(),
                     config.getDeviceType(),
-                    callback
+                    callback,
+                    config.getDecodeThreads(),
+                    config.getDecodeThreadType()
             );
             isStreaming = true;
             return true;
@@ -2,7 +2,10 @@
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include <android/asset_manager.h>
+#include <benchmark.h>
 #include "vision_base.h" // Object结构体
+#include "pool_allocator.h"
+#include "model_warmup.h"
 
 class IYoloAlgo {
 public:
@@ -15,5 +18,75 @@ public:
     virtual const char** getClassNames() const = 0;
     virtual int getClassCount() const = 0;
     virtual const unsigned char (*getColors() const)[3] = 0;
+    // letterbox 输入的目标边长；返回 0 表示不支持 detectLetterboxed
+    virtual int getTargetSize() const { return 0; }
+    // 对已缩放填充好的输入推理，结果坐标映射回原图（lb.orig_w x lb.orig_h）
+    virtual int detectLetterboxed(const Letterbox& lb, std::vector<Object>& objects) { return -1; }
+    // 对已缩放、填充、归一化好的张量推理，结果坐标映射回原图（in.orig_w x in.orig_h）
+    virtual int detectTensor(const LetterboxTensor& in, std::vector<Object>& objects) { return -1; }
+    // detectTensor 要求的归一化参数，value = (pixel - mean) * norm（RGB 顺序）；不支持时返回 false
+    virtual bool getTensorNorm(float mean[3], float norm[3]) const { return false; }
+    // 各 Net 使用的内存池统计；未使用模型内存池时返回 false
+    virtual bool getMemoryStats(ModelMemoryStats& stats) const { return false; }
+    // 需要预热的各 Net 输入尺寸（在 load 之后调用）
+    virtual void getWarmupTargets(std::vector<WarmupTarget>& targets) const {}
+    // 加载后预热：对每个输入尺寸跑 runs 次空输入前向，让各层一次性初始化和内存池扩充在首帧之前完成；
+    // 没有声明预热尺寸的算法退回用灰图跑 detect
+    virtual int warmup(int runs, WarmupReport& report)
+    {
+        std::vector<WarmupTarget> targets;
+        getWarmupTargets(targets);
+        if (!targets.empty())
+            return runWarmup(targets, runs, report);
+
+        report.runs = runs > 0 ? runs : 0;
+        report.total_ms = 0.f;
+        report.timings.clear();
+        const int size = getTargetSize() > 0 ? getTargetSize() : 320;
+        cv::Mat blank(size, size, CV_8UC3, cv::Scalar(114, 114, 114));
+        WarmupTiming timing = {size, size, 0.f, 0.f};
+        for (int i = 0; i < runs; i++)
+        {
+            std::vector<Object> objects;
+            const double t0 = ncnn::get_current_time();
+            int ret = detect(blank, objects);
+            if (ret != 0)
+                return ret;
+            const float ms = (float)(ncnn::get_current_time() - t0);
+            report.total_ms += ms;
+            if (i == 0)
+                timing.cold_ms = ms;
+            else
+                timing.warm_ms += ms / (runs - 1);
+        }
+        if (runs == 1)
+            timing.warm_ms = timing.cold_ms;
+        if (runs > 0)
+            report.timings.push_back(timing);
+        return 0;
+    }
+    // 批量推理，objects[i] 对应 inputs[i]；默认逐张调用，YOLOv8 系列在同一 Net 上并发多个 Extractor
+    virtual int detectBatch(const std::vector<cv::Mat>& inputs, std::vector<std::vector<Object> >& objects)
+    {
+        objects.assign(inputs.size(), std::vector<Object>());
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            int ret = detect(inputs[i], objects[i]);
+            if (ret != 0)
+                return ret;
+        }
+        return 0;
+    }
+    virtual int detectLetterboxedBatch(const std::vector<Letterbox>& inputs, std::vector<std::vector<Object> >& objects)
+    {
+        objects.assign(inputs.size(), std::vector<Object>());
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            int ret = detectLetterboxed(inputs[i], objects[i]);
+            if (ret != 0)
+                return ret;
+        }
+        return 0;
+    }
 };
 inline IYoloAlgo::~IYoloAlgo() {}
\ No newline at end of file
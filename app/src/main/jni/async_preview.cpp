@@ -0,0 +1,176 @@
+#include "async_preview.h"
+
+#include <algorithm>
+
+#include <benchmark.h>
+
+#include "vision_infer.h"
+#include "trace.h"
+
+// 与单路全局跟踪器参数一致
+#define PREVIEW_TRACK_FRAME_RATE 25
+#define PREVIEW_TRACK_BUFFER 30
+
+AsyncPreview::AsyncPreview()
+    : running_(false),
+      seq_(0),
+      tracker_(PREVIEW_TRACK_FRAME_RATE, PREVIEW_TRACK_BUFFER),
+      last_inferred_seq_(-1),
+      result_seq_(-1),
+      seq_interval_(1.f),
+      reset_tracker_(false)
+{
+    staging_.seq = 0;
+    staging_.t0 = 0;
+}
+
+AsyncPreview::~AsyncPreview()
+{
+    stop();
+}
+
+void AsyncPreview::start()
+{
+    if (running_)
+        return;
+
+    reset();
+    mailbox_.reopen();
+    worker_ = std::thread(&AsyncPreview::workerLoop, this);
+    running_ = true;
+}
+
+void AsyncPreview::stop()
+{
+    if (!running_)
+        return;
+
+    running_ = false;
+    mailbox_.close();
+    if (worker_.joinable())
+        worker_.join();
+    reset();
+}
+
+void AsyncPreview::reset()
+{
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    objects_.clear();
+    tracks_.clear();
+    model_.reset();
+    result_seq_ = -1;
+    seq_interval_ = 1.f;
+    reset_tracker_ = true;
+}
+
+// 把检测框按所属轨迹的外推位移 / 尺度变化移动到当前帧，关键点与掩码跟随平移
+static void shiftObject(Object& obj, const std::vector<float>& from, const std::vector<float>& to)
+{
+    const float dx = (to[0] + to[2] * 0.5f) - (from[0] + from[2] * 0.5f);
+    const float dy = (to[1] + to[3] * 0.5f) - (from[1] + from[3] * 0.5f);
+    const float sw = from[2] > 0.f ? to[2] / from[2] : 1.f;
+    const float sh = from[3] > 0.f ? to[3] / from[3] : 1.f;
+
+    const float cx = obj.rect.x + obj.rect.width * 0.5f + dx;
+    const float cy = obj.rect.y + obj.rect.height * 0.5f + dy;
+    obj.rect.width *= sw;
+    obj.rect.height *= sh;
+    obj.rect.x = cx - obj.rect.width * 0.5f;
+    obj.rect.y = cy - obj.rect.height * 0.5f;
+
+    for (auto& kp : obj.keyPoints)
+    {
+        kp.p.x += dx;
+        kp.p.y += dy;
+    }
+    for (auto& kp : obj.Face_keyPoints)
+    {
+        kp.p.x += dx;
+        kp.p.y += dy;
+    }
+    obj.markPoint.origin.x += cvRound(dx);
+    obj.markPoint.origin.y += cvRound(dy);
+}
+
+void AsyncPreview::render(cv::Mat& rgb)
+{
+    const int64_t seq = ++seq_;
+
+    // 投递给推理线程：拷贝进复用的暂存帧，与邮箱槽位交换后暂存帧持有可复用的旧缓冲
+    rgb.copyTo(staging_.rgb);
+    staging_.seq = seq;
+    staging_.t0 = ncnn::get_current_time();
+    mailbox_.put(staging_);
+
+    // 取最近一次结果（拷贝到复用的绘制缓冲，锁外外推和绘制）
+    int64_t result_seq;
+    float interval;
+    {
+        std::lock_guard<std::mutex> lock(result_mutex_);
+        if (result_seq_ < 0)
+            return;
+
+        draw_objects_ = objects_;
+        draw_tracks_ = tracks_;
+        draw_model_ = model_;
+        result_seq = result_seq_;
+        interval = seq_interval_;
+    }
+
+    // 结果落后的相机帧数折算成卡尔曼更新次数
+    const float steps = (float)(seq - result_seq) / interval;
+    if (steps > 0.f)
+    {
+        for (auto& track : draw_tracks_)
+        {
+            std::vector<float> predicted = track.predict_ahead(steps);
+            for (auto& obj : draw_objects_)
+            {
+                if (obj.track_id == track.track_id)
+                    shiftObject(obj, track.tlwh, predicted);
+            }
+            track.tlwh = predicted;
+            track.static_tlbr();
+        }
+    }
+
+    drawPredictedOnFrame(rgb, draw_objects_, draw_tracks_, trackEnabled, draw_model_);
+}
+
+void AsyncPreview::workerLoop()
+{
+    PreviewFrame frame;
+    std::vector<Object> objects;
+    std::shared_ptr<IYoloAlgo> model;
+
+    while (mailbox_.take(frame))
+    {
+        objects.clear();
+        if (frame.rgb.empty() || !detectFrame(frame.rgb, objects, &model))
+            continue;
+
+        bool reset_tracker;
+        {
+            std::lock_guard<std::mutex> lock(result_mutex_);
+            reset_tracker = reset_tracker_;
+            reset_tracker_ = false;
+        }
+        if (reset_tracker)
+        {
+            tracker_ = BYTETracker(PREVIEW_TRACK_FRAME_RATE, PREVIEW_TRACK_BUFFER);
+            last_inferred_seq_ = -1;
+        }
+
+        // 跟踪始终开启：即使不显示轨迹，也需要它的运动模型来外推检测框
+        std::vector<STrack> tracks = updateTracks(objects, &tracker_);
+        updateSummary(objects, frame.rgb.cols, frame.rgb.rows, frame.t0, trace_thread_last_ms(TRACE_FORWARD), model);
+
+        std::lock_guard<std::mutex> lock(result_mutex_);
+        seq_interval_ = last_inferred_seq_ >= 0 ? (float)std::max<int64_t>(1, frame.seq - last_inferred_seq_) : 1.f;
+        last_inferred_seq_ = frame.seq;
+        objects_.swap(objects);
+        tracks_.swap(tracks);
+        model_.swap(model);
+        result_seq_ = frame.seq;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef ASYNC_PREVIEW_H
+#define ASYNC_PREVIEW_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "vision_base.h"
+#include "frame_queue.h"
+#include "BYTETracker.h"
+
+// =============================
+// 相机异步预览：渲染与推理解耦
+// =============================
+//
+// - 相机线程每帧只做：拷贝帧投递到单槽邮箱（最新帧覆盖未处理的旧帧）+ 把最近一次结果画上去，
+//   预览帧率不再受模型耗时限制，AImageReader 的 4 张图像也不会被推理占住
+// - 推理线程从邮箱取最新帧推理，更新自己的 BYTETracker，保存结果快照
+// - 结果落后于当前帧时，按轨迹的卡尔曼匀速模型把框外推到当前帧（相机帧数 / 推理间隔帧数）
+struct PreviewFrame
+{
+    cv::Mat rgb;
+    int64_t seq;
+    double t0;
+};
+
+class AsyncPreview
+{
+public:
+    AsyncPreview();
+    ~AsyncPreview();
+
+    void start();
+    void stop();
+    bool running() const { return running_; }
+
+    // 相机线程调用：投递当前帧，并把最近一次结果外推后画到 rgb 上
+    void render(cv::Mat& rgb);
+
+    // 清除结果快照与轨迹（切换模型 / 重新开始检测时）
+    void reset();
+
+private:
+    AsyncPreview(const AsyncPreview&) = delete;
+    AsyncPreview& operator=(const AsyncPreview&) = delete;
+
+    void workerLoop();
+
+    LatestFrameMailbox<PreviewFrame> mailbox_;
+    std::thread worker_;
+    std::atomic<bool> running_;
+
+    // 仅相机线程访问
+    PreviewFrame staging_;
+    int64_t seq_;
+    std::vector<Object> draw_objects_;
+    std::vector<STrack> draw_tracks_;
+    std::shared_ptr<IYoloAlgo> draw_model_;
+
+    // 仅推理线程访问
+    BYTETracker tracker_;
+    int64_t last_inferred_seq_;
+
+    // 结果快照（推理线程写，相机线程读）
+    mutable std::mutex result_mutex_;
+    std::vector<Object> objects_;
+    std::vector<STrack> tracks_;
+    std::shared_ptr<IYoloAlgo> model_;  // 产生 objects_ 的模型，绘制时取它的类别表
+    int64_t result_seq_;    // 结果对应的帧序号，-1 表示尚无结果
+    float seq_interval_;    // 相邻两次推理之间的相机帧数（卡尔曼一次更新对应的帧数）
+    bool reset_tracker_;
+};
+
+#endif // ASYNC_PREVIEW_H
@@ -0,0 +1,184 @@
+#include "batch_infer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cpu.h"
+
+// 当前线程正在执行某个批次的任务项（调用线程或池线程），嵌套的 run_batch 在本线程串行执行
+static thread_local bool t_in_batch = false;
+
+BatchPlan plan_batch(int batch_size, int max_workers)
+{
+    BatchPlan plan;
+    if (t_in_batch)
+    {
+        // 外层批次已把大核分给各任务项，嵌套批次不再并发
+        plan.workers = 1;
+        plan.threads_per_extractor = 1;
+        return plan;
+    }
+
+    const int big_cores = std::max(1, ncnn::get_big_cpu_count());
+
+    plan.workers = std::max(1, std::min(batch_size, big_cores));
+    if (max_workers > 0)
+        plan.workers = std::min(plan.workers, max_workers);
+    plan.threads_per_extractor = std::max(1, big_cores / plan.workers);
+    return plan;
+}
+
+// =============================
+// 常驻工作线程池
+// =============================
+//
+// 大核数 - 1 个线程（调用线程也参与），首次使用时创建并绑定到大核，之后一直复用；
+// 每次 run_batch 只是一次入队 + 唤醒，不再创建 / 回收线程。
+// 多个批次可同时在队列中，空闲线程按先来先服务加入最早的批次，直到该批次要求的线程数凑满。
+
+struct BatchJob
+{
+    const std::function<void(int)>* task;
+    int n;
+    std::atomic<int> next;
+    int helpers_wanted;     // 还需加入的池线程数（由池的 mutex_ 保护）
+    int helpers_active;     // 正在执行本批次的池线程数（由池的 mutex_ 保护）
+};
+
+// 取任务项直到取完
+static void drain_job(BatchJob& job)
+{
+    const bool was_in_batch = t_in_batch;
+    t_in_batch = true;
+    int i;
+    while ((i = job.next.fetch_add(1)) < job.n)
+    {
+        (*job.task)(i);
+    }
+    t_in_batch = was_in_batch;
+}
+
+class BatchWorkerPool
+{
+public:
+    static BatchWorkerPool& instance()
+    {
+        static BatchWorkerPool pool;
+        return pool;
+    }
+
+    int size() const { return (int)threads_.size(); }
+
+    void run(BatchJob& job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back(&job);
+        }
+        cond_.notify_all();
+
+        drain_job(job);
+
+        // 调用线程做完后撤下未被领满的批次，等已加入的池线程结束
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = std::find(jobs_.begin(), jobs_.end(), &job);
+        if (it != jobs_.end())
+            jobs_.erase(it);
+        done_.wait(lock, [&job] { return job.helpers_active == 0; });
+    }
+
+private:
+    BatchWorkerPool() : stopping_(false)
+    {
+        const int count = std::max(0, ncnn::get_big_cpu_count() - 1);
+        threads_.reserve(count);
+        for (int i = 0; i < count; i++)
+        {
+            threads_.emplace_back(&BatchWorkerPool::workerLoop, this);
+        }
+    }
+
+    ~BatchWorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cond_.notify_all();
+        for (auto& t : threads_)
+        {
+            t.join();
+        }
+    }
+
+    BatchWorkerPool(const BatchWorkerPool&) = delete;
+    BatchWorkerPool& operator=(const BatchWorkerPool&) = delete;
+
+    void workerLoop()
+    {
+        // 与 plan_batch 按大核分配线程一致；同时绑定本线程 Extractor 使用的 OpenMP 线程
+        ncnn::set_cpu_thread_affinity(ncnn::get_cpu_thread_affinity_mask(2));
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            cond_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (stopping_)
+                return;
+
+            BatchJob* job = jobs_.front();
+            job->helpers_active++;
+            if (--job->helpers_wanted <= 0)
+                jobs_.pop_front();
+
+            lock.unlock();
+            drain_job(*job);
+            lock.lock();
+
+            if (--job->helpers_active == 0)
+                done_.notify_all();
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::condition_variable done_;
+    std::deque<BatchJob*> jobs_;
+    bool stopping_;
+};
+
+void run_batch(int n, const BatchPlan& plan, const std::function<void(int)>& task)
+{
+    if (n <= 0)
+        return;
+
+    BatchJob job;
+    job.task = &task;
+    job.n = n;
+    job.next.store(0);
+    job.helpers_active = 0;
+
+    // 单项、单线程方案或已在批次任务内时直接在调用线程执行
+    const int workers = std::max(1, std::min(plan.workers, n));
+    if (workers <= 1 || t_in_batch)
+    {
+        job.helpers_wanted = 0;
+        drain_job(job);
+        return;
+    }
+
+    BatchWorkerPool& pool = BatchWorkerPool::instance();
+    job.helpers_wanted = std::min(workers - 1, pool.size());
+    if (job.helpers_wanted <= 0)
+    {
+        drain_job(job);
+        return;
+    }
+    pool.run(job);
+}
@@ -0,0 +1,28 @@
+#ifndef BATCH_INFER_H
+#define BATCH_INFER_H
+
+#include <functional>
+
+// =============================
+// 批量推理调度（同一个 ncnn::Net 上并发多个 Extractor）
+// =============================
+//
+// ncnn::Net 加载后只读，多个 Extractor 可以在不同线程上同时 extract。
+// 小输入（如 320）单个 Extractor 吃不满大核，把大核按并发数平分给各 Extractor 吞吐更高。
+
+// 批量推理的并发方案
+struct BatchPlan
+{
+    int workers;                // 并发的 Extractor 数（含调用线程）
+    int threads_per_extractor;  // 每个 Extractor 的 ncnn 线程数（Extractor::set_num_threads）
+};
+
+// 按批大小与大核数生成并发方案；max_workers <= 0 时不额外限制
+// 在某个批次的任务项内调用时（嵌套批次）返回单线程方案
+BatchPlan plan_batch(int batch_size, int max_workers = 0);
+
+// 用 plan.workers 个线程（调用线程也参与）并发执行 task(0 .. n-1)，各项按先到先取分配；
+// 其余线程取自常驻、绑定大核的工作线程池，嵌套调用在当前线程串行执行
+void run_batch(int n, const BatchPlan& plan, const std::function<void(int)>& task);
+
+#endif // BATCH_INFER_H
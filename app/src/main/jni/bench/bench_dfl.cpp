@@ -0,0 +1,266 @@
+// generate_proposals 热点段（argmax -> sigmoid -> DFL 解码 -> 框还原）的基准
+//
+// 对比三条路径，候选数 1k / 10k（全部超过阈值，即最坏情况）：
+//   fused   当前实现：postprocess_kernels 的向量化 argmax + dfl_decode
+//   scalar  同样的数学逐元素标量实现，不创建层（衡量 SIMD 本身的收益）
+//   softmax 被替换的旧路径：每个候选 create_layer("Softmax") / create_pipeline / forward_inplace / destroy
+//           （需要 ncnn，配置时找到 ncnn 才编译，见 CMakeLists.txt）
+// 同时检查三条路径的框坐标一致，不一致时返回非 0
+//
+// 用法：bench_dfl [--quick]   --quick 只跑少量轮次，供 ctest 做回归检查
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "postprocess_kernels.h"
+#include "bench_util.h"
+
+#if BENCH_WITH_NCNN
+#include "layer.h"
+#include "mat.h"
+#endif
+
+#define REG_MAX 16
+#define NUM_CLASS 80
+#define ROW_SIZE (4 * REG_MAX + NUM_CLASS)
+
+// 与 YoloV8 输出行布局一致：[4][reg_max] 的框分布 + num_class 个类别 logit
+static void make_pred(std::vector<float>& pred, int n, BenchRng& rng)
+{
+    pred.resize((size_t)n * ROW_SIZE);
+    for (int i = 0; i < n; i++)
+    {
+        float* row = &pred[(size_t)i * ROW_SIZE];
+        for (int j = 0; j < 4 * REG_MAX; j++)
+            row[j] = rng.uniform(-6.f, 6.f);
+        for (int j = 0; j < NUM_CLASS; j++)
+            row[4 * REG_MAX + j] = rng.uniform(-8.f, -2.f);
+        // 每个候选都有一个类别过阈值，保证所有候选都走 DFL
+        row[4 * REG_MAX + rng.range(0, NUM_CLASS)] = rng.uniform(1.f, 6.f);
+    }
+}
+
+// 解码结果：每个候选 x0, y0, x1, y1, prob, label
+struct Decoded
+{
+    std::vector<float> v;
+
+    void clear() { v.clear(); }
+
+    void push(float cx, float cy, float stride, const float ltrb[4], float prob, int label)
+    {
+        v.push_back(cx - ltrb[0] * stride);
+        v.push_back(cy - ltrb[1] * stride);
+        v.push_back(cx + ltrb[2] * stride);
+        v.push_back(cy + ltrb[3] * stride);
+        v.push_back(prob);
+        v.push_back((float)label);
+    }
+};
+
+static void run_fused(float* pred, int n, const AnchorTable& anchors, float threshold, Decoded& out)
+{
+    out.clear();
+    for (int i = 0; i < n; i++)
+    {
+        float* row = pred + (size_t)i * ROW_SIZE;
+        float score;
+        int label = argmax(row + 4 * REG_MAX, NUM_CLASS, &score);
+        float prob = sigmoid(score);
+        if (prob < threshold)
+            continue;
+
+        float ltrb[4];
+        dfl_decode(row, REG_MAX, ltrb);
+        out.push(anchors.cx[i], anchors.cy[i], anchors.stride[i], ltrb, prob, label);
+    }
+}
+
+static void run_scalar(float* pred, int n, const AnchorTable& anchors, float threshold, Decoded& out)
+{
+    out.clear();
+    for (int i = 0; i < n; i++)
+    {
+        float* row = pred + (size_t)i * ROW_SIZE;
+        const float* scores = row + 4 * REG_MAX;
+        int label = -1;
+        float score = -FLT_MAX;
+        for (int k = 0; k < NUM_CLASS; k++)
+        {
+            if (scores[k] > score)
+            {
+                label = k;
+                score = scores[k];
+            }
+        }
+        float prob = sigmoid(score);
+        if (prob < threshold)
+            continue;
+
+        float ltrb[4];
+        for (int k = 0; k < 4; k++)
+        {
+            float* p = row + k * REG_MAX;
+            float max_val = -FLT_MAX;
+            for (int l = 0; l < REG_MAX; l++)
+                max_val = std::max(max_val, p[l]);
+            float sum = 0.f;
+            for (int l = 0; l < REG_MAX; l++)
+            {
+                p[l] = expf(p[l] - max_val);
+                sum += p[l];
+            }
+            float dis = 0.f;
+            for (int l = 0; l < REG_MAX; l++)
+            {
+                p[l] /= sum;
+                dis += l * p[l];
+            }
+            ltrb[k] = dis;
+        }
+        out.push(anchors.cx[i], anchors.cy[i], anchors.stride[i], ltrb, prob, label);
+    }
+}
+
+#if BENCH_WITH_NCNN
+// 被替换前的实现（逐候选创建 / 销毁 Softmax 层）
+static void run_softmax_layer(float* pred, int n, const AnchorTable& anchors, float threshold, Decoded& out)
+{
+    out.clear();
+    for (int i = 0; i < n; i++)
+    {
+        float* row = pred + (size_t)i * ROW_SIZE;
+        const float* scores = row + 4 * REG_MAX;
+        int label = -1;
+        float score = -FLT_MAX;
+        for (int k = 0; k < NUM_CLASS; k++)
+        {
+            if (scores[k] > score)
+            {
+                label = k;
+                score = scores[k];
+            }
+        }
+        float prob = sigmoid(score);
+        if (prob < threshold)
+            continue;
+
+        ncnn::Mat bbox_pred(REG_MAX, 4, (void*)row);
+        {
+            ncnn::Layer* softmax = ncnn::create_layer("Softmax");
+
+            ncnn::ParamDict pd;
+            pd.set(0, 1); // axis
+            pd.set(1, 1);
+            softmax->load_param(pd);
+
+            ncnn::Option opt;
+            opt.num_threads = 1;
+            opt.use_packing_layout = false;
+
+            softmax->create_pipeline(opt);
+
+            softmax->forward_inplace(bbox_pred, opt);
+
+            softmax->destroy_pipeline(opt);
+
+            delete softmax;
+        }
+
+        float ltrb[4];
+        for (int k = 0; k < 4; k++)
+        {
+            float dis = 0.f;
+            const float* dis_after_sm = bbox_pred.row(k);
+            for (int l = 0; l < REG_MAX; l++)
+            {
+                dis += l * dis_after_sm[l];
+            }
+            ltrb[k] = dis;
+        }
+        out.push(anchors.cx[i], anchors.cy[i], anchors.stride[i], ltrb, prob, label);
+    }
+}
+#endif
+
+static void check_same(const char* name, const Decoded& got, const Decoded& want, int n)
+{
+    CHECK(got.v.size() == want.v.size(), "%s n=%d: %zu values, want %zu", name, n, got.v.size(), want.v.size());
+    const size_t count = std::min(got.v.size(), want.v.size());
+    int mismatches = 0;
+    for (size_t i = 0; i < count && mismatches < 5; i++)
+    {
+        // 坐标以像素计（stride 最大 32），1e-3 足够区分实现错误
+        if (fabsf(got.v[i] - want.v[i]) > 1e-3f)
+        {
+            CHECK(false, "%s n=%d: value %zu = %f, want %f", name, n, i, got.v[i], want.v[i]);
+            mismatches++;
+        }
+    }
+}
+
+typedef void (*DecodeFn)(float*, int, const AnchorTable&, float, Decoded&);
+
+// 每轮从原始数据拷贝一份（DFL 会原地写回 softmax），拷贝时间不计入
+static double time_path(DecodeFn fn, const std::vector<float>& src, int n, const AnchorTable& anchors,
+                        int rounds, Decoded& out)
+{
+    std::vector<float> work(src.size());
+    double best = 1e30;
+    for (int r = 0; r <= rounds; r++)
+    {
+        memcpy(work.data(), src.data(), src.size() * sizeof(float));
+        const double t0 = bench_now_ms();
+        fn(work.data(), n, anchors, 0.25f, out);
+        const double t = bench_now_ms() - t0;
+        if (r > 0)
+            best = std::min(best, t);
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+    const int rounds = quick ? 2 : 20;
+
+    BenchRng rng;
+    const int sizes[] = {1000, 10000};
+    for (int n : sizes)
+    {
+        // 足够大的输入，保证 anchor 数 >= n（1280x1280 共 33600 个点）
+        std::shared_ptr<const AnchorTable> anchors = get_anchor_table(1280, 1280, std::vector<int>{8, 16, 32});
+
+        std::vector<float> pred;
+        make_pred(pred, n, rng);
+
+        Decoded fused, scalar;
+        const double t_fused = time_path(run_fused, pred, n, *anchors, rounds, fused);
+        const double t_scalar = time_path(run_scalar, pred, n, *anchors, rounds, scalar);
+        CHECK((int)fused.v.size() == n * 6, "n=%d: only %zu proposals decoded", n, fused.v.size() / 6);
+        check_same("scalar", scalar, fused, n);
+
+        printf("dfl n=%5d  fused %8.3f ms  scalar %8.3f ms", n, t_fused, t_scalar);
+#if BENCH_WITH_NCNN
+        Decoded layer;
+        const double t_layer = time_path(run_softmax_layer, pred, n, *anchors, rounds, layer);
+        check_same("softmax", layer, fused, n);
+        printf("  softmax-layer %8.3f ms  (x%.1f)", t_layer, t_layer / t_fused);
+#else
+        printf("  softmax-layer n/a (configured without ncnn)");
+#endif
+        printf("\n");
+    }
+
+    if (bench_failures())
+    {
+        fprintf(stderr, "bench_dfl: %d check(s) failed\n", bench_failures());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+// 分割掩码叠加基准：1920x1080 画面，50 个椭圆掩码（框边长 80~300 像素）
+//
+//   full-frame   逐目标扫描整帧、判断像素是否在该目标掩码内再混合（最初的做法）
+//   per-object   逐目标遍历 RLE 前景段、逐像素标量混合（重叠处会被重复混合）
+//   compositor   MaskCompositor：标签图 + 按段 SIMD 混合，每像素最多混合一次
+//
+// 用法：bench_mask_overlay [--quick]   --quick 跳过 full-frame 且只跑一轮
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "mask_overlay.h"
+#include "bench_util.h"
+
+#define FRAME_W 1920
+#define FRAME_H 1080
+#define NUM_OBJECTS 50
+#define ALPHA 128
+
+static void blend_px(uint8_t* px, const uint8_t color[3], int alpha)
+{
+    for (int c = 0; c < 3; c++)
+        px[c] = (uint8_t)((px[c] * (256 - alpha) + color[c] * alpha + 128) >> 8);
+}
+
+static void ellipse_mask(MaskRLE& rle, int w, int h)
+{
+    std::vector<uint8_t> bits((size_t)w * h);
+    const float rx = w * 0.5f;
+    const float ry = h * 0.5f;
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            const float dx = (x + 0.5f - rx) / rx;
+            const float dy = (y + 0.5f - ry) / ry;
+            bits[(size_t)y * w + x] = dx * dx + dy * dy <= 1.f;
+        }
+    }
+    rle_encode(bits.data(), w, h, w, rle);
+}
+
+static void overlay_full_frame(const std::vector<MaskLayer>& layers, const std::vector<std::vector<uint8_t> >& bitmaps, uint8_t* frame)
+{
+    for (size_t k = 0; k < layers.size(); k++)
+    {
+        const MaskLayer& l = layers[k];
+        for (int y = 0; y < FRAME_H; y++)
+        {
+            for (int x = 0; x < FRAME_W; x++)
+            {
+                const int mx = x - l.ox;
+                const int my = y - l.oy;
+                if (mx < 0 || my < 0 || mx >= l.rle->width || my >= l.rle->height)
+                    continue;
+                if (bitmaps[k][(size_t)my * l.rle->width + mx])
+                    blend_px(frame + ((size_t)y * FRAME_W + x) * 3, l.color, ALPHA);
+            }
+        }
+    }
+}
+
+static void overlay_per_object(const std::vector<MaskLayer>& layers, uint8_t* frame)
+{
+    for (const MaskLayer& l : layers)
+    {
+        rle_for_each_span(*l.rle, [&](int y, int x, int len) {
+            uint8_t* p = frame + ((size_t)(l.oy + y) * FRAME_W + l.ox + x) * 3;
+            for (int i = 0; i < len; i++)
+                blend_px(p + i * 3, l.color, ALPHA);
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+    const int rounds = quick ? 1 : 10;
+
+    BenchRng rng;
+    std::vector<MaskRLE> masks(NUM_OBJECTS);
+    std::vector<MaskLayer> layers(NUM_OBJECTS);
+    std::vector<std::vector<uint8_t> > bitmaps(NUM_OBJECTS);
+    size_t fg_pixels = 0;
+    for (int k = 0; k < NUM_OBJECTS; k++)
+    {
+        const int w = rng.range(80, 301);
+        const int h = rng.range(80, 301);
+        ellipse_mask(masks[k], w, h);
+        fg_pixels += rle_area(masks[k]);
+
+        MaskLayer& l = layers[k];
+        l.rle = &masks[k];
+        l.ox = rng.range(0, FRAME_W - w + 1);
+        l.oy = rng.range(0, FRAME_H - h + 1);
+        l.color[0] = (uint8_t)rng.next();
+        l.color[1] = (uint8_t)rng.next();
+        l.color[2] = (uint8_t)rng.next();
+
+        bitmaps[k].resize((size_t)w * h);
+        rle_decode(masks[k], 0, 0, w, h, 1, bitmaps[k].data(), w);
+    }
+
+    std::vector<uint8_t> source((size_t)FRAME_W * FRAME_H * 3);
+    for (uint8_t& v : source)
+        v = (uint8_t)rng.next();
+    std::vector<uint8_t> frame(source.size());
+
+    printf("mask overlay %dx%d, %d ellipses, %zu foreground pixels\n", FRAME_W, FRAME_H, NUM_OBJECTS, fg_pixels);
+
+    // 每轮从原始帧拷贝，拷贝不计时
+    auto time_overlay = [&](auto fn) {
+        double best = 1e30;
+        for (int r = 0; r < rounds; r++)
+        {
+            memcpy(frame.data(), source.data(), source.size());
+            const double t0 = bench_now_ms();
+            fn();
+            best = std::min(best, bench_now_ms() - t0);
+        }
+        return best;
+    };
+
+    if (!quick)
+    {
+        const double t = time_overlay([&]() { overlay_full_frame(layers, bitmaps, frame.data()); });
+        printf("  full-frame  %8.3f ms\n", t);
+    }
+
+    const double t_obj = time_overlay([&]() { overlay_per_object(layers, frame.data()); });
+    printf("  per-object  %8.3f ms\n", t_obj);
+
+    MaskCompositor compositor;
+    compositor.composite(layers, frame.data(), FRAME_W, FRAME_H, FRAME_W * 3, ALPHA);   // 预热标签图缓冲
+    const double t_comp = time_overlay([&]() {
+        compositor.composite(layers, frame.data(), FRAME_W, FRAME_H, FRAME_W * 3, ALPHA);
+    });
+    printf("  compositor  %8.3f ms\n", t_comp);
+    return 0;
+}
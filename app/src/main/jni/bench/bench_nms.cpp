@@ -0,0 +1,273 @@
+// NMS 引擎基准与正确性检查（nms.h 的 0–4 五种模式）
+//
+// 合成场景：1920x1080 画面内若干目标，每个目标周围有数个抖动的重复框（模拟检测头的密集输出），
+// 10 个类别，框数 100 / 1k / 5k / 20k
+// 检查：
+//   - NMS_GRID 的 picked 与 NMS_GREEDY 完全一致
+//   - NMS_PER_CLASS / NMS_FAST / NMS_MATRIX 与逐对计算 IoU 的标量参考实现一致（框数 <= 5k）
+//
+// 用法：bench_nms [--quick]   --quick 每种模式只计时一轮，供 ctest 做回归检查
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "nms.h"
+#include "postprocess.h"
+#include "bench_util.h"
+
+#define NUM_LABELS 10
+#define SCENE_W 1920.f
+#define SCENE_H 1080.f
+
+static void make_scene(std::vector<Object>& objects, int n, BenchRng& rng)
+{
+    objects.clear();
+    objects.reserve(n);
+    while ((int)objects.size() < n)
+    {
+        // 一个目标：基准框 + 若干抖动副本，同一目标的副本同一类别
+        const float w = rng.uniform(16.f, 200.f);
+        const float h = rng.uniform(16.f, 200.f);
+        const float x = rng.uniform(0.f, SCENE_W - w);
+        const float y = rng.uniform(0.f, SCENE_H - h);
+        const int label = rng.range(0, NUM_LABELS);
+        const int copies = rng.range(1, 9);
+        for (int c = 0; c < copies && (int)objects.size() < n; c++)
+        {
+            Object obj;
+            obj.rect.x = x + rng.uniform(-0.15f, 0.15f) * w;
+            obj.rect.y = y + rng.uniform(-0.15f, 0.15f) * h;
+            obj.rect.width = w * rng.uniform(0.85f, 1.15f);
+            obj.rect.height = h * rng.uniform(0.85f, 1.15f);
+            obj.label = label;
+            obj.prob = rng.uniform(0.25f, 1.f);
+            objects.push_back(obj);
+        }
+    }
+    qsort_descent_inplace(objects);
+}
+
+// =============================
+// 标量参考实现（逐对 IoU，不用 BoxSoA）
+// =============================
+
+static void corners(const Object& o, float b[4])
+{
+    b[0] = o.rect.x;
+    b[1] = o.rect.y;
+    b[2] = o.rect.x + o.rect.width;
+    b[3] = o.rect.y + o.rect.height;
+}
+
+static float inter_area(const float a[4], const float b[4])
+{
+    float w = std::min(a[2], b[2]) - std::max(a[0], b[0]);
+    float h = std::min(a[3], b[3]) - std::max(a[1], b[1]);
+    return std::max(w, 0.f) * std::max(h, 0.f);
+}
+
+static float area_of(const float b[4])
+{
+    return (b[2] - b[0]) * (b[3] - b[1]);
+}
+
+// 与 BoxSoA::overlaps 相同的判定：inter > t * union
+static bool suppresses(const float a[4], const float b[4], float t)
+{
+    float inter = inter_area(a, b);
+    return inter > (area_of(a) + area_of(b) - inter) * t;
+}
+
+static float iou(const float a[4], const float b[4])
+{
+    float inter = inter_area(a, b);
+    return inter / std::max(area_of(a) + area_of(b) - inter, FLT_MIN);
+}
+
+static void groups_of(const std::vector<Object>& objects, std::vector<std::vector<int> >& groups, size_t cap)
+{
+    groups.assign(NUM_LABELS, std::vector<int>());
+    for (int i = 0; i < (int)objects.size(); i++)
+    {
+        if (groups[objects[i].label].size() < cap)
+            groups[objects[i].label].push_back(i);
+    }
+}
+
+static void ref_per_class(const std::vector<Object>& objects, std::vector<int>& picked, float t)
+{
+    picked.clear();
+    std::vector<std::vector<int> > groups;
+    groups_of(objects, groups, objects.size());
+    for (const auto& g : groups)
+    {
+        std::vector<int> kept;
+        for (int idx : g)
+        {
+            float a[4];
+            corners(objects[idx], a);
+            bool keep = true;
+            for (int k : kept)
+            {
+                float b[4];
+                corners(objects[k], b);
+                if (suppresses(a, b, t))
+                {
+                    keep = false;
+                    break;
+                }
+            }
+            if (keep)
+                kept.push_back(idx);
+        }
+        picked.insert(picked.end(), kept.begin(), kept.end());
+    }
+    std::sort(picked.begin(), picked.end());
+}
+
+static void ref_fast(const std::vector<Object>& objects, std::vector<int>& picked, float t)
+{
+    picked.clear();
+    std::vector<std::vector<int> > groups;
+    groups_of(objects, groups, NMS_MATRIX_MAX_CANDIDATES);
+    for (const auto& g : groups)
+    {
+        for (size_t i = 0; i < g.size(); i++)
+        {
+            float a[4];
+            corners(objects[g[i]], a);
+            float max_iou = 0.f;
+            for (size_t j = 0; j < i; j++)
+            {
+                float b[4];
+                corners(objects[g[j]], b);
+                max_iou = std::max(max_iou, iou(b, a));
+            }
+            if (max_iou <= t)
+                picked.push_back(g[i]);
+        }
+    }
+    std::sort(picked.begin(), picked.end());
+}
+
+static void ref_matrix(std::vector<Object>& objects, std::vector<int>& picked, float score_threshold, float sigma)
+{
+    picked.clear();
+    std::vector<std::vector<int> > groups;
+    groups_of(objects, groups, NMS_MATRIX_MAX_CANDIDATES);
+    for (const auto& g : groups)
+    {
+        const size_t m = g.size();
+        // max_iou[i]：框 i 被更高分框覆盖的最大 IoU
+        std::vector<float> max_iou(m, 0.f);
+        std::vector<std::vector<float> > ious(m, std::vector<float>(m, 0.f));
+        for (size_t i = 0; i < m; i++)
+        {
+            float a[4];
+            corners(objects[g[i]], a);
+            for (size_t j = i + 1; j < m; j++)
+            {
+                float b[4];
+                corners(objects[g[j]], b);
+                ious[i][j] = iou(a, b);
+                max_iou[j] = std::max(max_iou[j], ious[i][j]);
+            }
+        }
+        std::vector<float> decay(m, 1.f);
+        for (size_t j = 0; j < m; j++)
+        {
+            for (size_t i = 0; i < j; i++)
+                decay[j] = std::min(decay[j], expf(-sigma * (ious[i][j] * ious[i][j] - max_iou[i] * max_iou[i])));
+        }
+        for (size_t i = 0; i < m; i++)
+        {
+            objects[g[i]].prob *= decay[i];
+            if (objects[g[i]].prob >= score_threshold)
+                picked.push_back(g[i]);
+        }
+    }
+    std::sort(picked.begin(), picked.end(), [&objects](int a, int b) {
+        return objects[a].prob > objects[b].prob;
+    });
+}
+
+static void check_picked(const char* name, int n, const std::vector<int>& got, const std::vector<int>& want)
+{
+    CHECK(got == want, "%s n=%d: %zu picked, want %zu%s", name, n, got.size(), want.size(),
+          got.size() == want.size() ? " (same count, different indices)" : "");
+}
+
+static const char* mode_names[NMS_MODE_COUNT] = {"greedy", "per-class", "grid", "fast", "matrix"};
+
+int main(int argc, char** argv)
+{
+    const bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+    const int rounds = quick ? 1 : 10;
+    const float nms_threshold = 0.45f;
+    const float score_threshold = 0.25f;
+
+    BenchRng rng;
+    const int sizes[] = {100, 1000, 5000, 20000};
+    for (int n : sizes)
+    {
+        std::vector<Object> scene;
+        make_scene(scene, n, rng);
+
+        printf("nms n=%5d", n);
+        std::vector<int> picked[NMS_MODE_COUNT];
+        std::vector<Object> matrix_objects;
+        for (int mode = 0; mode < NMS_MODE_COUNT; mode++)
+        {
+            std::vector<Object> objects;
+            // Matrix-NMS 会改写分数，每轮从原始场景拷贝（拷贝不计时）
+            double best = 1e30;
+            for (int r = 0; r < rounds; r++)
+            {
+                objects = scene;
+                const double t0 = bench_now_ms();
+                nms_dispatch(objects, picked[mode], nms_threshold, score_threshold, mode);
+                best = std::min(best, bench_now_ms() - t0);
+            }
+            if (mode == NMS_MATRIX)
+                matrix_objects = objects;
+            printf("  %s %7.3f ms (%zu)", mode_names[mode], best, picked[mode].size());
+        }
+        printf("\n");
+
+        check_picked("grid vs greedy", n, picked[NMS_GRID], picked[NMS_GREEDY]);
+
+        if (n <= 5000)
+        {
+            std::vector<int> want;
+            ref_per_class(scene, want, nms_threshold);
+            check_picked("per-class", n, picked[NMS_PER_CLASS], want);
+
+            ref_fast(scene, want, nms_threshold);
+            check_picked("fast", n, picked[NMS_FAST], want);
+
+            std::vector<Object> ref_objects = scene;
+            ref_matrix(ref_objects, want, score_threshold, 2.f);
+            check_picked("matrix", n, picked[NMS_MATRIX], want);
+            for (size_t i = 0; i < ref_objects.size(); i++)
+            {
+                if (fabsf(matrix_objects[i].prob - ref_objects[i].prob) > 1e-5f)
+                {
+                    CHECK(false, "matrix n=%d: decayed prob[%zu] = %f, want %f", n, i, matrix_objects[i].prob, ref_objects[i].prob);
+                    break;
+                }
+            }
+        }
+    }
+
+    if (bench_failures())
+    {
+        fprintf(stderr, "bench_nms: %d check(s) failed\n", bench_failures());
+        return 1;
+    }
+    return 0;
+}
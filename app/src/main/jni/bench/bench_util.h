@@ -0,0 +1,81 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+
+// =============================
+// 主机单测 / 基准共用的小工具
+// =============================
+
+inline double bench_now_ms()
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// 运行 fn 共 rounds 轮，返回单轮最短耗时（ms），首轮之前先预热一次
+template<typename Fn>
+double bench_best_ms(int rounds, Fn fn)
+{
+    fn();
+    double best = 1e30;
+    for (int r = 0; r < rounds; r++)
+    {
+        const double t0 = bench_now_ms();
+        fn();
+        best = std::min(best, bench_now_ms() - t0);
+    }
+    return best;
+}
+
+// 固定种子的 xorshift 随机数，保证每次运行的合成数据一致
+struct BenchRng
+{
+    uint32_t s;
+
+    explicit BenchRng(uint32_t seed = 2463534242u) : s(seed) {}
+
+    uint32_t next()
+    {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        return s;
+    }
+
+    // [lo, hi)
+    float uniform(float lo, float hi)
+    {
+        return lo + (hi - lo) * (float)(next() >> 8) * (1.f / 16777216.f);
+    }
+
+    int range(int lo, int hi)
+    {
+        return lo + (int)(next() % (uint32_t)(hi - lo));
+    }
+};
+
+// 失败计数：CHECK 失败时打印位置并计数，main 最后返回 bench_failures() != 0
+inline int& bench_failures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond, ...)                                              \
+    do                                                                \
+    {                                                                 \
+        if (!(cond))                                                  \
+        {                                                             \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond); \
+            fprintf(stderr, __VA_ARGS__);                             \
+            fprintf(stderr, "\n");                                    \
+            bench_failures()++;                                       \
+        }                                                             \
+    } while (0)
+
+#endif // BENCH_UTIL_H
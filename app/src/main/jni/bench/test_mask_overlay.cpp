@@ -0,0 +1,181 @@
+// mask_overlay 正确性检查
+//   - blend_span_rgb 的 SIMD 路径与逐像素标量公式逐字节一致（含 n % 16 != 0 的尾部、非对齐起点、alpha 0 / 256）
+//   - MaskCompositor::composite 与逐像素暴力实现逐字节一致：层相互重叠（后加入的层优先、每像素只混合一次）、
+//     层部分超出画面、空掩码 / 空指针层、带行填充的帧（填充字节不得被改写）
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "mask_overlay.h"
+#include "bench_util.h"
+
+static void blend_px_ref(uint8_t* px, const uint8_t color[3], int alpha)
+{
+    for (int c = 0; c < 3; c++)
+        px[c] = (uint8_t)((px[c] * (256 - alpha) + color[c] * alpha + 128) >> 8);
+}
+
+static void test_blend_span(BenchRng& rng)
+{
+    const int alphas[] = {0, 1, 77, 128, 200, 255, 256};
+    for (int n = 0; n <= 70; n++)
+    {
+        for (int alpha : alphas)
+        {
+            for (int offset = 0; offset < 3; offset++)
+            {
+                // offset 让起点不按 16 字节对齐
+                std::vector<uint8_t> buf((n + 2) * 3 + offset);
+                for (uint8_t& v : buf)
+                    v = (uint8_t)rng.next();
+                std::vector<uint8_t> ref = buf;
+
+                const uint8_t color[3] = {(uint8_t)rng.next(), (uint8_t)rng.next(), (uint8_t)rng.next()};
+                blend_span_rgb(buf.data() + offset, n, color, alpha);
+                for (int i = 0; i < n; i++)
+                    blend_px_ref(ref.data() + offset + i * 3, color, alpha);
+
+                // 段外字节（前 offset 个、末尾 2 个像素）必须保持原样，ref 中同样未改动
+                for (size_t i = 0; i < buf.size(); i++)
+                {
+                    if (buf[i] != ref[i])
+                    {
+                        CHECK(false, "n=%d alpha=%d offset=%d: byte %zu = %d, want %d", n, alpha, offset, i, buf[i], ref[i]);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 随机形状的掩码（每行若干段前景），保证覆盖跨行游程与整行前景 / 背景
+static void random_mask(MaskRLE& rle, int w, int h, BenchRng& rng)
+{
+    std::vector<uint8_t> bits((size_t)w * h);
+    for (int y = 0; y < h; y++)
+    {
+        const int mode = rng.range(0, 4);
+        for (int x = 0; x < w; x++)
+        {
+            uint8_t v;
+            if (mode == 0)
+                v = 0;
+            else if (mode == 1)
+                v = 1;
+            else
+                v = (uint8_t)((x / (1 + rng.range(0, 3)) + y) % 5 < 3);
+            bits[(size_t)y * w + x] = v;
+        }
+    }
+    rle_encode(bits.data(), w, h, w, rle);
+}
+
+// 暴力参考：逐像素找最后一个覆盖它的层，混合一次
+static void composite_ref(const std::vector<MaskLayer>& layers, uint8_t* frame, int fw, int fh, size_t stride, int alpha)
+{
+    std::vector<std::vector<uint8_t> > bitmaps(layers.size());
+    for (size_t k = 0; k < layers.size(); k++)
+    {
+        const MaskRLE* rle = layers[k].rle;
+        if (!rle || rle->empty())
+            continue;
+        bitmaps[k].resize((size_t)rle->width * rle->height);
+        rle_decode(*rle, 0, 0, rle->width, rle->height, 1, bitmaps[k].data(), rle->width);
+    }
+
+    for (int y = 0; y < fh; y++)
+    {
+        for (int x = 0; x < fw; x++)
+        {
+            int top = -1;
+            for (size_t k = 0; k < layers.size(); k++)
+            {
+                const MaskLayer& l = layers[k];
+                if (bitmaps[k].empty())
+                    continue;
+                const int mx = x - l.ox;
+                const int my = y - l.oy;
+                if (mx < 0 || my < 0 || mx >= l.rle->width || my >= l.rle->height)
+                    continue;
+                if (bitmaps[k][(size_t)my * l.rle->width + mx])
+                    top = (int)k;
+            }
+            if (top >= 0)
+                blend_px_ref(frame + stride * y + x * 3, layers[top].color, alpha);
+        }
+    }
+}
+
+static void test_composite(BenchRng& rng)
+{
+    MaskCompositor compositor;   // 跨场景复用，覆盖缓冲复用路径
+    for (int scene = 0; scene < 60; scene++)
+    {
+        const int fw = rng.range(1, 97);
+        const int fh = rng.range(1, 61);
+        const size_t stride = (size_t)fw * 3 + rng.range(0, 9);
+
+        const int num_layers = rng.range(0, 9);
+        std::vector<MaskRLE> masks(num_layers);
+        std::vector<MaskLayer> layers(num_layers);
+        for (int k = 0; k < num_layers; k++)
+        {
+            MaskLayer& l = layers[k];
+            const int kind = rng.range(0, 10);
+            if (kind == 0)
+            {
+                l.rle = nullptr;
+            }
+            else
+            {
+                // kind == 1 为空掩码
+                if (kind != 1)
+                    random_mask(masks[k], rng.range(1, fw + 20), rng.range(1, fh + 20), rng);
+                l.rle = &masks[k];
+            }
+            // 允许超出画面（含完全在画面外）
+            l.ox = rng.range(-fw / 2 - 10, fw);
+            l.oy = rng.range(-fh / 2 - 10, fh);
+            l.color[0] = (uint8_t)rng.next();
+            l.color[1] = (uint8_t)rng.next();
+            l.color[2] = (uint8_t)rng.next();
+        }
+
+        std::vector<uint8_t> frame(stride * fh);
+        for (uint8_t& v : frame)
+            v = (uint8_t)rng.next();
+        std::vector<uint8_t> ref = frame;
+
+        const int alpha = scene % 3 == 0 ? 128 : rng.range(0, 257);
+        compositor.composite(layers, frame.data(), fw, fh, stride, alpha);
+        composite_ref(layers, ref.data(), fw, fh, stride, alpha);
+
+        for (size_t i = 0; i < frame.size(); i++)
+        {
+            if (frame[i] != ref[i])
+            {
+                CHECK(false, "scene %d (%dx%d, %d layers): byte %zu (row %zu, col %zu) = %d, want %d",
+                      scene, fw, fh, num_layers, i, i / stride, i % stride, frame[i], ref[i]);
+                break;
+            }
+        }
+    }
+}
+
+int main()
+{
+    BenchRng rng;
+    test_blend_span(rng);
+    test_composite(rng);
+
+    if (bench_failures())
+    {
+        fprintf(stderr, "mask_overlay: %d check(s) failed\n", bench_failures());
+        return 1;
+    }
+    printf("mask_overlay: ok\n");
+    return 0;
+}
@@ -0,0 +1,187 @@
+// mask_rle 正确性检查：编码 / 解码往返、ROI 解码、面积、IoU（与逐像素位图计算对比）
+// IoU 覆盖两掩码相对平移（含负偏移、不相交、完全重合）、整行前景产生的跨行游程、空掩码
+
+#include <math.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "mask_rle.h"
+#include "bench_util.h"
+
+struct Bitmap
+{
+    int w;
+    int h;
+    std::vector<uint8_t> bits;
+
+    uint8_t at(int x, int y) const { return bits[(size_t)y * w + x]; }
+};
+
+static void random_bitmap(Bitmap& b, int w, int h, BenchRng& rng)
+{
+    b.w = w;
+    b.h = h;
+    b.bits.assign((size_t)w * h, 0);
+    const int style = rng.range(0, 4);
+    for (int y = 0; y < h; y++)
+    {
+        // 整行前景 / 背景的行让游程跨行
+        const int row_mode = rng.range(0, 5);
+        for (int x = 0; x < w; x++)
+        {
+            uint8_t v;
+            if (style == 0)
+                v = 0;
+            else if (row_mode == 0)
+                v = 0;
+            else if (row_mode == 1)
+                v = 1;
+            else if (style == 1)
+                v = (rng.next() & 3) == 0;
+            else
+                v = (uint8_t)(((x * 3 + y * 5) / (2 + style)) % 4 < 2);
+            b.bits[(size_t)y * w + x] = v;
+        }
+    }
+}
+
+static uint32_t area_ref(const Bitmap& b)
+{
+    uint32_t n = 0;
+    for (uint8_t v : b.bits)
+        n += v != 0;
+    return n;
+}
+
+static float iou_ref(const Bitmap& a, int ax, int ay, const Bitmap& b, int bx, int by)
+{
+    uint32_t inter = 0;
+    for (int y = 0; y < a.h; y++)
+    {
+        for (int x = 0; x < a.w; x++)
+        {
+            if (!a.at(x, y))
+                continue;
+            const int qx = ax + x - bx;
+            const int qy = ay + y - by;
+            if (qx >= 0 && qy >= 0 && qx < b.w && qy < b.h && b.at(qx, qy))
+                inter++;
+        }
+    }
+    const uint32_t uni = area_ref(a) + area_ref(b) - inter;
+    return uni ? (float)inter / uni : 0.f;
+}
+
+static void test_encode_decode(BenchRng& rng)
+{
+    for (int t = 0; t < 200; t++)
+    {
+        Bitmap b;
+        random_bitmap(b, rng.range(1, 40), rng.range(1, 30), rng);
+
+        // 带行填充的源数据，填充字节非 0，不能被当作前景
+        const size_t stride = b.w + rng.range(0, 5);
+        std::vector<uint8_t> src(stride * b.h, 0xff);
+        for (int y = 0; y < b.h; y++)
+            std::copy(b.bits.begin() + (size_t)y * b.w, b.bits.begin() + (size_t)(y + 1) * b.w, src.begin() + stride * y);
+
+        MaskRLE rle;
+        rle_encode(src.data(), b.w, b.h, stride, rle);
+        CHECK(rle.width == b.w && rle.height == b.h, "t=%d size %dx%d", t, rle.width, rle.height);
+
+        uint64_t total = 0;
+        for (uint32_t c : rle.counts)
+            total += c;
+        CHECK(total == (uint64_t)b.w * b.h, "t=%d counts sum %llu, want %d", t, (unsigned long long)total, b.w * b.h);
+        for (size_t i = 1; i + 1 < rle.counts.size(); i++)
+            CHECK(rle.counts[i] > 0, "t=%d zero-length run at %zu", t, i);
+
+        CHECK(rle_area(rle) == area_ref(b), "t=%d area %u, want %u", t, rle_area(rle), area_ref(b));
+
+        // 全图解码往返
+        std::vector<uint8_t> out((size_t)b.w * b.h, 0x55);
+        rle_decode(rle, 0, 0, b.w, b.h, 1, out.data(), b.w);
+        CHECK(out == b.bits, "t=%d full decode mismatch", t);
+
+        // 随机 ROI 解码
+        const int rx = rng.range(0, b.w);
+        const int ry = rng.range(0, b.h);
+        const int rw = rng.range(1, b.w - rx + 1);
+        const int rh = rng.range(1, b.h - ry + 1);
+        std::vector<uint8_t> roi((size_t)rw * rh, 0x55);
+        rle_decode(rle, rx, ry, rw, rh, 255, roi.data(), rw);
+        for (int y = 0; y < rh; y++)
+        {
+            for (int x = 0; x < rw; x++)
+            {
+                const uint8_t want = b.at(rx + x, ry + y) ? 255 : 0;
+                if (roi[(size_t)y * rw + x] != want)
+                {
+                    CHECK(false, "t=%d roi (%d,%d %dx%d) pixel (%d,%d) = %d, want %d", t, rx, ry, rw, rh, x, y, roi[(size_t)y * rw + x], want);
+                    y = rh;
+                    break;
+                }
+            }
+        }
+
+        // 阈值编码与位图编码一致
+        std::vector<float> prob((size_t)b.w * b.h);
+        for (size_t i = 0; i < prob.size(); i++)
+            prob[i] = b.bits[i] ? rng.uniform(0.51f, 1.f) : rng.uniform(0.f, 0.5f);
+        MaskRLE rle_t;
+        rle_encode_threshold(prob.data(), b.w, b.h, b.w * sizeof(float), 0.5f, rle_t);
+        CHECK(rle_t.counts == rle.counts, "t=%d threshold encode differs", t);
+    }
+}
+
+static void test_iou(BenchRng& rng)
+{
+    for (int t = 0; t < 400; t++)
+    {
+        Bitmap a, b;
+        random_bitmap(a, rng.range(1, 30), rng.range(1, 30), rng);
+        random_bitmap(b, rng.range(1, 30), rng.range(1, 30), rng);
+        MaskRLE ra, rb;
+        rle_encode(a.bits.data(), a.w, a.h, a.w, ra);
+        rle_encode(b.bits.data(), b.w, b.h, b.w, rb);
+
+        const int ax = rng.range(-10, 10);
+        const int ay = rng.range(-10, 10);
+        // 多数情况相交，少数完全错开
+        const int bx = t % 8 == 0 ? ax + a.w + rng.range(0, 5) : ax + rng.range(-b.w + 1, a.w);
+        const int by = ay + rng.range(-b.h + 1, a.h);
+
+        const float want = iou_ref(a, ax, ay, b, bx, by);
+        const float got = rle_iou(ra, ax, ay, rb, bx, by);
+        CHECK(fabsf(got - want) < 1e-6f, "t=%d a %dx%d@(%d,%d) b %dx%d@(%d,%d): iou %f, want %f",
+              t, a.w, a.h, ax, ay, b.w, b.h, bx, by, got, want);
+
+        const float sym = rle_iou(rb, bx, by, ra, ax, ay);
+        CHECK(got == sym, "t=%d iou not symmetric: %f vs %f", t, got, sym);
+
+        // 与自身完全重合
+        if (area_ref(a) > 0)
+            CHECK(rle_iou(ra, ax, ay, ra, ax, ay) == 1.f, "t=%d self iou %f", t, rle_iou(ra, ax, ay, ra, ax, ay));
+    }
+
+    MaskRLE empty;
+    CHECK(rle_area(empty) == 0, "empty area %u", rle_area(empty));
+    CHECK(rle_iou(empty, 0, 0, empty, 0, 0) == 0.f, "empty iou");
+}
+
+int main()
+{
+    BenchRng rng;
+    test_encode_decode(rng);
+    test_iou(rng);
+
+    if (bench_failures())
+    {
+        fprintf(stderr, "mask_rle: %d check(s) failed\n", bench_failures());
+        return 1;
+    }
+    printf("mask_rle: ok\n");
+    return 0;
+}
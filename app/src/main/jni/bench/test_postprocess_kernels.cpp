@@ -0,0 +1,196 @@
+// postprocess_kernels 的 SIMD 路径与标量参考实现对比
+// 长度覆盖 n % 4 != 0 的尾部，确保向量主循环与标量尾循环衔接正确
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "postprocess_kernels.h"
+#include "bench_util.h"
+
+// 逐元素 softmax + 期望，与 ncnn Softmax 层 + 逐 bin 累加的旧路径等价
+static float dfl_side_ref(float* p, int reg_max)
+{
+    float max_val = -FLT_MAX;
+    for (int l = 0; l < reg_max; l++)
+        max_val = std::max(max_val, p[l]);
+
+    float sum = 0.f;
+    for (int l = 0; l < reg_max; l++)
+    {
+        p[l] = expf(p[l] - max_val);
+        sum += p[l];
+    }
+
+    float dot = 0.f;
+    for (int l = 0; l < reg_max; l++)
+    {
+        p[l] /= sum;
+        dot += l * p[l];
+    }
+    return dot;
+}
+
+static float iou_ref(const float a[4], const float b[4])
+{
+    float w = std::min(a[2], b[2]) - std::max(a[0], b[0]);
+    float h = std::min(a[3], b[3]) - std::max(a[1], b[1]);
+    float inter = std::max(w, 0.f) * std::max(h, 0.f);
+    float uni = (a[2] - a[0]) * (a[3] - a[1]) + (b[2] - b[0]) * (b[3] - b[1]) - inter;
+    return inter / std::max(uni, FLT_MIN);
+}
+
+static void test_sigmoid(BenchRng& rng)
+{
+    for (int n = 0; n <= 37; n++)
+    {
+        std::vector<float> x(n);
+        for (float& v : x)
+            v = rng.uniform(-12.f, 12.f);
+
+        std::vector<float> y = x;
+        sigmoid_inplace(y.data(), n);
+        for (int i = 0; i < n; i++)
+        {
+            const float ref = 1.f / (1.f + expf(-x[i]));
+            CHECK(fabsf(y[i] - ref) < 1e-5f, "n=%d i=%d x=%f got %f want %f", n, i, x[i], y[i], ref);
+        }
+    }
+}
+
+static void test_argmax(BenchRng& rng)
+{
+    CHECK(argmax(nullptr, 0, nullptr) == -1, "n=0 should return -1");
+
+    for (int n = 1; n <= 90; n++)
+    {
+        std::vector<float> s(n);
+        for (float& v : s)
+            v = rng.uniform(-1.f, 1.f);
+        // 并列最大值：取第一个
+        if (n > 2)
+            s[n - 1] = s[n / 2] = 2.f;
+
+        float max_score = 0.f;
+        const int got = argmax(s.data(), n, &max_score);
+        const int want = (int)(std::max_element(s.begin(), s.end()) - s.begin());
+        CHECK(got == want, "n=%d got %d want %d", n, got, want);
+        CHECK(max_score == s[want], "n=%d max %f want %f", n, max_score, s[want]);
+    }
+}
+
+static void test_dfl(BenchRng& rng)
+{
+    const int reg_maxes[] = {1, 3, 4, 7, 16, 17};
+    for (int reg_max : reg_maxes)
+    {
+        for (int t = 0; t < 50; t++)
+        {
+            std::vector<float> pred(4 * reg_max);
+            for (float& v : pred)
+                v = rng.uniform(-8.f, 8.f);
+            std::vector<float> ref = pred;
+
+            float ltrb[4];
+            dfl_decode(pred.data(), reg_max, ltrb);
+            for (int k = 0; k < 4; k++)
+            {
+                const float want = dfl_side_ref(&ref[k * reg_max], reg_max);
+                CHECK(fabsf(ltrb[k] - want) < 1e-4f, "reg_max=%d side=%d got %f want %f", reg_max, k, ltrb[k], want);
+            }
+            for (size_t i = 0; i < pred.size(); i++)
+                CHECK(fabsf(pred[i] - ref[i]) < 1e-5f, "reg_max=%d softmax[%zu] got %f want %f", reg_max, i, pred[i], ref[i]);
+        }
+    }
+}
+
+static void test_anchor_table()
+{
+    const std::vector<int> strides = {8, 16, 32};
+    std::shared_ptr<const AnchorTable> t = get_anchor_table(640, 384, strides);
+    CHECK(t->size() == 80 * 48 + 40 * 24 + 20 * 12, "size %d", t->size());
+    CHECK(t->cx[0] == 4.f && t->cy[0] == 4.f && t->stride[0] == 8.f, "first anchor (%f, %f, %f)", t->cx[0], t->cy[0], t->stride[0]);
+    CHECK(t->cx[80] == 4.f && t->cy[80] == 12.f, "second row (%f, %f)", t->cx[80], t->cy[80]);
+    const int last = t->size() - 1;
+    CHECK(t->cx[last] == 624.f && t->cy[last] == 368.f && t->stride[last] == 32.f, "last anchor (%f, %f, %f)", t->cx[last], t->cy[last], t->stride[last]);
+
+    // 命中缓存返回同一张表
+    CHECK(get_anchor_table(640, 384, strides) == t, "cache miss on identical key");
+
+    // 超出容量后最久未用的被淘汰，已取得的表仍然有效
+    for (int i = 1; i <= ANCHOR_CACHE_CAPACITY; i++)
+        get_anchor_table(640, 384 + 32 * i, strides);
+    CHECK(get_anchor_table(640, 384, strides) != t, "evicted table returned");
+    CHECK(t->size() == 80 * 48 + 40 * 24 + 20 * 12, "held table changed after eviction");
+}
+
+static void test_box_soa(BenchRng& rng)
+{
+    for (int n = 0; n <= 23; n++)
+    {
+        std::vector<float> boxes(4 * n);
+        BoxSoA soa;
+        for (int i = 0; i < n; i++)
+        {
+            float* b = &boxes[4 * i];
+            b[0] = rng.uniform(0.f, 200.f);
+            b[1] = rng.uniform(0.f, 200.f);
+            b[2] = b[0] + rng.uniform(0.f, 80.f);   // 含退化（零面积）框
+            b[3] = b[1] + rng.uniform(0.f, 80.f);
+            soa.push(b[0], b[1], b[2], b[3]);
+        }
+        CHECK((int)soa.size() == n, "size %zu want %d", soa.size(), n);
+
+        for (int t = 0; t < 20; t++)
+        {
+            float q[4];
+            q[0] = rng.uniform(0.f, 200.f);
+            q[1] = rng.uniform(0.f, 200.f);
+            q[2] = q[0] + rng.uniform(1.f, 80.f);
+            q[3] = q[1] + rng.uniform(1.f, 80.f);
+
+            const size_t begin = n ? (size_t)rng.range(0, n) : 0;
+            std::vector<float> row(n - begin + 1);
+            soa.iou_row(q[0], q[1], q[2], q[3], begin, row.data());
+
+            float max_iou = 0.f;
+            for (int j = 0; j < n; j++)
+            {
+                const float want = iou_ref(q, &boxes[4 * j]);
+                max_iou = std::max(max_iou, want);
+                if (j >= (int)begin)
+                    CHECK(fabsf(row[j - begin] - want) < 1e-5f, "n=%d j=%d iou %f want %f", n, j, row[j - begin], want);
+            }
+
+            const float thresholds[] = {0.f, 0.3f, 0.5f, 0.9f};
+            for (float th : thresholds)
+            {
+                // 阈值附近的浮点误差不计
+                if (fabsf(max_iou - th) < 1e-5f)
+                    continue;
+                CHECK(soa.overlaps(q[0], q[1], q[2], q[3], th) == (max_iou > th), "n=%d th=%.2f max_iou %f", n, th, max_iou);
+            }
+        }
+    }
+}
+
+int main()
+{
+    BenchRng rng;
+    test_sigmoid(rng);
+    test_argmax(rng);
+    test_dfl(rng);
+    test_anchor_table();
+    test_box_soa(rng);
+
+    if (bench_failures())
+    {
+        fprintf(stderr, "postprocess_kernels: %d check(s) failed\n", bench_failures());
+        return 1;
+    }
+    printf("postprocess_kernels: ok\n");
+    return 0;
+}
@@ -0,0 +1,215 @@
+// yuv_repack 正确性检查（构造的 YUV_420_888 平面数据）
+//   - yuv420_to_nv21 与原先 NdkCamera 中逐字节拷贝的循环逐字节一致，覆盖：
+//     带行填充的 NV21 半平面（V 在前）、NV12 半平面（U 在前）、三平面 I420、像素跨度 2 的分离平面、
+//     Y 平面像素跨度 2（走 deinterleave 路径，最后一行不含末尾填充字节），色度宽 w2 为奇数 / 非 16 倍数
+//   - 各平面按有效数据的最后一个字节精确分配，越界读可由 ASan 发现
+//   - nv21_crop_rotate 与先裁剪再 ncnn::kanna_rotate_yuv420sp 的结果一致（rotate_type 1~8，需 ncnn）
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "yuv_repack.h"
+#include "bench_util.h"
+
+#if BENCH_WITH_NCNN
+#include "mat.h"
+#endif
+
+// 原 NdkCamera::onImageAvailable 中的 NV21 构造循环
+static void yuv420_to_nv21_ref(const Yuv420Planes& p, uint8_t* nv21)
+{
+    uint8_t* yptr = nv21;
+    for (int y = 0; y < p.height; y++)
+    {
+        const uint8_t* y_data_ptr = p.y + p.y_row_stride * y;
+        for (int x = 0; x < p.width; x++)
+        {
+            yptr[0] = y_data_ptr[0];
+            yptr++;
+            y_data_ptr += p.y_pixel_stride;
+        }
+    }
+
+    uint8_t* uvptr = nv21 + p.width * p.height;
+    for (int y = 0; y < p.height / 2; y++)
+    {
+        const uint8_t* v_data_ptr = p.v + p.v_row_stride * y;
+        const uint8_t* u_data_ptr = p.u + p.u_row_stride * y;
+        for (int x = 0; x < p.width / 2; x++)
+        {
+            uvptr[0] = v_data_ptr[0];
+            uvptr[1] = u_data_ptr[0];
+            uvptr += 2;
+            v_data_ptr += p.v_pixel_stride;
+            u_data_ptr += p.u_pixel_stride;
+        }
+    }
+}
+
+// 平面恰好到最后一个有效字节为止（最后一行不带填充）
+static size_t plane_bytes(int rows, int row_stride, int cols, int pixel_stride)
+{
+    return (size_t)(rows - 1) * row_stride + (size_t)(cols - 1) * pixel_stride + 1;
+}
+
+static void fill_random(std::vector<uint8_t>& buf, BenchRng& rng)
+{
+    for (uint8_t& v : buf)
+        v = (uint8_t)rng.next();
+}
+
+enum Layout
+{
+    LAYOUT_NV21,        // 半平面，V 在前（u == v + 1）
+    LAYOUT_NV12,        // 半平面，U 在前（v == u + 1）
+    LAYOUT_I420,        // 三平面，像素跨度 1
+    LAYOUT_SPLIT_PS2,   // 分离的 U / V 平面，像素跨度 2
+    LAYOUT_Y_PS2,       // NV21 色度 + 像素跨度 2 的 Y 平面
+    LAYOUT_COUNT
+};
+
+static const char* layout_names[LAYOUT_COUNT] = {"nv21", "nv12", "i420", "split-ps2", "y-ps2"};
+
+static void test_repack(BenchRng& rng)
+{
+    const int widths[] = {2, 16, 30, 32, 34, 62, 64, 66, 96, 130, 640};
+    for (int layout = 0; layout < LAYOUT_COUNT; layout++)
+    {
+        for (int w : widths)
+        {
+            const int h = 2 * rng.range(1, 12);
+            const int w2 = w / 2;
+            const int h2 = h / 2;
+            const int pad = rng.range(0, 3) * 8;
+
+            Yuv420Planes p;
+            p.width = w;
+            p.height = h;
+
+            const int y_ps = layout == LAYOUT_Y_PS2 ? 2 : 1;
+            p.y_pixel_stride = y_ps;
+            p.y_row_stride = w * y_ps + pad;
+            std::vector<uint8_t> ybuf(plane_bytes(h, p.y_row_stride, w, y_ps));
+            fill_random(ybuf, rng);
+            p.y = ybuf.data();
+
+            std::vector<uint8_t> ubuf, vbuf;
+            if (layout == LAYOUT_NV21 || layout == LAYOUT_NV12 || layout == LAYOUT_Y_PS2)
+            {
+                const int rs = w + pad;
+                // 一块交错缓冲，后一个分量的最后一个字节即缓冲末尾
+                vbuf.resize(plane_bytes(h2, rs, w2, 2) + 1);
+                fill_random(vbuf, rng);
+                const bool v_first = layout != LAYOUT_NV12;
+                p.v = vbuf.data() + (v_first ? 0 : 1);
+                p.u = vbuf.data() + (v_first ? 1 : 0);
+                p.u_row_stride = p.v_row_stride = rs;
+                p.u_pixel_stride = p.v_pixel_stride = 2;
+            }
+            else
+            {
+                const int ps = layout == LAYOUT_I420 ? 1 : 2;
+                const int rs = w2 * ps + pad;
+                ubuf.resize(plane_bytes(h2, rs, w2, ps));
+                vbuf.resize(plane_bytes(h2, rs, w2, ps));
+                fill_random(ubuf, rng);
+                fill_random(vbuf, rng);
+                p.u = ubuf.data();
+                p.v = vbuf.data();
+                p.u_row_stride = p.v_row_stride = rs;
+                p.u_pixel_stride = p.v_pixel_stride = ps;
+            }
+
+            CHECK(!yuv420_is_nv21(p), "%s w=%d: separate buffers reported as packed nv21", layout_names[layout], w);
+
+            // 输出缓冲多留哨兵字节，检查不越界写
+            const int size = nv21_size(w, h);
+            std::vector<uint8_t> got(size + 16, 0xa5);
+            std::vector<uint8_t> want(size + 16, 0xa5);
+            yuv420_to_nv21(p, got.data());
+            yuv420_to_nv21_ref(p, want.data());
+            for (int i = 0; i < size + 16; i++)
+            {
+                if (got[i] != want[i])
+                {
+                    CHECK(false, "%s w=%d h=%d pad=%d: byte %d = %d, want %d", layout_names[layout], w, h, pad, i, got[i], want[i]);
+                    break;
+                }
+            }
+        }
+    }
+
+    // 紧密 NV21 识别
+    const int w = 64, h = 32;
+    std::vector<uint8_t> packed(nv21_size(w, h));
+    Yuv420Planes p;
+    p.width = w;
+    p.height = h;
+    p.y = packed.data();
+    p.v = packed.data() + w * h;
+    p.u = p.v + 1;
+    p.y_row_stride = p.u_row_stride = p.v_row_stride = w;
+    p.y_pixel_stride = 1;
+    p.u_pixel_stride = p.v_pixel_stride = 2;
+    CHECK(yuv420_is_nv21(p), "packed nv21 not recognised");
+    p.u_row_stride = p.v_row_stride = w + 16;
+    CHECK(!yuv420_is_nv21(p), "padded chroma reported as packed");
+}
+
+#if BENCH_WITH_NCNN
+static void test_crop_rotate(BenchRng& rng)
+{
+    for (int t = 0; t < 80; t++)
+    {
+        const int w = 2 * rng.range(2, 40);
+        const int h = 2 * rng.range(2, 30);
+        std::vector<uint8_t> nv21(nv21_size(w, h));
+        fill_random(nv21, rng);
+
+        const int roi_w = 2 * rng.range(1, w / 2 + 1);
+        const int roi_h = 2 * rng.range(1, h / 2 + 1);
+        const int roi_x = 2 * rng.range(0, (w - roi_w) / 2 + 1);
+        const int roi_y = 2 * rng.range(0, (h - roi_h) / 2 + 1);
+
+        // 先裁剪成紧密的 NV21
+        std::vector<uint8_t> crop(nv21_size(roi_w, roi_h));
+        for (int y = 0; y < roi_h; y++)
+            memcpy(&crop[(size_t)y * roi_w], &nv21[(size_t)(roi_y + y) * w + roi_x], roi_w);
+        for (int y = 0; y < roi_h / 2; y++)
+            memcpy(&crop[(size_t)roi_w * roi_h + (size_t)y * roi_w], &nv21[(size_t)w * h + (size_t)(roi_y / 2 + y) * w + roi_x], roi_w);
+
+        for (int type = 1; type <= 8; type++)
+        {
+            const int dst_w = type <= 4 ? roi_w : roi_h;
+            const int dst_h = type <= 4 ? roi_h : roi_w;
+            std::vector<uint8_t> got(nv21_size(dst_w, dst_h));
+            std::vector<uint8_t> want(nv21_size(dst_w, dst_h));
+            nv21_crop_rotate(nv21.data(), w, h, roi_x, roi_y, roi_w, roi_h, got.data(), dst_w, dst_h, type);
+            ncnn::kanna_rotate_yuv420sp(crop.data(), roi_w, roi_h, want.data(), dst_w, dst_h, type);
+            CHECK(got == want, "t=%d %dx%d roi (%d,%d %dx%d) type %d differs from kanna_rotate_yuv420sp",
+                  t, w, h, roi_x, roi_y, roi_w, roi_h, type);
+        }
+    }
+}
+#endif
+
+int main()
+{
+    BenchRng rng;
+    test_repack(rng);
+#if BENCH_WITH_NCNN
+    test_crop_rotate(rng);
+#else
+    printf("yuv_repack: configured without ncnn, nv21_crop_rotate not checked\n");
+#endif
+
+    if (bench_failures())
+    {
+        fprintf(stderr, "yuv_repack: %d check(s) failed\n", bench_failures());
+        return 1;
+    }
+    printf("yuv_repack: ok\n");
+    return 0;
+}
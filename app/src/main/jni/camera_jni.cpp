@@ -9,6 +9,7 @@
 extern "C" {
 #include <libavformat/avformat.h>
 }
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
@@ -27,33 +28,115 @@ extern "C" {
 #include "vision_infer.h"
 #include "ndkcamera.h"
 #include "IYoloAlgo.h"
+#include "nms.h"
+#include "trace.h"
+#include "jni_cache.h"
+#include "result_pack.h"
+#include "async_preview.h"
+#include "stream_manager.h"
+#include "model_warmup.h"
+#include "model_loader.h"
+#include "net_cache.h"
+#include "nv21_letterbox.h"
 #if __ARM_NEON
 #include <arm_neon.h>
 #endif // __ARM_NEON
 
 static bool enableDetect = false;
 
+// 异步预览：相机线程只投递帧和画最近结果，推理在独立线程进行
+static AsyncPreview g_preview;
+
+// 加载模型后每个输入尺寸的预热前向次数（0 表示不预热）
+static int g_warmup_runs = 3;
+
+// 模型后台加载线程，以及加载期间持有的 AssetManager 全局引用
+static ModelLoader g_loader;
+static jobject g_asset_manager = nullptr;
+
 // 相机帧渲染回调：MyNdkCamera类，继承自NdkCameraWindow，重载on_image_render用于推理和画框
 class MyNdkCamera : public NdkCameraWindow
 {
 public:
     virtual void on_image_render(cv::Mat& rgb) const;
+
+private:
+    // 由 NV21 直接生成模型输入并推理；模型不支持张量输入时返回 false
+    bool detect_from_nv21(std::vector<Object>& objects, std::shared_ptr<IYoloAlgo>& model) const;
+
+    // 相机线程复用的输入张量
+    mutable LetterboxTensor tensor;
 };
 
+bool MyNdkCamera::detect_from_nv21(std::vector<Object>& objects, std::shared_ptr<IYoloAlgo>& model) const
+{
+    const CameraFrameSource& src = frame_source();
+    if (!src.nv21)
+        return false;
+
+    int target_size = 0;
+    float mean[3];
+    float norm[3];
+    if (!getModelTensorInput(target_size, mean, norm))
+        return false;
+
+    if (!nv21_letterbox(src.nv21, src.nv21_width, src.nv21_height,
+                        src.roi_x, src.roi_y, src.roi_w, src.roi_h, src.rotate_type,
+                        target_size, mean, norm, tensor))
+        return false;
+
+    return detectTensor(tensor, objects, &model);
+}
+
 // 实现：是否启用检测、执行YOLO推理、画框、类别统计、更新summary
 void MyNdkCamera::on_image_render(cv::Mat& rgb) const
 {
     if (!enableDetect)
         return;
 
+    if (g_preview.running())
+    {
+        g_preview.render(rgb);
+        return;
+    }
+
     double t0 = ncnn::get_current_time();
-    double t1 = t0;
+
+    // 优先走 NV21 -> 张量的融合预处理，检测结果坐标与 rgb 一致
+    std::vector<Object> objects;
+    std::shared_ptr<IYoloAlgo> model;
+    if (detect_from_nv21(objects, model))
+    {
+        drawAndUpdateSummary(rgb, objects, t0, trace_thread_last_ms(TRACE_FORWARD), model);
+        return;
+    }
+
     // 使用公共函数执行推理和更新摘要
-    detectAndUpdateSummary(rgb, t0, t1);
+    detectAndUpdateSummary(rgb, t0);
 }
 
 static MyNdkCamera* g_camera = 0;
 
+// Java 侧请求的采集配置（宽高 <= 0 表示按模型输入边长自动选择），下次 openCamera 生效
+static CameraCaptureConfig g_capture_request = default_capture_config();
+
+// 把协商后的采集配置写进全局摘要（相机关闭时清零）
+static void setSummaryCapture(const CameraCaptureConfig* capture)
+{
+    std::lock_guard<std::mutex> lock(g_summary_mutex);
+    g_summary.captureWidth = capture ? capture->width : 0;
+    g_summary.captureHeight = capture ? capture->height : 0;
+    g_summary.captureFpsMin = capture ? capture->fps_min : 0;
+    g_summary.captureFpsMax = capture ? capture->fps_max : 0;
+    if (g_summary_cache)
+    {
+        g_summary_cache->captureWidth = g_summary.captureWidth;
+        g_summary_cache->captureHeight = g_summary.captureHeight;
+        g_summary_cache->captureFpsMin = g_summary.captureFpsMin;
+        g_summary_cache->captureFpsMax = g_summary.captureFpsMax;
+    }
+}
+
 extern "C" {
 
 JNIEXPORT jint JNI_OnLoad(JavaVM* vm, void* reserved)
@@ -63,7 +146,24 @@ JNIEXPORT jint JNI_OnLoad(JavaVM* vm, void* reserved)
     avformat_network_init();
     __android_log_print(ANDROID_LOG_DEBUG, "ncnn", "FFmpeg network initialized");
 
+    // 缓存帧回调路径用到的类 / 方法（原生线程上 FindClass 找不到应用类）
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv((void**)&env, JNI_VERSION_1_4) == JNI_OK && env)
+    {
+        if (!jni_cache_init(env))
+        {
+            __android_log_print(ANDROID_LOG_WARN, "ncnn", "JNI cache init failed, falling back to per-call lookup");
+        }
+    }
+
     g_camera = new MyNdkCamera;
+
+    // 新模型切换上去后，旧模型的结果 / 轨迹不再适用：异步预览、单路全局跟踪器、多路流各自的跟踪器
+    g_loader.set_on_swap([] {
+        g_preview.reset();
+        resetTracker();
+        StreamManager::instance().resetTrackers();
+    });
     return JNI_VERSION_1_4;
 }
 
@@ -71,15 +171,22 @@ JNIEXPORT void JNI_OnUnload(JavaVM* vm, void* reserved)
 {
     __android_log_print(ANDROID_LOG_DEBUG, "ncnn", "JNI_OnUnload");
 
-    {
-        ncnn::MutexLockGuard g(g_lock);
-        delete g_yolo;
-        g_yolo = 0;
-    }
+    g_preview.stop();
+
+    g_loader.stop();
+    swapModel(nullptr);
+    resetModelReadiness();
+    clearNetCache();
 
     delete g_camera;
     g_camera = 0;
 
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv((void**)&env, JNI_VERSION_1_4) == JNI_OK && env)
+    {
+        jni_cache_release(env);
+    }
+
     // 清理FFmpeg网络组件
     avformat_network_deinit();
     __android_log_print(ANDROID_LOG_DEBUG, "ncnn", "FFmpeg network deinitialized");
@@ -97,28 +204,122 @@ Java_NcnnTencent_common_JniBridge_loadModel(JNIEnv* env, jobject thiz,
         return JNI_FALSE;
     }
 
-    AAssetManager* mgr = AAssetManager_fromJava(env, assetManager);
+    // AAssetManager 由 Java 对象持有，后台加载期间需要保持全局引用
+    if (!g_asset_manager || !env->IsSameObject(g_asset_manager, assetManager))
+    {
+        g_loader.wait();
+        if (g_asset_manager)
+            env->DeleteGlobalRef(g_asset_manager);
+        g_asset_manager = env->NewGlobalRef(assetManager);
+    }
+    AAssetManager* mgr = AAssetManager_fromJava(env, g_asset_manager);
 
     __android_log_print(ANDROID_LOG_DEBUG, "ncnn", "loadModel %p", mgr);
 
-    // 使用公共函数创建模型
+    // 后台加载 + 预热，完成后原子切换；期间当前模型照常推理
+    ModelLoadRequest request;
+    request.mgr = mgr;
+    request.modelid = (int)modelid;
+    request.inputsize = (int)inputsize;
+    request.use_gpu = (int)cpugpu == 1;
+    request.warmup_runs = g_warmup_runs;
+    g_loader.submit(request);
+
+    // 还没有可用模型时没有旧模型可以顶替，等加载完成再返回
+    if (!acquireModel())
     {
-        ncnn::MutexLockGuard g(g_lock);
-        if (g_yolo)
-        {
-            delete g_yolo;
-            g_yolo = nullptr;
-        }
-        g_yolo = createModelInstance(modelid);
+        return g_loader.wait() ? JNI_TRUE : JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
+// 模型 Net 缓存统计：[hits, misses, evictions, entries, inUse, residentBytes, budgetBytes]
+JNIEXPORT jlongArray JNICALL
+Java_NcnnTencent_common_JniBridge_getNetCacheStats(JNIEnv* env, jobject thiz)
+{
+    const NetCacheStats s = netCacheStats();
+    const jlong values[7] = {(jlong)s.hits, (jlong)s.misses, (jlong)s.evictions, (jlong)s.entries,
+                             (jlong)s.in_use, (jlong)s.resident_bytes, (jlong)s.budget_bytes};
+
+    jlongArray result = env->NewLongArray(7);
+    if (result)
+        env->SetLongArrayRegion(result, 0, 7, values);
+    return result;
+}
+
+// public native void setNetCacheBudget(long bytes);
+JNIEXPORT void JNICALL
+Java_NcnnTencent_common_JniBridge_setNetCacheBudget(JNIEnv* env, jobject thiz, jlong bytes)
+{
+    setNetCacheBudget(bytes > 0 ? (size_t)bytes : 0);
+}
+
+// public native void setWarmupRuns(int runs);
+JNIEXPORT void JNICALL
+Java_NcnnTencent_common_JniBridge_setWarmupRuns(JNIEnv* env, jobject thiz, jint runs)
+{
+    g_warmup_runs = runs > 0 ? (int)runs : 0;
+}
+
+// public native boolean isModelReady();
+JNIEXPORT jboolean JNICALL
+Java_NcnnTencent_common_JniBridge_isModelReady(JNIEnv* env, jobject thiz)
+{
+    return getModelReadiness().ready ? JNI_TRUE : JNI_FALSE;
+}
+
+// 就绪状态与预热耗时：[ready, loading, loadMs, warmupMs, runs, count]，之后 count 组 [w, h, coldMs, warmMs]
+JNIEXPORT jfloatArray JNICALL
+Java_NcnnTencent_common_JniBridge_getModelReadiness(JNIEnv* env, jobject thiz)
+{
+    const ModelReadiness r = getModelReadiness();
+
+    std::vector<jfloat> values;
+    values.reserve(6 + r.warmup.timings.size() * 4);
+    values.push_back(r.ready ? 1.f : 0.f);
+    values.push_back(r.loading ? 1.f : 0.f);
+    values.push_back(r.load_ms);
+    values.push_back(r.warmup.total_ms);
+    values.push_back((jfloat)r.warmup.runs);
+    values.push_back((jfloat)r.warmup.timings.size());
+    for (const WarmupTiming& t : r.warmup.timings)
+    {
+        values.push_back((jfloat)t.w);
+        values.push_back((jfloat)t.h);
+        values.push_back(t.cold_ms);
+        values.push_back(t.warm_ms);
     }
 
-    bool use_gpu = (int)cpugpu == 1;
-    if (g_yolo)
+    jfloatArray result = env->NewFloatArray((jsize)values.size());
+    if (result)
+        env->SetFloatArrayRegion(result, 0, (jsize)values.size(), values.data());
+    return result;
+}
+
+// 当前模型的内存池统计：blob 池与 workspace 池依次各 5 项
+// [allocs, misses, liveBytes, pooledBytes, peakBytes]；模型未加载返回 null
+JNIEXPORT jlongArray JNICALL
+Java_NcnnTencent_common_JniBridge_getModelMemoryStats(JNIEnv* env, jobject)
+{
+    ModelMemoryStats stats;
+    if (!getModelMemoryStats(stats))
+        return nullptr;
+
+    const AllocatorStats* pools[2] = {&stats.blob, &stats.workspace};
+    jlong values[10];
+    for (int i = 0; i < 2; i++)
     {
-        g_yolo->load(mgr, modelid, inputsize, use_gpu);
+        values[i * 5 + 0] = (jlong)pools[i]->allocs;
+        values[i * 5 + 1] = (jlong)pools[i]->misses;
+        values[i * 5 + 2] = (jlong)pools[i]->live_bytes;
+        values[i * 5 + 3] = (jlong)pools[i]->pooled_bytes;
+        values[i * 5 + 4] = (jlong)pools[i]->peak_bytes;
     }
 
-    return JNI_TRUE;
+    jlongArray result = env->NewLongArray(10);
+    if (result)
+        env->SetLongArrayRegion(result, 0, 10, values);
+    return result;
 }
 
 // public native boolean openCamera(int facing);
@@ -129,7 +330,20 @@ Java_NcnnTencent_common_JniBridge_openCamera(JNIEnv* env, jobject thiz, jint fac
         return JNI_FALSE;
 
     __android_log_print(ANDROID_LOG_DEBUG, "ncnn", "openCamera %d", facing);
-    g_camera->open((int)facing);
+
+    CameraCaptureConfig config = g_capture_request;
+    if (config.width <= 0 || config.height <= 0)
+    {
+        // 自动选择：采集尺寸贴合当前模型输入，避免采集大图后再缩小
+        config.target_size = getModelTargetSize();
+    }
+    g_camera->set_capture_config(config);
+
+    if (g_camera->open((int)facing) != 0)
+        return JNI_FALSE;
+
+    const CameraCaptureConfig capture = g_camera->capture_config();
+    setSummaryCapture(&capture);
     return JNI_TRUE;
 }
 
@@ -139,9 +353,83 @@ Java_NcnnTencent_common_JniBridge_closeCamera(JNIEnv* env, jobject thiz)
 {
     __android_log_print(ANDROID_LOG_DEBUG, "ncnn", "closeCamera");
     g_camera->close();
+    setSummaryCapture(nullptr);
     return JNI_TRUE;
 }
 
+// JNI 接口：设置相机采集配置，下次 openCamera 生效
+// width / height <= 0 时按当前模型输入边长自动选择；不受支持的尺寸 / 帧率范围取最接近的
+JNIEXPORT void JNICALL
+Java_NcnnTencent_common_JniBridge_setCameraConfig(JNIEnv*, jobject, jint width, jint height,
+                                                  jint fpsMin, jint fpsMax, jint maxImages)
+{
+    g_capture_request.width = width;
+    g_capture_request.height = height;
+    g_capture_request.fps_min = fpsMin;
+    g_capture_request.fps_max = fpsMax;
+    g_capture_request.max_images = maxImages;
+}
+
+// 当前采集配置 [width, height, fpsMin, fpsMax, maxImages]，相机打开后为协商结果
+JNIEXPORT jintArray JNICALL
+Java_NcnnTencent_common_JniBridge_getCameraConfig(JNIEnv* env, jobject)
+{
+    const CameraCaptureConfig c = g_camera->capture_config();
+    const jint values[5] = {c.width, c.height, c.fps_min, c.fps_max, c.max_images};
+
+    jintArray result = env->NewIntArray(5);
+    if (result)
+        env->SetIntArrayRegion(result, 0, 5, values);
+    return result;
+}
+
+// 相机支持的 YUV 输出尺寸，按 [width, height, maxFps] 三元组排布（maxFps 为 0 表示未知）；找不到相机返回 null
+JNIEXPORT jintArray JNICALL
+Java_NcnnTencent_common_JniBridge_getCameraStreamConfigs(JNIEnv* env, jobject, jint facing)
+{
+    std::vector<CameraStreamConfig> configs;
+    std::vector<std::pair<int, int> > fps_ranges;
+    if (NdkCamera::query_stream_configs((int)facing, configs, fps_ranges) != 0)
+        return nullptr;
+
+    std::vector<jint> values;
+    values.reserve(configs.size() * 3);
+    for (const CameraStreamConfig& c : configs)
+    {
+        values.push_back(c.width);
+        values.push_back(c.height);
+        values.push_back(c.max_fps);
+    }
+
+    jintArray result = env->NewIntArray((jsize)values.size());
+    if (result)
+        env->SetIntArrayRegion(result, 0, (jsize)values.size(), values.data());
+    return result;
+}
+
+// 相机支持的 AE 目标帧率范围，按 [min, max] 二元组排布；找不到相机返回 null
+JNIEXPORT jintArray JNICALL
+Java_NcnnTencent_common_JniBridge_getCameraFpsRanges(JNIEnv* env, jobject, jint facing)
+{
+    std::vector<CameraStreamConfig> configs;
+    std::vector<std::pair<int, int> > fps_ranges;
+    if (NdkCamera::query_stream_configs((int)facing, configs, fps_ranges) != 0)
+        return nullptr;
+
+    std::vector<jint> values;
+    values.reserve(fps_ranges.size() * 2);
+    for (const std::pair<int, int>& r : fps_ranges)
+    {
+        values.push_back(r.first);
+        values.push_back(r.second);
+    }
+
+    jintArray result = env->NewIntArray((jsize)values.size());
+    if (result)
+        env->SetIntArrayRegion(result, 0, (jsize)values.size(), values.data());
+    return result;
+}
+
 // public native boolean setOutputWindow(Surface surface);
 JNIEXPORT jboolean JNICALL
 Java_NcnnTencent_common_JniBridge_setOutputWindow(JNIEnv* env, jobject thiz,
@@ -167,6 +455,13 @@ Java_NcnnTencent_common_JniBridge_setNms(JNIEnv*, jobject, jfloat nms)
     g_nms = nms;
 }
 
+// JNI 接口：设置 NMS 模式（0=贪心 1=按类别 2=网格分桶 3=Fast-NMS 4=Matrix-NMS）
+JNIEXPORT void JNICALL
+Java_NcnnTencent_common_JniBridge_setNmsMode(JNIEnv*, jobject, jint mode)
+{
+    g_nms_mode = (mode >= 0 && mode < NMS_MODE_COUNT) ? mode : NMS_GREEDY;
+}
+
 JNIEXPORT void JNICALL
 Java_NcnnTencent_common_JniBridge_setTrackEnabled(JNIEnv* env, jobject thiz,
                                                       jboolean enabled)
@@ -187,6 +482,22 @@ Java_NcnnTencent_common_JniBridge_setDetectEnabled(JNIEnv*, jobject,
                                                        jboolean enabled)
 {
     enableDetect = enabled;
+    // 重新开始检测时不再显示停止前的旧结果
+    g_preview.reset();
+}
+
+// JNI 接口：开关相机异步预览（预览逐帧渲染，推理只处理最新帧，结果按轨迹外推到当前帧）
+JNIEXPORT void JNICALL
+Java_NcnnTencent_common_JniBridge_setAsyncPreview(JNIEnv*, jobject, jboolean enabled)
+{
+    if (enabled)
+    {
+        g_preview.start();
+    }
+    else
+    {
+        g_preview.stop();
+    }
 }
 
 JNIEXPORT jobject JNICALL
@@ -196,6 +507,94 @@ Java_NcnnTencent_common_JniBridge_getDetectSummary(JNIEnv *env, jobject thiz)
                                       "NcnnTencent/common/Models$DetectSummary");
 }
 
+// JNI 接口：把最新一帧的打包检测结果拷贝到 direct ByteBuffer（布局见 result_pack.h）
+// streamId 为 0 时取单路画面（相机 / 本地视频 / 单路网络流），否则取对应的多路流
+// 返回写入字节数；缓冲区不足时返回所需字节数的相反数；尚无结果返回 0
+JNIEXPORT jint JNICALL
+Java_NcnnTencent_common_JniBridge_getDetectResults(JNIEnv* env, jobject, jint streamId, jobject buffer)
+{
+    if (!buffer)
+        return 0;
+
+    uint8_t* dst = (uint8_t*)env->GetDirectBufferAddress(buffer);
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (!dst || capacity < 0)
+        return 0;
+
+    return (jint)copyLatestResults(streamId, dst, (size_t)capacity);
+}
+
+// JNI 接口：帧回调是否仍附带逐目标的 RectF[]（默认关闭，回调中传 null）
+JNIEXPORT void JNICALL
+Java_NcnnTencent_common_JniBridge_setLegacyRectFResults(JNIEnv*, jobject, jboolean enabled)
+{
+    setLegacyRectFResults(enabled);
+}
+
+// JNI 接口：开关分阶段耗时追踪（关闭时仍更新各阶段最近一次耗时）
+JNIEXPORT void JNICALL
+Java_NcnnTencent_common_JniBridge_setTraceEnabled(JNIEnv*, jobject, jboolean enabled)
+{
+    trace_set_enabled(enabled);
+}
+
+JNIEXPORT void JNICALL
+Java_NcnnTencent_common_JniBridge_resetTrace(JNIEnv*, jobject)
+{
+    trace_reset();
+}
+
+// 各阶段统计，按 [阶段][次数, 均值, p50, p95, p99] 排布，单位 ms
+JNIEXPORT jfloatArray JNICALL
+Java_NcnnTencent_common_JniBridge_getTraceStats(JNIEnv* env, jobject)
+{
+    float stats[TRACE_STAGE_COUNT * TRACE_STAT_FIELDS];
+    trace_stats(stats);
+
+    jfloatArray result = env->NewFloatArray(TRACE_STAGE_COUNT * TRACE_STAT_FIELDS);
+    if (result)
+    {
+        env->SetFloatArrayRegion(result, 0, TRACE_STAGE_COUNT * TRACE_STAT_FIELDS, stats);
+    }
+    return result;
+}
+
+JNIEXPORT jobjectArray JNICALL
+Java_NcnnTencent_common_JniBridge_getTraceStageNames(JNIEnv* env, jobject)
+{
+    const JniCache* c = jni_cache();
+    jclass stringCls = c ? c->stringCls : env->FindClass("java/lang/String");
+    jobjectArray names = env->NewObjectArray(TRACE_STAGE_COUNT, stringCls, nullptr);
+    if (names)
+    {
+        for (int i = 0; i < TRACE_STAGE_COUNT; i++)
+        {
+            jstring name = env->NewStringUTF(trace_stage_name(i));
+            env->SetObjectArrayElement(names, i, name);
+            env->DeleteLocalRef(name);
+        }
+    }
+    if (!c)
+        env->DeleteLocalRef(stringCls);
+    return names;
+}
+
+// 导出 Chrome trace JSON 到指定路径（应用私有目录）
+JNIEXPORT jboolean JNICALL
+Java_NcnnTencent_common_JniBridge_dumpTrace(JNIEnv* env, jobject, jstring path)
+{
+    if (!path)
+        return JNI_FALSE;
+
+    const char* cpath = env->GetStringUTFChars(path, nullptr);
+    if (!cpath)
+        return JNI_FALSE;
+    std::string file(cpath);
+    env->ReleaseStringUTFChars(path, cpath);
+
+    return trace_dump_chrome(file) ? JNI_TRUE : JNI_FALSE;
+}
+
 JNIEXPORT jobject JNICALL
 Java_NcnnTencent_common_JniBridge_detectImage(JNIEnv* env, jobject thiz,
                                                   jobject bitmap, jint inputSize)
@@ -215,10 +614,61 @@ Java_NcnnTencent_common_JniBridge_detectImage(JNIEnv* env, jobject thiz,
     AndroidBitmap_unlockPixels(env, bitmap);
 
     // 使用公共函数执行推理和更新摘要
-    double t1 = ncnn::get_current_time();
-    detectAndUpdateSummary(orig_rgb, t0, t1);
+    detectAndUpdateSummary(orig_rgb, t0);
 
     return matToBitmap(env, orig_rgb);
 }
 
+// 批量推理吞吐测试：同一张图复制成 1..maxBatch 张，每个批大小跑 rounds 轮
+// 返回长度为 maxBatch 的数组，第 b-1 项为批大小 b 时的吞吐（张/秒）
+JNIEXPORT jfloatArray JNICALL
+Java_NcnnTencent_common_JniBridge_benchmarkBatch(JNIEnv* env, jobject thiz,
+                                                 jobject bitmap, jint maxBatch, jint rounds)
+{
+    cv::Mat rgb;
+    {
+        AndroidBitmapInfo info;
+        void* pixels;
+        if (AndroidBitmap_getInfo(env, bitmap, &info) < 0)
+            return nullptr;
+        if (AndroidBitmap_lockPixels(env, bitmap, &pixels) < 0)
+            return nullptr;
+        cv::Mat rgba(info.height, info.width, CV_8UC4, pixels);
+        cv::cvtColor(rgba, rgb, cv::COLOR_RGBA2RGB);
+        AndroidBitmap_unlockPixels(env, bitmap);
+    }
+
+    maxBatch = std::max(1, (int)maxBatch);
+    rounds = std::max(1, (int)rounds);
+
+    std::vector<float> throughput(maxBatch, 0.f);
+    std::vector<std::vector<Object> > objects;
+    for (int b = 1; b <= maxBatch; b++)
+    {
+        std::vector<cv::Mat> batch(b, rgb);
+
+        // 预热一轮（首轮包含内存分配）
+        if (!detectBatch(batch, objects))
+            return nullptr;
+
+        double t0 = ncnn::get_current_time();
+        for (int r = 0; r < rounds; r++)
+        {
+            detectBatch(batch, objects);
+        }
+        double elapsed = ncnn::get_current_time() - t0;
+        throughput[b - 1] = elapsed > 0 ? (float)(b * rounds * 1000.0 / elapsed) : 0.f;
+
+        __android_log_print(ANDROID_LOG_INFO, "ncnn", "benchmarkBatch: batch=%d %.1f img/s",
+                            b, throughput[b - 1]);
+    }
+
+    jfloatArray result = env->NewFloatArray(maxBatch);
+    if (result)
+    {
+        env->SetFloatArrayRegion(result, 0, maxBatch, throughput.data());
+    }
+    return result;
+}
+
 } // extern "C"
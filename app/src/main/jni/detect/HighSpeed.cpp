@@ -12,7 +12,10 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 #include "HighSpeed.h"
-#include "layer.h"
+#include "trace.h"
+#include "postprocess.h"
+#include "nms.h"
+#include "batch_infer.h"
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include <float.h>
@@ -25,127 +28,12 @@ const unsigned char HighSpeed::colors_[10][3] = {
         {0, 0, 255}, {99, 30, 233}, {176, 39, 156}, {0, 255, 0}, {181, 81, 63},
         {243, 150, 33}, {244, 169, 3}, {212, 188, 0}, {136, 150, 0}, {80, 175, 76}
 };
-static float fast_exp(float x)
+static void generate_proposals(const AnchorTable& anchors, const ncnn::Mat& pred, float prob_threshold, std::vector<Object>& objects)
 {
-    union {
-        uint32_t i;
-        float f;
-    } v{};
-    v.i = (1 << 23) * (1.4426950409 * x + 126.93490512f);
-    return v.f;
-}
-
-static float sigmoid(float x)
-{
-    return 1.0f / (1.0f + fast_exp(-x));
-}
-static float intersection_area(const Object& a, const Object& b)
-{
-    cv::Rect_<float> inter = a.rect & b.rect;
-    return inter.area();
-}
-
-static void qsort_descent_inplace(std::vector<Object>& faceobjects, int left, int right)
-{
-    int i = left;
-    int j = right;
-    float p = faceobjects[(left + right) / 2].prob;
-
-    while (i <= j)
-    {
-        while (faceobjects[i].prob > p)
-            i++;
-
-        while (faceobjects[j].prob < p)
-            j--;
-
-        if (i <= j)
-        {
-            // swap
-            std::swap(faceobjects[i], faceobjects[j]);
-
-            i++;
-            j--;
-        }
-    }
-
-    //     #pragma omp parallel sections
-    {
-        //         #pragma omp section
-        {
-            if (left < j) qsort_descent_inplace(faceobjects, left, j);
-        }
-        //         #pragma omp section
-        {
-            if (i < right) qsort_descent_inplace(faceobjects, i, right);
-        }
-    }
-}
-
-static void qsort_descent_inplace(std::vector<Object>& faceobjects)
-{
-    if (faceobjects.empty())
-        return;
-
-    qsort_descent_inplace(faceobjects, 0, faceobjects.size() - 1);
-}
-
-static void nms_sorted_bboxes(const std::vector<Object>& faceobjects, std::vector<int>& picked, float nms_threshold)
-{
-    picked.clear();
-
-    const int n = faceobjects.size();
-
-    std::vector<float> areas(n);
-    for (int i = 0; i < n; i++)
-    {
-        areas[i] = faceobjects[i].rect.width * faceobjects[i].rect.height;
-    }
-
-    for (int i = 0; i < n; i++)
-    {
-        const Object& a = faceobjects[i];
-
-        int keep = 1;
-        for (int j = 0; j < (int)picked.size(); j++)
-        {
-            const Object& b = faceobjects[picked[j]];
-
-            // intersection over union
-            float inter_area = intersection_area(a, b);
-            float union_area = areas[i] + areas[picked[j]] - inter_area;
-            // float IoU = inter_area / union_area
-            if (inter_area / union_area > nms_threshold)
-                keep = 0;
-        }
-
-        if (keep)
-            picked.push_back(i);
-    }
-}
-static void generate_grids_and_stride(const int target_w, const int target_h, std::vector<int>& strides, std::vector<highspeed::GridAndStride>& grid_strides)
-{
-    for (int i = 0; i < (int)strides.size(); i++)
-    {
-        int stride = strides[i];
-        int num_grid_w = target_w / stride;
-        int num_grid_h = target_h / stride;
-        for (int g1 = 0; g1 < num_grid_h; g1++)
-        {
-            for (int g0 = 0; g0 < num_grid_w; g0++)
-            {
-                highspeed::GridAndStride gs;
-                gs.grid0 = g0;
-                gs.grid1 = g1;
-                gs.stride = stride;
-                grid_strides.push_back(gs);
-            }
-        }
-    }
-}
-static void generate_proposals(std::vector<highspeed::GridAndStride> grid_strides, const ncnn::Mat& pred, float prob_threshold, std::vector<Object>& objects)
-{
-    const int num_points = grid_strides.size();
+    const int num_points = anchors.size();
+    const float* anchor_cx = anchors.cx.data();
+    const float* anchor_cy = anchors.cy.data();
+    const float* anchor_stride = anchors.stride.data();
     const int num_class = 10;
     const int reg_max_1 = 16;
 
@@ -153,56 +41,21 @@ static void generate_proposals(std::vector<highspeed::GridAndStride> grid_stride
     {
         const float* scores = pred.row(i) + 4 * reg_max_1;
         // find label with max score
-        int label = -1;
-        float score = -FLT_MAX;
-        for (int k = 0; k < num_class; k++)
-        {
-            float confidence = scores[k];
-            if (confidence > score)
-            {
-                label = k;
-                score = confidence;
-            }
-        }
+        float score;
+        int label = argmax(scores, num_class, &score);
         float box_prob = sigmoid(score);
         if (box_prob >= prob_threshold)
         {
-            ncnn::Mat bbox_pred(reg_max_1, 4, (void*)pred.row(i));
-            {
-                ncnn::Layer* softmax = ncnn::create_layer("Softmax");
-                ncnn::ParamDict pd;
-                pd.set(0, 1); // axis
-                pd.set(1, 1);
-                softmax->load_param(pd);
-
-                ncnn::Option opt;
-                opt.num_threads = 1;
-                opt.use_packing_layout = false;
-
-                softmax->create_pipeline(opt);
-
-                softmax->forward_inplace(bbox_pred, opt);
-
-                softmax->destroy_pipeline(opt);
-
-                delete softmax;
-            }
-
+            // DFL 解码：softmax + 期望一次完成，避免逐候选创建 Softmax 层
             float pred_ltrb[4];
+            dfl_decode((float*)pred.row(i), reg_max_1, pred_ltrb);
             for (int k = 0; k < 4; k++)
             {
-                float dis = 0.f;
-                const float* dis_after_sm = bbox_pred.row(k);
-                for (int l = 0; l < reg_max_1; l++)
-                {
-                    dis += l * dis_after_sm[l];
-                }
-
-                pred_ltrb[k] = dis * grid_strides[i].stride;
+                pred_ltrb[k] *= anchor_stride[i];
             }
 
-            float pb_cx = (grid_strides[i].grid0 + 0.5f) * grid_strides[i].stride;
-            float pb_cy = (grid_strides[i].grid1 + 0.5f) * grid_strides[i].stride;
+            float pb_cx = anchor_cx[i];
+            float pb_cy = anchor_cy[i];
 
             float x0 = pb_cx - pred_ltrb[0];
             float y0 = pb_cy - pred_ltrb[1];
@@ -227,31 +80,25 @@ HighSpeed::HighSpeed(){
 }
 HighSpeed::~HighSpeed()
 {
-    yolo.clear();
 }
 int HighSpeed::load(AAssetManager* mgr,  int modelid, int inputsize,bool use_gpu)
 {
     ncnn::set_cpu_powersave(0);
     ncnn::set_omp_num_threads(ncnn::get_big_cpu_count());
-    yolo.opt = ncnn::Option();
-#if NCNN_VULKAN
-    yolo.opt.use_vulkan_compute = use_gpu;
-#endif
-    // 启用轻量模式
-    yolo.opt.lightmode = true;
-    const char* modeltype = "High_Speed";
-    char parampath[256];
-    char modelpath[256];
-    sprintf(parampath, "%s.param", modeltype);
-    sprintf(modelpath, "%s.bin", modeltype);
-    yolo.load_param(mgr, parampath);
-    yolo.load_model(mgr, modelpath);
+    yolo = acquireNet(mgr, "High_Speed", use_gpu);
+    if (!yolo)
+        return -1;
     target_size = (inputsize == 0) ? 320 : 640;
     return 0;
 }
+void HighSpeed::getWarmupTargets(std::vector<WarmupTarget>& targets) const
+{
+    addLetterboxWarmupTargets(targets, &yolo->net, "images", {"output0"}, target_size);
+}
 // 图像预处理函数：缩放和填充到32的倍数
 ncnn::Mat HighSpeed::preprocessImage(const cv::Mat& rgb, float& scale, int& wpad, int& hpad)
 {
+    TRACE_SCOPE(TRACE_PREPROCESS);
     int width = rgb.cols;
     int height = rgb.rows;
     // pad to multiple of 32
@@ -281,30 +128,99 @@ ncnn::Mat HighSpeed::preprocessImage(const cv::Mat& rgb, float& scale, int& wpad
 }
 int HighSpeed::detect(const cv::Mat& rgb, std::vector<Object>& objects)
 {
-    float prob_threshold =g_threshold;
-    float nms_threshold =g_nms;
-    int width = rgb.cols;
-    int height = rgb.rows;
     // 使用封装的预处理函数
     float scale;
     int wpad, hpad;
     ncnn::Mat in_pad = preprocessImage(rgb, scale, wpad, hpad);
-    in_pad.substract_mean_normalize(mean_vals, norm_vals);
-    double t3 = ncnn::get_current_time();
-    ncnn::Extractor ex = yolo.create_extractor();
+    return detectPadded(in_pad, scale, wpad, hpad, rgb.cols, rgb.rows, objects);
+}
+int HighSpeed::detectLetterboxed(const Letterbox& lb, std::vector<Object>& objects)
+{
+    // 解码阶段已完成缩放与填充，直接封装为 ncnn::Mat
+    ncnn::Mat in_pad = ncnn::Mat::from_pixels(lb.image.data, ncnn::Mat::PIXEL_RGB, lb.image.cols, lb.image.rows);
+    return detectPadded(in_pad, lb.scale, lb.wpad, lb.hpad, lb.orig_w, lb.orig_h, objects);
+}
+int HighSpeed::detectTensor(const LetterboxTensor& in, std::vector<Object>& objects)
+{
+    // 张量已完成缩放、填充与归一化（浅拷贝，不复制数据）
+    ncnn::Mat in_pad = in.tensor;
+    return detectPadded(in_pad, in.scale, in.wpad, in.hpad, in.orig_w, in.orig_h, objects, 0, true);
+}
+bool HighSpeed::getTensorNorm(float mean[3], float norm[3]) const
+{
+    // 与 detectPadded 使用相同的 mean_vals / norm_vals
+    for (int c = 0; c < 3; c++)
+    {
+        mean[c] = mean_vals[c];
+        norm[c] = norm_vals[c];
+    }
+    return true;
+}
+int HighSpeed::detectBatch(const std::vector<cv::Mat>& inputs, std::vector<std::vector<Object> >& objects)
+{
+    // 同一个 Net 上并发多个 Extractor，大核按并发数平分；预处理与后处理也在各自线程里完成
+    const int n = inputs.size();
+    objects.assign(n, std::vector<Object>());
+    const BatchPlan plan = plan_batch(n);
+    std::vector<int> rets(n, 0);
+    run_batch(n, plan, [&](int i) {
+        float scale;
+        int wpad, hpad;
+        ncnn::Mat in_pad = preprocessImage(inputs[i], scale, wpad, hpad);
+        rets[i] = detectPadded(in_pad, scale, wpad, hpad, inputs[i].cols, inputs[i].rows, objects[i], plan.threads_per_extractor);
+    });
+    for (int ret : rets)
+    {
+        if (ret != 0)
+            return ret;
+    }
+    return 0;
+}
+int HighSpeed::detectLetterboxedBatch(const std::vector<Letterbox>& inputs, std::vector<std::vector<Object> >& objects)
+{
+    const int n = inputs.size();
+    objects.assign(n, std::vector<Object>());
+    const BatchPlan plan = plan_batch(n);
+    std::vector<int> rets(n, 0);
+    run_batch(n, plan, [&](int i) {
+        const Letterbox& lb = inputs[i];
+        ncnn::Mat in_pad = ncnn::Mat::from_pixels(lb.image.data, ncnn::Mat::PIXEL_RGB, lb.image.cols, lb.image.rows);
+        rets[i] = detectPadded(in_pad, lb.scale, lb.wpad, lb.hpad, lb.orig_w, lb.orig_h, objects[i], plan.threads_per_extractor);
+    });
+    for (int ret : rets)
+    {
+        if (ret != 0)
+            return ret;
+    }
+    return 0;
+}
+int HighSpeed::detectPadded(ncnn::Mat& in_pad, float scale, int wpad, int hpad, int width, int height, std::vector<Object>& objects, int num_threads, bool normalized)
+{
+    float prob_threshold =g_threshold;
+    float nms_threshold =g_nms;
+    if (!normalized)
+        in_pad.substract_mean_normalize(mean_vals, norm_vals);
+    const int64_t t3 = trace_now_us();
+    ncnn::Extractor ex = yolo->net.create_extractor();
+    if (num_threads > 0)
+        ex.set_num_threads(num_threads);
     ex.input("images", in_pad);
     std::vector<Object> proposals;
     ncnn::Mat out;
     ex.extract("output0", out);  //adds
-    double t4 = ncnn::get_current_time();
-    std::vector<int> strides = {8, 16, 32}; // might have stride=64
-    std::vector<highspeed::GridAndStride> grid_strides;
-    generate_grids_and_stride(in_pad.w, in_pad.h, strides, grid_strides);
-    generate_proposals(grid_strides, out, prob_threshold, proposals);
+    trace_record(TRACE_FORWARD, t3);
+    const int64_t t4 = trace_now_us();
+    static const std::vector<int> strides = {8, 16, 32}; // might have stride=64
+    // anchor 表按输入尺寸缓存，同一尺寸只生成一次
+    std::shared_ptr<const AnchorTable> anchors = get_anchor_table(in_pad.w, in_pad.h, strides);
+    generate_proposals(*anchors, out, prob_threshold, proposals);
     qsort_descent_inplace(proposals);
+    trace_record(TRACE_PROPOSAL, t4);
+    const int64_t t5 = trace_now_us();
     // apply nms with nms_threshold
     std::vector<int> picked;
-    nms_sorted_bboxes(proposals, picked, nms_threshold);
+    nms_dispatch(proposals, picked, nms_threshold, prob_threshold, g_nms_mode);
+    trace_record(TRACE_NMS, t5);
     int count = picked.size();
     objects.resize(count);
     for (int i = 0; i < count; i++)
@@ -337,7 +253,5 @@ int HighSpeed::detect(const cv::Mat& rgb, std::vector<Object>& objects)
         }
     } objects_area_greater;
     std::sort(objects.begin(), objects.end(), objects_area_greater);
-    std::lock_guard<std::mutex> lock(g_summary_mutex);
-    g_summary.inferTimeMs = (t4 - t3); // 单位：秒
     return 0;
 }
\ No newline at end of file
@@ -12,7 +12,9 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 #include "NanoDet.h"
-#include "layer.h"
+#include "trace.h"
+#include "postprocess.h"
+#include "nms.h"
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include <float.h>
@@ -125,72 +127,11 @@ const unsigned char NanoDet::colors_[80][3] = {
         {72, 61, 139},    // hair drier (暗蓝紫)
         {255, 99, 71}     // toothbrush (番茄红)
 };
-static float fast_exp(float x)
-{
-    union {
-        uint32_t i;
-        float f;
-    } v{};
-    v.i = (1 << 23) * (1.4426950409 * x + 126.93490512f);
-    return v.f;
-}
-static float sigmoid(float x)
-{
-    return 1.0f / (1.0f + fast_exp(-x));
-}
-static float intersection_area(const Object& a, const Object& b)
-{
-    cv::Rect_<float> inter = a.rect & b.rect;
-    return inter.area();
-}
-static void nms_sorted_bboxes(const std::vector<Object>& faceobjects, std::vector<int>& picked, float nms_threshold)
-{
-    picked.clear();
-    const int n = faceobjects.size();
-    std::vector<float> areas(n);
-    for (int i = 0; i < n; i++)
-    {
-        areas[i] = faceobjects[i].rect.width * faceobjects[i].rect.height;
-    }
-
-    for (int i = 0; i < n; i++)
-    {
-        const Object& a = faceobjects[i];
-
-        int keep = 1;
-        for (int j = 0; j < (int)picked.size(); j++)
-        {
-            const Object& b = faceobjects[picked[j]];
-
-            // intersection over union
-            float inter_area = intersection_area(a, b);
-            float union_area = areas[i] + areas[picked[j]] - inter_area;
-            // float IoU = inter_area / union_area
-            if (inter_area / union_area > nms_threshold)
-                keep = 0;
-        }
-        if (keep)
-            picked.push_back(i);
-    }
-}
 NanoDet::NanoDet(){
 
 }
 NanoDet::~NanoDet()
 {
-    Nano_net.clear();
-}
-void activation_function_softmax(const float* src, float* dst, int length)
-{
-    const float alpha = *std::max_element(src, src + length);
-    float denominator = 0.0f;
-    for (int i = 0; i < length; i++) {
-        dst[i] = fast_exp(src[i] - alpha);
-        denominator += dst[i];
-    }
-    for (int i = 0; i < length; i++) {
-        dst[i] /= denominator;
-    }
 }
 Object NanoDet::disPred2Bbox(const float*& dfl_det, int label, float score, int x, int y, int stride,
                              float width_ratio, float height_ratio)
@@ -198,18 +139,10 @@ Object NanoDet::disPred2Bbox(const float*& dfl_det, int label, float score, int
     float ct_x = (x + 0.5f) * stride;
     float ct_y = (y + 0.5f) * stride;
 
-    std::vector<float> dis_pred;
-    dis_pred.resize(4);
+    float dis_pred[4];
+    dfl_decode((float*)dfl_det, 8, dis_pred); // reg_max + 1 = 8
     for (int i = 0; i < 4; i++) {
-        float dis = 0;
-        float* dis_after_sm = new float[8]; // reg_max + 1 = 8
-        activation_function_softmax(dfl_det + i * 8, dis_after_sm, 8);
-        for (int j = 0; j < 8; j++) {
-            dis += j * dis_after_sm[j];
-        }
-        dis *= stride;  // 先乘以stride，再赋值
-        dis_pred[i] = dis;
-        delete[] dis_after_sm;
+        dis_pred[i] *= stride;  // 先乘以stride，再赋值
     }
     float xmin = std::max(ct_x - dis_pred[0], 0.0f) * width_ratio;
     float ymin = std::max(ct_y - dis_pred[1], 0.0f) * height_ratio;
@@ -236,14 +169,8 @@ void NanoDet::decode_infer(ncnn::Mat& cls_pred, ncnn::Mat& dis_pred, int stride,
         const float* scores = cls_pred.row(idx);
         int row = idx / feature_w;
         int col = idx % feature_w;
-        float score = 0;
-        int cur_label = 0;
-        for (int label = 0; label < num_class; label++) {
-            if (scores[label] > score) {
-                score = scores[label];
-                cur_label = label;
-            }
-        }
+        float score;
+        int cur_label = argmax(scores, num_class, &score);
         if (score > threshold) {
             const float* bbox_pred = dis_pred.row(idx);
             Object obj = disPred2Bbox(bbox_pred, cur_label, score, col, row, stride, width_ratio, height_ratio);
@@ -256,21 +183,22 @@ int NanoDet::load(AAssetManager* mgr,  int modelid, int inputsize,bool use_gpu)
 {
     ncnn::set_cpu_powersave(0);
     ncnn::set_omp_num_threads(ncnn::get_big_cpu_count());
-    Nano_net.opt = ncnn::Option();
-#if NCNN_VULKAN
-    Nano_net.opt.use_vulkan_compute = use_gpu;
-#endif
-    Nano_net.opt.lightmode = true;
-    const char* modeltype = "NanoDet";
-    char parampath[256];
-    char modelpath[256];
-    sprintf(parampath, "%s.param", modeltype);
-    sprintf(modelpath, "%s.bin", modeltype);
-    Nano_net.load_param(mgr, parampath);
-    Nano_net.load_model(mgr, modelpath);
+    Nano_net = acquireNet(mgr, "NanoDet", use_gpu);
+    if (!Nano_net)
+        return -1;
     target_size = (inputsize == 0) ? 320 : 640;
     return 0;
 }
+void NanoDet::getWarmupTargets(std::vector<WarmupTarget>& targets) const
+{
+    std::vector<std::string> outputs;
+    for (const auto& head_info : heads_info)
+    {
+        outputs.push_back(head_info.dis_layer);
+        outputs.push_back(head_info.cls_layer);
+    }
+    addWarmupTarget(targets, &Nano_net->net, "input.1", outputs, target_size, target_size);
+}
 int NanoDet::detect(const cv::Mat& rgb, std::vector<Object>& objects)
 {
     float prob_threshold =g_threshold;
@@ -278,10 +206,12 @@ int NanoDet::detect(const cv::Mat& rgb, std::vector<Object>& objects)
     int width = rgb.cols;
     int height = rgb.rows;
     //no padding
+    const int64_t t2 = trace_now_us();
     ncnn::Mat input = ncnn::Mat::from_pixels_resize(rgb.data, ncnn::Mat::PIXEL_RGB2BGR, width, height, target_size, target_size);
     input.substract_mean_normalize(mean_vals, norm_vals);
-    double t3 = ncnn::get_current_time();
-    ncnn::Extractor ex = Nano_net.create_extractor();
+    trace_record(TRACE_PREPROCESS, t2);
+    const int64_t t3 = trace_now_us();
+    ncnn::Extractor ex = Nano_net->net.create_extractor();
     ex.input("input.1", input);
     std::vector<Object> proposals;
     for (const auto &head_info : this->heads_info) {
@@ -290,15 +220,18 @@ int NanoDet::detect(const cv::Mat& rgb, std::vector<Object>& objects)
         ex.extract(head_info.cls_layer.c_str(), cls_pred);
         decode_infer(cls_pred, dis_pred, head_info.stride, prob_threshold, proposals, float(width) / target_size, float(height) / target_size);
     }
-    double t4 = ncnn::get_current_time();
+    // 各检测头的解码与提取交错进行，计入前向
+    trace_record(TRACE_FORWARD, t3);
+    const int64_t t4 = trace_now_us();
+    // nms_sorted_bboxes 要求输入按置信度降序
+    qsort_descent_inplace(proposals);
     std::vector<int> picked;
-    nms_sorted_bboxes(proposals, picked, nms_threshold);
+    nms_dispatch(proposals, picked, nms_threshold, prob_threshold, g_nms_mode);
+    trace_record(TRACE_NMS, t4);
     objects.resize(picked.size());
     for (int i = 0; i < picked.size(); i++)
     {
         objects[i] = proposals[picked[i]];
     }
-    std::lock_guard<std::mutex> lock(g_summary_mutex);
-    g_summary.inferTimeMs = (t4 - t3); // 单位：秒
     return 0;
 }
\ No newline at end of file
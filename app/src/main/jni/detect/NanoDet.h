@@ -5,6 +5,7 @@
 #include <net.h>
 #include "vision_base.h"
 #include "IYoloAlgo.h"
+#include "net_cache.h"
 typedef struct HeadInfo {
     std::string cls_layer;
     std::string dis_layer;
@@ -20,10 +21,12 @@ public:
     const char** getClassNames() const override { return class_names_; }
     int getClassCount() const override { return 80; }
     const unsigned char (*getColors() const)[3] override { return colors_; }
+    bool getMemoryStats(ModelMemoryStats& stats) const override { stats = netMemoryStats({Nano_net.get()}); return true; }
+    void getWarmupTargets(std::vector<WarmupTarget>& targets) const override;
 private:
     Object disPred2Bbox(const float*& dfl_det, int label, float score, int x, int y, int stride, float width_ratio, float height_ratio);
     void decode_infer(ncnn::Mat& cls_pred, ncnn::Mat& dis_pred, int stride, float threshold, std::vector<Object>& objects, float width_ratio, float height_ratio);
-    ncnn::Net Nano_net;
+    std::shared_ptr<CachedNet> Nano_net;
     int target_size;
     int num_class = 80;
     static const char* class_names_[80];
@@ -20,13 +20,8 @@
 
 #include "vision_base.h"
 #include "IYoloAlgo.h"
+#include "net_cache.h"
 
-namespace yolov8 {
-    struct GridAndStride{
-        int grid0;
-        int grid1;
-        int stride;};
-}
 class YoloV8: public IYoloAlgo
 {
 public:
@@ -37,8 +32,16 @@ public:
     const char** getClassNames() const override { return class_names_; }
     int getClassCount() const override { return 80; }
     const unsigned char (*getColors() const)[3] override { return colors_; }
+    bool getMemoryStats(ModelMemoryStats& stats) const override { stats = netMemoryStats({yolo.get()}); return true; }
+    void getWarmupTargets(std::vector<WarmupTarget>& targets) const override;
+    int getTargetSize() const override { return target_size; }
+    int detectLetterboxed(const Letterbox& lb, std::vector<Object>& objects) override;
+    int detectTensor(const LetterboxTensor& in, std::vector<Object>& objects) override;
+    bool getTensorNorm(float mean[3], float norm[3]) const override;
+    int detectBatch(const std::vector<cv::Mat>& inputs, std::vector<std::vector<Object> >& objects) override;
+    int detectLetterboxedBatch(const std::vector<Letterbox>& inputs, std::vector<std::vector<Object> >& objects) override;
 private:
-    ncnn::Net yolo;
+    std::shared_ptr<CachedNet> yolo;
     int target_size;
     static const char* class_names_[80];
     static const unsigned char colors_[80][3];
@@ -46,6 +49,9 @@ private:
     const float norm_vals[3] = {1 / 255.f, 1 / 255.f, 1 / 255.f};
     // 图像预处理函数：缩放和填充到32的倍数
     ncnn::Mat preprocessImage(const cv::Mat& rgb, float& scale, int& wpad, int& hpad);
+    // 对填充后的输入推理并把结果映射回 width x height 的原图；num_threads > 0 时限定该 Extractor 的线程数
+    // normalized 为 true 时输入已归一化（detectTensor），跳过 substract_mean_normalize
+    int detectPadded(ncnn::Mat& in_pad, float scale, int wpad, int hpad, int width, int height, std::vector<Object>& objects, int num_threads = 0, bool normalized = false);
 };
 
 #endif // NANODET_H
@@ -0,0 +1,469 @@
+// FFmpeg 解码器实现
+
+#include "ffmpeg_decoder.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/mem.h>
+#include <libavutil/error.h>
+#include <libavutil/display.h>
+#include <libavutil/dict.h>
+}
+
+#include <android/log.h>
+
+#include "cpu.h"
+#include "vision_infer.h"
+#include "IYoloAlgo.h"
+#include "trace.h"
+
+bool pinCurrentThreadToLittleCores(cpu_set_t* old_mask)
+{
+    const int little = ncnn::get_little_cpu_count();
+    if (little <= 0 || little >= ncnn::get_cpu_count()) {
+        return false;
+    }
+    if (old_mask && sched_getaffinity(0, sizeof(cpu_set_t), old_mask) != 0) {
+        return false;
+    }
+    const ncnn::CpuSet& mask = ncnn::get_cpu_thread_affinity_mask(1);
+    if (sched_setaffinity(0, sizeof(cpu_set_t), &mask.cpu_set) != 0) {
+        __android_log_print(ANDROID_LOG_WARN, "FFmpegVideoDetect",
+                            "sched_setaffinity failed, errno=%d", errno);
+        return false;
+    }
+    return true;
+}
+
+// =========================
+// FFmpeg 解码器
+// =========================
+
+static int rotateCode(int rotation)
+{
+    if (rotation == 90)  return cv::ROTATE_90_COUNTERCLOCKWISE;
+    if (rotation == 180) return cv::ROTATE_180;
+    if (rotation == 270) return cv::ROTATE_90_CLOCKWISE;
+    return -1;
+}
+
+FFmpegVideoDecoder::FFmpegVideoDecoder()
+    : format_ctx(nullptr), codec_ctx(nullptr),
+      frame(nullptr), packet(nullptr), video_stream_index(-1),
+      width(0), height(0), stop_flag(false), drain_sent(false),
+      rotation(0), last_error_code(0), last_error_msg(""),
+      rgb_sws_ctx(nullptr), lb_sws_ctx(nullptr)
+{}
+
+std::string FFmpegVideoDecoder::getLastError() const {
+    if (last_error_code != 0) {
+        return "FFmpeg错误码: " + std::to_string(last_error_code) + ", " + last_error_msg;
+    }
+    return last_error_msg;
+}
+
+FFmpegVideoDecoder::~FFmpegVideoDecoder() {
+    cleanup();
+}
+
+int FFmpegVideoDecoder::interrupt_cb(void* opaque) {
+    return static_cast<FFmpegVideoDecoder*>(opaque)->stop_flag ? 1 : 0;
+}
+
+bool FFmpegVideoDecoder::init(const char* filename, const DecoderThreadConfig& threads) {
+    AVDictionary* options = nullptr;
+
+    // 判断是否为网络流
+    bool isNetworkStream =
+            (strstr(filename, "http://")  != nullptr ||
+             strstr(filename, "https://") != nullptr ||
+             strstr(filename, "rtsp://")  != nullptr ||
+             strstr(filename, "rtmp://")  != nullptr);
+
+    if (isNetworkStream) {
+        // 网络流参数
+        av_dict_set(&options, "timeout", "10000000", 0);      // 10s
+        av_dict_set(&options, "tcp_timeout", "10000000", 0);  // TCP 超时
+        av_dict_set(&options, "user_agent", "FFmpeg/Android", 0);
+
+        if (strstr(filename, "rtsp://") != nullptr) {
+            av_dict_set(&options, "rtsp_transport", "tcp", 0);
+        }
+
+        if (strstr(filename, "http://") != nullptr ||
+            strstr(filename, "https://") != nullptr) {
+            av_dict_set(&options, "follow_redirect", "1", 0);
+            av_dict_set(&options, "multiple_requests", "1", 0);
+        }
+
+        av_dict_set(&options, "buffer_size", "10485760", 0); // 10MB
+        av_dict_set(&options, "verify_ssl", "0", 0);
+
+        __android_log_print(ANDROID_LOG_INFO, "FFmpegVideoDetect",
+                            "Opening network stream: %s", filename);
+    }
+
+    // 预先分配上下文以便在打开前挂上中断回调：网络阻塞时 stop() 不必等到 timeout 才能退出
+    format_ctx = avformat_alloc_context();
+    if (!format_ctx) {
+        av_dict_free(&options);
+        last_error_code = AVERROR(ENOMEM);
+        last_error_msg  = "分配 AVFormatContext 失败";
+        return false;
+    }
+    format_ctx->interrupt_callback.callback = interrupt_cb;
+    format_ctx->interrupt_callback.opaque   = this;
+
+    int ret = avformat_open_input(&format_ctx, filename, nullptr, &options);
+    if (options) {
+        av_dict_free(&options);
+    }
+    if (ret < 0) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+        __android_log_print(ANDROID_LOG_ERROR, "FFmpegVideoDetect",
+                            "Failed to open input: %s, error: %s",
+                            filename, errbuf);
+        last_error_code = ret;
+        last_error_msg  = errbuf;
+        return false;
+    }
+
+    // 查找流信息
+    AVDictionary* stream_options = nullptr;
+    if (isNetworkStream) {
+        av_dict_set(&stream_options, "timeout", "15000000", 0);
+    }
+
+    ret = avformat_find_stream_info(format_ctx, &stream_options);
+    if (stream_options) {
+        av_dict_free(&stream_options);
+    }
+    if (ret < 0) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+        __android_log_print(ANDROID_LOG_ERROR, "FFmpegVideoDetect",
+                            "Failed to find stream info: code=%d, error=%s",
+                            ret, errbuf);
+        last_error_code = ret;
+        last_error_msg  = std::string("查找流信息失败: ") + errbuf;
+        return false;
+    }
+
+    // 查找视频流
+    for (unsigned int i = 0; i < format_ctx->nb_streams; i++) {
+        if (format_ctx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
+            video_stream_index = (int)i;
+            break;
+        }
+    }
+
+    if (video_stream_index == -1) {
+        __android_log_print(ANDROID_LOG_ERROR, "FFmpegVideoDetect",
+                            "No video stream found: %s", filename);
+        return false;
+    }
+
+    // 获取解码器
+    AVCodecParameters* codecpar = format_ctx->streams[video_stream_index]->codecpar;
+    const AVCodec* codec = avcodec_find_decoder(codecpar->codec_id);
+    if (!codec) {
+        return false;
+    }
+
+    codec_ctx = avcodec_alloc_context3(codec);
+    if (!codec_ctx) {
+        return false;
+    }
+    if (avcodec_parameters_to_context(codec_ctx, codecpar) < 0) {
+        return false;
+    }
+
+    // 多线程解码：线程数 / 并行方式
+    int thread_count = threads.thread_count;
+    if (thread_count <= 0) {
+        const int little = ncnn::get_little_cpu_count();
+        thread_count = (little > 0 && little < ncnn::get_cpu_count()) ? little : 0;
+    }
+    int thread_type = threads.thread_type;
+    if (thread_type == DECODE_THREAD_AUTO) {
+        thread_type = isNetworkStream ? DECODE_THREAD_SLICE : DECODE_THREAD_BOTH;
+    }
+    codec_ctx->thread_count = thread_count;
+    codec_ctx->thread_type  = ((thread_type & DECODE_THREAD_SLICE) ? FF_THREAD_SLICE : 0) |
+                              ((thread_type & DECODE_THREAD_FRAME) ? FF_THREAD_FRAME : 0);
+
+    // FFmpeg 工作线程在 avcodec_open2 内创建并继承调用线程的亲和性，
+    // 打开期间临时绑到小核，打开后恢复调用线程原有亲和性
+    cpu_set_t old_mask;
+    const bool pinned = threads.pin_little && pinCurrentThreadToLittleCores(&old_mask);
+    ret = avcodec_open2(codec_ctx, codec, nullptr);
+    if (pinned) {
+        sched_setaffinity(0, sizeof(cpu_set_t), &old_mask);
+    }
+    if (ret < 0) {
+        return false;
+    }
+
+    __android_log_print(ANDROID_LOG_INFO, "FFmpegVideoDetect",
+                        "codec=%s, thread_count=%d, thread_type=%d, active=%d, pinned=%d",
+                        codec->name, codec_ctx->thread_count, codec_ctx->thread_type,
+                        codec_ctx->active_thread_type, pinned ? 1 : 0);
+
+    width  = codec_ctx->width;
+    height = codec_ctx->height;
+    if (width == 0 || height == 0) {
+        __android_log_print(ANDROID_LOG_ERROR, "FFmpegVideoDetect",
+                            "Invalid video size: %dx%d", width, height);
+        return false;
+    }
+
+    // 分配帧/缓冲（sws 上下文在首次转换时按帧格式创建）
+    frame  = av_frame_alloc();
+    packet = av_packet_alloc();
+    if (!frame || !packet) {
+        return false;
+    }
+
+    // 旋转元数据
+    rotation = 0;
+    uint8_t* display_matrix = av_stream_get_side_data(
+            format_ctx->streams[video_stream_index],
+            AV_PKT_DATA_DISPLAYMATRIX, nullptr);
+    if (display_matrix) {
+        double rot = av_display_rotation_get((int32_t*)display_matrix);
+        rotation = (int)round(rot);
+        if (rotation % 90 != 0) rotation = 0;
+        if (rotation < 0) rotation += 360;
+    }
+
+    return true;
+}
+
+void FFmpegVideoDecoder::stop() {
+    stop_flag = true;
+}
+
+bool FFmpegVideoDecoder::receive_frame() {
+    if (stop_flag) return false;
+
+    // 解码耗时覆盖整次调用（读包 + 送包 + 取帧），只在真正得到一帧时记录
+    const int64_t t_begin = trace_now_us();
+    while (true) {
+        if (!end_of_stream) {
+            int ret = av_read_frame(format_ctx, packet);
+            if (ret < 0) {
+                end_of_stream = true;
+                av_packet_unref(packet);
+                __android_log_print(ANDROID_LOG_INFO, "FFmpegVideoDetect",
+                                    "Enter flush mode");
+            } else if (packet->stream_index == video_stream_index) {
+                int response = avcodec_send_packet(codec_ctx, packet);
+                __android_log_print(ANDROID_LOG_INFO, "FFmpegVideoDetect",
+                                    "Send packet, response=%d", response);
+                av_packet_unref(packet);
+                if (response < 0) continue;
+            } else {
+                av_packet_unref(packet);
+                continue;
+            }
+        }
+
+        // 读包结束后送一个空包让解码器进入 draining，之后反复取帧直到 AVERROR_EOF，
+        // 否则帧多线程 / 重排序缓存在解码器内的最后若干帧会丢失
+        if (end_of_stream && !drain_sent) {
+            int response = avcodec_send_packet(codec_ctx, nullptr);
+            __android_log_print(ANDROID_LOG_INFO, "FFmpegVideoDetect",
+                                "Send drain packet, response=%d", response);
+            if (response < 0 && response != AVERROR_EOF) return false;
+            drain_sent = true;
+        }
+
+        int response = avcodec_receive_frame(codec_ctx, frame);
+        __android_log_print(ANDROID_LOG_INFO, "FFmpegVideoDetect",
+                            "Receive frame, response=%d", response);
+        if (response == AVERROR(EAGAIN)) {
+            // draining 期间解码器不会再要输入，EAGAIN 只可能出现在送空包之前
+            if (drain_sent) return false;
+            continue;
+        } else if (response == AVERROR_EOF) {
+            return false;
+        } else if (response < 0) {
+            return false;
+        }
+
+        __android_log_print(ANDROID_LOG_INFO, "FFmpegVideoDetect",
+                            "Decoded frame: %d x %d, pix_fmt=%d",
+                            frame->width, frame->height, frame->format);
+        trace_record(TRACE_DECODE, t_begin);
+        return true;
+    }
+}
+
+std::shared_ptr<AVFrame> FFmpegVideoDecoder::ref_frame() const {
+    AVFrame* ref = av_frame_clone(frame);
+    if (!ref) return nullptr;
+    return std::shared_ptr<AVFrame>(ref, [](AVFrame* f) { av_frame_free(&f); });
+}
+
+bool FFmpegVideoDecoder::convert_rgb(const AVFrame* src, cv::Mat& output_frame) {
+    TRACE_SCOPE(TRACE_CONVERT);
+    std::lock_guard<std::mutex> lock(rgb_sws_mutex);
+    rgb_sws_ctx = sws_getCachedContext(rgb_sws_ctx,
+                                       src->width, src->height, (AVPixelFormat)src->format,
+                                       src->width, src->height, AV_PIX_FMT_RGB24,
+                                       SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!rgb_sws_ctx) return false;
+
+    // 输出必须是新分配的 Mat，避免与仍在其它阶段使用的上一帧共享内存
+    const int code = rotateCode(rotation);
+    cv::Mat target;
+    if (code < 0) {
+        target = cv::Mat(src->height, src->width, CV_8UC3);
+    } else {
+        rgb_scratch.create(src->height, src->width, CV_8UC3);
+        target = rgb_scratch;
+    }
+
+    uint8_t* dst_data[4] = {target.data, nullptr, nullptr, nullptr};
+    int dst_linesize[4]  = {(int)target.step, 0, 0, 0};
+    sws_scale(rgb_sws_ctx, src->data, src->linesize, 0, src->height, dst_data, dst_linesize);
+
+    if (code < 0) {
+        output_frame = target;
+    } else {
+        output_frame = cv::Mat();
+        cv::rotate(rgb_scratch, output_frame, code);
+    }
+    return true;
+}
+
+bool FFmpegVideoDecoder::convert_letterbox(const AVFrame* src, int target_size, Letterbox& lb) {
+    TRACE_SCOPE(TRACE_CONVERT);
+    const bool swap = (rotation == 90 || rotation == 270);
+    const int disp_w = swap ? src->height : src->width;
+    const int disp_h = swap ? src->width  : src->height;
+
+    int w = disp_w;
+    int h = disp_h;
+    float scale = 1.f;
+    if (w > h) {
+        scale = (float)target_size / w;
+        w = target_size;
+        h = h * scale;
+    } else {
+        scale = (float)target_size / h;
+        h = target_size;
+        w = w * scale;
+    }
+    if (w <= 0 || h <= 0) return false;
+
+    const int wpad = (w + 31) / 32 * 32 - w;
+    const int hpad = (h + 31) / 32 * 32 - h;
+
+    lb.image  = cv::Mat(h + hpad, w + wpad, CV_8UC3, cv::Scalar(114, 114, 114));
+    lb.scale  = scale;
+    lb.wpad   = wpad;
+    lb.hpad   = hpad;
+    lb.orig_w = disp_w;
+    lb.orig_h = disp_h;
+    cv::Mat roi = lb.image(cv::Rect(wpad / 2, hpad / 2, w, h));
+
+    // sws 输出为旋转前的方向
+    const int sws_w = swap ? h : w;
+    const int sws_h = swap ? w : h;
+
+    std::lock_guard<std::mutex> lock(lb_sws_mutex);
+    lb_sws_ctx = sws_getCachedContext(lb_sws_ctx,
+                                      src->width, src->height, (AVPixelFormat)src->format,
+                                      sws_w, sws_h, AV_PIX_FMT_RGB24,
+                                      SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!lb_sws_ctx) return false;
+
+    const int code = rotateCode(rotation);
+    if (code >= 0) {
+        lb_scratch.create(sws_h, sws_w, CV_8UC3);
+    }
+    cv::Mat& target = (code < 0) ? roi : lb_scratch;
+
+    uint8_t* dst_data[4] = {target.data, nullptr, nullptr, nullptr};
+    int dst_linesize[4]  = {(int)target.step, 0, 0, 0};
+    sws_scale(lb_sws_ctx, src->data, src->linesize, 0, src->height, dst_data, dst_linesize);
+
+    if (code >= 0) {
+        // roi 尺寸与类型已匹配，rotate 直接写入填充缓冲
+        cv::rotate(lb_scratch, roi, code);
+    }
+    return true;
+}
+
+bool FFmpegVideoDecoder::decode_frame(cv::Mat& output_frame) {
+    if (!receive_frame()) return false;
+    return convert_rgb(frame, output_frame);
+}
+
+void FFmpegVideoDecoder::cleanup() {
+    stop_flag = true;
+
+    if (rgb_sws_ctx) {
+        sws_freeContext(rgb_sws_ctx);
+        rgb_sws_ctx = nullptr;
+    }
+    if (lb_sws_ctx) {
+        sws_freeContext(lb_sws_ctx);
+        lb_sws_ctx = nullptr;
+    }
+    if (packet) {
+        av_packet_free(&packet);
+    }
+    if (frame) {
+        av_frame_free(&frame);
+    }
+    if (codec_ctx) {
+        avcodec_free_context(&codec_ctx);
+    }
+    if (format_ctx) {
+        avformat_close_input(&format_ctx);
+    }
+}
+
+// =========================
+// 解码帧推理
+// =========================
+
+std::vector<Object> inferDecodedFrame(FFmpegVideoDecoder& decoder, const AVFrame* src,
+                                      cv::Mat& rgb, std::shared_ptr<IYoloAlgo>& model)
+{
+    std::vector<Object> objects;
+
+    // 整个推理只取一次模型，letterbox 尺寸、推理与绘制用的类别表都来自同一实例
+    model = acquireModel();
+    if (!model) {
+        return objects;
+    }
+
+    const int targetSize = model->getTargetSize();
+    if (targetSize > 0) {
+        Letterbox lb;
+        if (decoder.convert_letterbox(src, targetSize, lb)) {
+            ncnn::MutexLockGuard g(g_lock);
+            if (model->detectLetterboxed(lb, objects) == 0) {
+                return objects;
+            }
+        }
+        objects.clear();
+    }
+
+    if (rgb.empty() && !decoder.convert_rgb(src, rgb)) {
+        return objects;
+    }
+    ncnn::MutexLockGuard g(g_lock);
+    model->detect(rgb, objects);
+    return objects;
+}
@@ -0,0 +1,122 @@
+#ifndef FFMPEG_DECODER_H
+#define FFMPEG_DECODER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sched.h>
+
+#include <opencv2/core/core.hpp>
+
+// FFmpeg
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+#include <libavutil/frame.h>
+}
+
+#include "vision_base.h"
+
+// =========================
+// 解码线程配置
+// =========================
+
+// thread_type 取值（与 JNI 参数一致）
+enum DecodeThreadType {
+    DECODE_THREAD_AUTO  = 0,   // 本地文件用帧+片并行，网络流只用片并行（帧并行会增加 thread_count 帧延迟）
+    DECODE_THREAD_SLICE = 1,
+    DECODE_THREAD_FRAME = 2,
+    DECODE_THREAD_BOTH  = 3
+};
+
+struct DecoderThreadConfig {
+    int thread_count = 0;      // <= 0 时取小核数（无大小核之分时交给 FFmpeg 自动选择）
+    int thread_type  = DECODE_THREAD_AUTO;
+    bool pin_little  = true;   // 解码线程绑到小核，避开 ncnn 推理使用的大核
+};
+
+// 当前线程绑到小核，old_mask 保存原亲和性以便恢复（可为空）；没有大小核之分或失败时返回 false
+bool pinCurrentThreadToLittleCores(cpu_set_t* old_mask);
+
+// =========================
+// FFmpeg 解码器（本地视频 / 网络流共用，每路流一个实例）
+// =========================
+
+class FFmpegVideoDecoder {
+private:
+    AVFormatContext* format_ctx;
+    AVCodecContext* codec_ctx;
+    AVFrame* frame;
+    AVPacket* packet;
+    int video_stream_index;
+    int width, height;
+    std::atomic<bool> stop_flag;
+    bool drain_sent;        // 读包结束后已送入空包，解码器进入 draining
+    int rotation;           // 视频旋转角度
+    int last_error_code;    // 最后错误码
+    std::string last_error_msg; // 最后错误信息
+
+    // 像素格式转换：全分辨率 RGB（渲染用）与 letterbox（推理用）各自独立的 sws 上下文，
+    // 可分别在渲染线程 / 推理线程调用，各用一把锁保护
+    SwsContext* rgb_sws_ctx;
+    SwsContext* lb_sws_ctx;
+    std::mutex rgb_sws_mutex;
+    std::mutex lb_sws_mutex;
+    cv::Mat rgb_scratch;    // 需要旋转时的中间缓冲（复用）
+    cv::Mat lb_scratch;
+
+    // AVFormatContext 的中断回调：stop() 后让阻塞中的打开 / av_read_frame 立即返回
+    static int interrupt_cb(void* opaque);
+
+public:
+    AVFormatContext* getFormatCtx() const { return format_ctx; }
+    int getVideoStreamIndex() const { return video_stream_index; }
+
+    FFmpegVideoDecoder();
+
+    // 获取最后的错误信息
+    std::string getLastError() const;
+
+    ~FFmpegVideoDecoder();
+
+    bool init(const char* filename, const DecoderThreadConfig& threads = DecoderThreadConfig());
+
+    // 请求停止（可从其它线程调用）：阻塞中的打开 / 读包经中断回调立即返回
+    void stop();
+
+    bool end_of_stream = false;
+
+    // 解码下一帧到内部 frame，不做像素格式转换；结束或失败返回 false
+    bool receive_frame();
+
+    // 引用当前解码帧（只增加引用计数，不拷贝像素），用于把转换推迟到其它线程
+    std::shared_ptr<AVFrame> ref_frame() const;
+
+    // 转为全分辨率 RGB（已按旋转元数据矫正），sws 直接写入新分配的 Mat，无额外拷贝
+    bool convert_rgb(const AVFrame* src, cv::Mat& output_frame);
+
+    // 转为模型输入 letterbox：一次 sws_scale 完成 YUV->RGB 与缩放，直接写入填充缓冲的有效区域；
+    // 有旋转时在缩放后的小图上旋转（而不是全分辨率图），缩放、填充方式与各模型 preprocessImage 一致
+    bool convert_letterbox(const AVFrame* src, int target_size, Letterbox& lb);
+
+    // 解码并转为全分辨率 RGB（兼容原接口）
+    bool decode_frame(cv::Mat& output_frame);
+
+    const AVFrame* current_frame() const { return frame; }
+
+    void cleanup();
+
+    int getWidth()  const { return width; }
+    int getHeight() const { return height; }
+};
+
+// 对解码帧推理：模型支持 letterbox 时由 YUV 直接生成模型输入；
+// 否则转全分辨率 RGB 走 detect，此时 rgb 同时留给渲染使用
+// model 写入执行推理的模型（未加载时为空），绘制时传回 drawAndUpdateSummary
+std::vector<Object> inferDecodedFrame(FFmpegVideoDecoder& decoder, const AVFrame* src,
+                                      cv::Mat& rgb, std::shared_ptr<IYoloAlgo>& model);
+
+#endif // FFMPEG_DECODER_H
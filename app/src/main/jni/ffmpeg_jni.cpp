@@ -6,10 +6,12 @@
 #include <vector>
 #include <string>
 #include <cstring>
+#include <climits>
 #include <algorithm>
 #include <thread>
 #include <atomic>
 #include <chrono>
+#include <memory>
 
 // OpenCV
 #include <opencv2/core/core.hpp>
@@ -35,293 +37,10 @@ extern "C" {
 #include "vision_base.h"
 #include "vision_infer.h"
 #include "IYoloAlgo.h"
-
-// =========================
-// FFmpeg 解码器
-// =========================
-
-class FFmpegVideoDecoder {
-private:
-    AVFormatContext* format_ctx;
-    AVCodecContext* codec_ctx;
-    SwsContext* sws_ctx;
-    AVFrame* frame;
-    AVFrame* rgb_frame;
-    AVPacket* packet;
-    uint8_t* rgb_buffer;
-    int video_stream_index;
-    int width, height;
-    std::atomic<bool> stop_flag;
-    int rotation;           // 视频旋转角度
-    int last_error_code;    // 最后错误码
-    std::string last_error_msg; // 最后错误信息
-
-public:
-    AVFormatContext* getFormatCtx() const { return format_ctx; }
-    int getVideoStreamIndex() const { return video_stream_index; }
-
-    FFmpegVideoDecoder()
-        : format_ctx(nullptr), codec_ctx(nullptr), sws_ctx(nullptr),
-          frame(nullptr), rgb_frame(nullptr), packet(nullptr),
-          rgb_buffer(nullptr), video_stream_index(-1),
-          width(0), height(0), stop_flag(false),
-          rotation(0), last_error_code(0), last_error_msg("")
-    {}
-
-    // 获取最后的错误信息
-    std::string getLastError() const {
-        if (last_error_code != 0) {
-            return "FFmpeg错误码: " + std::to_string(last_error_code) + ", " + last_error_msg;
-        }
-        return last_error_msg;
-    }
-
-    ~FFmpegVideoDecoder() {
-        cleanup();
-    }
-
-    bool init(const char* filename) {
-        AVDictionary* options = nullptr;
-
-        // 判断是否为网络流
-        bool isNetworkStream =
-                (strstr(filename, "http://")  != nullptr ||
-                 strstr(filename, "https://") != nullptr ||
-                 strstr(filename, "rtsp://")  != nullptr ||
-                 strstr(filename, "rtmp://")  != nullptr);
-
-        if (isNetworkStream) {
-            // 网络流参数
-            av_dict_set(&options, "timeout", "10000000", 0);      // 10s
-            av_dict_set(&options, "tcp_timeout", "10000000", 0);  // TCP 超时
-            av_dict_set(&options, "user_agent", "FFmpeg/Android", 0);
-
-            if (strstr(filename, "rtsp://") != nullptr) {
-                av_dict_set(&options, "rtsp_transport", "tcp", 0);
-            }
-
-            if (strstr(filename, "http://") != nullptr ||
-                strstr(filename, "https://") != nullptr) {
-                av_dict_set(&options, "follow_redirect", "1", 0);
-                av_dict_set(&options, "multiple_requests", "1", 0);
-            }
-
-            av_dict_set(&options, "buffer_size", "10485760", 0); // 10MB
-            av_dict_set(&options, "verify_ssl", "0", 0);
-
-            __android_log_print(ANDROID_LOG_INFO, "FFmpegVideoDetect",
-                                "Opening network stream: %s", filename);
-        }
-
-        int ret = avformat_open_input(&format_ctx, filename, nullptr, &options);
-        if (options) {
-            av_dict_free(&options);
-        }
-        if (ret < 0) {
-            char errbuf[AV_ERROR_MAX_STRING_SIZE];
-            av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
-            __android_log_print(ANDROID_LOG_ERROR, "FFmpegVideoDetect",
-                                "Failed to open input: %s, error: %s",
-                                filename, errbuf);
-            last_error_code = ret;
-            last_error_msg  = errbuf;
-            return false;
-        }
-
-        // 查找流信息
-        AVDictionary* stream_options = nullptr;
-        if (isNetworkStream) {
-            av_dict_set(&stream_options, "timeout", "15000000", 0);
-        }
-
-        ret = avformat_find_stream_info(format_ctx, &stream_options);
-        if (stream_options) {
-            av_dict_free(&stream_options);
-        }
-        if (ret < 0) {
-            char errbuf[AV_ERROR_MAX_STRING_SIZE];
-            av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
-            __android_log_print(ANDROID_LOG_ERROR, "FFmpegVideoDetect",
-                                "Failed to find stream info: code=%d, error=%s",
-                                ret, errbuf);
-            last_error_code = ret;
-            last_error_msg  = std::string("查找流信息失败: ") + errbuf;
-            return false;
-        }
-
-        // 查找视频流
-        for (unsigned int i = 0; i < format_ctx->nb_streams; i++) {
-            if (format_ctx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
-                video_stream_index = (int)i;
-                break;
-            }
-        }
-
-        if (video_stream_index == -1) {
-            __android_log_print(ANDROID_LOG_ERROR, "FFmpegVideoDetect",
-                                "No video stream found: %s", filename);
-            return false;
-        }
-
-        // 获取解码器
-        AVCodecParameters* codecpar = format_ctx->streams[video_stream_index]->codecpar;
-        const AVCodec* codec = avcodec_find_decoder(codecpar->codec_id);
-        if (!codec) {
-            return false;
-        }
-
-        codec_ctx = avcodec_alloc_context3(codec);
-        if (!codec_ctx) {
-            return false;
-        }
-        if (avcodec_parameters_to_context(codec_ctx, codecpar) < 0) {
-            return false;
-        }
-        if (avcodec_open2(codec_ctx, codec, nullptr) < 0) {
-            return false;
-        }
-
-        width  = codec_ctx->width;
-        height = codec_ctx->height;
-        if (width == 0 || height == 0) {
-            __android_log_print(ANDROID_LOG_ERROR, "FFmpegVideoDetect",
-                                "Invalid video size: %dx%d", width, height);
-            return false;
-        }
-
-        // 分配帧/缓冲
-        frame     = av_frame_alloc();
-        rgb_frame = av_frame_alloc();
-        packet    = av_packet_alloc();
-        if (!frame || !rgb_frame || !packet) {
-            return false;
-        }
-
-        int num_bytes = av_image_get_buffer_size(AV_PIX_FMT_RGB24, width, height, 1);
-        rgb_buffer = (uint8_t*)av_malloc(num_bytes * sizeof(uint8_t));
-        if (!rgb_buffer) {
-            return false;
-        }
-
-        av_image_fill_arrays(rgb_frame->data, rgb_frame->linesize, rgb_buffer,
-                             AV_PIX_FMT_RGB24, width, height, 1);
-
-        sws_ctx = sws_getContext(width, height, codec_ctx->pix_fmt,
-                                 width, height, AV_PIX_FMT_RGB24,
-                                 SWS_BILINEAR, nullptr, nullptr, nullptr);
-
-        // 旋转元数据
-        rotation = 0;
-        uint8_t* display_matrix = av_stream_get_side_data(
-                format_ctx->streams[video_stream_index],
-                AV_PKT_DATA_DISPLAYMATRIX, nullptr);
-        if (display_matrix) {
-            double rot = av_display_rotation_get((int32_t*)display_matrix);
-            rotation = (int)round(rot);
-            if (rotation % 90 != 0) rotation = 0;
-            if (rotation < 0) rotation += 360;
-        }
-
-        return true;
-    }
-
-    void stop() {
-        stop_flag = true;
-    }
-
-    bool end_of_stream = false;
-
-    bool decode_frame(cv::Mat& output_frame) {
-        if (stop_flag) return false;
-
-        while (true) {
-            if (!end_of_stream) {
-                int ret = av_read_frame(format_ctx, packet);
-                if (ret < 0) {
-                    end_of_stream = true;
-                    av_packet_unref(packet);
-                    __android_log_print(ANDROID_LOG_INFO, "FFmpegVideoDetect",
-                                        "Enter flush mode");
-                } else if (packet->stream_index == video_stream_index) {
-                    int response = avcodec_send_packet(codec_ctx, packet);
-                    __android_log_print(ANDROID_LOG_INFO, "FFmpegVideoDetect",
-                                        "Send packet, response=%d", response);
-                    av_packet_unref(packet);
-                    if (response < 0) continue;
-                } else {
-                    av_packet_unref(packet);
-                    continue;
-                }
-            }
-
-            int response = avcodec_receive_frame(codec_ctx, frame);
-            __android_log_print(ANDROID_LOG_INFO, "FFmpegVideoDetect",
-                                "Receive frame, response=%d", response);
-            if (response == AVERROR(EAGAIN)) {
-                if (end_of_stream) return false;
-                continue;
-            } else if (response == AVERROR_EOF) {
-                return false;
-            } else if (response < 0) {
-                return false;
-            }
-
-            __android_log_print(ANDROID_LOG_INFO, "FFmpegVideoDetect",
-                                "Decoded frame: %d x %d, pix_fmt=%d",
-                                frame->width, frame->height, frame->format);
-
-            sws_scale(sws_ctx, frame->data, frame->linesize,
-                      0, height, rgb_frame->data, rgb_frame->linesize);
-
-            output_frame = cv::Mat(height, width, CV_8UC3,
-                                   rgb_buffer, rgb_frame->linesize[0]);
-            output_frame = output_frame.clone();
-
-            // 按旋转元数据矫正
-            if (rotation == 90) {
-                cv::rotate(output_frame, output_frame,
-                           cv::ROTATE_90_COUNTERCLOCKWISE);
-            } else if (rotation == 180) {
-                cv::rotate(output_frame, output_frame, cv::ROTATE_180);
-            } else if (rotation == 270) {
-                cv::rotate(output_frame, output_frame, cv::ROTATE_90_CLOCKWISE);
-            }
-
-            return true;
-        }
-    }
-
-    void cleanup() {
-        stop_flag = true;
-
-        if (sws_ctx) {
-            sws_freeContext(sws_ctx);
-            sws_ctx = nullptr;
-        }
-        if (rgb_buffer) {
-            av_free(rgb_buffer);
-            rgb_buffer = nullptr;
-        }
-        if (packet) {
-            av_packet_free(&packet);
-        }
-        if (frame) {
-            av_frame_free(&frame);
-        }
-        if (rgb_frame) {
-            av_frame_free(&rgb_frame);
-        }
-        if (codec_ctx) {
-            avcodec_free_context(&codec_ctx);
-        }
-        if (format_ctx) {
-            avformat_close_input(&format_ctx);
-        }
-    }
-
-    int getWidth()  const { return width; }
-    int getHeight() const { return height; }
-};
+#include "frame_queue.h"
+#include "ffmpeg_decoder.h"
+#include "stream_manager.h"
+#include "trace.h"
 
 // =========================
 // 本地视频检测
@@ -331,7 +50,8 @@ extern "C"
 JNIEXPORT void JNICALL
 Java_NcnnTencent_common_JniBridge_startFFmpegVideoDetect(
         JNIEnv* env, jobject thiz, jstring videoPath, jint inputSize,
-        jobject callback, jobject assetManager, jint modelid, jint cpugpu)
+        jobject callback, jobject assetManager, jint modelid, jint cpugpu,
+        jint decodeThreads, jint decodeThreadType)
 {
     const char* path = env->GetStringUTFChars(videoPath, 0);
 
@@ -344,8 +64,7 @@ Java_NcnnTencent_common_JniBridge_startFFmpegVideoDetect(
 
     // 检查模型是否已加载
     {
-        ncnn::MutexLockGuard g(g_lock);
-        if (!g_yolo) {
+        if (!acquireModel()) {
             jstring msg = env->NewStringUTF("模型未加载");
             env->CallVoidMethod(callback, onError, msg);
             env->DeleteLocalRef(msg);
@@ -354,8 +73,12 @@ Java_NcnnTencent_common_JniBridge_startFFmpegVideoDetect(
         }
     }
 
+    DecoderThreadConfig threads;
+    threads.thread_count = decodeThreads;
+    threads.thread_type  = decodeThreadType;
+
     FFmpegVideoDecoder decoder;
-    if (!decoder.init(path)) {
+    if (!decoder.init(path, threads)) {
         jstring msg = env->NewStringUTF("视频无视频流或解码器初始化失败");
         env->CallVoidMethod(callback, onError, msg);
         env->DeleteLocalRef(msg);
@@ -371,36 +94,41 @@ Java_NcnnTencent_common_JniBridge_startFFmpegVideoDetect(
     cv::Mat rgb_frame;
     while (frameCount < maxFrames) {
         double t0 = ncnn::get_current_time();
-        bool decodeSuccess = decoder.decode_frame(rgb_frame);
+        bool decodeSuccess = decoder.receive_frame();
         if (!decodeSuccess) break;
 
         frameCount++;
 
-        // 抽帧
+        // 抽帧（被跳过的帧不做任何像素格式转换）
         if (frameCount % 2 == 0) {
             continue;
         }
 
-        // 推理 + 绘制
-        double t1 = ncnn::get_current_time();
-        (void)t1;
-        detectAndUpdateSummary(rgb_frame, t0, t1);
+        // 推理（letterbox 直出）-> 转全分辨率 RGB -> 绘制
+        rgb_frame.release();
+        std::shared_ptr<IYoloAlgo> model;
+        std::vector<Object> objects = inferDecodedFrame(decoder, decoder.current_frame(), rgb_frame, model);
+        if (rgb_frame.empty() && !decoder.convert_rgb(decoder.current_frame(), rgb_frame)) {
+            continue;
+        }
+        drawAndUpdateSummary(rgb_frame, objects, t0, trace_thread_last_ms(TRACE_FORWARD), model);
 
-        // 回调
-        jclass rectFCls = env->FindClass("android/graphics/RectF");
-        jobjectArray rectFArray = env->NewObjectArray(0, rectFCls, nullptr);
+        // 回调（Java 侧接管并自行 recycle 每帧 Bitmap，因此这里不走复用池）
+        // 检测结果由 Java 通过 getDetectResults 读取，RectF[] 仅在兼容模式下构建
         jobject bitmap = matToBitmap(env, rgb_frame);
         if (!bitmap) {
-            env->DeleteLocalRef(rectFArray);
             continue;
         }
+        jobjectArray rectFArray = legacyRectFResults() ? buildRectFArray(env, objects) : nullptr;
 
         processedFrames++;
         hasFrameCallback = true;
         env->CallVoidMethod(callback, onFrame, bitmap, rectFArray);
 
         env->DeleteLocalRef(bitmap);
-        env->DeleteLocalRef(rectFArray);
+        if (rectFArray) {
+            env->DeleteLocalRef(rectFArray);
+        }
     }
 
     decoder.cleanup();
@@ -424,11 +152,245 @@ static std::thread      g_network_thread;
 static std::atomic<bool> g_network_running(false);
 static std::atomic<bool> g_network_stop(false);
 
+// 当前单路网络流的解码器：stop 时需直接打断阻塞中的 avformat_open_input / av_read_frame
+static std::mutex          g_network_decoder_mutex;
+static FFmpegVideoDecoder* g_network_decoder = nullptr;
+
+// 在网络线程作用域内登记解码器，离开作用域（含各错误返回）时自动注销
+struct NetworkDecoderRegistration {
+    explicit NetworkDecoderRegistration(FFmpegVideoDecoder& decoder) {
+        std::lock_guard<std::mutex> lock(g_network_decoder_mutex);
+        g_network_decoder = &decoder;
+        // stop 可能发生在登记之前，此时直接置位
+        if (g_network_stop.load()) {
+            decoder.stop();
+        }
+    }
+    ~NetworkDecoderRegistration() {
+        std::lock_guard<std::mutex> lock(g_network_decoder_mutex);
+        g_network_decoder = nullptr;
+    }
+};
+
+// 流水线模式配置：解码 -> 推理 -> 渲染 三个阶段分别运行在独立线程
+static std::atomic<bool> g_pipeline_enabled(true);
+static std::atomic<int>  g_pipeline_capacity(3);
+static std::atomic<bool> g_pipeline_drop_oldest(true);
+
+// 流水线各阶段统计（供 Java 层查询）
+struct NetworkPipelineStats {
+    std::atomic<int> decodeQueueDepth{0};
+    std::atomic<int> renderQueueDepth{0};
+    std::atomic<int> decodeDropped{0};
+    std::atomic<int> renderDropped{0};
+    std::atomic<int> decodedFrames{0};
+    std::atomic<int> inferredFrames{0};
+    std::atomic<int> renderedFrames{0};
+
+    void reset() {
+        decodeQueueDepth = 0;
+        renderQueueDepth = 0;
+        decodeDropped    = 0;
+        renderDropped    = 0;
+        decodedFrames    = 0;
+        inferredFrames   = 0;
+        renderedFrames   = 0;
+    }
+};
+static NetworkPipelineStats g_pipeline_stats;
+
+static const int MAX_CONSECUTIVE_FAILURES = 10;
+
+// 在流水线各阶段之间传递的帧
+struct NetworkFrame {
+    std::shared_ptr<AVFrame> av;   // 解码帧引用，像素格式转换推迟到需要时
+    cv::Mat rgb;                   // 全分辨率 RGB，仅渲染阶段（或不支持 letterbox 的模型）生成
+    std::vector<Object> objects;
+    std::shared_ptr<IYoloAlgo> model;  // 产生 objects 的模型，绘制时取它的类别表
+    float forward_ms = 0.f;            // 推理线程记录的前向耗时
+    bool inferred = false;
+    double t_decode = 0;
+};
+
+static bool queryDetecting(JNIEnv* env, jobject manager, jmethodID isDetecting)
+{
+    jboolean detecting = env->CallBooleanMethod(manager, isDetecting);
+    if (env->ExceptionCheck()) {
+        env->ExceptionClear();
+        detecting = JNI_FALSE;
+    }
+    return detecting == JNI_TRUE;
+}
+
+// 串行模式：解码、推理、回调依次在同一线程执行
+static int runSerialNetworkStream(JNIEnv* env, jobject manager, jmethodID onFrame,
+                                  jmethodID isDetecting, FFmpegVideoDecoder& decoder,
+                                  std::string& error)
+{
+    int frameCount          = 0;
+    int consecutiveFailures = 0;
+
+    while (!g_network_stop.load()) {
+        double t0 = ncnn::get_current_time();
+        bool decodeSuccess = decoder.receive_frame();
+        if (!decodeSuccess) {
+            consecutiveFailures++;
+            __android_log_print(ANDROID_LOG_WARN, "NetworkVideo",
+                                "decode failed, consecutive=%d",
+                                consecutiveFailures);
+
+            if (consecutiveFailures >= MAX_CONSECUTIVE_FAILURES) {
+                error = "无法解码视频流，可能流已断开或格式不支持";
+                break;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+
+        consecutiveFailures = 0;
+        frameCount++;
+
+        if (frameCount % 2 == 0) {
+            continue;
+        }
+
+        cv::Mat rgb_frame;
+        std::vector<Object> objects;
+        std::shared_ptr<IYoloAlgo> model;
+        bool detecting = queryDetecting(env, manager, isDetecting);
+        if (detecting) {
+            objects = inferDecodedFrame(decoder, decoder.current_frame(), rgb_frame, model);
+        }
+        if (rgb_frame.empty() && !decoder.convert_rgb(decoder.current_frame(), rgb_frame)) {
+            continue;
+        }
+        if (detecting) {
+            drawAndUpdateSummary(rgb_frame, objects, t0, trace_thread_last_ms(TRACE_FORWARD), model);
+        }
+
+        deliverNetworkFrame(env, manager, onFrame, rgb_frame, objects, BITMAP_CHANNEL_NETWORK);
+
+        frameCount++;
+    }
+
+    return frameCount;
+}
+
+// 流水线模式：解码线程 -> 推理线程 -> 渲染（当前已 Attach 的线程），阶段之间用有界环形队列衔接
+static int runPipelinedNetworkStream(JNIEnv* env, jobject manager, jmethodID onFrame,
+                                     jmethodID isDetecting, FFmpegVideoDecoder& decoder,
+                                     std::string& error)
+{
+    const size_t capacity = (size_t)std::max(1, g_pipeline_capacity.load());
+    const bool dropOldest = g_pipeline_drop_oldest.load();
+    FrameRingBuffer<NetworkFrame> decodeQueue(capacity, dropOldest);
+    FrameRingBuffer<NetworkFrame> renderQueue(capacity, dropOldest);
+
+    // isDetecting 只能在已 Attach 的线程上调用，渲染阶段每帧刷新一次供推理阶段读取
+    std::atomic<bool> detecting(queryDetecting(env, manager, isDetecting));
+
+    g_pipeline_stats.reset();
+    auto publishStats = [&]() {
+        g_pipeline_stats.decodeQueueDepth = (int)decodeQueue.size();
+        g_pipeline_stats.renderQueueDepth = (int)renderQueue.size();
+        g_pipeline_stats.decodeDropped    = (int)decodeQueue.dropped();
+        g_pipeline_stats.renderDropped    = (int)renderQueue.dropped();
+    };
+
+    __android_log_print(ANDROID_LOG_INFO, "NetworkVideo",
+                        "pipeline mode, capacity=%d, dropOldest=%d",
+                        (int)capacity, dropOldest ? 1 : 0);
+
+    // 解码阶段（解包 / 码流解析也在小核上跑，不与推理抢大核）
+    std::thread decodeThread([&]() {
+        pinCurrentThreadToLittleCores(nullptr);
+        int consecutiveFailures = 0;
+        while (!g_network_stop.load()) {
+            NetworkFrame item;
+            item.t_decode = ncnn::get_current_time();
+            if (!decoder.receive_frame() || !(item.av = decoder.ref_frame())) {
+                consecutiveFailures++;
+                __android_log_print(ANDROID_LOG_WARN, "NetworkVideo",
+                                    "decode failed, consecutive=%d",
+                                    consecutiveFailures);
+
+                if (consecutiveFailures >= MAX_CONSECUTIVE_FAILURES) {
+                    error = "无法解码视频流，可能流已断开或格式不支持";
+                    break;
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
+            }
+
+            consecutiveFailures = 0;
+            g_pipeline_stats.decodedFrames++;
+            if (!decodeQueue.push(std::move(item))) {
+                break;
+            }
+            publishStats();
+        }
+        decodeQueue.close();
+    });
+
+    // 推理阶段
+    std::thread inferThread([&]() {
+        NetworkFrame item;
+        while (decodeQueue.pop(item)) {
+            if (detecting.load()) {
+                item.objects    = inferDecodedFrame(decoder, item.av.get(), item.rgb, item.model);
+                item.forward_ms = trace_thread_last_ms(TRACE_FORWARD);
+                item.inferred   = true;
+                g_pipeline_stats.inferredFrames++;
+            }
+            if (!renderQueue.push(std::move(item))) {
+                break;
+            }
+            publishStats();
+        }
+        renderQueue.close();
+    });
+
+    // 渲染阶段
+    NetworkFrame item;
+    while (renderQueue.pop(item)) {
+        // 只有真正要显示的帧才转全分辨率 RGB，队列中被丢弃的帧不产生转换开销
+        if (item.rgb.empty() && !decoder.convert_rgb(item.av.get(), item.rgb)) {
+            continue;
+        }
+        item.av.reset();
+        if (item.inferred) {
+            drawAndUpdateSummary(item.rgb, item.objects, item.t_decode, item.forward_ms, item.model);
+        }
+        deliverNetworkFrame(env, manager, onFrame, item.rgb, item.objects, BITMAP_CHANNEL_NETWORK);
+        detecting.store(queryDetecting(env, manager, isDetecting));
+        g_pipeline_stats.renderedFrames++;
+        publishStats();
+    }
+
+    decodeQueue.close();
+    renderQueue.close();
+    decodeThread.join();
+    inferThread.join();
+
+    __android_log_print(ANDROID_LOG_INFO, "NetworkVideo",
+                        "pipeline stopped, decoded=%d, inferred=%d, rendered=%d, dropped=%d/%d",
+                        g_pipeline_stats.decodedFrames.load(),
+                        g_pipeline_stats.inferredFrames.load(),
+                        g_pipeline_stats.renderedFrames.load(),
+                        g_pipeline_stats.decodeDropped.load(),
+                        g_pipeline_stats.renderDropped.load());
+
+    return g_pipeline_stats.renderedFrames.load();
+}
+
 extern "C"
 JNIEXPORT void JNICALL
 Java_NcnnTencent_common_JniBridge_startNetworkVideoStream(
         JNIEnv* env, jobject thiz, jstring jurl, jint inputSize,
-        jint modelid, jint cpugpu, jobject callback)
+        jint modelid, jint cpugpu, jobject callback,
+        jint decodeThreads, jint decodeThreadType)
 {
     if (g_network_running.load()) {
         __android_log_print(ANDROID_LOG_WARN, "NetworkVideo",
@@ -456,7 +418,7 @@ Java_NcnnTencent_common_JniBridge_startNetworkVideoStream(
     g_network_running.store(true);
 
     g_network_thread = std::thread(
-            [jvm, managerGlobal, url, inputSize, modelid, cpugpu]() {
+            [jvm, managerGlobal, url, inputSize, modelid, cpugpu, decodeThreads, decodeThreadType]() {
         JNIEnv* envThread = nullptr;
         if (jvm->AttachCurrentThread(&envThread, nullptr) != JNI_OK) {
             __android_log_print(ANDROID_LOG_ERROR, "NetworkVideo",
@@ -494,10 +456,9 @@ Java_NcnnTencent_common_JniBridge_startNetworkVideoStream(
 
         // 确保模型已加载
         {
-            ncnn::MutexLockGuard g(g_lock);
-            if (!g_yolo) {
+            if (!acquireModel()) {
                 __android_log_print(ANDROID_LOG_ERROR, "NetworkVideo",
-                                    "Model not loaded, g_yolo is null");
+                                    "Model not loaded");
                 jstring msg = envThread->NewStringUTF(
                         "模型未加载，请先在Java侧调用 loadModel");
                 if (msg) {
@@ -518,10 +479,15 @@ Java_NcnnTencent_common_JniBridge_startNetworkVideoStream(
             }
         }
 
+        DecoderThreadConfig threads;
+        threads.thread_count = decodeThreads;
+        threads.thread_type  = decodeThreadType;
+
         FFmpegVideoDecoder decoder;
+        NetworkDecoderRegistration registration(decoder);
         __android_log_print(ANDROID_LOG_INFO, "NetworkVideo",
                             "Attempting to connect: %s", url.c_str());
-        if (!decoder.init(url.c_str())) {
+        if (!decoder.init(url.c_str(), threads)) {
             std::string ffmpegError = decoder.getLastError();
             __android_log_print(ANDROID_LOG_ERROR, "NetworkVideo",
                                 "Failed to init decoder: %s, err=%s",
@@ -532,7 +498,8 @@ Java_NcnnTencent_common_JniBridge_startNetworkVideoStream(
                     "\n\n请检查：\n1. 地址是否正确\n2. 网络是否通畅\n"
                     "3. 服务器是否支持该协议\n4. AndroidManifest.xml是否添加网络权限";
 
-            jstring msg = envThread->NewStringUTF(errorMsg.c_str());
+            // 主动 stop 打断的连接不算错误，不弹提示
+            jstring msg = g_network_stop.load() ? nullptr : envThread->NewStringUTF(errorMsg.c_str());
             if (msg) {
                 envThread->CallVoidMethod(managerGlobal, onError, msg);
                 if (envThread->ExceptionCheck()) {
@@ -557,136 +524,25 @@ Java_NcnnTencent_common_JniBridge_startNetworkVideoStream(
             envThread->ExceptionClear();
         }
 
-        cv::Mat rgb_frame;
-        int frameCount          = 0;
-        int consecutiveFailures = 0;
-        const int MAX_CONSECUTIVE_FAILURES = 10;
-
-        while (!g_network_stop.load()) {
-            bool decodeSuccess = decoder.decode_frame(rgb_frame);
-            if (!decodeSuccess) {
-                consecutiveFailures++;
-                __android_log_print(ANDROID_LOG_WARN, "NetworkVideo",
-                                    "decode failed, consecutive=%d",
-                                    consecutiveFailures);
-
-                if (consecutiveFailures >= MAX_CONSECUTIVE_FAILURES) {
-                    jstring msg = envThread->NewStringUTF(
-                            "无法解码视频流，可能流已断开或格式不支持");
-                    if (msg) {
-                        envThread->CallVoidMethod(managerGlobal, onError, msg);
-                        if (envThread->ExceptionCheck()) {
-                            envThread->ExceptionClear();
-                        }
-                        envThread->DeleteLocalRef(msg);
-                    }
-                    break;
-                }
-
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                continue;
-            }
-
-            consecutiveFailures = 0;
-            frameCount++;
-
-            if (frameCount % 2 == 0) {
-                continue;
-            }
-
-            jboolean detecting = JNI_FALSE;
-            detecting = envThread->CallBooleanMethod(managerGlobal, isDetecting);
-            if (envThread->ExceptionCheck()) {
-                envThread->ExceptionClear();
-                detecting = JNI_FALSE;
-            }
+        int frameCount = 0;
+        std::string streamError;
+        if (g_pipeline_enabled.load()) {
+            frameCount = runPipelinedNetworkStream(envThread, managerGlobal, onFrame,
+                                                   isDetecting, decoder, streamError);
+        } else {
+            frameCount = runSerialNetworkStream(envThread, managerGlobal, onFrame,
+                                                isDetecting, decoder, streamError);
+        }
 
-            std::vector<Object> objects;
-            jobjectArray rectFArray = nullptr;
-
-            if (detecting) {
-                double t1 = ncnn::get_current_time();
-                double t0 = t1;
-                objects = detectAndUpdateSummary(rgb_frame, t0, t1);
-
-                jclass rectFCls = envThread->FindClass("android/graphics/RectF");
-                if (rectFCls) {
-                    jmethodID rectCtor = envThread->GetMethodID(
-                            rectFCls, "<init>", "(FFFF)V");
-                    if (rectCtor && !envThread->ExceptionCheck()) {
-                        rectFArray = envThread->NewObjectArray(
-                                (jsize)objects.size(), rectFCls, nullptr);
-                        if (rectFArray && !envThread->ExceptionCheck()) {
-                            for (jsize i = 0; i < (jsize)objects.size(); ++i) {
-                                const Object& obj = objects[i];
-                                float left   = obj.rect.x;
-                                float top    = obj.rect.y;
-                                float right  = obj.rect.x + obj.rect.width;
-                                float bottom = obj.rect.y + obj.rect.height;
-                                jobject rect = envThread->NewObject(
-                                        rectFCls, rectCtor,
-                                        left, top, right, bottom);
-                                if (rect && !envThread->ExceptionCheck()) {
-                                    envThread->SetObjectArrayElement(
-                                            rectFArray, i, rect);
-                                    envThread->DeleteLocalRef(rect);
-                                } else if (envThread->ExceptionCheck()) {
-                                    envThread->ExceptionClear();
-                                }
-                            }
-                        } else if (envThread->ExceptionCheck()) {
-                            envThread->ExceptionClear();
-                        }
-                    } else if (envThread->ExceptionCheck()) {
-                        envThread->ExceptionClear();
-                    }
-                    envThread->DeleteLocalRef(rectFCls);
-                }
+        if (!streamError.empty()) {
+            jstring msg = envThread->NewStringUTF(streamError.c_str());
+            if (msg) {
+                envThread->CallVoidMethod(managerGlobal, onError, msg);
                 if (envThread->ExceptionCheck()) {
                     envThread->ExceptionClear();
-                    jclass rectFCls = envThread->FindClass("android/graphics/RectF");
-                    if (rectFCls) {
-                        rectFArray = envThread->NewObjectArray(0, rectFCls, nullptr);
-                        envThread->DeleteLocalRef(rectFCls);
-                    }
-                }
-            } else {
-                jclass rectFCls = envThread->FindClass("android/graphics/RectF");
-                if (rectFCls) {
-                    rectFArray = envThread->NewObjectArray(0, rectFCls, nullptr);
-                    if (envThread->ExceptionCheck()) {
-                        envThread->ExceptionClear();
-                        rectFArray = nullptr;
-                    }
-                    envThread->DeleteLocalRef(rectFCls);
                 }
+                envThread->DeleteLocalRef(msg);
             }
-
-            jobject bitmap = matToBitmap(envThread, rgb_frame);
-            if (envThread->ExceptionCheck()) {
-                envThread->ExceptionClear();
-                bitmap = nullptr;
-            }
-            if (!bitmap) {
-                if (rectFArray) {
-                    envThread->DeleteLocalRef(rectFArray);
-                }
-                continue;
-            }
-
-            envThread->CallVoidMethod(managerGlobal, onFrame, bitmap, rectFArray);
-            if (envThread->ExceptionCheck()) {
-                envThread->ExceptionClear();
-            }
-
-            if (bitmap) {
-                envThread->DeleteLocalRef(bitmap);
-            }
-            if (rectFArray) {
-                envThread->DeleteLocalRef(rectFArray);
-            }
-
-            frameCount++;
         }
 
         decoder.cleanup();
@@ -699,9 +555,10 @@ Java_NcnnTencent_common_JniBridge_startNetworkVideoStream(
             envThread->ExceptionClear();
         }
 
+        releaseBitmapPool(envThread, BITMAP_CHANNEL_NETWORK);
+        envThread->DeleteGlobalRef(managerGlobal);
         g_network_running.store(false);
         jvm->DetachCurrentThread();
-        envThread->DeleteGlobalRef(managerGlobal);
     });
 }
 
@@ -715,11 +572,219 @@ Java_NcnnTencent_common_JniBridge_stopNetworkVideoStream(
     }
 
     g_network_stop.store(true);
+    {
+        // 打断可能阻塞在网络 I/O 上的解码器，避免 join 等到 socket 超时
+        std::lock_guard<std::mutex> lock(g_network_decoder_mutex);
+        if (g_network_decoder) {
+            g_network_decoder->stop();
+        }
+    }
     if (g_network_thread.joinable()) {
         g_network_thread.join();
     }
 }
 
+// Java 归还不再显示的帧 Bitmap（单路网络流 / 多路流回调中的复用池 Bitmap）
+extern "C"
+JNIEXPORT void JNICALL
+Java_NcnnTencent_common_JniBridge_releaseFrameBitmap(
+        JNIEnv* env, jobject thiz, jobject bitmap)
+{
+    releasePooledBitmap(env, bitmap);
+}
+
+// 配置网络流流水线模式（下次 startNetworkVideoStream 时生效）
+extern "C"
+JNIEXPORT void JNICALL
+Java_NcnnTencent_common_JniBridge_setNetworkPipeline(
+        JNIEnv* env, jobject thiz, jboolean enabled, jint queueCapacity,
+        jboolean dropOldest)
+{
+    g_pipeline_enabled.store(enabled == JNI_TRUE);
+    g_pipeline_capacity.store(std::max(1, (int)queueCapacity));
+    g_pipeline_drop_oldest.store(dropOldest == JNI_TRUE);
+}
+
+// 流水线统计：[解码队列深度, 渲染队列深度, 解码队列丢帧, 渲染队列丢帧, 已解码, 已推理, 已渲染]
+extern "C"
+JNIEXPORT jintArray JNICALL
+Java_NcnnTencent_common_JniBridge_getNetworkPipelineStats(
+        JNIEnv* env, jobject thiz)
+{
+    jint stats[7] = {
+            g_pipeline_stats.decodeQueueDepth.load(),
+            g_pipeline_stats.renderQueueDepth.load(),
+            g_pipeline_stats.decodeDropped.load(),
+            g_pipeline_stats.renderDropped.load(),
+            g_pipeline_stats.decodedFrames.load(),
+            g_pipeline_stats.inferredFrames.load(),
+            g_pipeline_stats.renderedFrames.load()
+    };
+
+    jintArray result = env->NewIntArray(7);
+    if (result) {
+        env->SetIntArrayRegion(result, 0, 7, stats);
+    }
+    return result;
+}
+
+// =========================
+// 多路流（共享模型的推理服务）
+// =========================
+
+// 添加一路流，返回流 id，失败返回 -1；callback 与 startNetworkVideoStream 的回调对象相同
+extern "C"
+JNIEXPORT jint JNICALL
+Java_NcnnTencent_common_JniBridge_addStream(
+        JNIEnv* env, jobject thiz, jstring jurl, jobject callback,
+        jint decodeThreads, jint decodeThreadType)
+{
+    const char* url_c = env->GetStringUTFChars(jurl, nullptr);
+    if (!url_c) {
+        return -1;
+    }
+    std::string url(url_c);
+    env->ReleaseStringUTFChars(jurl, url_c);
+
+    DecoderThreadConfig threads;
+    threads.thread_count = decodeThreads;
+    threads.thread_type  = decodeThreadType;
+    return StreamManager::instance().addStream(env, url, callback, threads);
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_NcnnTencent_common_JniBridge_removeStream(
+        JNIEnv* env, jobject thiz, jint streamId)
+{
+    return StreamManager::instance().removeStream(env, streamId) ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_NcnnTencent_common_JniBridge_removeAllStreams(
+        JNIEnv* env, jobject thiz)
+{
+    StreamManager::instance().removeAll(env);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_NcnnTencent_common_JniBridge_setStreamWorkers(
+        JNIEnv* env, jobject thiz, jint count)
+{
+    StreamManager::instance().setWorkerCount(count);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_NcnnTencent_common_JniBridge_setStreamBatch(
+        JNIEnv* env, jobject thiz, jint maxBatch)
+{
+    StreamManager::instance().setMaxBatch(maxBatch);
+}
+
+extern "C"
+JNIEXPORT jintArray JNICALL
+Java_NcnnTencent_common_JniBridge_getStreamIds(
+        JNIEnv* env, jobject thiz)
+{
+    std::vector<int> ids = StreamManager::instance().streamIds();
+    jintArray result = env->NewIntArray((jsize)ids.size());
+    if (result && !ids.empty()) {
+        env->SetIntArrayRegion(result, 0, (jsize)ids.size(), ids.data());
+    }
+    return result;
+}
+
+// 单路统计：[已解码, 已推理, 已回调, 覆盖丢帧, 是否运行中]，流不存在返回 null
+extern "C"
+JNIEXPORT jintArray JNICALL
+Java_NcnnTencent_common_JniBridge_getStreamStats(
+        JNIEnv* env, jobject thiz, jint streamId)
+{
+    StreamStats stats;
+    if (!StreamManager::instance().getStats(streamId, stats)) {
+        return nullptr;
+    }
+
+    jint values[5] = {
+            stats.decoded,
+            stats.inferred,
+            stats.rendered,
+            stats.dropped,
+            stats.running ? 1 : 0
+    };
+    jintArray result = env->NewIntArray(5);
+    if (result) {
+        env->SetIntArrayRegion(result, 0, 5, values);
+    }
+    return result;
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_NcnnTencent_common_JniBridge_getStreamSummary(
+        JNIEnv* env, jobject thiz, jint streamId)
+{
+    DetectSummary summary;
+    if (!StreamManager::instance().getSummary(streamId, summary)) {
+        return nullptr;
+    }
+    return createDetectSummaryJObject(env, "NcnnTencent/common/Models$DetectSummary", summary);
+}
+
+// 纯解码吞吐测试（不做格式转换和推理），用于在设备上比较不同线程配置
+// 返回 [解码帧数, 耗时(ms), 帧率]，打开失败返回 null
+extern "C"
+JNIEXPORT jfloatArray JNICALL
+Java_NcnnTencent_common_JniBridge_benchmarkDecode(
+        JNIEnv* env, jobject thiz, jstring videoPath, jint decodeThreads,
+        jint decodeThreadType, jint maxFrames)
+{
+    const char* path = env->GetStringUTFChars(videoPath, nullptr);
+    if (!path) {
+        return nullptr;
+    }
+
+    DecoderThreadConfig threads;
+    threads.thread_count = decodeThreads;
+    threads.thread_type  = decodeThreadType;
+
+    FFmpegVideoDecoder decoder;
+    bool ok = decoder.init(path, threads);
+    env->ReleaseStringUTFChars(videoPath, path);
+    if (!ok) {
+        __android_log_print(ANDROID_LOG_ERROR, "FFmpegVideoDetect",
+                            "benchmark init failed: %s", decoder.getLastError().c_str());
+        return nullptr;
+    }
+
+    const int limit = maxFrames > 0 ? maxFrames : INT_MAX;
+    int frames = 0;
+    double t0 = ncnn::get_current_time();
+    while (frames < limit && decoder.receive_frame()) {
+        frames++;
+    }
+    double elapsed = ncnn::get_current_time() - t0;
+    decoder.cleanup();
+
+    jfloat result[3] = {
+            (jfloat)frames,
+            (jfloat)elapsed,
+            elapsed > 0 ? (jfloat)(frames * 1000.0 / elapsed) : 0.f
+    };
+    __android_log_print(ANDROID_LOG_INFO, "FFmpegVideoDetect",
+                        "benchmark: threads=%d type=%d frames=%d %.1fms %.1ffps",
+                        (int)decodeThreads, (int)decodeThreadType, frames, elapsed, result[2]);
+
+    jfloatArray arr = env->NewFloatArray(3);
+    if (arr) {
+        env->SetFloatArrayRegion(arr, 0, 3, result);
+    }
+    return arr;
+}
+
 extern "C"
 JNIEXPORT jboolean JNICALL
 Java_NcnnTencent_CloudDetect_MainCloudActivity_testNetworkConnection(
@@ -0,0 +1,190 @@
+#ifndef FRAME_QUEUE_H
+#define FRAME_QUEUE_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// =============================
+// 有界环形帧队列（流水线各阶段之间传递帧）
+// =============================
+//
+// - drop_oldest = true ：队列满时丢弃最旧的一帧，保证下游总是拿到最新帧（实时流推荐）
+// - drop_oldest = false：队列满时 push 阻塞，形成背压（本地文件推荐，不丢帧）
+// - close() 之后 push 直接返回 false，pop 在取完剩余帧后返回 false
+template <typename T>
+class FrameRingBuffer
+{
+public:
+    explicit FrameRingBuffer(size_t capacity = 3, bool drop_oldest = true)
+        : slots_(std::max<size_t>(capacity, 1)),
+          head_(0), count_(0), dropped_(0),
+          closed_(false), drop_oldest_(drop_oldest)
+    {}
+
+    FrameRingBuffer(const FrameRingBuffer&) = delete;
+    FrameRingBuffer& operator=(const FrameRingBuffer&) = delete;
+
+    bool push(T&& item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!drop_oldest_)
+        {
+            not_full_.wait(lock, [this] { return closed_ || count_ < slots_.size(); });
+        }
+        if (closed_)
+            return false;
+
+        if (count_ == slots_.size())
+        {
+            // 丢弃最旧帧，释放其持有的图像内存
+            slots_[head_] = T();
+            head_ = (head_ + 1) % slots_.size();
+            count_--;
+            dropped_++;
+        }
+
+        slots_[(head_ + count_) % slots_.size()] = std::move(item);
+        count_++;
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // 阻塞直到取到一帧；队列已关闭且为空时返回 false
+    bool pop(T& out)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || count_ > 0; });
+        if (count_ == 0)
+            return false;
+
+        out = std::move(slots_[head_]);
+        slots_[head_] = T();
+        head_ = (head_ + 1) % slots_.size();
+        count_--;
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count_;
+    }
+
+    size_t dropped() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return dropped_;
+    }
+
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    std::vector<T> slots_;
+    size_t head_;
+    size_t count_;
+    size_t dropped_;
+    bool closed_;
+    const bool drop_oldest_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+};
+
+// =============================
+// 单槽"最新帧"邮箱（生产者永不阻塞，消费者总是拿到最新一帧）
+// =============================
+//
+// 与 FrameRingBuffer(1, true) 语义相同，但 put / take 都通过 swap 交换内容：
+// 被覆盖的旧帧和消费者归还的空帧留在调用方 / 槽位里，下次直接复用其内存，
+// 生产者、槽位、消费者三份缓冲轮转，稳定后不再分配。
+template <typename T>
+class LatestFrameMailbox
+{
+public:
+    LatestFrameMailbox() : full_(false), closed_(false), dropped_(0) {}
+
+    LatestFrameMailbox(const LatestFrameMailbox&) = delete;
+    LatestFrameMailbox& operator=(const LatestFrameMailbox&) = delete;
+
+    // 放入 item（与槽位交换）；返回后 item 持有被覆盖的旧帧或可复用的空帧
+    bool put(T& item)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_)
+                return false;
+
+            if (full_)
+                dropped_++;
+
+            std::swap(slot_, item);
+            full_ = true;
+        }
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // 阻塞直到有新帧；out 原有内容交还槽位供下次 put 复用。已关闭时返回 false
+    bool take(T& out)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || full_; });
+        if (closed_)
+            return false;
+
+        std::swap(slot_, out);
+        full_ = false;
+        return true;
+    }
+
+    // 关闭后 put 返回 false，阻塞中的 take 立即返回 false
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+    }
+
+    // 重新打开（丢弃槽位中未取走的帧）
+    void reopen()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = false;
+        full_ = false;
+    }
+
+    size_t dropped() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return dropped_;
+    }
+
+private:
+    T slot_;
+    bool full_;
+    bool closed_;
+    size_t dropped_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+};
+
+#endif // FRAME_QUEUE_H
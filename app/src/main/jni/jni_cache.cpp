@@ -0,0 +1,248 @@
+#include "jni_cache.h"
+
+#include <android/log.h>
+
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+static JniCache g_jni_cache;
+static bool g_jni_cache_ready = false;
+
+static jclass findGlobalClass(JNIEnv* env, const char* name)
+{
+    jclass local = env->FindClass(name);
+    if (!local)
+    {
+        env->ExceptionClear();
+        __android_log_print(ANDROID_LOG_ERROR, "JniCache", "FindClass failed: %s", name);
+        return nullptr;
+    }
+    jclass global = (jclass)env->NewGlobalRef(local);
+    env->DeleteLocalRef(local);
+    return global;
+}
+
+bool jni_cache_init(JNIEnv* env)
+{
+    JniCache& c = g_jni_cache;
+
+    c.bitmapCls = findGlobalClass(env, "android/graphics/Bitmap");
+    c.rectFCls  = findGlobalClass(env, "android/graphics/RectF");
+    c.stringCls = findGlobalClass(env, "java/lang/String");
+    c.summaryCls = findGlobalClass(env, JNI_DETECT_SUMMARY_CLASS);
+    if (!c.bitmapCls || !c.rectFCls || !c.stringCls || !c.summaryCls)
+    {
+        jni_cache_release(env);
+        return false;
+    }
+
+    c.bitmapCreate = env->GetStaticMethodID(c.bitmapCls, "createBitmap",
+            "(IILandroid/graphics/Bitmap$Config;)Landroid/graphics/Bitmap;");
+    c.bitmapIsRecycled = env->GetMethodID(c.bitmapCls, "isRecycled", "()Z");
+    c.rectFCtor = env->GetMethodID(c.rectFCls, "<init>", "(FFFF)V");
+    c.summaryCtor = env->GetMethodID(c.summaryCls, "<init>", JNI_DETECT_SUMMARY_CTOR_SIG);
+
+    // Bitmap.Config.ARGB_8888
+    jclass configCls = env->FindClass("android/graphics/Bitmap$Config");
+    if (configCls)
+    {
+        jfieldID field = env->GetStaticFieldID(configCls, "ARGB_8888", "Landroid/graphics/Bitmap$Config;");
+        if (field)
+        {
+            jobject config = env->GetStaticObjectField(configCls, field);
+            c.argb8888 = config ? env->NewGlobalRef(config) : nullptr;
+            env->DeleteLocalRef(config);
+        }
+        env->DeleteLocalRef(configCls);
+    }
+
+    if (env->ExceptionCheck())
+    {
+        env->ExceptionClear();
+    }
+    if (!c.bitmapCreate || !c.bitmapIsRecycled || !c.rectFCtor || !c.summaryCtor || !c.argb8888)
+    {
+        __android_log_print(ANDROID_LOG_ERROR, "JniCache", "method lookup failed");
+        jni_cache_release(env);
+        return false;
+    }
+
+    g_jni_cache_ready = true;
+    return true;
+}
+
+const JniCache* jni_cache()
+{
+    return g_jni_cache_ready ? &g_jni_cache : nullptr;
+}
+
+// =============================
+// 输出 Bitmap 池
+// =============================
+
+struct BitmapPoolKey
+{
+    int channel;
+    int width;
+    int height;
+
+    bool operator<(const BitmapPoolKey& o) const
+    {
+        return std::tie(channel, width, height) < std::tie(o.channel, o.width, o.height);
+    }
+};
+
+struct BitmapPoolSlot
+{
+    std::vector<jobject> bitmaps;   // 全局引用
+    std::vector<bool> in_use;       // 已交给 Java 且尚未归还
+};
+
+static std::mutex g_bitmap_pool_mutex;
+static std::map<BitmapPoolKey, BitmapPoolSlot> g_bitmap_pool;
+
+static void deleteSlot(JNIEnv* env, BitmapPoolSlot& slot)
+{
+    for (jobject bitmap : slot.bitmaps)
+    {
+        env->DeleteGlobalRef(bitmap);
+    }
+    slot.bitmaps.clear();
+    slot.in_use.clear();
+}
+
+static jobject createBitmapGlobal(JNIEnv* env, const JniCache& c, int width, int height)
+{
+    jobject local = env->CallStaticObjectMethod(c.bitmapCls, c.bitmapCreate, width, height, c.argb8888);
+    if (!local || env->ExceptionCheck())
+    {
+        env->ExceptionClear();
+        return nullptr;
+    }
+    jobject global = env->NewGlobalRef(local);
+    env->DeleteLocalRef(local);
+    return global;
+}
+
+jobject acquirePooledBitmap(JNIEnv* env, int channel, int width, int height)
+{
+    const JniCache* c = jni_cache();
+    if (!c || width <= 0 || height <= 0)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(g_bitmap_pool_mutex);
+
+    const BitmapPoolKey key{channel, width, height};
+    auto it = g_bitmap_pool.find(key);
+    if (it == g_bitmap_pool.end())
+    {
+        // 同一通道分辨率变化时丢弃旧尺寸的缓存
+        for (auto old = g_bitmap_pool.begin(); old != g_bitmap_pool.end();)
+        {
+            if (old->first.channel == channel)
+            {
+                deleteSlot(env, old->second);
+                old = g_bitmap_pool.erase(old);
+            }
+            else
+            {
+                ++old;
+            }
+        }
+        it = g_bitmap_pool.emplace(key, BitmapPoolSlot()).first;
+    }
+
+    BitmapPoolSlot& slot = it->second;
+
+    // 优先复用 Java 已归还的
+    for (size_t i = 0; i < slot.bitmaps.size(); i++)
+    {
+        if (slot.in_use[i])
+            continue;
+
+        jobject& entry = slot.bitmaps[i];
+        if (env->CallBooleanMethod(entry, c->bitmapIsRecycled) || env->ExceptionCheck())
+        {
+            env->ExceptionClear();
+            jobject fresh = createBitmapGlobal(env, *c, width, height);
+            if (!fresh)
+                return nullptr;
+            env->DeleteGlobalRef(entry);
+            entry = fresh;
+        }
+        slot.in_use[i] = true;
+        return env->NewLocalRef(entry);
+    }
+
+    // 全部占用：未满时扩充，已满时由调用方新分配
+    if (slot.bitmaps.size() >= BITMAP_POOL_DEPTH)
+        return nullptr;
+
+    jobject bitmap = createBitmapGlobal(env, *c, width, height);
+    if (!bitmap)
+        return nullptr;
+    slot.bitmaps.push_back(bitmap);
+    slot.in_use.push_back(true);
+    return env->NewLocalRef(bitmap);
+}
+
+void releasePooledBitmap(JNIEnv* env, jobject bitmap)
+{
+    if (!bitmap)
+        return;
+
+    std::lock_guard<std::mutex> lock(g_bitmap_pool_mutex);
+    for (auto& kv : g_bitmap_pool)
+    {
+        BitmapPoolSlot& slot = kv.second;
+        for (size_t i = 0; i < slot.bitmaps.size(); i++)
+        {
+            if (env->IsSameObject(slot.bitmaps[i], bitmap))
+            {
+                slot.in_use[i] = false;
+                return;
+            }
+        }
+    }
+}
+
+void releaseBitmapPool(JNIEnv* env, int channel)
+{
+    std::lock_guard<std::mutex> lock(g_bitmap_pool_mutex);
+    for (auto it = g_bitmap_pool.begin(); it != g_bitmap_pool.end();)
+    {
+        if (it->first.channel == channel)
+        {
+            deleteSlot(env, it->second);
+            it = g_bitmap_pool.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void jni_cache_release(JNIEnv* env)
+{
+    {
+        std::lock_guard<std::mutex> lock(g_bitmap_pool_mutex);
+        for (auto& kv : g_bitmap_pool)
+        {
+            deleteSlot(env, kv.second);
+        }
+        g_bitmap_pool.clear();
+    }
+
+    g_jni_cache_ready = false;
+
+    JniCache& c = g_jni_cache;
+    if (c.bitmapCls)  env->DeleteGlobalRef(c.bitmapCls);
+    if (c.rectFCls)   env->DeleteGlobalRef(c.rectFCls);
+    if (c.stringCls)  env->DeleteGlobalRef(c.stringCls);
+    if (c.summaryCls) env->DeleteGlobalRef(c.summaryCls);
+    if (c.argb8888)   env->DeleteGlobalRef(c.argb8888);
+    c = JniCache();
+}
@@ -0,0 +1,66 @@
+#ifndef JNI_CACHE_H
+#define JNI_CACHE_H
+
+#include <jni.h>
+
+// =============================
+// JNI 句柄缓存
+// =============================
+//
+// - JNI_OnLoad 中一次性查找常用类 / 方法并持有全局引用，帧回调路径不再 FindClass / GetMethodID
+// - 原生线程（AttachCurrentThread）上的 FindClass 只能找到系统类，应用类必须在这里预先缓存
+
+#define JNI_DETECT_SUMMARY_CLASS "NcnnTencent/common/Models$DetectSummary"
+// (allTimeMs, inferTimeMs, fps, logText, captureWidth, captureHeight, captureFpsMin, captureFpsMax)
+#define JNI_DETECT_SUMMARY_CTOR_SIG "(FFFLjava/lang/String;IIII)V"
+
+struct JniCache
+{
+    jclass    bitmapCls;
+    jmethodID bitmapCreate;       // static Bitmap createBitmap(int, int, Bitmap.Config)
+    jmethodID bitmapIsRecycled;   // boolean isRecycled()
+    jobject   argb8888;           // Bitmap.Config.ARGB_8888
+
+    jclass    rectFCls;
+    jmethodID rectFCtor;          // RectF(float, float, float, float)
+
+    jclass    stringCls;
+
+    jclass    summaryCls;         // Models$DetectSummary
+    jmethodID summaryCtor;        // JNI_DETECT_SUMMARY_CTOR_SIG
+};
+
+// 在 JNI_OnLoad 中调用；失败时返回 false，调用方仍可回退到逐次查找
+bool jni_cache_init(JNIEnv* env);
+
+// 在 JNI_OnUnload 中调用，释放全局引用（同时清空 Bitmap 池）
+void jni_cache_release(JNIEnv* env);
+
+// 未初始化成功时返回 nullptr
+const JniCache* jni_cache();
+
+// =============================
+// 输出 Bitmap 池
+// =============================
+//
+// - 按 (通道, 宽, 高) 分组，每组最多 BITMAP_POOL_DEPTH 个 ARGB_8888 Bitmap
+// - 通道区分不同的画面来源（单路网络流 / 多路流各自的流 id），避免一路的画面写进另一路仍在显示的 Bitmap
+// - 交给 Java 的 Bitmap 标记为占用，直到 Java 不再显示它时经 JniBridge.releaseFrameBitmap 归还，
+//   只有归还过的才会被写入新帧；组内全部占用时返回 nullptr，调用方改为新分配一个不入池的 Bitmap
+// - 被 Java recycle() 的 Bitmap 在下次取用时自动替换为新分配的
+
+#define BITMAP_POOL_DEPTH 3
+
+// 单路网络流使用的通道；多路流直接使用流 id（> 0）
+#define BITMAP_CHANNEL_NETWORK 0
+
+// 取出（或新建）一个空闲 Bitmap 并标记为占用，返回局部引用；无空闲或失败返回 nullptr
+jobject acquirePooledBitmap(JNIEnv* env, int channel, int width, int height);
+
+// Java 归还不再使用的 Bitmap；不属于池的（已被清空或新分配的）忽略
+void releasePooledBitmap(JNIEnv* env, jobject bitmap);
+
+// 释放某个通道的全部 Bitmap（流停止时调用）
+void releaseBitmapPool(JNIEnv* env, int channel);
+
+#endif // JNI_CACHE_H
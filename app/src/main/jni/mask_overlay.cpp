@@ -0,0 +1,170 @@
+#include "mask_overlay.h"
+
+#include <algorithm>
+
+#if __ARM_NEON
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// 标签用 uint16 存放，超出的层不绘制
+#define MASK_MAX_LAYERS 65535
+
+void blend_span_rgb(uint8_t* p, int n, const uint8_t color[3], int alpha)
+{
+    // p * (256 - alpha) + color * alpha + 128 <= 255 * 256 + 128，16 位无符号不会溢出
+    const uint16_t inv = (uint16_t)(256 - alpha);
+    const uint16_t c0 = (uint16_t)(color[0] * alpha + 128);
+    const uint16_t c1 = (uint16_t)(color[1] * alpha + 128);
+    const uint16_t c2 = (uint16_t)(color[2] * alpha + 128);
+
+    int i = 0;
+#if __ARM_NEON
+    const uint16x8_t _c0 = vdupq_n_u16(c0);
+    const uint16x8_t _c1 = vdupq_n_u16(c1);
+    const uint16x8_t _c2 = vdupq_n_u16(c2);
+    for (; i + 7 < n; i += 8)
+    {
+        uint8x8x3_t _p = vld3_u8(p + i * 3);
+        _p.val[0] = vshrn_n_u16(vmlaq_n_u16(_c0, vmovl_u8(_p.val[0]), inv), 8);
+        _p.val[1] = vshrn_n_u16(vmlaq_n_u16(_c1, vmovl_u8(_p.val[1]), inv), 8);
+        _p.val[2] = vshrn_n_u16(vmlaq_n_u16(_c2, vmovl_u8(_p.val[2]), inv), 8);
+        vst3_u8(p + i * 3, _p);
+    }
+#elif defined(__SSE2__)
+    // 16 个像素 = 48 字节 = 3 个寄存器，通道按 3 字节循环，每 8 字节（展开为 16 位）一组颜色项
+    uint16_t cterm[48];
+    for (int k = 0; k < 48; k++)
+    {
+        cterm[k] = k % 3 == 0 ? c0 : k % 3 == 1 ? c1 : c2;
+    }
+    __m128i _cterm[6];
+    for (int k = 0; k < 6; k++)
+    {
+        _cterm[k] = _mm_loadu_si128((const __m128i*)(cterm + k * 8));
+    }
+    const __m128i _inv = _mm_set1_epi16((short)inv);
+    const __m128i _zero = _mm_setzero_si128();
+    for (; i + 15 < n; i += 16)
+    {
+        uint8_t* ptr = p + i * 3;
+        for (int b = 0; b < 3; b++)
+        {
+            __m128i _p = _mm_loadu_si128((const __m128i*)(ptr + b * 16));
+            __m128i _lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(_p, _zero), _inv), _cterm[b * 2]);
+            __m128i _hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(_p, _zero), _inv), _cterm[b * 2 + 1]);
+            _lo = _mm_srli_epi16(_lo, 8);
+            _hi = _mm_srli_epi16(_hi, 8);
+            _mm_storeu_si128((__m128i*)(ptr + b * 16), _mm_packus_epi16(_lo, _hi));
+        }
+    }
+#endif
+    for (; i < n; i++)
+    {
+        uint8_t* px = p + i * 3;
+        px[0] = (uint8_t)((px[0] * inv + c0) >> 8);
+        px[1] = (uint8_t)((px[1] * inv + c1) >> 8);
+        px[2] = (uint8_t)((px[2] * inv + c2) >> 8);
+    }
+}
+
+// 从 x 起标签连续等于 label 的段的结束位置（不超过 end），每次比较 8 个标签
+static int label_run_end(const uint16_t* row, int x, int end, uint16_t label)
+{
+#if __ARM_NEON
+    const uint16x8_t _label = vdupq_n_u16(label);
+    for (; x + 7 < end; x += 8)
+    {
+        uint64x2_t _eq = vreinterpretq_u64_u16(vceqq_u16(vld1q_u16(row + x), _label));
+        if ((vgetq_lane_u64(_eq, 0) & vgetq_lane_u64(_eq, 1)) != ~(uint64_t)0)
+            break;
+    }
+#elif defined(__SSE2__)
+    const __m128i _label = _mm_set1_epi16((short)label);
+    for (; x + 7 < end; x += 8)
+    {
+        __m128i _eq = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(row + x)), _label);
+        if (_mm_movemask_epi8(_eq) != 0xffff)
+            break;
+    }
+#endif
+    while (x < end && row[x] == label)
+        x++;
+    return x;
+}
+
+void MaskCompositor::composite(const std::vector<MaskLayer>& layers, uint8_t* frame, int frame_w, int frame_h, size_t frame_stride, int alpha)
+{
+    const int num_layers = std::min((int)layers.size(), MASK_MAX_LAYERS);
+
+    // 各层与帧相交部分的并集
+    int x0 = frame_w;
+    int y0 = frame_h;
+    int x1 = 0;
+    int y1 = 0;
+    for (int k = 0; k < num_layers; k++)
+    {
+        const MaskLayer& layer = layers[k];
+        if (!layer.rle || layer.rle->empty())
+            continue;
+        x0 = std::min(x0, std::max(layer.ox, 0));
+        y0 = std::min(y0, std::max(layer.oy, 0));
+        x1 = std::max(x1, std::min(layer.ox + layer.rle->width, frame_w));
+        y1 = std::max(y1, std::min(layer.oy + layer.rle->height, frame_h));
+    }
+    if (x1 <= x0 || y1 <= y0)
+        return;
+
+    const int rw = x1 - x0;
+    const int rh = y1 - y0;
+    labels_.assign((size_t)rw * rh, 0);
+    row_x0_.assign(rh, rw);
+    row_x1_.assign(rh, 0);
+
+    // 第一遍：前景游程写入标签图，后写入的层覆盖先写入的层
+    for (int k = 0; k < num_layers; k++)
+    {
+        const MaskLayer& layer = layers[k];
+        if (!layer.rle)
+            continue;
+
+        const uint16_t label = (uint16_t)(k + 1);
+        rle_for_each_span(*layer.rle, [&](int y, int x, int len) {
+            const int ry = layer.oy + y - y0;
+            if (ry < 0 || ry >= rh)
+                return;
+            const int rx0 = std::max(layer.ox + x, x0) - x0;
+            const int rx1 = std::min(layer.ox + x + len, x1) - x0;
+            if (rx1 <= rx0)
+                return;
+
+            uint16_t* row = labels_.data() + (size_t)rw * ry;
+            std::fill(row + rx0, row + rx1, label);
+            row_x0_[ry] = std::min(row_x0_[ry], rx0);
+            row_x1_[ry] = std::max(row_x1_[ry], rx1);
+        });
+    }
+
+    // 第二遍：逐行按同一标签的连续段混合
+    for (int ry = 0; ry < rh; ry++)
+    {
+        const uint16_t* row = labels_.data() + (size_t)rw * ry;
+        uint8_t* frame_row = frame + frame_stride * (y0 + ry) + x0 * 3;
+        const int end = row_x1_[ry];
+        int x = row_x0_[ry];
+        while (x < end)
+        {
+            const uint16_t label = row[x];
+            if (label == 0)
+            {
+                x = label_run_end(row, x, end, 0);
+                continue;
+            }
+
+            const int start = x;
+            x = label_run_end(row, x, end, label);
+            blend_span_rgb(frame_row + start * 3, x - start, layers[label - 1].color, alpha);
+        }
+    }
+}
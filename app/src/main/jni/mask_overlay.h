@@ -0,0 +1,44 @@
+#ifndef MASK_OVERLAY_H
+#define MASK_OVERLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "mask_rle.h"
+
+// =============================
+// 分割掩码叠加（所有目标一次合成）
+// =============================
+//
+// 先把各目标的前景游程写入标签图（每像素记录覆盖它的目标序号，后加入的目标优先），
+// 再逐行按标签连续段做整数 alpha 混合（NEON / SSE2，无 SIMD 时退回标量）。
+// 只访问各目标框的并集区域，每个像素最多混合一次，重叠处不会叠加变色。
+// 不依赖 OpenCV，可在 Linux 上直接验证 / 测速。
+
+struct MaskLayer
+{
+    const MaskRLE* rle;
+    int ox;             // 掩码左上角在帧中的位置
+    int oy;
+    uint8_t color[3];   // 按帧内通道顺序
+};
+
+// 三通道 uint8 像素段混合：p = (p * (256 - alpha) + color * alpha + 128) >> 8，alpha 取 0 ~ 256
+void blend_span_rgb(uint8_t* p, int n, const uint8_t color[3], int alpha);
+
+class MaskCompositor
+{
+public:
+    // 把 layers 以 alpha（0 ~ 256，128 为半透明）合成到 frame（frame_w x frame_h，三通道，行跨度 frame_stride 字节）
+    void composite(const std::vector<MaskLayer>& layers, uint8_t* frame, int frame_w, int frame_h, size_t frame_stride, int alpha);
+
+private:
+    // 标签图覆盖各层并集区域，0 为无目标，k 为 layers[k - 1]；缓冲跨帧复用
+    std::vector<uint16_t> labels_;
+    // 每行实际写入标签的列范围 [row_x0_, row_x1_)，混合时只扫描这一段
+    std::vector<int> row_x0_;
+    std::vector<int> row_x1_;
+};
+
+#endif // MASK_OVERLAY_H
@@ -0,0 +1,137 @@
+#include "mask_rle.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+// 逐像素判断前景并累计游程，游程跨行连续
+template<typename T, typename Pred>
+static void encode_rows(const T* data, int width, int height, size_t stride, Pred is_fg, MaskRLE& rle)
+{
+    rle.width = width;
+    rle.height = height;
+    rle.counts.clear();
+    if (width <= 0 || height <= 0)
+        return;
+
+    bool fg = false;
+    uint32_t run = 0;
+    for (int y = 0; y < height; y++)
+    {
+        const T* row = (const T*)((const uint8_t*)data + stride * y);
+        for (int x = 0; x < width; x++)
+        {
+            const bool v = is_fg(row[x]);
+            if (v != fg)
+            {
+                rle.counts.push_back(run);
+                run = 0;
+                fg = v;
+            }
+            run++;
+        }
+    }
+    rle.counts.push_back(run);
+    rle.counts.shrink_to_fit();
+}
+
+void rle_encode(const uint8_t* data, int width, int height, size_t stride, MaskRLE& rle)
+{
+    encode_rows(data, width, height, stride, [](uint8_t v) { return v != 0; }, rle);
+}
+
+void rle_encode_threshold(const float* data, int width, int height, size_t stride, float threshold, MaskRLE& rle)
+{
+    encode_rows(data, width, height, stride, [threshold](float v) { return v > threshold; }, rle);
+}
+
+void rle_decode(const MaskRLE& rle, int roi_x, int roi_y, int roi_w, int roi_h,
+                uint8_t fg, uint8_t* dst, size_t dst_stride)
+{
+    for (int y = 0; y < roi_h; y++)
+    {
+        memset(dst + dst_stride * y, 0, roi_w);
+    }
+
+    rle_for_each_span(rle, [&](int y, int x, int len) {
+        if (y < roi_y || y >= roi_y + roi_h)
+            return;
+        const int x0 = std::max(x, roi_x);
+        const int x1 = std::min(x + len, roi_x + roi_w);
+        if (x1 > x0)
+            memset(dst + dst_stride * (y - roi_y) + (x0 - roi_x), fg, x1 - x0);
+    });
+}
+
+uint32_t rle_area(const MaskRLE& rle)
+{
+    uint32_t area = 0;
+    for (size_t i = 1; i < rle.counts.size(); i += 2)
+    {
+        area += rle.counts[i];
+    }
+    return area;
+}
+
+// 原图坐标下的一段前景：第 y 行 [x0, x1)
+struct MaskSpan
+{
+    int y;
+    int x0;
+    int x1;
+};
+
+static void collect_spans(const MaskRLE& rle, int ox, int oy, std::vector<MaskSpan>& spans)
+{
+    spans.clear();
+    rle_for_each_span(rle, [&](int y, int x, int len) {
+        spans.push_back({oy + y, ox + x, ox + x + len});
+    });
+}
+
+float rle_iou(const MaskRLE& a, int ax, int ay, const MaskRLE& b, int bx, int by)
+{
+    const uint32_t area_a = rle_area(a);
+    const uint32_t area_b = rle_area(b);
+    if (area_a + area_b == 0)
+        return 0.f;
+
+    // 框不相交时不必展开游程
+    const bool overlap = ax < bx + b.width && bx < ax + a.width && ay < by + b.height && by < ay + a.height;
+    if (!overlap)
+        return 0.f;
+
+    std::vector<MaskSpan> sa;
+    std::vector<MaskSpan> sb;
+    collect_spans(a, ax, ay, sa);
+    collect_spans(b, bx, by, sb);
+
+    // 两组段都按 (y, x) 递增且同行内不重叠，双指针求交
+    uint64_t inter = 0;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < sa.size() && j < sb.size())
+    {
+        const MaskSpan& p = sa[i];
+        const MaskSpan& q = sb[j];
+        if (p.y != q.y)
+        {
+            if (p.y < q.y)
+                i++;
+            else
+                j++;
+            continue;
+        }
+
+        const int x0 = std::max(p.x0, q.x0);
+        const int x1 = std::min(p.x1, q.x1);
+        if (x1 > x0)
+            inter += x1 - x0;
+        if (p.x1 < q.x1)
+            i++;
+        else
+            j++;
+    }
+
+    return (float)((double)inter / ((double)area_a + area_b - inter));
+}
@@ -0,0 +1,76 @@
+#ifndef MASK_RLE_H
+#define MASK_RLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// =============================
+// 实例掩码游程编码（RLE）
+// =============================
+//
+// 掩码只覆盖目标框（width x height），按行主序展开后交替记录背景 / 前景游程长度，
+// 第一个游程为背景（可以为 0），与 COCO RLE 相同但按行而非按列展开，便于逐行绘制与打包。
+// 一个框内掩码通常每行只有 2~4 个游程，比框内 uint8 掩码小 1~2 个数量级；
+// 面积 / IoU 直接在游程上计算，不需要还原成位图；绘制见 mask_overlay.h。
+// 不依赖 OpenCV（坐标与帧缓冲用整数 / 指针传递），可在 Linux 上直接验证。
+
+struct MaskRLE
+{
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> counts;   // 背景、前景交替的游程长度，总和为 width * height
+
+    bool empty() const { return width <= 0 || height <= 0; }
+};
+
+// 遍历前景游程，跨行的游程按行拆开：fn(y, x, len)，坐标相对掩码左上角，按 (y, x) 递增
+template<typename Fn>
+void rle_for_each_span(const MaskRLE& rle, Fn fn)
+{
+    if (rle.empty())
+        return;
+
+    const uint32_t w = rle.width;
+    uint32_t pos = 0;
+    for (size_t i = 0; i < rle.counts.size(); i++)
+    {
+        uint32_t len = rle.counts[i];
+        if (i & 1)
+        {
+            uint32_t y = pos / w;
+            uint32_t x = pos % w;
+            while (len > 0)
+            {
+                const uint32_t n = len < w - x ? len : w - x;
+                fn((int)y, (int)x, (int)n);
+                len -= n;
+                pos += n;
+                x = 0;
+                y++;
+            }
+        }
+        else
+        {
+            pos += len;
+        }
+    }
+}
+
+// 从 uint8 位图编码，非 0 为前景；stride 为行字节跨度
+void rle_encode(const uint8_t* data, int width, int height, size_t stride, MaskRLE& rle);
+
+// 从概率图编码，> threshold 为前景（采样后的掩码概率直接编码，不生成中间位图）
+void rle_encode_threshold(const float* data, int width, int height, size_t stride, float threshold, MaskRLE& rle);
+
+// 解码 (roi_x, roi_y, roi_w, roi_h)（掩码坐标，须在掩码范围内）到 dst，前景写 fg、背景写 0
+void rle_decode(const MaskRLE& rle, int roi_x, int roi_y, int roi_w, int roi_h,
+                uint8_t fg, uint8_t* dst, size_t dst_stride);
+
+// 前景面积（像素数）
+uint32_t rle_area(const MaskRLE& rle);
+
+// 两个掩码（左上角分别位于原图 (ax, ay)、(bx, by)）的交并比，均为空时返回 0
+float rle_iou(const MaskRLE& a, int ax, int ay, const MaskRLE& b, int bx, int by);
+
+#endif // MASK_RLE_H
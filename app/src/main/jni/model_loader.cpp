@@ -0,0 +1,163 @@
+#include "model_loader.h"
+
+#include <chrono>
+#include <memory>
+
+#include <android/log.h>
+#include <benchmark.h>
+
+#include "vision_base.h"
+#include "vision_infer.h"
+#include "IYoloAlgo.h"
+#include "model_warmup.h"
+#include "net_cache.h"
+
+// 旧模型等待读者释放的上限，超时后交给最后一个读者析构
+#define RETIRE_WAIT_MS 2000
+
+ModelLoader::ModelLoader()
+    : has_pending_(false),
+      busy_(false),
+      stopping_(false),
+      generation_(0),
+      last_ok_(false)
+{
+}
+
+ModelLoader::~ModelLoader()
+{
+    stop();
+}
+
+void ModelLoader::set_on_swap(std::function<void()> on_swap)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    on_swap_ = std::move(on_swap);
+}
+
+void ModelLoader::submit(const ModelLoadRequest& request)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!worker_.joinable())
+    {
+        stopping_ = false;
+        worker_ = std::thread(&ModelLoader::workerLoop, this);
+    }
+    pending_ = request;
+    has_pending_ = true;
+    generation_++;
+    setModelLoading(true);
+    cond_.notify_all();
+}
+
+bool ModelLoader::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return !has_pending_ && !busy_; });
+    return last_ok_;
+}
+
+bool ModelLoader::loading() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return has_pending_ || busy_;
+}
+
+void ModelLoader::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        has_pending_ = false;
+        cond_.notify_all();
+    }
+    if (worker_.joinable())
+        worker_.join();
+}
+
+void ModelLoader::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        cond_.wait(lock, [this] { return has_pending_ || stopping_; });
+        if (stopping_)
+            break;
+
+        const ModelLoadRequest request = pending_;
+        const int generation = generation_;
+        has_pending_ = false;
+        busy_ = true;
+
+        lock.unlock();
+        const bool ok = loadAndSwap(request, generation);
+        lock.lock();
+
+        busy_ = false;
+        if (generation == generation_)
+            last_ok_ = ok;
+        if (!has_pending_)
+            setModelLoading(false);
+        cond_.notify_all();
+    }
+    busy_ = false;
+    setModelLoading(false);
+    cond_.notify_all();
+}
+
+bool ModelLoader::loadAndSwap(const ModelLoadRequest& request, int generation)
+{
+    std::shared_ptr<IYoloAlgo> model(createModelInstance(request.modelid));
+    if (!model)
+        return false;
+
+    const double t0 = ncnn::get_current_time();
+    int ret = model->load(request.mgr, request.modelid, request.inputsize, request.use_gpu);
+    const double t1 = ncnn::get_current_time();
+
+    WarmupReport report;
+    report.runs = 0;
+    report.total_ms = 0.f;
+    if (ret == 0)
+        ret = model->warmup(request.warmup_runs, report);
+
+    if (ret != 0)
+    {
+        __android_log_print(ANDROID_LOG_ERROR, "ncnn", "load model %d failed %d, keep current model", request.modelid, ret);
+        return false;
+    }
+
+    std::function<void()> on_swap;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (generation != generation_ || stopping_)
+        {
+            // 已被更新的请求取代
+            return false;
+        }
+        on_swap = on_swap_;
+    }
+
+    std::shared_ptr<IYoloAlgo> retired = swapModel(model);
+    publishModelReadiness((float)(t1 - t0), report);
+    if (on_swap)
+        on_swap();
+
+    ModelMemoryStats stats;
+    if (model->getMemoryStats(stats))
+    {
+        __android_log_print(ANDROID_LOG_DEBUG, "ncnn", "load %.2f ms, warmup %.2f ms (%d shapes x %d runs), blob peak %zu KB, workspace peak %zu KB",
+                            t1 - t0, report.total_ms, (int)report.timings.size(), report.runs,
+                            stats.blob.peak_bytes / 1024, stats.workspace.peak_bytes / 1024);
+    }
+    model.reset();
+
+    // 正在推理的读者仍持有旧模型，等它们用完后在这里析构
+    for (int waited = 0; retired && retired.use_count() > 1 && waited < RETIRE_WAIT_MS; waited += 5)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    retired.reset();
+
+    // 旧模型独占的 Net 此时只剩缓存持有，按预算淘汰
+    trimNetCache();
+    return true;
+}
@@ -0,0 +1,67 @@
+#ifndef MODEL_LOADER_H
+#define MODEL_LOADER_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <android/asset_manager.h>
+
+// =============================
+// 后台加载与模型热切换
+// =============================
+//
+// - 加载线程创建新实例，依次 load -> 预热（兼做校验：输入 / 输出 blob 都能取到）
+// - 新模型准备好之后才通过 swapModel 原子替换，期间旧模型照常推理，读者不会看到半加载的模型
+// - 加载中又来了新请求时只保留最新的一个，被取代的请求加载完成后直接丢弃，不切换上去
+// - 旧模型在加载线程上析构：等所有读者释放引用后再释放，避免在相机 / 解码线程上析构
+struct ModelLoadRequest
+{
+    AAssetManager* mgr;
+    int modelid;
+    int inputsize;
+    bool use_gpu;
+    int warmup_runs;
+};
+
+class ModelLoader
+{
+public:
+    ModelLoader();
+    ~ModelLoader();
+
+    // 每次切换成功后在加载线程回调（清理与旧模型相关的结果 / 轨迹）
+    void set_on_swap(std::function<void()> on_swap);
+
+    // 提交加载请求，立即返回
+    void submit(const ModelLoadRequest& request);
+
+    // 等待已提交的请求全部处理完，返回最后一个请求是否加载成功并切换
+    bool wait();
+
+    bool loading() const;
+
+    // 等待当前加载结束并退出线程（未开始的请求丢弃）
+    void stop();
+
+private:
+    ModelLoader(const ModelLoader&) = delete;
+    ModelLoader& operator=(const ModelLoader&) = delete;
+
+    void workerLoop();
+    bool loadAndSwap(const ModelLoadRequest& request, int generation);
+
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    ModelLoadRequest pending_;
+    bool has_pending_;
+    bool busy_;
+    bool stopping_;
+    int generation_;       // 每次 submit 加一，用于判断加载结果是否已被新请求取代
+    bool last_ok_;
+    std::function<void()> on_swap_;
+};
+
+#endif // MODEL_LOADER_H
@@ -0,0 +1,137 @@
+#include "model_warmup.h"
+
+#include <mutex>
+
+#include <benchmark.h>
+
+void addWarmupTarget(std::vector<WarmupTarget>& targets, const ncnn::Net* net, const char* input,
+                     const std::vector<std::string>& outputs, int w, int h, int c)
+{
+    for (const WarmupTarget& t : targets)
+    {
+        if (t.net == net && t.w == w && t.h == h && t.c == c && t.input == input)
+            return;
+    }
+
+    WarmupTarget t;
+    t.net = net;
+    t.input = input;
+    t.outputs = outputs;
+    t.w = w;
+    t.h = h;
+    t.c = c;
+    targets.push_back(t);
+}
+
+void addLetterboxWarmupTargets(std::vector<WarmupTarget>& targets, const ncnn::Net* net, const char* input,
+                               const std::vector<std::string>& outputs, int target_size, int c)
+{
+    static const int aspects[][2] = {{1, 1}, {4, 3}, {3, 4}, {16, 9}, {9, 16}};
+
+    for (const auto& a : aspects)
+    {
+        // 与各算法 preprocessImage 相同的缩放取整方式
+        int w = a[0];
+        int h = a[1];
+        if (w > h)
+        {
+            const float scale = (float)target_size / w;
+            w = target_size;
+            h = h * scale;
+        }
+        else
+        {
+            const float scale = (float)target_size / h;
+            h = target_size;
+            w = w * scale;
+        }
+        addWarmupTarget(targets, net, input, outputs, (w + 31) / 32 * 32, (h + 31) / 32 * 32, c);
+    }
+}
+
+static int forwardOnce(const WarmupTarget& t, const ncnn::Mat& in, double& ms)
+{
+    const double t0 = ncnn::get_current_time();
+    ncnn::Extractor ex = t.net->create_extractor();
+    ex.set_light_mode(true);
+    int ret = ex.input(t.input.c_str(), in);
+    for (size_t i = 0; ret == 0 && i < t.outputs.size(); i++)
+    {
+        ncnn::Mat out;
+        ret = ex.extract(t.outputs[i].c_str(), out);
+    }
+    ms = ncnn::get_current_time() - t0;
+    return ret;
+}
+
+int runWarmup(const std::vector<WarmupTarget>& targets, int runs, WarmupReport& report)
+{
+    report.runs = runs > 0 ? runs : 0;
+    report.total_ms = 0.f;
+    report.timings.clear();
+    if (runs <= 0)
+        return 0;
+
+    const double t0 = ncnn::get_current_time();
+    for (const WarmupTarget& t : targets)
+    {
+        ncnn::Mat in(t.w, t.h, t.c);
+        in.fill(0.f);
+
+        WarmupTiming timing;
+        timing.w = t.w;
+        timing.h = t.h;
+
+        double ms = 0.0;
+        int ret = forwardOnce(t, in, ms);
+        if (ret != 0)
+            return ret;
+        timing.cold_ms = (float)ms;
+
+        double warm = 0.0;
+        for (int i = 1; i < runs; i++)
+        {
+            ret = forwardOnce(t, in, ms);
+            if (ret != 0)
+                return ret;
+            warm += ms;
+        }
+        timing.warm_ms = runs > 1 ? (float)(warm / (runs - 1)) : timing.cold_ms;
+
+        report.timings.push_back(timing);
+    }
+    report.total_ms = (float)(ncnn::get_current_time() - t0);
+    return 0;
+}
+
+static std::mutex g_readiness_mutex;
+static ModelReadiness g_readiness = {false, false, 0.f, {0, 0.f, {}}};
+
+void resetModelReadiness()
+{
+    std::lock_guard<std::mutex> lock(g_readiness_mutex);
+    g_readiness.ready = false;
+    g_readiness.loading = false;
+    g_readiness.load_ms = 0.f;
+    g_readiness.warmup = WarmupReport();
+}
+
+void publishModelReadiness(float load_ms, const WarmupReport& warmup)
+{
+    std::lock_guard<std::mutex> lock(g_readiness_mutex);
+    g_readiness.ready = true;
+    g_readiness.load_ms = load_ms;
+    g_readiness.warmup = warmup;
+}
+
+void setModelLoading(bool loading)
+{
+    std::lock_guard<std::mutex> lock(g_readiness_mutex);
+    g_readiness.loading = loading;
+}
+
+ModelReadiness getModelReadiness()
+{
+    std::lock_guard<std::mutex> lock(g_readiness_mutex);
+    return g_readiness;
+}
@@ -0,0 +1,73 @@
+#ifndef MODEL_WARMUP_H
+#define MODEL_WARMUP_H
+
+#include <string>
+#include <vector>
+
+#include <net.h>
+
+// =============================
+// 模型预热与就绪状态
+// =============================
+//
+// load_param / load_model 之后，首次前向还要创建各层 pipeline、做权重打包变换、扩充内存池，
+// 首帧耗时可达稳定值的数倍。加载后对每个 (Net, 输入尺寸) 先跑若干次空输入前向，
+// 记录首次（冷）与之后（热）的耗时，完成后才标记模型就绪。
+
+// 一个需要预热的 Net 输入尺寸
+struct WarmupTarget
+{
+    const ncnn::Net* net;
+    std::string input;
+    std::vector<std::string> outputs;
+    int w;
+    int h;
+    int c;
+};
+
+struct WarmupTiming
+{
+    int w;
+    int h;
+    float cold_ms;   // 首次前向耗时
+    float warm_ms;   // 之后各次前向的平均耗时（runs 为 1 时等于 cold_ms）
+};
+
+struct WarmupReport
+{
+    int runs;                            // 每个尺寸的前向次数
+    float total_ms;                      // 预热总耗时
+    std::vector<WarmupTiming> timings;   // 与 WarmupTarget 一一对应
+};
+
+// 固定输入尺寸
+void addWarmupTarget(std::vector<WarmupTarget>& targets, const ncnn::Net* net, const char* input,
+                     const std::vector<std::string>& outputs, int w, int h, int c = 3);
+
+// letterbox 输入（长边缩放到 target_size，各边补到 32 的倍数）：按常见画面比例
+// （1:1、4:3、3:4、16:9、9:16）生成输入尺寸，去重后逐个加入
+void addLetterboxWarmupTargets(std::vector<WarmupTarget>& targets, const ncnn::Net* net, const char* input,
+                               const std::vector<std::string>& outputs, int target_size, int c = 3);
+
+// 对每个目标跑 runs 次空输入前向；runs <= 0 时不预热
+// 输入 / 输出 blob 取不到（模型文件缺失或不匹配）时返回非 0
+int runWarmup(const std::vector<WarmupTarget>& targets, int runs, WarmupReport& report);
+
+// 当前模型的就绪状态（新模型加载、预热并切换上去之后发布；加载期间旧模型保持就绪）
+struct ModelReadiness
+{
+    bool ready;
+    bool loading;          // 后台是否有模型正在加载
+    float load_ms;         // load_param / load_model 耗时
+    WarmupReport warmup;
+};
+
+void resetModelReadiness();
+
+void publishModelReadiness(float load_ms, const WarmupReport& warmup);
+
+void setModelLoading(bool loading);
+
+ModelReadiness getModelReadiness();
+
+#endif // MODEL_WARMUP_H
@@ -14,6 +14,9 @@
 
 #include "ndkcamera.h"
 
+#include <stdlib.h>
+
+#include <algorithm>
 #include <string>
 
 #include <android/log.h>
@@ -22,6 +25,17 @@
 
 #include "mat.h"
 
+#include "trace.h"
+#include "yuv_repack.h"
+
+// 默认采集配置
+#define NDKCAMERA_WIDTH 640
+#define NDKCAMERA_HEIGHT 480
+#define NDKCAMERA_FPS 30
+#define NDKCAMERA_MAX_IMAGES 4
+// acquireLatestImage 至少需要 2 张图像
+#define NDKCAMERA_MIN_IMAGES 2
+
 static void onDisconnected(void* context, ACameraDevice* device)
 {
     __android_log_print(ANDROID_LOG_WARN, "NdkCamera", "onDisconnected %p", device);
@@ -79,49 +93,35 @@ static void onImageAvailable(void* context, AImageReader* reader)
     AImage_getPlaneData(image, 1, &u_data, &u_len);
     AImage_getPlaneData(image, 2, &v_data, &v_len);
 
-    if (u_data == v_data + 1 && v_data == y_data + width * height && y_pixelStride == 1 && u_pixelStride == 2 && v_pixelStride == 2 && y_rowStride == width && u_rowStride == width && v_rowStride == width)
+    Yuv420Planes planes;
+    planes.width = width;
+    planes.height = height;
+    planes.y = y_data;
+    planes.u = u_data;
+    planes.v = v_data;
+    planes.y_row_stride = y_rowStride;
+    planes.u_row_stride = u_rowStride;
+    planes.v_row_stride = v_rowStride;
+    planes.y_pixel_stride = y_pixelStride;
+    planes.u_pixel_stride = u_pixelStride;
+    planes.v_pixel_stride = v_pixelStride;
+
+    NdkCamera* camera = (NdkCamera*)context;
+    if (yuv420_is_nv21(planes))
     {
         // already nv21  :)
-        ((NdkCamera*)context)->on_image((unsigned char*)y_data, (int)width, (int)height);
+        camera->on_image((unsigned char*)y_data, (int)width, (int)height);
     }
     else
     {
-        // construct nv21
-        unsigned char* nv21 = new unsigned char[width * height + width * height / 2];
+        // construct nv21（复用暂存缓冲，按跨度逐行重排）
+        unsigned char* nv21 = camera->nv21_buffer(width, height);
         {
-            // Y
-            unsigned char* yptr = nv21;
-            for (int y=0; y<height; y++)
-            {
-                const unsigned char* y_data_ptr = y_data + y_rowStride * y;
-                for (int x=0; x<width; x++)
-                {
-                    yptr[0] = y_data_ptr[0];
-                    yptr++;
-                    y_data_ptr += y_pixelStride;
-                }
-            }
-
-            // UV
-            unsigned char* uvptr = nv21 + width * height;
-            for (int y=0; y<height/2; y++)
-            {
-                const unsigned char* v_data_ptr = v_data + v_rowStride * y;
-                const unsigned char* u_data_ptr = u_data + u_rowStride * y;
-                for (int x=0; x<width/2; x++)
-                {
-                    uvptr[0] = v_data_ptr[0];
-                    uvptr[1] = u_data_ptr[0];
-                    uvptr += 2;
-                    v_data_ptr += v_pixelStride;
-                    u_data_ptr += u_pixelStride;
-                }
-            }
+            TRACE_SCOPE(TRACE_CONVERT);
+            yuv420_to_nv21(planes, nv21);
         }
 
-        ((NdkCamera*)context)->on_image((unsigned char*)nv21, (int)width, (int)height);
-
-        delete[] nv21;
+        camera->on_image(nv21, (int)width, (int)height);
     }
 
     AImage_delete(image);
@@ -177,40 +177,257 @@ NdkCamera::NdkCamera()
     capture_session_output = 0;
     capture_session = 0;
 
+    // ImageReader 在 open() 中按协商后的尺寸创建
+    requested_capture = default_capture_config();
+    capture = requested_capture;
+}
 
-    // setup imagereader and its surface
+NdkCamera::~NdkCamera()
+{
+    close();
+}
+
+CameraCaptureConfig default_capture_config()
+{
+    CameraCaptureConfig config;
+    config.width = NDKCAMERA_WIDTH;
+    config.height = NDKCAMERA_HEIGHT;
+    config.target_size = 0;
+    config.fps_min = NDKCAMERA_FPS;
+    config.fps_max = NDKCAMERA_FPS;
+    config.max_images = NDKCAMERA_MAX_IMAGES;
+    return config;
+}
+
+bool choose_capture_size(const std::vector<CameraStreamConfig>& configs, int target_size, int min_fps,
+                         int& width, int& height)
+{
+    if (configs.empty())
+        return false;
+
+    // 没有任何尺寸满足帧率时忽略帧率要求
+    auto fps_ok = [min_fps](const CameraStreamConfig& c) {
+        return min_fps <= 0 || c.max_fps == 0 || c.max_fps >= min_fps;
+    };
+    const bool any_fps_ok = std::any_of(configs.begin(), configs.end(), fps_ok);
+
+    const CameraStreamConfig* best = 0;     // 长边 >= target_size 的最小尺寸
+    const CameraStreamConfig* largest = 0;
+    for (const CameraStreamConfig& c : configs)
     {
-        AImageReader_new(640, 480, AIMAGE_FORMAT_YUV_420_888, /*maxImages*/4, &image_reader);  //add
+        if (any_fps_ok && !fps_ok(c))
+            continue;
+
+        const long area = (long)c.width * c.height;
+        if (!largest || area > (long)largest->width * largest->height)
+            largest = &c;
+        if (std::max(c.width, c.height) >= target_size && (!best || area < (long)best->width * best->height))
+            best = &c;
+    }
 
-        AImageReader_ImageListener listener;
-        listener.context = this;
-        listener.onImageAvailable = onImageAvailable;
+    const CameraStreamConfig* pick = best ? best : largest;
+    width = pick->width;
+    height = pick->height;
+    return true;
+}
 
-        AImageReader_setImageListener(image_reader, &listener);
+// 按朝向查找相机 id 与传感器方向，找不到返回 false
+static bool find_camera(ACameraManager* camera_manager, int camera_facing, std::string& camera_id, int& orientation)
+{
+    ACameraIdList* camera_id_list = 0;
+    ACameraManager_getCameraIdList(camera_manager, &camera_id_list);
+    if (!camera_id_list)
+        return false;
 
-        AImageReader_getWindow(image_reader, &image_reader_surface);
+    for (int i = 0; i < camera_id_list->numCameras; ++i)
+    {
+        const char* id = camera_id_list->cameraIds[i];
+        ACameraMetadata* camera_metadata = 0;
+        ACameraManager_getCameraCharacteristics(camera_manager, id, &camera_metadata);
 
-        ANativeWindow_acquire(image_reader_surface);
+        // query faceing
+        acamera_metadata_enum_android_lens_facing_t facing = ACAMERA_LENS_FACING_FRONT;
+        {
+            ACameraMetadata_const_entry e = { 0 };
+            ACameraMetadata_getConstEntry(camera_metadata, ACAMERA_LENS_FACING, &e);
+            facing = (acamera_metadata_enum_android_lens_facing_t)e.data.u8[0];
+        }
+
+        if (camera_facing == 0 && facing != ACAMERA_LENS_FACING_FRONT)
+        {
+            ACameraMetadata_free(camera_metadata);
+            continue;
+        }
+
+        if (camera_facing == 1 && facing != ACAMERA_LENS_FACING_BACK)
+        {
+            ACameraMetadata_free(camera_metadata);
+            continue;
+        }
+
+        camera_id = id;
+
+        // query orientation
+        {
+            ACameraMetadata_const_entry e = { 0 };
+            ACameraMetadata_getConstEntry(camera_metadata, ACAMERA_SENSOR_ORIENTATION, &e);
+
+            orientation = (int)e.data.i32[0];
+        }
+
+        ACameraMetadata_free(camera_metadata);
+
+        break;
     }
+
+    ACameraManager_deleteCameraIdList(camera_id_list);
+    return !camera_id.empty();
 }
 
-NdkCamera::~NdkCamera()
+// 从相机元数据读取 YUV_420_888 输出尺寸（含最大帧率）与 AE 帧率范围
+static void read_stream_configs(const ACameraMetadata* camera_metadata, std::vector<CameraStreamConfig>& configs,
+                                std::vector<std::pair<int, int> >& fps_ranges)
 {
-    close();
+    configs.clear();
+    fps_ranges.clear();
 
-    if (image_reader)
+    // [format, width, height, input] 四元组
+    ACameraMetadata_const_entry e = { 0 };
+    if (ACameraMetadata_getConstEntry(camera_metadata, ACAMERA_SCALER_AVAILABLE_STREAM_CONFIGURATIONS, &e) == ACAMERA_OK)
     {
-        AImageReader_delete(image_reader);
-        image_reader = 0;
+        for (uint32_t i = 0; i + 3 < e.count; i += 4)
+        {
+            if (e.data.i32[i] != AIMAGE_FORMAT_YUV_420_888 || e.data.i32[i + 3] != ACAMERA_SCALER_AVAILABLE_STREAM_CONFIGURATIONS_OUTPUT)
+                continue;
+
+            CameraStreamConfig c;
+            c.width = e.data.i32[i + 1];
+            c.height = e.data.i32[i + 2];
+            c.max_fps = 0;
+            configs.push_back(c);
+        }
     }
 
-    if (image_reader_surface)
+    // [format, width, height, min_frame_duration_ns] 四元组
+    ACameraMetadata_const_entry d = { 0 };
+    if (ACameraMetadata_getConstEntry(camera_metadata, ACAMERA_SCALER_AVAILABLE_MIN_FRAME_DURATIONS, &d) == ACAMERA_OK)
     {
-        ANativeWindow_release(image_reader_surface);
-        image_reader_surface = 0;
+        for (uint32_t i = 0; i + 3 < d.count; i += 4)
+        {
+            if (d.data.i64[i] != AIMAGE_FORMAT_YUV_420_888 || d.data.i64[i + 3] <= 0)
+                continue;
+
+            for (CameraStreamConfig& c : configs)
+            {
+                if (c.width == d.data.i64[i + 1] && c.height == d.data.i64[i + 2])
+                    c.max_fps = (int)(1000000000LL / d.data.i64[i + 3]);
+            }
+        }
+    }
+
+    ACameraMetadata_const_entry f = { 0 };
+    if (ACameraMetadata_getConstEntry(camera_metadata, ACAMERA_CONTROL_AE_AVAILABLE_TARGET_FPS_RANGES, &f) == ACAMERA_OK)
+    {
+        for (uint32_t i = 0; i + 1 < f.count; i += 2)
+        {
+            fps_ranges.push_back(std::make_pair(f.data.i32[i], f.data.i32[i + 1]));
+        }
     }
 }
 
+// 请求配置 -> 相机实际支持的配置
+static CameraCaptureConfig negotiate_capture(const CameraCaptureConfig& requested,
+                                             const std::vector<CameraStreamConfig>& configs,
+                                             const std::vector<std::pair<int, int> >& fps_ranges)
+{
+    CameraCaptureConfig config = requested;
+
+    if (config.width <= 0 || config.height <= 0)
+    {
+        // 自动：按模型输入边长选
+        const int target_size = config.target_size > 0 ? config.target_size : NDKCAMERA_WIDTH;
+        config.width = NDKCAMERA_WIDTH;
+        config.height = NDKCAMERA_HEIGHT;
+        choose_capture_size(configs, target_size, config.fps_max, config.width, config.height);
+    }
+    else if (!configs.empty())
+    {
+        // 指定尺寸不受支持时取最接近的
+        int best = -1;
+        for (const CameraStreamConfig& c : configs)
+        {
+            const int diff = abs(c.width - requested.width) + abs(c.height - requested.height);
+            if (best < 0 || diff < best)
+            {
+                best = diff;
+                config.width = c.width;
+                config.height = c.height;
+            }
+        }
+    }
+
+    if (config.fps_min <= 0 || config.fps_max <= 0)
+    {
+        config.fps_min = NDKCAMERA_FPS;
+        config.fps_max = NDKCAMERA_FPS;
+    }
+    if (config.fps_min > config.fps_max)
+        std::swap(config.fps_min, config.fps_max);
+
+    if (!fps_ranges.empty())
+    {
+        int best = -1;
+        const int fps_min = config.fps_min;
+        const int fps_max = config.fps_max;
+        for (const std::pair<int, int>& r : fps_ranges)
+        {
+            const int diff = abs(r.first - fps_min) + abs(r.second - fps_max);
+            if (best < 0 || diff < best)
+            {
+                best = diff;
+                config.fps_min = r.first;
+                config.fps_max = r.second;
+            }
+        }
+    }
+
+    config.max_images = std::max(config.max_images > 0 ? config.max_images : NDKCAMERA_MAX_IMAGES, NDKCAMERA_MIN_IMAGES);
+    return config;
+}
+
+void NdkCamera::set_capture_config(const CameraCaptureConfig& config)
+{
+    requested_capture = config;
+    capture = config;
+}
+
+CameraCaptureConfig NdkCamera::capture_config() const
+{
+    return capture;
+}
+
+int NdkCamera::query_stream_configs(int camera_facing, std::vector<CameraStreamConfig>& configs,
+                                    std::vector<std::pair<int, int> >& fps_ranges)
+{
+    ACameraManager* camera_manager = ACameraManager_create();
+
+    std::string camera_id;
+    int orientation = 0;
+    if (!find_camera(camera_manager, camera_facing, camera_id, orientation))
+    {
+        ACameraManager_delete(camera_manager);
+        return -1;
+    }
+
+    ACameraMetadata* camera_metadata = 0;
+    ACameraManager_getCameraCharacteristics(camera_manager, camera_id.c_str(), &camera_metadata);
+    read_stream_configs(camera_metadata, configs, fps_ranges);
+    ACameraMetadata_free(camera_metadata);
+
+    ACameraManager_delete(camera_manager);
+    return 0;
+}
+
 int NdkCamera::open(int _camera_facing)
 {
     __android_log_print(ANDROID_LOG_WARN, "NdkCamera", "open");
@@ -221,59 +438,47 @@ int NdkCamera::open(int _camera_facing)
 
     // find front camera
     std::string camera_id;
+    if (!find_camera(camera_manager, camera_facing, camera_id, camera_orientation))
     {
-        ACameraIdList* camera_id_list = 0;
-        ACameraManager_getCameraIdList(camera_manager, &camera_id_list);
-
-        for (int i = 0; i < camera_id_list->numCameras; ++i)
-        {
-            const char* id = camera_id_list->cameraIds[i];
-            ACameraMetadata* camera_metadata = 0;
-            ACameraManager_getCameraCharacteristics(camera_manager, id, &camera_metadata);
-
-            // query faceing
-            acamera_metadata_enum_android_lens_facing_t facing = ACAMERA_LENS_FACING_FRONT;
-            {
-                ACameraMetadata_const_entry e = { 0 };
-                ACameraMetadata_getConstEntry(camera_metadata, ACAMERA_LENS_FACING, &e);
-                facing = (acamera_metadata_enum_android_lens_facing_t)e.data.u8[0];
-            }
+        __android_log_print(ANDROID_LOG_WARN, "NdkCamera", "no camera for facing %d", camera_facing);
+        ACameraManager_delete(camera_manager);
+        camera_manager = 0;
+        return -1;
+    }
 
-            if (camera_facing == 0 && facing != ACAMERA_LENS_FACING_FRONT)
-            {
-                ACameraMetadata_free(camera_metadata);
-                continue;
-            }
+    // negotiate capture size / fps range
+    {
+        std::vector<CameraStreamConfig> configs;
+        std::vector<std::pair<int, int> > fps_ranges;
 
-            if (camera_facing == 1 && facing != ACAMERA_LENS_FACING_BACK)
-            {
-                ACameraMetadata_free(camera_metadata);
-                continue;
-            }
+        ACameraMetadata* camera_metadata = 0;
+        ACameraManager_getCameraCharacteristics(camera_manager, camera_id.c_str(), &camera_metadata);
+        read_stream_configs(camera_metadata, configs, fps_ranges);
+        ACameraMetadata_free(camera_metadata);
 
-            camera_id = id;
+        capture = negotiate_capture(requested_capture, configs, fps_ranges);
+    }
 
-            // query orientation
-            int orientation = 0;
-            {
-                ACameraMetadata_const_entry e = { 0 };
-                ACameraMetadata_getConstEntry(camera_metadata, ACAMERA_SENSOR_ORIENTATION, &e);
+    __android_log_print(ANDROID_LOG_WARN, "NdkCamera", "open %s %d capture %dx%d fps [%d,%d] images %d",
+                        camera_id.c_str(), camera_orientation, capture.width, capture.height,
+                        capture.fps_min, capture.fps_max, capture.max_images);
 
-                orientation = (int)e.data.i32[0];
-            }
+    // setup imagereader and its surface
+    {
+        AImageReader_new(capture.width, capture.height, AIMAGE_FORMAT_YUV_420_888, capture.max_images, &image_reader);
+        nv21_staging.resize(nv21_size(capture.width, capture.height));
 
-            camera_orientation = orientation;
+        AImageReader_ImageListener listener;
+        listener.context = this;
+        listener.onImageAvailable = onImageAvailable;
 
-            ACameraMetadata_free(camera_metadata);
+        AImageReader_setImageListener(image_reader, &listener);
 
-            break;
-        }
+        AImageReader_getWindow(image_reader, &image_reader_surface);
 
-        ACameraManager_deleteCameraIdList(camera_id_list);
+        ANativeWindow_acquire(image_reader_surface);
     }
 
-    __android_log_print(ANDROID_LOG_WARN, "NdkCamera", "open %s %d", camera_id.c_str(), camera_orientation);
-
     // open camera
     {
         ACameraDevice_StateCallbacks camera_device_state_callbacks;
@@ -302,8 +507,8 @@ int NdkCamera::open(int _camera_facing)
         uint8_t awb_mode = ACAMERA_CONTROL_AWB_MODE_AUTO;
         ACaptureRequest_setEntry_u8(capture_request, ACAMERA_CONTROL_AWB_MODE, 1, &awb_mode);
 
-        // 优化帧率设置
-        int32_t fps_range[2] = {30, 30};
+        // 优化帧率设置（协商后的 AE 目标帧率范围）
+        int32_t fps_range[2] = {capture.fps_min, capture.fps_max};
         ACaptureRequest_setEntry_i32(capture_request, ACAMERA_CONTROL_AE_TARGET_FPS_RANGE, 2, fps_range);
     }
 
@@ -385,12 +590,34 @@ void NdkCamera::close()
         ACameraManager_delete(camera_manager);
         camera_manager = 0;
     }
+
+    if (image_reader)
+    {
+        AImageReader_delete(image_reader);
+        image_reader = 0;
+    }
+
+    if (image_reader_surface)
+    {
+        ANativeWindow_release(image_reader_surface);
+        image_reader_surface = 0;
+    }
 }
 
 void NdkCamera::on_image(const cv::Mat& rgb) const
 {
 }
 
+unsigned char* NdkCamera::nv21_buffer(int width, int height)
+{
+    const size_t size = nv21_size(width, height);
+    if (nv21_staging.size() < size)
+    {
+        nv21_staging.resize(size);
+    }
+    return nv21_staging.data();
+}
+
 void NdkCamera::on_image(const unsigned char* nv21, int nv21_width, int nv21_height) const
 {
     // rotate nv21
@@ -424,14 +651,17 @@ void NdkCamera::on_image(const unsigned char* nv21, int nv21_width, int nv21_hei
         }
     }
 
-    cv::Mat nv21_rotated(h + h / 2, w, CV_8UC1);
-    ncnn::kanna_rotate_yuv420sp(nv21, nv21_width, nv21_height, nv21_rotated.data, w, h, rotate_type);
+    nv21_rotated_buffer.create(h + h / 2, w, CV_8UC1);
+    ncnn::kanna_rotate_yuv420sp(nv21, nv21_width, nv21_height, nv21_rotated_buffer.data, w, h, rotate_type);
 
     // nv21_rotated to rgb
-    cv::Mat rgb(h, w, CV_8UC3);
-    ncnn::yuv420sp2rgb(nv21_rotated.data, w, h, rgb.data);
+    rgb_buffer.create(h, w, CV_8UC3);
+    {
+        TRACE_SCOPE(TRACE_CONVERT);
+        ncnn::yuv420sp2rgb(nv21_rotated_buffer.data, w, h, rgb_buffer.data);
+    }
 
-    on_image(rgb);
+    on_image(rgb_buffer);
 }
 
 static const int NDKCAMERAWINDOW_ID = 233;
@@ -445,6 +675,8 @@ NdkCameraWindow::NdkCameraWindow() : NdkCamera()
 
     accelerometer_orientation = 0;
 
+    source = CameraFrameSource();
+
     // sensor
     sensor_manager = ASensorManager_getInstance();
 
@@ -718,27 +950,34 @@ void NdkCameraWindow::on_image(const unsigned char* nv21, int nv21_width, int nv
         }
     }
 
-    // crop and rotate nv21
-    cv::Mat nv21_croprotated(roi_h + roi_h / 2, roi_w, CV_8UC1);
-    {
-        const unsigned char* srcY = nv21 + nv21_roi_y * nv21_width + nv21_roi_x;
-        unsigned char* dstY = nv21_croprotated.data;
-        ncnn::kanna_rotate_c1(srcY, nv21_roi_w, nv21_roi_h, nv21_width, dstY, roi_w, roi_h, roi_w, rotate_type);
+    // crop and rotate nv21（中间缓冲逐帧复用，尺寸不变时不再分配）
+    nv21_croprotated_buffer.create(roi_h + roi_h / 2, roi_w, CV_8UC1);
+    nv21_crop_rotate(nv21, nv21_width, nv21_height, nv21_roi_x, nv21_roi_y, nv21_roi_w, nv21_roi_h,
+                     nv21_croprotated_buffer.data, roi_w, roi_h, rotate_type);
 
-        const unsigned char* srcUV = nv21 + nv21_width * nv21_height + nv21_roi_y * nv21_width / 2 + nv21_roi_x;
-        unsigned char* dstUV = nv21_croprotated.data + roi_w * roi_h;
-        ncnn::kanna_rotate_c2(srcUV, nv21_roi_w / 2, nv21_roi_h / 2, nv21_width, dstUV, roi_w / 2, roi_h / 2, roi_w, rotate_type);
+    // nv21_croprotated to rgb
+    rgb_buffer.create(roi_h, roi_w, CV_8UC3);
+    {
+        TRACE_SCOPE(TRACE_CONVERT);
+        ncnn::yuv420sp2rgb(nv21_croprotated_buffer.data, roi_w, roi_h, rgb_buffer.data);
     }
 
-    // nv21_croprotated to rgb
-    cv::Mat rgb(roi_h, roi_w, CV_8UC3);
-    ncnn::yuv420sp2rgb(nv21_croprotated.data, roi_w, roi_h, rgb.data);
+    source.nv21 = nv21;
+    source.nv21_width = nv21_width;
+    source.nv21_height = nv21_height;
+    source.roi_x = nv21_roi_x;
+    source.roi_y = nv21_roi_y;
+    source.roi_w = nv21_roi_w;
+    source.roi_h = nv21_roi_h;
+    source.rotate_type = rotate_type;
+
+    on_image_render(rgb_buffer);
 
-    on_image_render(rgb);
+    source.nv21 = 0;
 
     // rotate to native window orientation
-    cv::Mat rgb_render(render_h, render_w, CV_8UC3);
-    ncnn::kanna_rotate_c3(rgb.data, roi_w, roi_h, rgb_render.data, render_w, render_h, render_rotate_type);
+    rgb_render_buffer.create(render_h, render_w, CV_8UC3);
+    ncnn::kanna_rotate_c3(rgb_buffer.data, roi_w, roi_h, rgb_render_buffer.data, render_w, render_h, render_rotate_type);
 
     ANativeWindow_setBuffersGeometry(win, render_w, render_h, AHARDWAREBUFFER_FORMAT_R8G8B8A8_UNORM);
 
@@ -750,7 +989,7 @@ void NdkCameraWindow::on_image(const unsigned char* nv21, int nv21_width, int nv
     {
         for (int y = 0; y < render_h; y++)
         {
-            const unsigned char* ptr = rgb_render.ptr<const unsigned char>(y);
+            const unsigned char* ptr = rgb_render_buffer.ptr<const unsigned char>(y);
             unsigned char* outptr = (unsigned char*)buf.bits + buf.stride * 4 * y;
 
             int x = 0;
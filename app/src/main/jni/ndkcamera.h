@@ -23,8 +23,38 @@
 #include <camera/NdkCameraMetadata.h>
 #include <media/NdkImageReader.h>
 
+#include <utility>
+#include <vector>
+
 #include <opencv2/core/core.hpp>
 
+// 相机支持的一种 YUV_420_888 输出尺寸（相机坐标系，未旋转）
+struct CameraStreamConfig
+{
+    int width;
+    int height;
+    int max_fps;    // 由最小帧间隔换算，元数据缺失时为 0（未知）
+};
+
+// 采集配置：open() 时按相机能力协商，协商结果通过 capture_config() 读取
+struct CameraCaptureConfig
+{
+    int width;          // <= 0 时按 target_size 自动选择
+    int height;
+    int target_size;    // 自动选择时参考的模型输入边长（取长边不小于它的最小尺寸）
+    int fps_min;        // AE 目标帧率范围，取相机支持的最接近范围
+    int fps_max;
+    int max_images;     // ImageReader 缓冲图像数
+};
+
+// 默认 640x480 @ 30fps，4 张缓冲图像
+CameraCaptureConfig default_capture_config();
+
+// 在 configs 中选择长边不小于 target_size 的最小尺寸（避免采集后再缩小浪费带宽），
+// 都小于 target_size 时取最大的；min_fps > 0 时优先满足帧率。configs 为空时返回 false
+bool choose_capture_size(const std::vector<CameraStreamConfig>& configs, int target_size, int min_fps,
+                         int& width, int& height);
+
 class NdkCamera
 {
 public:
@@ -39,15 +69,36 @@ public:
 
     virtual void on_image(const unsigned char* nv21, int nv21_width, int nv21_height) const;
 
+    // 设置采集配置，下次 open() 生效
+    void set_capture_config(const CameraCaptureConfig& config);
+
+    // open() 之后为协商后的实际配置，之前为请求的配置
+    CameraCaptureConfig capture_config() const;
+
+    // 枚举 facing 对应相机支持的 YUV_420_888 输出尺寸与 AE 帧率范围，找不到相机返回 -1
+    static int query_stream_configs(int camera_facing, std::vector<CameraStreamConfig>& configs,
+                                    std::vector<std::pair<int, int> >& fps_ranges);
+
+    // 非 NV21 帧重排用的暂存缓冲（按协商分辨率预分配，逐帧复用；只在图像回调线程使用）
+    unsigned char* nv21_buffer(int width, int height);
+
 public:
     int camera_facing;
     int camera_orientation;
 
+protected:
+    // 逐帧复用的中间缓冲（尺寸不变时 create 不重新分配）
+    mutable cv::Mat nv21_rotated_buffer;
+    mutable cv::Mat rgb_buffer;
+
 private:
     ACameraManager* camera_manager;
     ACameraDevice* camera_device;
     AImageReader* image_reader;
     ANativeWindow* image_reader_surface;
+    std::vector<unsigned char> nv21_staging;
+    CameraCaptureConfig requested_capture;
+    CameraCaptureConfig capture;
     ACameraOutputTarget* image_reader_target;
     ACaptureRequest* capture_request;
     ACaptureSessionOutputContainer* capture_session_output_container;
@@ -55,6 +106,19 @@ private:
     ACameraCaptureSession* capture_session;
 };
 
+// 当前帧的 NV21 来源（仅在 on_image_render 回调期间有效），推理可直接由 NV21 生成模型输入
+struct CameraFrameSource
+{
+    const unsigned char* nv21;
+    int nv21_width;
+    int nv21_height;
+    int roi_x;          // 源图方向上的 ROI
+    int roi_y;
+    int roi_w;
+    int roi_h;
+    int rotate_type;    // 同 ncnn::kanna_rotate_*，ROI 旋转后即 on_image_render 收到的 rgb
+};
+
 class NdkCameraWindow : public NdkCamera
 {
 public:
@@ -70,11 +134,18 @@ public:
 public:
     mutable int accelerometer_orientation;
 
+protected:
+    const CameraFrameSource& frame_source() const { return source; }
+
 private:
     ASensorManager* sensor_manager;
     mutable ASensorEventQueue* sensor_event_queue;
     const ASensor* accelerometer_sensor;
     ANativeWindow* win;
+
+    mutable cv::Mat nv21_croprotated_buffer;
+    mutable cv::Mat rgb_render_buffer;
+    mutable CameraFrameSource source;
 };
 
 #endif // NDKCAMERA_H
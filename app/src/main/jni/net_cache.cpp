@@ -0,0 +1,197 @@
+#include "net_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include <android/log.h>
+
+// 默认预算：可同时常驻若干个小模型，或一个大模型加一个小模型
+#define NET_CACHE_DEFAULT_BUDGET (96 * 1024 * 1024)
+
+size_t CachedNet::resident_bytes() const
+{
+    const ModelMemoryStats s = allocators.stats();
+    return weight_bytes + s.blob.peak_bytes + s.workspace.peak_bytes;
+}
+
+static std::mutex g_net_cache_mutex;
+// 最近使用的在前
+static std::list<std::shared_ptr<CachedNet> > g_net_cache;
+static size_t g_net_cache_budget = NET_CACHE_DEFAULT_BUDGET;
+static size_t g_net_cache_hits = 0;
+static size_t g_net_cache_misses = 0;
+static size_t g_net_cache_evictions = 0;
+
+// 调用方持有 g_net_cache_mutex；只有缓存自身持有引用（use_count == 1）的 Net 才能淘汰
+static void evictOverBudget()
+{
+    size_t resident = 0;
+    for (const auto& n : g_net_cache)
+        resident += n->resident_bytes();
+
+    for (auto it = g_net_cache.end(); it != g_net_cache.begin() && resident > g_net_cache_budget;)
+    {
+        --it;
+        if (it->use_count() > 1)
+            continue;
+
+        __android_log_print(ANDROID_LOG_DEBUG, "ncnn", "net cache evict %s (%zu KB)", (*it)->name.c_str(), (*it)->resident_bytes() / 1024);
+        resident -= (*it)->resident_bytes();
+        it = g_net_cache.erase(it);
+        g_net_cache_evictions++;
+    }
+}
+
+static std::shared_ptr<CachedNet> loadNet(AAssetManager* mgr, const char* modeltype, bool use_gpu)
+{
+    char parampath[256];
+    char modelpath[256];
+    sprintf(parampath, "%s.param", modeltype);
+    sprintf(modelpath, "%s.bin", modeltype);
+
+    std::shared_ptr<CachedNet> n = std::make_shared<CachedNet>();
+    n->name = modeltype;
+    n->use_gpu = use_gpu;
+    n->weight_bytes = 0;
+
+    n->net.opt = ncnn::Option();
+#if NCNN_VULKAN
+    n->net.opt.use_vulkan_compute = use_gpu;
+#endif
+    // 启用轻量模式，减少内存使用
+    n->net.opt.lightmode = true;
+    n->allocators.attach(n->net.opt);
+
+    if (n->net.load_param(mgr, parampath) != 0 || n->net.load_model(mgr, modelpath) != 0)
+        return std::shared_ptr<CachedNet>();
+
+    AAsset* asset = AAssetManager_open(mgr, modelpath, AASSET_MODE_UNKNOWN);
+    if (asset)
+    {
+        n->weight_bytes = (size_t)AAsset_getLength64(asset);
+        AAsset_close(asset);
+    }
+    return n;
+}
+
+std::shared_ptr<CachedNet> acquireNet(AAssetManager* mgr, const char* modeltype, bool use_gpu)
+{
+    {
+        std::lock_guard<std::mutex> lock(g_net_cache_mutex);
+        for (auto it = g_net_cache.begin(); it != g_net_cache.end(); ++it)
+        {
+            if ((*it)->name == modeltype && (*it)->use_gpu == use_gpu)
+            {
+                g_net_cache.splice(g_net_cache.begin(), g_net_cache, it);
+                g_net_cache_hits++;
+                return g_net_cache.front();
+            }
+        }
+    }
+
+    // 在锁外加载，不阻塞其它算法取缓存
+    std::shared_ptr<CachedNet> n = loadNet(mgr, modeltype, use_gpu);
+    if (!n)
+        return n;
+
+    std::lock_guard<std::mutex> lock(g_net_cache_mutex);
+    for (const auto& cached : g_net_cache)
+    {
+        // 加载期间别的线程已放入同一个 Net
+        if (cached->name == modeltype && cached->use_gpu == use_gpu)
+            return cached;
+    }
+    g_net_cache_misses++;
+    g_net_cache.push_front(n);
+    evictOverBudget();
+    return n;
+}
+
+ModelMemoryStats netMemoryStats(std::initializer_list<const CachedNet*> nets)
+{
+    ModelMemoryStats total;
+    memset(&total, 0, sizeof(total));
+
+    std::vector<const CachedNet*> counted;
+    for (const CachedNet* n : nets)
+    {
+        if (!n || std::find(counted.begin(), counted.end(), n) != counted.end())
+            continue;
+        counted.push_back(n);
+
+        const ModelMemoryStats s = n->allocators.stats();
+        AllocatorStats* dst[2] = {&total.blob, &total.workspace};
+        const AllocatorStats* src[2] = {&s.blob, &s.workspace};
+        for (int i = 0; i < 2; i++)
+        {
+            dst[i]->allocs += src[i]->allocs;
+            dst[i]->misses += src[i]->misses;
+            dst[i]->live_bytes += src[i]->live_bytes;
+            dst[i]->pooled_bytes += src[i]->pooled_bytes;
+            dst[i]->peak_bytes += src[i]->peak_bytes;
+        }
+    }
+    return total;
+}
+
+NetCacheStats netCacheStats()
+{
+    std::lock_guard<std::mutex> lock(g_net_cache_mutex);
+
+    NetCacheStats s;
+    s.hits = g_net_cache_hits;
+    s.misses = g_net_cache_misses;
+    s.evictions = g_net_cache_evictions;
+    s.entries = g_net_cache.size();
+    s.in_use = 0;
+    s.resident_bytes = 0;
+    s.budget_bytes = g_net_cache_budget;
+    for (const auto& n : g_net_cache)
+    {
+        if (n.use_count() > 1)
+            s.in_use++;
+        s.resident_bytes += n->resident_bytes();
+    }
+    return s;
+}
+
+void setNetCacheBudget(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(g_net_cache_mutex);
+    g_net_cache_budget = bytes;
+    evictOverBudget();
+}
+
+void trimNetCache()
+{
+    std::lock_guard<std::mutex> lock(g_net_cache_mutex);
+
+    // 切走的 Net 只剩缓存持有时，先归还池中空闲块，常驻估算随之降为权重大小；
+    // 下次切回时池会在预热 / 首帧中重新长起来
+    for (const auto& n : g_net_cache)
+    {
+        if (n.use_count() == 1)
+            n->allocators.clear();
+    }
+    evictOverBudget();
+}
+
+void clearNetCache()
+{
+    std::lock_guard<std::mutex> lock(g_net_cache_mutex);
+    for (auto it = g_net_cache.begin(); it != g_net_cache.end();)
+    {
+        if (it->use_count() > 1)
+        {
+            ++it;
+            continue;
+        }
+        it = g_net_cache.erase(it);
+        g_net_cache_evictions++;
+    }
+}
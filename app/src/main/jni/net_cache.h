@@ -0,0 +1,65 @@
+#ifndef NET_CACHE_H
+#define NET_CACHE_H
+
+#include <stddef.h>
+#include <initializer_list>
+#include <memory>
+#include <string>
+
+#include <android/asset_manager.h>
+#include <net.h>
+
+#include "pool_allocator.h"
+
+// =============================
+// 已加载 Net 的 LRU 缓存
+// =============================
+//
+// - 按 (模型文件名, cpu/gpu) 缓存加载好的 ncnn::Net，切回最近用过的模型时不再重新读取 .param / .bin、
+//   重建各层 pipeline；输入边长只影响 letterbox 目标尺寸，不影响 Net 本身，不作为缓存键
+// - 组合算法（CombinedPoseFace 等）与单独的算法拿到的是同一个 Net 实例
+// - 每个 Net 自带 blob / workspace 内存池，Net 被多个算法共用时池随 Net 一起共用
+// - 常驻内存按 权重文件大小 + 内存池峰值 估算；超出预算时从最久未用、且没有算法在用的 Net 开始淘汰，
+//   正在使用的 Net 不会被淘汰（此时允许暂时超出预算）
+
+struct CachedNet
+{
+    ModelAllocators allocators;   // 需先于 net 构造、后于 net 析构
+    ncnn::Net net;
+    std::string name;
+    bool use_gpu;
+    size_t weight_bytes;          // .bin 文件大小
+
+    // 权重 + 内存池峰值
+    size_t resident_bytes() const;
+};
+
+// 取得 modeltype.param / modeltype.bin 对应的 Net，未命中时加载后放入缓存；加载失败返回空
+std::shared_ptr<CachedNet> acquireNet(AAssetManager* mgr, const char* modeltype, bool use_gpu);
+
+// 多个 Net 内存池统计之和（同一 Net 只计一次）
+ModelMemoryStats netMemoryStats(std::initializer_list<const CachedNet*> nets);
+
+struct NetCacheStats
+{
+    size_t hits;
+    size_t misses;          // 实际从 AssetManager 加载的次数
+    size_t evictions;
+    size_t entries;         // 缓存中的 Net 数
+    size_t in_use;          // 其中正被算法使用的数量
+    size_t resident_bytes;  // 缓存中所有 Net 的常驻内存估算
+    size_t budget_bytes;
+};
+
+NetCacheStats netCacheStats();
+
+// 设置内存预算并立即按预算淘汰
+void setNetCacheBudget(size_t bytes);
+
+// 清空未被使用的 Net 的内存池空闲块，再按预算淘汰（模型切换、旧模型释放之后调用）
+void trimNetCache();
+
+// 释放所有未被使用的 Net
+void clearNetCache();
+
+#endif // NET_CACHE_H
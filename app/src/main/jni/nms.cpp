@@ -0,0 +1,273 @@
+#include "nms.h"
+#include "postprocess.h"
+
+#include <algorithm>
+#include <cmath>
+#include <float.h>
+
+// 按类别分组（组内保持原有的降序），返回各组下标
+static void group_by_label(const std::vector<Object>& objects, std::vector<std::vector<int> >& groups)
+{
+    int max_label = -1;
+    for (const auto& obj : objects)
+    {
+        max_label = std::max(max_label, obj.label);
+    }
+
+    groups.assign(max_label + 1, std::vector<int>());
+    for (int i = 0; i < (int)objects.size(); i++)
+    {
+        if (objects[i].label >= 0)
+            groups[objects[i].label].push_back(i);
+    }
+}
+
+static inline void rect_corners(const Object& obj, float& x0, float& y0, float& x1, float& y1)
+{
+    x0 = obj.rect.x;
+    y0 = obj.rect.y;
+    x1 = obj.rect.x + obj.rect.width;
+    y1 = obj.rect.y + obj.rect.height;
+}
+
+void nms_dispatch(std::vector<Object>& objects, std::vector<int>& picked,
+                  float nms_threshold, float score_threshold, int mode)
+{
+    switch (mode)
+    {
+    case NMS_PER_CLASS:
+        nms_per_class(objects, picked, nms_threshold);
+        break;
+    case NMS_GRID:
+        nms_grid(objects, picked, nms_threshold);
+        break;
+    case NMS_FAST:
+        nms_fast(objects, picked, nms_threshold);
+        break;
+    case NMS_MATRIX:
+        nms_matrix(objects, picked, score_threshold);
+        break;
+    case NMS_GREEDY:
+    default:
+        nms_sorted_bboxes(objects, picked, nms_threshold);
+        break;
+    }
+}
+
+// =============================
+// 按类别贪心 NMS
+// =============================
+void nms_per_class(const std::vector<Object>& objects, std::vector<int>& picked, float nms_threshold)
+{
+    picked.clear();
+
+    std::vector<std::vector<int> > groups;
+    group_by_label(objects, groups);
+
+    BoxSoA kept;
+    for (const auto& group : groups)
+    {
+        kept.clear();
+        kept.reserve(group.size());
+        for (int idx : group)
+        {
+            float x0, y0, x1, y1;
+            rect_corners(objects[idx], x0, y0, x1, y1);
+            if (kept.overlaps(x0, y0, x1, y1, nms_threshold))
+                continue;
+
+            kept.push(x0, y0, x1, y1);
+            picked.push_back(idx);
+        }
+    }
+
+    // 各组结果合并后恢复整体的置信度降序
+    std::sort(picked.begin(), picked.end());
+}
+
+// =============================
+// 网格分桶贪心 NMS
+// =============================
+//
+// 两个框 IoU > 0 必然相交，相交区域落在两者都覆盖的某个格子里；
+// 因此已保留框登记到它覆盖的所有格子，新框只需与自己覆盖格子里的框比较，结果与全量贪心一致。
+void nms_grid(const std::vector<Object>& objects, std::vector<int>& picked, float nms_threshold)
+{
+    picked.clear();
+
+    const int n = objects.size();
+    if (n == 0)
+        return;
+
+    // 场景范围与平均框尺寸决定格子大小
+    float min_x = FLT_MAX, min_y = FLT_MAX, max_x = -FLT_MAX, max_y = -FLT_MAX;
+    float mean_size = 0.f;
+    for (const auto& obj : objects)
+    {
+        min_x = std::min(min_x, obj.rect.x);
+        min_y = std::min(min_y, obj.rect.y);
+        max_x = std::max(max_x, obj.rect.x + obj.rect.width);
+        max_y = std::max(max_y, obj.rect.y + obj.rect.height);
+        mean_size += std::max(obj.rect.width, obj.rect.height);
+    }
+    mean_size /= n;
+
+    // 每个方向的格子数不超过 sqrt(n)，避免框少时分桶开销反而更大
+    const int max_cells = std::max(1, std::min(64, (int)std::sqrt((float)n)));
+    const float cell = std::max(mean_size, 1.f);
+    const int grid_w = std::max(1, std::min(max_cells, (int)std::ceil((max_x - min_x) / cell)));
+    const int grid_h = std::max(1, std::min(max_cells, (int)std::ceil((max_y - min_y) / cell)));
+    const float inv_cell_w = grid_w / std::max(max_x - min_x, 1.f);
+    const float inv_cell_h = grid_h / std::max(max_y - min_y, 1.f);
+
+    std::vector<BoxSoA> cells(grid_w * grid_h);
+
+    for (int i = 0; i < n; i++)
+    {
+        float x0, y0, x1, y1;
+        rect_corners(objects[i], x0, y0, x1, y1);
+
+        const int cx0 = std::min(grid_w - 1, std::max(0, (int)((x0 - min_x) * inv_cell_w)));
+        const int cy0 = std::min(grid_h - 1, std::max(0, (int)((y0 - min_y) * inv_cell_h)));
+        const int cx1 = std::min(grid_w - 1, std::max(0, (int)((x1 - min_x) * inv_cell_w)));
+        const int cy1 = std::min(grid_h - 1, std::max(0, (int)((y1 - min_y) * inv_cell_h)));
+
+        bool keep = true;
+        for (int gy = cy0; gy <= cy1 && keep; gy++)
+        {
+            for (int gx = cx0; gx <= cx1; gx++)
+            {
+                if (cells[gy * grid_w + gx].overlaps(x0, y0, x1, y1, nms_threshold))
+                {
+                    keep = false;
+                    break;
+                }
+            }
+        }
+        if (!keep)
+            continue;
+
+        for (int gy = cy0; gy <= cy1; gy++)
+        {
+            for (int gx = cx0; gx <= cx1; gx++)
+            {
+                cells[gy * grid_w + gx].push(x0, y0, x1, y1);
+            }
+        }
+        picked.push_back(i);
+    }
+}
+
+// =============================
+// Fast-NMS / Matrix-NMS
+// =============================
+//
+// 逐行计算上三角 IoU（第 i 行为框 i 与所有更低分框的 IoU），行内向量化；
+// 只保留每列的最大值 / 衰减值，内存为 O(n) 而不是 O(n^2)
+
+void nms_fast(const std::vector<Object>& objects, std::vector<int>& picked, float nms_threshold)
+{
+    picked.clear();
+
+    std::vector<std::vector<int> > groups;
+    group_by_label(objects, groups);
+
+    BoxSoA boxes;
+    std::vector<float> row;
+    std::vector<float> max_iou;
+    for (auto& group : groups)
+    {
+        if ((int)group.size() > NMS_MATRIX_MAX_CANDIDATES)
+            group.resize(NMS_MATRIX_MAX_CANDIDATES);
+
+        const int m = group.size();
+        boxes.clear();
+        boxes.reserve(m);
+        for (int idx : group)
+        {
+            float x0, y0, x1, y1;
+            rect_corners(objects[idx], x0, y0, x1, y1);
+            boxes.push(x0, y0, x1, y1);
+        }
+
+        row.resize(m);
+        max_iou.assign(m, 0.f);
+        for (int i = 0; i < m; i++)
+        {
+            // 与贪心 NMS 不同，已被抑制的框也参与抑制
+            if (max_iou[i] <= nms_threshold)
+                picked.push_back(group[i]);
+
+            float x0, y0, x1, y1;
+            boxes.box(i, x0, y0, x1, y1);
+            boxes.iou_row(x0, y0, x1, y1, i + 1, row.data());
+            for (int j = i + 1; j < m; j++)
+            {
+                max_iou[j] = std::max(max_iou[j], row[j - i - 1]);
+            }
+        }
+    }
+
+    std::sort(picked.begin(), picked.end());
+}
+
+void nms_matrix(std::vector<Object>& objects, std::vector<int>& picked, float score_threshold, float sigma)
+{
+    picked.clear();
+
+    std::vector<std::vector<int> > groups;
+    group_by_label(objects, groups);
+
+    BoxSoA boxes;
+    std::vector<float> row;
+    std::vector<float> max_iou; // compensate：每个框被更高分框覆盖的最大 IoU
+    std::vector<float> decay;
+    for (auto& group : groups)
+    {
+        if ((int)group.size() > NMS_MATRIX_MAX_CANDIDATES)
+            group.resize(NMS_MATRIX_MAX_CANDIDATES);
+
+        const int m = group.size();
+        boxes.clear();
+        boxes.reserve(m);
+        for (int idx : group)
+        {
+            float x0, y0, x1, y1;
+            rect_corners(objects[idx], x0, y0, x1, y1);
+            boxes.push(x0, y0, x1, y1);
+        }
+
+        row.resize(m);
+        max_iou.assign(m, 0.f);
+        decay.assign(m, 1.f);
+        for (int i = 0; i < m; i++)
+        {
+            // 行 i 处理前，max_iou[i] 已汇总了所有更高分框
+            const float comp = max_iou[i] * max_iou[i];
+
+            float x0, y0, x1, y1;
+            boxes.box(i, x0, y0, x1, y1);
+            boxes.iou_row(x0, y0, x1, y1, i + 1, row.data());
+            for (int j = i + 1; j < m; j++)
+            {
+                const float iou = row[j - i - 1];
+                max_iou[j] = std::max(max_iou[j], iou);
+                // 高斯核：exp(-sigma * (iou^2 - max_iou_i^2))，comp 即 max_iou_i^2
+                decay[j] = std::min(decay[j], expf(-sigma * (iou * iou - comp)));
+            }
+        }
+
+        for (int i = 0; i < m; i++)
+        {
+            Object& obj = objects[group[i]];
+            obj.prob *= decay[i];
+            if (obj.prob >= score_threshold)
+                picked.push_back(group[i]);
+        }
+    }
+
+    // 衰减后分数顺序可能变化，重新按分数降序
+    std::sort(picked.begin(), picked.end(), [&objects](int a, int b) {
+        return objects[a].prob > objects[b].prob;
+    });
+}
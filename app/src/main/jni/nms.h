@@ -0,0 +1,41 @@
+#ifndef NMS_H
+#define NMS_H
+
+#include <vector>
+
+#include "vision_base.h"
+
+// =============================
+// NMS 引擎（多种模式，由 g_nms_mode 选择）
+// =============================
+//
+// 所有模式的输入都要求已按置信度降序排列（qsort_descent_inplace），
+// 输出 picked 为保留框的下标，按置信度从高到低。
+enum NmsMode
+{
+    NMS_GREEDY = 0,    // 贪心 NMS，不区分类别（原有行为）
+    NMS_PER_CLASS = 1, // 按类别分组的贪心 NMS，不同类别的框互不抑制
+    NMS_GRID = 2,      // 空间网格分桶的贪心 NMS，结果与 NMS_GREEDY 一致，只和邻近格子里的框比较
+    NMS_FAST = 3,      // Fast-NMS（按类别）：一次算出上三角 IoU，被任何更高分框抑制即丢弃
+    NMS_MATRIX = 4,    // Matrix-NMS（按类别）：不直接丢框，按 IoU 衰减置信度后再用分数阈值过滤
+    NMS_MODE_COUNT
+};
+
+// Fast-NMS / Matrix-NMS 每个类别最多参与计算的候选框数（超出部分按低分丢弃）
+#define NMS_MATRIX_MAX_CANDIDATES 2048
+
+// 按 mode 选择对应实现；Matrix-NMS 会把衰减后的分数写回 objects[i].prob，
+// 并用 score_threshold 过滤，其余模式只用 nms_threshold
+void nms_dispatch(std::vector<Object>& objects, std::vector<int>& picked,
+                  float nms_threshold, float score_threshold, int mode);
+
+void nms_per_class(const std::vector<Object>& objects, std::vector<int>& picked, float nms_threshold);
+
+void nms_grid(const std::vector<Object>& objects, std::vector<int>& picked, float nms_threshold);
+
+void nms_fast(const std::vector<Object>& objects, std::vector<int>& picked, float nms_threshold);
+
+// sigma 为高斯衰减系数（SOLOv2 默认 2.0）
+void nms_matrix(std::vector<Object>& objects, std::vector<int>& picked, float score_threshold, float sigma = 2.f);
+
+#endif // NMS_H
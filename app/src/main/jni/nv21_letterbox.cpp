@@ -0,0 +1,202 @@
+#include "nv21_letterbox.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "trace.h"
+
+#define LETTERBOX_PAD_VALUE 114.f
+
+void letterbox_layout(int src_w, int src_h, int target_size, float& scale, int& w, int& h, int& wpad, int& hpad)
+{
+    w = src_w;
+    h = src_h;
+    scale = 1.f;
+    if (w > h)
+    {
+        scale = (float)target_size / w;
+        w = target_size;
+        h = h * scale;
+    }
+    else
+    {
+        scale = (float)target_size / h;
+        h = target_size;
+        w = w * scale;
+    }
+
+    wpad = (w + 31) / 32 * 32 - w;
+    hpad = (h + 31) / 32 * 32 - h;
+}
+
+// 一个坐标轴上的双线性取样：源坐标 i0 / i1（已加 ROI 偏移）与 i1 的权重
+struct AxisTap
+{
+    int i0;
+    int i1;
+    float frac;
+};
+
+// dst_n 个输出位置在长度 src_n 的轴上取样（像素中心对齐，同 resize_bilinear），
+// flip 时轴向翻转，offset 为 ROI 起点
+static void build_taps(int dst_n, int src_n, bool flip, int offset, std::vector<AxisTap>& taps)
+{
+    taps.resize(dst_n);
+    const float ratio = (float)src_n / dst_n;
+    for (int i = 0; i < dst_n; i++)
+    {
+        float c = (i + 0.5f) * ratio - 0.5f;
+        c = std::min(std::max(c, 0.f), (float)(src_n - 1));
+        if (flip)
+            c = (src_n - 1) - c;
+
+        const int i0 = (int)c;
+        AxisTap& t = taps[i];
+        t.i0 = offset + i0;
+        t.i1 = offset + std::min(i0 + 1, src_n - 1);
+        t.frac = c - i0;
+    }
+}
+
+static inline float clamp255(float v)
+{
+    return std::min(std::max(v, 0.f), 255.f);
+}
+
+void nv21_letterbox_planes(const uint8_t* nv21, int nv21_width, int nv21_height,
+                           int roi_x, int roi_y, int roi_w, int roi_h, int rotate_type,
+                           int w, int h, int wpad, int hpad,
+                           const float mean[3], const float norm[3],
+                           float* dst, size_t cstep)
+{
+    const int out_w = w + wpad;
+    const int out_h = h + hpad;
+    const int left = wpad / 2;
+    const int top = hpad / 2;
+
+    // 填充区
+    for (int c = 0; c < 3; c++)
+    {
+        const float pad = (LETTERBOX_PAD_VALUE - mean[c]) * norm[c];
+        float* plane = dst + cstep * c;
+        for (int y = 0; y < out_h; y++)
+        {
+            float* row = plane + (size_t)out_w * y;
+            if (y < top || y >= top + h)
+            {
+                std::fill(row, row + out_w, pad);
+            }
+            else
+            {
+                std::fill(row, row + left, pad);
+                std::fill(row + left + w, row + out_w, pad);
+            }
+        }
+    }
+
+    // 旋转类型 5~8 交换横纵轴：输出的列沿源图纵向、行沿源图横向
+    const bool transposed = rotate_type >= 5;
+    // 源图横向 / 纵向是否翻转（对应 kanna rotate 1~8 的 EXIF 定义）
+    bool flip_x = false;
+    bool flip_y = false;
+    switch (rotate_type)
+    {
+    case 2: flip_x = true; break;
+    case 3: flip_x = true; flip_y = true; break;
+    case 4: flip_y = true; break;
+    case 6: flip_y = true; break;
+    case 7: flip_x = true; flip_y = true; break;
+    case 8: flip_x = true; break;
+    default: break;
+    }
+
+    // 输出列 / 行对应的源图坐标轴
+    std::vector<AxisTap> col_taps;
+    std::vector<AxisTap> row_taps;
+    if (!transposed)
+    {
+        build_taps(w, roi_w, flip_x, roi_x, col_taps);
+        build_taps(h, roi_h, flip_y, roi_y, row_taps);
+    }
+    else
+    {
+        build_taps(w, roi_h, flip_y, roi_y, col_taps);
+        build_taps(h, roi_w, flip_x, roi_x, row_taps);
+    }
+
+    const uint8_t* yplane = nv21;
+    const uint8_t* vuplane = nv21 + (size_t)nv21_width * nv21_height;
+
+    float* rplane = dst;
+    float* gplane = dst + cstep;
+    float* bplane = dst + cstep * 2;
+
+    for (int oy = 0; oy < h; oy++)
+    {
+        const AxisTap& rt = row_taps[oy];
+        const size_t out_offset = (size_t)out_w * (top + oy) + left;
+        float* rrow = rplane + out_offset;
+        float* grow = gplane + out_offset;
+        float* brow = bplane + out_offset;
+
+        for (int ox = 0; ox < w; ox++)
+        {
+            const AxisTap& ct = col_taps[ox];
+            const AxisTap& tx = transposed ? rt : ct;
+            const AxisTap& ty = transposed ? ct : rt;
+
+            // 亮度双线性
+            const uint8_t* y0 = yplane + (size_t)nv21_width * ty.i0;
+            const uint8_t* y1 = yplane + (size_t)nv21_width * ty.i1;
+            const float top_y = y0[tx.i0] + (y0[tx.i1] - y0[tx.i0]) * tx.frac;
+            const float bot_y = y1[tx.i0] + (y1[tx.i1] - y1[tx.i0]) * tx.frac;
+            const float yy = top_y + (bot_y - top_y) * ty.frac;
+
+            // 色度最近邻（VU 交错，半分辨率）
+            const int sx = tx.frac < 0.5f ? tx.i0 : tx.i1;
+            const int sy = ty.frac < 0.5f ? ty.i0 : ty.i1;
+            const uint8_t* vu = vuplane + (size_t)nv21_width * (sy / 2) + (sx / 2) * 2;
+            const float v = vu[0] - 128.f;
+            const float u = vu[1] - 128.f;
+
+            // 与 ncnn::yuv420sp2rgb 相同的系数（定点 /64）
+            const float r = clamp255(yy + v * (90.f / 64));
+            const float g = clamp255(yy - v * (46.f / 64) - u * (22.f / 64));
+            const float b = clamp255(yy + u * (113.f / 64));
+
+            rrow[ox] = (r - mean[0]) * norm[0];
+            grow[ox] = (g - mean[1]) * norm[1];
+            brow[ox] = (b - mean[2]) * norm[2];
+        }
+    }
+}
+
+bool nv21_letterbox(const uint8_t* nv21, int nv21_width, int nv21_height,
+                    int roi_x, int roi_y, int roi_w, int roi_h, int rotate_type,
+                    int target_size, const float mean[3], const float norm[3],
+                    LetterboxTensor& out)
+{
+    if (!nv21 || target_size <= 0 || roi_w <= 0 || roi_h <= 0)
+        return false;
+
+    TRACE_SCOPE(TRACE_PREPROCESS);
+
+    // 旋转后的显示方向尺寸
+    const bool transposed = rotate_type >= 5;
+    const int src_w = transposed ? roi_h : roi_w;
+    const int src_h = transposed ? roi_w : roi_h;
+
+    int w, h;
+    letterbox_layout(src_w, src_h, target_size, out.scale, w, h, out.wpad, out.hpad);
+    out.orig_w = src_w;
+    out.orig_h = src_h;
+
+    // create 在尺寸不变时复用已有内存（引用计数为 1 时）
+    out.tensor.create(w + out.wpad, h + out.hpad, 3);
+    if (out.tensor.empty())
+        return false;
+
+    nv21_letterbox_planes(nv21, nv21_width, nv21_height, roi_x, roi_y, roi_w, roi_h, rotate_type,
+                          w, h, out.wpad, out.hpad, mean, norm, (float*)out.tensor.data, out.tensor.cstep);
+    return true;
+}
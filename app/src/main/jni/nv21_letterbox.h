@@ -0,0 +1,38 @@
+#ifndef NV21_LETTERBOX_H
+#define NV21_LETTERBOX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vision_base.h"
+
+// =============================
+// NV21 -> letterbox 模型输入张量（相机路径）
+// =============================
+//
+// 原流程：NV21 -> 整幅 RGB（yuv420sp2rgb）-> from_pixels_resize -> copy_make_border
+//        -> substract_mean_normalize，四次遍历像素。
+// 这里从 NV21 的 ROI 直接按旋转类型取样（亮度双线性、色度最近邻），转 RGB 后归一化写入
+// letterbox 张量，只遍历一次输出像素；缩放 / 填充规则与各模型 preprocessImage 一致
+// （长边缩放到 target_size，宽高各自填充到 32 的倍数，填充值 114）。
+
+// 显示方向（旋转后）的图像按长边缩放到 target_size 后的尺寸与填充
+void letterbox_layout(int src_w, int src_h, int target_size, float& scale, int& w, int& h, int& wpad, int& hpad);
+
+// 核心实现：输出 (w + wpad) x (h + hpad) 的三个 float 平面（R、G、B，平面间隔 cstep 个 float）
+// nv21 为 nv21_width x nv21_height 整幅图，ROI 为源图方向上的 (roi_x, roi_y, roi_w, roi_h)（均为偶数），
+// rotate_type 同 ncnn::kanna_rotate_*（1~8），value = (pixel - mean) * norm
+void nv21_letterbox_planes(const uint8_t* nv21, int nv21_width, int nv21_height,
+                           int roi_x, int roi_y, int roi_w, int roi_h, int rotate_type,
+                           int w, int h, int wpad, int hpad,
+                           const float mean[3], const float norm[3],
+                           float* dst, size_t cstep);
+
+// 生成 letterbox 张量（复用 out.tensor 的内存，尺寸不变时不重新分配）；
+// out.orig_w / orig_h 为旋转后的 ROI 尺寸，检测结果即映射到该坐标系
+bool nv21_letterbox(const uint8_t* nv21, int nv21_width, int nv21_height,
+                    int roi_x, int roi_y, int roi_w, int roi_h, int rotate_type,
+                    int target_size, const float mean[3], const float norm[3],
+                    LetterboxTensor& out);
+
+#endif // NV21_LETTERBOX_H
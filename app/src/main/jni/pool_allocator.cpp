@@ -0,0 +1,122 @@
+#include "pool_allocator.h"
+
+#include <string.h>
+
+#include <android/log.h>
+
+// 复用阈值：请求大小不小于块大小的 3/4 才复用该块（同 ncnn::PoolAllocator 默认值）
+static const float SIZE_COMPARE_RATIO = 0.75f;
+// 空闲块数量上限，超过后淘汰最早放回的块，避免输入尺寸变化时池无限增长
+static const size_t MAX_BUDGETS = 32;
+
+TrackedPoolAllocator::TrackedPoolAllocator()
+{
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+TrackedPoolAllocator::~TrackedPoolAllocator()
+{
+    clear();
+
+    if (!payouts_.empty())
+    {
+        __android_log_print(ANDROID_LOG_WARN, "ncnn", "TrackedPoolAllocator destroyed with %d blocks still in use",
+                            (int)payouts_.size());
+    }
+}
+
+void* TrackedPoolAllocator::fastMalloc(size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.allocs++;
+
+    // 在空闲块中找大小合适的块
+    for (auto it = budgets_.begin(); it != budgets_.end(); ++it)
+    {
+        const size_t bs = it->first;
+        if (bs >= size && bs * SIZE_COMPARE_RATIO <= size)
+        {
+            void* ptr = it->second;
+            payouts_.push_back(*it);
+            budgets_.erase(it);
+            stats_.pooled_bytes -= bs;
+            stats_.live_bytes += bs;
+            return ptr;
+        }
+    }
+
+    if (budgets_.size() >= MAX_BUDGETS)
+    {
+        stats_.pooled_bytes -= budgets_.front().first;
+        ncnn::fastFree(budgets_.front().second);
+        budgets_.pop_front();
+    }
+
+    void* ptr = ncnn::fastMalloc(size);
+    payouts_.push_back(std::make_pair(size, ptr));
+    stats_.misses++;
+    stats_.live_bytes += size;
+    if (stats_.live_bytes + stats_.pooled_bytes > stats_.peak_bytes)
+        stats_.peak_bytes = stats_.live_bytes + stats_.pooled_bytes;
+    return ptr;
+}
+
+void TrackedPoolAllocator::fastFree(void* ptr)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto it = payouts_.begin(); it != payouts_.end(); ++it)
+    {
+        if (it->second == ptr)
+        {
+            stats_.live_bytes -= it->first;
+            stats_.pooled_bytes += it->first;
+            budgets_.push_back(*it);
+            payouts_.erase(it);
+            return;
+        }
+    }
+
+    __android_log_print(ANDROID_LOG_WARN, "ncnn", "TrackedPoolAllocator %p: unknown block %p", this, ptr);
+    ncnn::fastFree(ptr);
+}
+
+void TrackedPoolAllocator::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto& b : budgets_)
+        ncnn::fastFree(b.second);
+    budgets_.clear();
+
+    memset(&stats_, 0, sizeof(stats_));
+    for (const auto& p : payouts_)
+        stats_.live_bytes += p.first;
+    stats_.peak_bytes = stats_.live_bytes;
+}
+
+AllocatorStats TrackedPoolAllocator::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ModelAllocators::attach(ncnn::Option& opt)
+{
+    opt.blob_allocator = &blob_;
+    opt.workspace_allocator = &workspace_;
+}
+
+void ModelAllocators::clear()
+{
+    blob_.clear();
+    workspace_.clear();
+}
+
+ModelMemoryStats ModelAllocators::stats() const
+{
+    ModelMemoryStats s;
+    s.blob = blob_.stats();
+    s.workspace = workspace_.stats();
+    return s;
+}
@@ -0,0 +1,77 @@
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <stddef.h>
+#include <list>
+#include <mutex>
+#include <utility>
+
+#include <allocator.h>
+#include <option.h>
+
+// =============================
+// 带统计的内存池分配器（每个 Net 独享）
+// =============================
+//
+// 与 ncnn::PoolAllocator 相同的复用策略：释放的块留在池中，之后申请大小在
+// [块大小 * 0.75, 块大小] 内的请求直接复用，稳定后每帧推理不再向系统申请内存。
+// 额外记录命中 / 实际申请次数和峰值占用，用于按模型输出内存报告。
+// 批量推理会在同一 Net 上并发多个 Extractor，所以分配 / 释放都加锁。
+
+struct AllocatorStats
+{
+    size_t allocs;        // 分配请求总数
+    size_t misses;        // 池中无可用块、实际向系统申请的次数
+    size_t live_bytes;    // 当前借出的字节数
+    size_t pooled_bytes;  // 当前池中空闲的字节数
+    size_t peak_bytes;    // 借出 + 空闲的历史峰值（模型实际占用的内存上限）
+};
+
+class TrackedPoolAllocator : public ncnn::Allocator
+{
+public:
+    TrackedPoolAllocator();
+    ~TrackedPoolAllocator() override;
+
+    void* fastMalloc(size_t size) override;
+    void fastFree(void* ptr) override;
+
+    // 释放池中所有空闲块（借出的块不受影响），统计清零
+    void clear();
+
+    AllocatorStats stats() const;
+
+private:
+    TrackedPoolAllocator(const TrackedPoolAllocator&);
+    TrackedPoolAllocator& operator=(const TrackedPoolAllocator&);
+
+    mutable std::mutex mutex_;
+    std::list<std::pair<size_t, void*> > budgets_;   // 空闲块
+    std::list<std::pair<size_t, void*> > payouts_;   // 借出块
+    AllocatorStats stats_;
+};
+
+// 一个 Net 的 blob / workspace 两个池
+// 需声明在所服务的 ncnn::Net 之前，保证 Net 析构时池仍然有效
+struct ModelMemoryStats
+{
+    AllocatorStats blob;
+    AllocatorStats workspace;
+};
+
+class ModelAllocators
+{
+public:
+    // 在 net.opt 重置之后、load_param 之前调用
+    void attach(ncnn::Option& opt);
+
+    void clear();
+
+    ModelMemoryStats stats() const;
+
+private:
+    TrackedPoolAllocator blob_;
+    TrackedPoolAllocator workspace_;
+};
+
+#endif // POOL_ALLOCATOR_H
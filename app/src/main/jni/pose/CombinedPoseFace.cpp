@@ -1,5 +1,8 @@
 #include "CombinedPoseFace.h"
+#include "trace.h"
 #include "layer.h"
+#include "postprocess.h"
+#include "pose_batch.h"
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include <float.h>
@@ -27,9 +30,6 @@ const unsigned char CombinedPoseFace::colors_[10][3] = {
 CombinedPoseFace::CombinedPoseFace(){ }
 CombinedPoseFace::~CombinedPoseFace()
 {
-    PersonNet.clear();
-    PoseNet.clear();
-    FaceNet.clear();
 }
 ncnn::Mat CombinedPoseFace::preprocessImage(const cv::Mat& rgb, float& scale, int& wpad, int& hpad)
 {
@@ -87,16 +87,6 @@ ncnn::Mat CombinedPoseFace::preprocessImage_face(const cv::Mat& rgb, float& scal
     ncnn::copy_make_border(in, in_pad, hpad / 2, hpad - hpad / 2, wpad / 2, wpad - wpad / 2, ncnn::BORDER_CONSTANT, 114.f);
     return in_pad;
 }
-// 添加快速指数函数，参考 DbFace 实现
-inline float CombinedPoseFace::fast_exp(float x) {
-    union {
-        uint32_t i;
-        float f;
-    } v{};
-    v.i = (1 << 23) * (1.4426950409 * x + 126.93490512f);
-    return v.f;
-}
-
 inline float CombinedPoseFace::myExp(float v) {
     float gate = 1;
     float base = exp(1);
@@ -151,40 +141,28 @@ void CombinedPoseFace::decode(int w, std::vector<Id_> ids, ncnn::Mat tlrb, std::
         objs.push_back(objTemp);
     }
 }
-float CombinedPoseFace::getIou(Box a, Box b) {
-    float aArea = (a.r - a.x + 1) * (a.b - a.y + 1);
-    float bArea = (b.r - b.x + 1) * (b.b - b.y + 1);
-
-    float x1 = a.x > b.x ? a.x : b.x;
-    float y1 = a.y > b.y ? a.y : b.y;
-    float x2 = a.r < b.r ? a.r : b.r;
-    float y2 = a.b < b.b ? a.b : b.b;
-    float w = 0.0f > x2 - x1 + 1 ? 0.0f : x2 - x1 + 1;
-    float h = 0.0f > y2 - y1 + 1 ? 0.0f : y2 - y1 + 1;
-    float area = w * h;
-
-    float iou = area / (aArea + bArea - area);
-    return iou;
-}
-std::vector<Obj_> CombinedPoseFace::nms(std::vector<Obj_> objs, float iou) {
-    if (objs.size() == 0) {
-        return objs;
-    }
-    sort(objs.begin(), objs.end(), [](Obj_ a, Obj_ b) { return a.score < b.score; });
+std::vector<Obj_> CombinedPoseFace::nms(const std::vector<Obj_>& objs, float iou) {
     std::vector<Obj_> keep;
-    int *flag = new int[objs.size()]();
-    for (int i = 0; i < objs.size(); i++) {
-        if (flag[i] != 0) {
+    if (objs.empty()) {
+        return keep;
+    }
+    // 按置信度从高到低排序（只排下标，避免拷贝关键点）
+    std::vector<int> order(objs.size());
+    for (int i = 0; i < (int)order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&objs](int a, int b) { return objs[a].score > objs[b].score; });
+    // 框坐标为含端点的像素坐标，右下角 +1 后按普通 IoU 计算
+    BoxSoA kept;
+    kept.reserve(objs.size());
+    for (int idx : order) {
+        const Box& b = objs[idx].box;
+        if (kept.overlaps(b.x, b.y, b.r + 1, b.b + 1, iou)) {
             continue;
         }
-        keep.push_back(objs[i]);
-        for (int j = i + 1; j < objs.size(); j++) {
-            if (flag[j] == 0 && getIou(objs[i].box, objs[j].box) > iou) {
-                flag[j] = 1;
-            }
-        }
+        kept.push(b.x, b.y, b.r + 1, b.b + 1);
+        keep.push_back(objs[idx]);
     }
-    delete[] flag;
     return keep;
 }
 int CombinedPoseFace::detectPersons(const cv::Mat& rgb, std::vector<cv::Rect>& personBoxes,float &prob_threshold, float &nms_threshold)
@@ -197,7 +175,7 @@ int CombinedPoseFace::detectPersons(const cv::Mat& rgb, std::vector<cv::Rect>& p
     ncnn::Mat input = preprocessImage(rgb, scale, wpad, hpad);
     input.substract_mean_normalize(mean_vals_1, norm_vals_1);
     // 人体检测推理
-    ncnn::Extractor ex = PersonNet.create_extractor();
+    ncnn::Extractor ex = PersonNet->net.create_extractor();
     ex.input("data", input);
     ncnn::Mat out;
     ex.extract("output", out);
@@ -228,55 +206,6 @@ int CombinedPoseFace::detectPersons(const cv::Mat& rgb, std::vector<cv::Rect>& p
     }
     return 0;
 }
-int CombinedPoseFace::detectPoseInPerson(const cv::Mat& rgb, const cv::Rect& personBox, std::vector<PoseKeyPoint>& keypoints,float &prob_threshold, float &nms_threshold)
-{
-    keypoints.clear();
-    // 提取人体ROI
-    cv::Mat roi = rgb(personBox).clone();
-    int w = roi.cols;
-    int h = roi.rows;
-    // 预处理ROI
-    ncnn::Mat in = ncnn::Mat::from_pixels_resize(roi.data, ncnn::Mat::PIXEL_BGR2RGB,
-                                                 roi.cols, roi.rows, pose_size_width, pose_size_height);
-    in.substract_mean_normalize(mean_vals_2, norm_vals_2);
-
-    // 姿态检测推理
-    auto ex = PoseNet.create_extractor();
-    ex.input("data", in);
-    ncnn::Mat out;
-    ex.extract("hybridsequential0_conv7_fwd", out);
-    // 解析关键点
-    for (int p = 0; p < out.c; p++) {
-        // 过滤掉面部关键点（索引0-4）
-        if (p < 5) {
-            continue;
-        }
-        const ncnn::Mat m = out.channel(p);
-        float max_prob = 0.f;
-        int max_x = 0;
-        int max_y = 0;
-        for (int y = 0; y < out.h; y++) {
-            const float *ptr = m.row(y);
-            for (int x = 0; x < out.w; x++) {
-                float prob = ptr[x];
-                if (prob > max_prob) {
-                    max_prob = prob;
-                    max_x = x;
-                    max_y = y;
-                }
-            }
-        }
-        if (max_prob >= prob_threshold) {
-            PoseKeyPoint keypoint;
-            keypoint.p = cv::Point2f(max_x * w / (float)out.w + personBox.x,
-                                     max_y * h / (float)out.h + personBox.y);
-            keypoint.prob = max_prob;
-            keypoints.push_back(keypoint);
-        }
-    }
-    return 0;
-}
-
 int CombinedPoseFace::detectFaces(const cv::Mat& rgb, std::vector<Object>& faceObjects,float &prob_threshold ,float &nms_threshold)
 {
     faceObjects.clear();
@@ -288,7 +217,7 @@ int CombinedPoseFace::detectFaces(const cv::Mat& rgb, std::vector<Object>& faceO
     ncnn::Mat input = preprocessImage_face(rgb, scale, wpad, hpad);
 
     input.substract_mean_normalize(mean_vals_3, norm_vals_3);
-    ncnn::Extractor ex = FaceNet.create_extractor();
+    ncnn::Extractor ex = FaceNet->net.create_extractor();
     ex.input("0", input);
     ncnn::Mat hm, hmPool, tlrb;
     //热力图，用于检测人脸中心位置
@@ -334,50 +263,26 @@ int CombinedPoseFace::load(AAssetManager* mgr, int modelid, int inputsize, bool
     //0 高效  2 性能
     ncnn::set_cpu_powersave(0);
     ncnn::set_omp_num_threads(ncnn::get_big_cpu_count());
-    PersonNet.opt = ncnn::Option();
-    PoseNet.opt = ncnn::Option();
-    FaceNet.opt = ncnn::Option();
-#if NCNN_VULKAN
-    PersonNet.opt.use_vulkan_compute = use_gpu;
-    PoseNet.opt.use_vulkan_compute = use_gpu;
-    FaceNet.opt.use_vulkan_compute = use_gpu;
-#endif
-    // 启用轻量模式，减少内存使用
-    PersonNet.opt.lightmode = true;
-    PoseNet.opt.lightmode = true;
-    FaceNet.opt.lightmode = true;
-
-    const char* modeltype_1 = "PersonDetector";
-    char parampath_1[256];
-    char modelpath_1[256];
-    sprintf(parampath_1, "%s.param", modeltype_1);
-    sprintf(modelpath_1, "%s.bin", modeltype_1);
-    PersonNet.load_param(mgr, parampath_1);
-    PersonNet.load_model(mgr, modelpath_1);
-
-    const char* modeltype_2 = "SimplePose";
-    char parampath_2[256];
-    char modelpath_2[256];
-    sprintf(parampath_2, "%s.param", modeltype_2);
-    sprintf(modelpath_2, "%s.bin", modeltype_2);
-    PoseNet.load_param(mgr, parampath_2);
-    PoseNet.load_model(mgr, modelpath_2);
-
-    const char* modeltype_3 = "DbFace";
-    char parampath_3[256];
-    char modelpath_3[256];
-    sprintf(parampath_3, "%s.param", modeltype_3);
-    sprintf(modelpath_3, "%s.bin", modeltype_3);
-    FaceNet.load_param(mgr, parampath_3);
-    FaceNet.load_model(mgr, modelpath_3);
+    // 与 SimplePose / DbFace 共用缓存中的同一组 Net
+    PersonNet = acquireNet(mgr, "PersonDetector", use_gpu);
+    PoseNet = acquireNet(mgr, "SimplePose", use_gpu);
+    FaceNet = acquireNet(mgr, "DbFace", use_gpu);
+    if (!PersonNet || !PoseNet || !FaceNet)
+        return -1;
     target_size = (inputsize == 0) ? 320 : 640;
     return 0;
 }
+void CombinedPoseFace::getWarmupTargets(std::vector<WarmupTarget>& targets) const
+{
+    addLetterboxWarmupTargets(targets, &PersonNet->net, "data", {"output"}, target_size);
+    addWarmupTarget(targets, &PoseNet->net, "data", {"hybridsequential0_conv7_fwd"}, pose_size_width, pose_size_height);
+    addLetterboxWarmupTargets(targets, &FaceNet->net, "0", {"hm", "pool_hm", "tlrb"}, target_size);
+}
 int CombinedPoseFace::detect(const cv::Mat& rgb, std::vector<Object>& objects)
 {
     float prob_threshold = g_threshold;
     float nms_threshold = g_nms;
-    double t3 = ncnn::get_current_time();
+    const int64_t t3 = trace_now_us();
     // 步骤1: 检测人体
     std::vector<cv::Rect> personBoxes;
     detectPersons(rgb, personBoxes,prob_threshold, nms_threshold);
@@ -386,6 +291,9 @@ int CombinedPoseFace::detect(const cv::Mat& rgb, std::vector<Object>& objects)
     detectFaces(rgb, faceObjects, prob_threshold, nms_threshold);
 
     // 将人体检测结果直接添加到objects
+    const size_t firstPerson = objects.size();
+    std::vector<cv::Rect> poseRois;
+    poseRois.reserve(personBoxes.size());
     for (const auto& personBox : personBoxes) {
         Object personObj;
         personObj.rect = personBox;
@@ -407,23 +315,26 @@ int CombinedPoseFace::detect(const cv::Mat& rgb, std::vector<Object>& objects)
         expandedBox.width = std::min(expandedBox.width, rgb.cols - expandedBox.x);
         expandedBox.height = std::min(expandedBox.height, rgb.rows - expandedBox.y);
 
-        // 确保ROI有效
-        if (expandedBox.width > 0 && expandedBox.height > 0) {
-            std::vector<PoseKeyPoint> keypoints;
-            detectPoseInPerson(rgb, expandedBox, keypoints, prob_threshold, nms_threshold);
-            personObj.keyPoints = keypoints; // 将姿态关键点添加到对应的人体对象中
-        }
+        // 无效 ROI 得到空的关键点
+        poseRois.push_back(expandedBox);
         objects.push_back(personObj);
     }
+    // 所有人体框一次批量估计关键点，添加到对应的人体对象中
+    const PoseNetConfig config = {pose_size_width, pose_size_height, ncnn::Mat::PIXEL_BGR2RGB, mean_vals_2, norm_vals_2,
+                                  "data", "hybridsequential0_conv7_fwd", 5, prob_threshold};
+    std::vector<std::vector<PoseKeyPoint> > keypoints;
+    detect_pose_batch(PoseNet->net, config, rgb, poseRois, keypoints);
+    for (size_t i = 0; i < poseRois.size(); i++)
+    {
+        objects[firstPerson + i].keyPoints.swap(keypoints[i]);
+    }
     // 将人脸检测结果直接追加到objects
     for (const auto& faceObj : faceObjects) {
         Object newFaceObj = faceObj;
         newFaceObj.label = 1; // face
         objects.push_back(newFaceObj);
     }
-    double t4 = ncnn::get_current_time();
-    std::lock_guard<std::mutex> lock(g_summary_mutex);
-    g_summary.inferTimeMs = (t4 - t3);
+    trace_record(TRACE_FORWARD, t3);
     return 0;
 }
 
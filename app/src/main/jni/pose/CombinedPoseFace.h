@@ -6,6 +6,7 @@
 
 #include "vision_base.h"
 #include "IYoloAlgo.h"
+#include "net_cache.h"
 #include "SimplePose.h"
 #include "DbFace.h"
 struct Box_ {
@@ -31,24 +32,23 @@ public:
     const char** getClassNames() const override { return class_names_; }
     int getClassCount() const override { return 2; }
     const unsigned char (*getColors() const)[3] override { return colors_; }
+    bool getMemoryStats(ModelMemoryStats& stats) const override { stats = netMemoryStats({PersonNet.get(), PoseNet.get(), FaceNet.get()}); return true; }
+    void getWarmupTargets(std::vector<WarmupTarget>& targets) const override;
 
 private:
-    ncnn::Net PersonNet;
-    ncnn::Net PoseNet;
-    ncnn::Net FaceNet;
+    std::shared_ptr<CachedNet> PersonNet;
+    std::shared_ptr<CachedNet> PoseNet;
+    std::shared_ptr<CachedNet> FaceNet;
     int target_size;
-    inline float fast_exp(float x);
     inline float myExp(float v);
-    // 三个独立的检测步骤
+    // 人体 / 人脸检测步骤（姿态见 pose_batch.h）
     int detectPersons(const cv::Mat& rgb, std::vector<cv::Rect>& personBoxes,float &prob_threshold ,float &nms_threshold);
-    int detectPoseInPerson(const cv::Mat& rgb, const cv::Rect& personBox, std::vector<PoseKeyPoint>& keypoints,float &prob_threshold ,float &nms_threshold);
     int detectFaces(const cv::Mat& rgb, std::vector<Object>& faceObjects,float &prob_threshold ,float &nms_threshold);
     ncnn::Mat preprocessImage(const cv::Mat& rgb, float& scale, int& wpad, int& hpad);
     ncnn::Mat preprocessImage_face(const cv::Mat& rgb, float& scale, int& wpad, int& hpad);
     void genIds(ncnn::Mat hm, ncnn::Mat hmPool, int w, double thresh, std::vector<Id_> &ids);
     void decode(int w, std::vector<Id_> ids, ncnn::Mat tlrb, std::vector<Obj_> &objs);
-    std::vector<Obj_> nms(std::vector<Obj_> objs, float iou);
-    float getIou(Box a, Box b);
+    std::vector<Obj_> nms(const std::vector<Obj_>& objs, float iou);
 
     static const char* class_names_[2];
     static const unsigned char colors_[10][3];
@@ -1,5 +1,7 @@
 #include "DbFace.h"
+#include "trace.h"
 #include "layer.h"
+#include "postprocess.h"
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include <float.h>
@@ -23,7 +25,6 @@ const unsigned char DbFace::colors_[10][3] = {
 DbFace::DbFace(){}
 DbFace::~DbFace()
 {
-    FaceNet.clear();
 }
 void DbFace::genIds(ncnn::Mat hm, ncnn::Mat hmPool, int w, double thresh, std::vector<Id> &ids) {
     const float *ptr = hm.channel(0);
@@ -42,14 +43,6 @@ void DbFace::genIds(ncnn::Mat hm, ncnn::Mat hmPool, int w, double thresh, std::v
         }
     }
 }
-inline float DbFace::fast_exp(float x) {
-    union {
-        uint32_t i;
-        float f;
-    } v{};
-    v.i = (1 << 23) * (1.4426950409 * x + 126.93490512f);
-    return v.f;
-}
 inline float DbFace::myExp(float v) {
     float gate = 1;
     float base = exp(1);
@@ -62,21 +55,6 @@ inline float DbFace::myExp(float v) {
         return -fast_exp(-v);
     }
 }
-float DbFace::getIou(Box a, Box b) {
-    float aArea = (a.r - a.x + 1) * (a.b - a.y + 1);
-    float bArea = (b.r - b.x + 1) * (b.b - b.y + 1);
-
-    float x1 = a.x > b.x ? a.x : b.x;
-    float y1 = a.y > b.y ? a.y : b.y;
-    float x2 = a.r < b.r ? a.r : b.r;
-    float y2 = a.b < b.b ? a.b : b.b;
-    float w = 0.0f > x2 - x1 + 1 ? 0.0f : x2 - x1 + 1;
-    float h = 0.0f > y2 - y1 + 1 ? 0.0f : y2 - y1 + 1;
-    float area = w * h;
-
-    float iou = area / (aArea + bArea - area);
-    return iou;
-}
 void DbFace::decode(int w, std::vector<Id> ids, ncnn::Mat tlrb, ncnn::Mat landmark, std::vector<Obj> &objs) {
     for (int i = 0; i < ids.size(); i++) {
         Obj objTemp;
@@ -118,48 +96,44 @@ void DbFace::decode(int w, std::vector<Id> ids, ncnn::Mat tlrb, ncnn::Mat landma
         objs.push_back(objTemp);
     }
 }
-std::vector<Obj> DbFace::nms(std::vector<Obj> objs, float iou) {
-    if (objs.size() == 0) {
-        return objs;
-    }
-    sort(objs.begin(), objs.end(), [](Obj a, Obj b) { return a.score < b.score; });
+std::vector<Obj> DbFace::nms(const std::vector<Obj>& objs, float iou) {
     std::vector<Obj> keep;
-    int *flag = new int[objs.size()]();
-    for (int i = 0; i < objs.size(); i++) {
-        if (flag[i] != 0) {
+    if (objs.empty()) {
+        return keep;
+    }
+    // 按置信度从高到低排序（只排下标，避免拷贝关键点）
+    std::vector<int> order(objs.size());
+    for (int i = 0; i < (int)order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&objs](int a, int b) { return objs[a].score > objs[b].score; });
+    // 框坐标为含端点的像素坐标，右下角 +1 后按普通 IoU 计算
+    BoxSoA kept;
+    kept.reserve(objs.size());
+    for (int idx : order) {
+        const Box& b = objs[idx].box;
+        if (kept.overlaps(b.x, b.y, b.r + 1, b.b + 1, iou)) {
             continue;
         }
-        keep.push_back(objs[i]);
-        for (int j = i + 1; j < objs.size(); j++) {
-            if (flag[j] == 0 && getIou(objs[i].box, objs[j].box) > iou) {
-                flag[j] = 1;
-            }
-        }
+        kept.push(b.x, b.y, b.r + 1, b.b + 1);
+        keep.push_back(objs[idx]);
     }
-    delete[] flag;
     return keep;
 }
 int DbFace::load(AAssetManager* mgr,  int modelid, int inputsize,bool use_gpu)
 {
     ncnn::set_cpu_powersave(0);
     ncnn::set_omp_num_threads(ncnn::get_big_cpu_count());
-    FaceNet.opt = ncnn::Option();
-#if NCNN_VULKAN
-    FaceNet.opt.use_vulkan_compute = use_gpu;
-#endif
-    // 启用轻量模式，减少内存使用
-    FaceNet.opt.lightmode = true;
-
-    const char* modeltype = "DbFace";
-    char parampath[256];
-    char modelpath[256];
-    sprintf(parampath, "%s.param", modeltype);
-    sprintf(modelpath, "%s.bin", modeltype);
-    FaceNet.load_param(mgr, parampath);
-    FaceNet.load_model(mgr, modelpath);
+    FaceNet = acquireNet(mgr, "DbFace", use_gpu);
+    if (!FaceNet)
+        return -1;
     target_size = (inputsize == 0) ? 320 : 640;
     return 0;
 }
+void DbFace::getWarmupTargets(std::vector<WarmupTarget>& targets) const
+{
+    addLetterboxWarmupTargets(targets, &FaceNet->net, "0", {"landmark", "hm", "pool_hm", "tlrb"}, target_size);
+}
 ncnn::Mat DbFace::preprocessImage(const cv::Mat& rgb, float& scale, int& wpad, int& hpad)
 {
     int width = rgb.cols;
@@ -199,8 +173,8 @@ int DbFace::detect(const cv::Mat& rgb, std::vector<Object>& objects)
     int wpad, hpad;
     ncnn::Mat in_pad = preprocessImage(rgb, scale, wpad, hpad);
     in_pad.substract_mean_normalize(mean_vals, norm_vals);
-    double t3 = ncnn::get_current_time();
-    ncnn::Extractor ex = FaceNet.create_extractor();
+    const int64_t t3 = trace_now_us();
+    ncnn::Extractor ex = FaceNet->net.create_extractor();
     ex.input("0", in_pad);
     ncnn::Mat landmark, hm, hmPool, tlrb;
     ex.extract("landmark", landmark);
@@ -251,8 +225,6 @@ int DbFace::detect(const cv::Mat& rgb, std::vector<Object>& objects)
         object.Face_keyPoints = restored_keypoints;
         objects.push_back(object);
     }
-    double t4 = ncnn::get_current_time();
-    std::lock_guard<std::mutex> lock(g_summary_mutex);
-    g_summary.inferTimeMs = (t4 - t3); // 单位：秒
+    trace_record(TRACE_FORWARD, t3);
     return 0;
 }
\ No newline at end of file
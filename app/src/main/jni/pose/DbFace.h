@@ -6,6 +6,7 @@
 
 #include "vision_base.h"
 #include "IYoloAlgo.h"
+#include "net_cache.h"
 
 struct Box {
     float x, y, r, b;
@@ -31,8 +32,10 @@ public:
     const char** getClassNames() const override { return class_names_; }
     int getClassCount() const override { return 1; }
     const unsigned char (*getColors() const)[3] override { return colors_; }
+    bool getMemoryStats(ModelMemoryStats& stats) const override { stats = netMemoryStats({FaceNet.get()}); return true; }
+    void getWarmupTargets(std::vector<WarmupTarget>& targets) const override;
 private:
-    ncnn::Net FaceNet;
+    std::shared_ptr<CachedNet> FaceNet;
     int target_size;
     float STRIDE = 4;
     static const char* class_names_[1];
@@ -43,8 +46,6 @@ private:
     void genIds(ncnn::Mat hm, ncnn::Mat hmPool, int w, double thresh, std::vector<Id> &ids);
     void decode(int w, std::vector<Id> ids, ncnn::Mat tlrb, ncnn::Mat landmark, std::vector<Obj> &objs);
     inline float myExp(float v);
-    std::vector<Obj> nms(std::vector<Obj> objs, float iou);
-    inline float fast_exp(float x);
-    float getIou(Box a, Box b);
+    std::vector<Obj> nms(const std::vector<Obj>& objs, float iou);
 };
 #endif // DBFACE_H
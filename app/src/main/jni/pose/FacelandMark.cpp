@@ -12,6 +12,7 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 #include "FacelandMark.h"
+#include "trace.h"
 #include "layer.h"
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
@@ -37,8 +38,6 @@ FacelandMark::FacelandMark()
 {}
 FacelandMark::~FacelandMark()
 {
-    FaceNet.clear();
-    LandmarkNet.clear();
 }
 int FacelandMark::runlandmark(cv::Mat &roi, int face_size_w, int face_size_h, std::vector<FaceKeyPoint> &keypoints,
                         float x1, float y1) {
@@ -48,7 +47,7 @@ int FacelandMark::runlandmark(cv::Mat &roi, int face_size_w, int face_size_h, st
                                                  roi.cols, roi.rows, face_size_w, face_size_h);
     //数据预处理
     in.substract_mean_normalize(mean_val, norm_val);
-    auto ex = LandmarkNet.create_extractor();
+    auto ex = LandmarkNet->net.create_extractor();
     ex.input("data", in);
     ncnn::Mat out;
     ex.extract("bn6_3_bn6_3_scale", out);
@@ -81,33 +80,17 @@ int FacelandMark::load(AAssetManager* mgr,  int modelid, int inputsize,bool use_
 {
     ncnn::set_cpu_powersave(0);
     ncnn::set_omp_num_threads(ncnn::get_big_cpu_count());
-    FaceNet.opt = ncnn::Option();
-    LandmarkNet.opt = ncnn::Option();
-#if NCNN_VULKAN
-    FaceNet.opt.use_vulkan_compute = use_gpu;
-    LandmarkNet.opt.use_vulkan_compute = use_gpu;
-#endif
-    // 启用轻量模式，减少内存使用
-    FaceNet.opt.lightmode = true;
-    LandmarkNet.opt.lightmode = true;
-
-    const char* modeltype = "YoloFace-500k";
-    char parampath[256];
-    char modelpath[256];
-    sprintf(parampath, "%s.param", modeltype);
-    sprintf(modelpath, "%s.bin", modeltype);
-    FaceNet.load_param(mgr, parampath);
-    FaceNet.load_model(mgr, modelpath);
-
-    const char* modeltype_ = "LandMark106";
-    char parampath_[256];
-    char modelpath_[256];
-    sprintf(parampath_, "%s.param", modeltype_);
-    sprintf(modelpath_, "%s.bin", modeltype_);
-    LandmarkNet.load_param(mgr, parampath_);
-    LandmarkNet.load_model(mgr, modelpath_);
+    FaceNet = acquireNet(mgr, "YoloFace-500k", use_gpu);
+    LandmarkNet = acquireNet(mgr, "LandMark106", use_gpu);
+    if (!FaceNet || !LandmarkNet)
+        return -1;
     return 0;
 }
+void FacelandMark::getWarmupTargets(std::vector<WarmupTarget>& targets) const
+{
+    addWarmupTarget(targets, &FaceNet->net, "data", {"output"}, detector_size_width, detector_size_height);
+    addWarmupTarget(targets, &LandmarkNet->net, "data", {"bn6_3_bn6_3_scale"}, landmark_size_width, landmark_size_height);
+}
 int FacelandMark::detect(const cv::Mat& rgb, std::vector<Object>& objects)
 {
     float prob_threshold =g_threshold;
@@ -117,8 +100,8 @@ int FacelandMark::detect(const cv::Mat& rgb, std::vector<Object>& objects)
     ncnn::Mat in = ncnn::Mat::from_pixels_resize(rgb.data, ncnn::Mat::PIXEL_RGB,\
                                                  width, height, detector_size_width, detector_size_height);
     in.substract_mean_normalize(mean_vals, norm_vals);
-    double t3 = ncnn::get_current_time();
-    ncnn::Extractor ex = FaceNet.create_extractor();
+    const int64_t t3 = trace_now_us();
+    ncnn::Extractor ex = FaceNet->net.create_extractor();
     ex.set_light_mode(true);
     ex.input("data", in);
     ncnn::Mat out;
@@ -167,8 +150,6 @@ int FacelandMark::detect(const cv::Mat& rgb, std::vector<Object>& objects)
         }
         objects.push_back(obj);
     }
-    double t4 = ncnn::get_current_time();
-    std::lock_guard<std::mutex> lock(g_summary_mutex);
-    g_summary.inferTimeMs = (t4 - t3); // 单位：秒
+    trace_record(TRACE_FORWARD, t3);
     return 0;
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 
 #include "vision_base.h"
 #include "IYoloAlgo.h"
+#include "net_cache.h"
 //if (landmark_id >= 0 && landmark_id <= 31) return "contour";
 //if (landmark_id >= 32 && landmark_id <= 51) return "eyebrow";
 //if (landmark_id >= 52 && landmark_id <= 71) return "nose";
@@ -21,12 +22,14 @@ public:
     const char** getClassNames() const override { return class_names_; }
     int getClassCount() const override { return 1; }
     const unsigned char (*getColors() const)[3] override { return colors_; }
+    bool getMemoryStats(ModelMemoryStats& stats) const override { stats = netMemoryStats({FaceNet.get(), LandmarkNet.get()}); return true; }
+    void getWarmupTargets(std::vector<WarmupTarget>& targets) const override;
 private:
     int runlandmark(cv::Mat &roi, int face_size_w, int face_size_h,
                     std::vector<FaceKeyPoint> &keypoints,
                     float x1, float y1);
-    ncnn::Net FaceNet;
-    ncnn::Net LandmarkNet;
+    std::shared_ptr<CachedNet> FaceNet;
+    std::shared_ptr<CachedNet> LandmarkNet;
     int target_size;
     static const char* class_names_[1];
     static const unsigned char colors_[10][3];
@@ -12,7 +12,8 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 #include "SimplePose.h"
-#include "layer.h"
+#include "trace.h"
+#include "pose_batch.h"
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include <float.h>
@@ -36,81 +37,24 @@ const unsigned char SimplePose::colors_[10][3] = {
 SimplePose::SimplePose(){}
 SimplePose::~SimplePose()
 {
-    PersonNet.clear();
-    PoseNet.clear();
-}
-int SimplePose::runpose(cv::Mat &roi, int pose_size_w, int pose_size_h, std::vector<PoseKeyPoint> &keypoints,
-                        float x1, float y1) {
-    int w = roi.cols;
-    int h = roi.rows;
-    ncnn::Mat in = ncnn::Mat::from_pixels_resize(roi.data, ncnn::Mat::PIXEL_RGB, \
-                                                 roi.cols, roi.rows, pose_size_w, pose_size_h);
-    //数据预处理
-    in.substract_mean_normalize(mean_val, norm_val);
-    auto ex = PoseNet.create_extractor();
-    ex.input("data", in);
-    ncnn::Mat out;
-    ex.extract("hybridsequential0_conv7_fwd", out);
-    keypoints.clear();
-    for (int p = 0; p < out.c; p++) {
-        if (p < 5) {
-            continue;
-        }
-        const ncnn::Mat m = out.channel(p);
-        float max_prob = 0.f;
-        int max_x = 0;
-        int max_y = 0;
-        for (int y = 0; y < out.h; y++) {
-
-            const float *ptr = m.row(y);
-            for (int x = 0; x < out.w; x++) {
-                float prob = ptr[x];
-                if (prob > max_prob) {
-                    max_prob = prob;
-                    max_x = x;
-                    max_y = y;
-                }
-            }
-        }
-        float kp_x = max_x * w / (float) out.w + x1;
-        float kp_y = max_y * h / (float) out.h + y1;
-        PoseKeyPoint keypoint;
-        keypoint.p = cv::Point2f(kp_x, kp_y);
-        keypoint.prob = max_prob;
-        keypoints.push_back(keypoint);
-    }
-    return 0;
 }
 int SimplePose::load(AAssetManager* mgr,  int modelid, int inputsize,bool use_gpu)
 {
     ncnn::set_cpu_powersave(0);
     ncnn::set_omp_num_threads(ncnn::get_big_cpu_count());
-    PersonNet.opt = ncnn::Option();
-    PoseNet.opt = ncnn::Option();
-#if NCNN_VULKAN
-    PersonNet.opt.use_vulkan_compute = use_gpu;
-    PoseNet.opt.use_vulkan_compute = use_gpu;
-#endif
-    PersonNet.opt.lightmode = true;
-    PoseNet.opt.lightmode = true;
-    const char* modeltype = "PersonDetector";
-    char parampath[256];
-    char modelpath[256];
-    sprintf(parampath, "%s.param", modeltype);
-    sprintf(modelpath, "%s.bin", modeltype);
-    PersonNet.load_param(mgr, parampath);
-    PersonNet.load_model(mgr, modelpath);
-
-    const char* modeltype_ = "SimplePose";
-    char parampath_[256];
-    char modelpath_[256];
-    sprintf(parampath_, "%s.param", modeltype_);
-    sprintf(modelpath_, "%s.bin", modeltype_);
-    PoseNet.load_param(mgr, parampath_);
-    PoseNet.load_model(mgr, modelpath_);
+    PersonNet = acquireNet(mgr, "PersonDetector", use_gpu);
+    PoseNet = acquireNet(mgr, "SimplePose", use_gpu);
+    if (!PersonNet || !PoseNet)
+        return -1;
     target_size = (inputsize == 0) ? 320 : 640;
     return 0;
 }
+void SimplePose::getWarmupTargets(std::vector<WarmupTarget>& targets) const
+{
+    addLetterboxWarmupTargets(targets, &PersonNet->net, "data", {"output"}, target_size);
+    // 姿态网络输入为固定尺寸的人体裁剪
+    addWarmupTarget(targets, &PoseNet->net, "data", {"hybridsequential0_conv7_fwd"}, pose_size_width, pose_size_height);
+}
 // 图像预处理函数：缩放和填充到32的倍数
 ncnn::Mat SimplePose::preprocessImage(const cv::Mat& rgb, float& scale, int& wpad, int& hpad)
 {
@@ -151,11 +95,14 @@ int SimplePose::detect(const cv::Mat& rgb, std::vector<Object>& objects)
     int wpad, hpad;
     ncnn::Mat in_pad = preprocessImage(rgb, scale, wpad, hpad);
     in_pad.substract_mean_normalize(mean_vals, norm_vals);
-    double t3 = ncnn::get_current_time();
-    ncnn::Extractor ex = PersonNet.create_extractor();
+    const int64_t t3 = trace_now_us();
+    ncnn::Extractor ex = PersonNet->net.create_extractor();
     ex.input("data", in_pad);
     ncnn::Mat out;
     ex.extract("output", out);
+    const size_t first = objects.size();
+    std::vector<cv::Rect> rois;
+    rois.reserve(out.h);
     for (int i = 0; i < out.h; i++) {
         Object obj;
         float x1, y1, x2, y2, score, label;
@@ -195,17 +142,22 @@ int SimplePose::detect(const cv::Mat& rgb, std::vector<Object>& objects)
         y1 = std::max(std::min(y1, (float)(height - 1)), 0.f);
         x2 = std::max(std::min(x2, (float)(width - 1)), 0.f);
         y2 = std::max(std::min(y2, (float)(height - 1)), 0.f);
-        cv::Mat roi = rgb(cv::Rect(x1, y1, x2 - x1, y2 - y1)).clone();
-        std::vector<PoseKeyPoint> keypoints;
-        runpose(roi, pose_size_width, pose_size_height, keypoints, x1, y1);
+        rois.push_back(cv::Rect(x1, y1, x2 - x1, y2 - y1));
 
         obj.label = label;
         obj.prob = score;
-        obj.keyPoints = keypoints;
         objects.push_back(obj);
     }
-    double t4 = ncnn::get_current_time();
-    std::lock_guard<std::mutex> lock(g_summary_mutex);
-    g_summary.inferTimeMs = (t4 - t3); // 单位：秒
+
+    // 所有人体框一次批量估计关键点
+    const PoseNetConfig config = {pose_size_width, pose_size_height, ncnn::Mat::PIXEL_RGB, mean_val, norm_val,
+                                  "data", "hybridsequential0_conv7_fwd", 5, 0.f};
+    std::vector<std::vector<PoseKeyPoint> > keypoints;
+    detect_pose_batch(PoseNet->net, config, rgb, rois, keypoints);
+    for (size_t i = 0; i < rois.size(); i++)
+    {
+        objects[first + i].keyPoints.swap(keypoints[i]);
+    }
+    trace_record(TRACE_FORWARD, t3);
     return 0;
 }
\ No newline at end of file
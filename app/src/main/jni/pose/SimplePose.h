@@ -6,6 +6,7 @@
 
 #include "vision_base.h"
 #include "IYoloAlgo.h"
+#include "net_cache.h"
 // 人体姿态关键点定义：
 // 0 nose, 1 left_eye, 2 right_eye, 3 left_Ear, 4 right_Ear (面部关键点 - 过滤掉)
 // 5 left_Shoulder, 6 right_Shoulder, 7 left_Elbow, 8 right_Elbow, 9 left_Wrist, 10 right_Wrist
@@ -20,12 +21,11 @@ public:
     const char** getClassNames() const override { return class_names_; }
     int getClassCount() const override { return 2; }
     const unsigned char (*getColors() const)[3] override { return colors_; }
+    bool getMemoryStats(ModelMemoryStats& stats) const override { stats = netMemoryStats({PersonNet.get(), PoseNet.get()}); return true; }
+    void getWarmupTargets(std::vector<WarmupTarget>& targets) const override;
 private:
-    int runpose(cv::Mat &roi, int pose_size_width, int pose_size_height,
-                std::vector<PoseKeyPoint> &keypoints,
-                float x1, float y1);
-    ncnn::Net PersonNet;
-    ncnn::Net PoseNet;
+    std::shared_ptr<CachedNet> PersonNet;
+    std::shared_ptr<CachedNet> PoseNet;
     int target_size;
     static const char* class_names_[2];
     static const unsigned char colors_[10][3];
@@ -0,0 +1,82 @@
+#include "pose_batch.h"
+
+#include <stdint.h>
+
+#include "batch_infer.h"
+#include "postprocess.h"
+
+// 单个人体：缩放后的像素 -> 推理 -> 每个热力图通道取最大值位置
+static int detect_pose_one(const ncnn::Net& net, const PoseNetConfig& config, const cv::Mat& rgb,
+                           const cv::Rect& roi, unsigned char* pixels, int num_threads,
+                           std::vector<PoseKeyPoint>& keypoints)
+{
+    keypoints.clear();
+    if (roi.area() <= 0)
+        return 0;
+
+    // ROI 直接从原图按行跨度缩放到网络输入尺寸
+    const unsigned char* src = rgb.ptr<unsigned char>(roi.y) + roi.x * 3;
+    ncnn::resize_bilinear_c3(src, roi.width, roi.height, (int)rgb.step, pixels,
+                             config.input_w, config.input_h, config.input_w * 3);
+
+    ncnn::Mat in = ncnn::Mat::from_pixels(pixels, config.pixel_type, config.input_w, config.input_h);
+    in.substract_mean_normalize(config.mean_vals, config.norm_vals);
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.set_num_threads(num_threads);
+    ex.input(config.input_name, in);
+    ncnn::Mat out;
+    int ret = ex.extract(config.output_name, out);
+    if (ret != 0)
+        return ret;
+
+    // 每个通道整张热力图连续存放，向量化 argmax；最大值不为正时与逐点 ">" 比较一致，取 (0, 0) 且置信度为 0
+    const int plane = out.w * out.h;
+    for (int p = config.skip_channels; p < out.c; p++)
+    {
+        float max_prob = 0.f;
+        int idx = argmax(out.channel(p), plane, &max_prob);
+        if (max_prob <= 0.f)
+        {
+            max_prob = 0.f;
+            idx = 0;
+        }
+        if (max_prob < config.min_prob)
+            continue;
+
+        PoseKeyPoint keypoint;
+        keypoint.p = cv::Point2f((idx % out.w) * roi.width / (float)out.w + roi.x,
+                                 (idx / out.w) * roi.height / (float)out.h + roi.y);
+        keypoint.prob = max_prob;
+        keypoints.push_back(keypoint);
+    }
+    return 0;
+}
+
+int detect_pose_batch(const ncnn::Net& net, const PoseNetConfig& config, const cv::Mat& rgb,
+                      const std::vector<cv::Rect>& rois, std::vector<std::vector<PoseKeyPoint> >& keypoints)
+{
+    const int n = rois.size();
+    keypoints.resize(n);
+    if (n == 0)
+        return 0;
+
+    // 所有人体的缩放像素放在同一块缓冲里，按线程复用，稳定后不再分配
+    static thread_local std::vector<unsigned char> pixels;
+    const size_t crop_size = (size_t)config.input_w * config.input_h * 3;
+    if (pixels.size() < crop_size * n)
+        pixels.resize(crop_size * n);
+
+    const BatchPlan plan = plan_batch(n);
+    std::vector<int> rets(n, 0);
+    unsigned char* base = pixels.data();
+    run_batch(n, plan, [&](int i) {
+        rets[i] = detect_pose_one(net, config, rgb, rois[i], base + crop_size * i, plan.threads_per_extractor, keypoints[i]);
+    });
+    for (int ret : rets)
+    {
+        if (ret != 0)
+            return ret;
+    }
+    return 0;
+}
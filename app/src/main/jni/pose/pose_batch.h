@@ -0,0 +1,36 @@
+#ifndef POSE_BATCH_H
+#define POSE_BATCH_H
+
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <net.h>
+
+#include "vision_base.h"
+
+// =============================
+// 自顶向下姿态估计：所有人体框一次批量处理
+// =============================
+//
+// 各人体 ROI 直接从原图双线性缩放进同一块复用的像素缓冲（不再 clone ROI），
+// 按 plan_batch 在多个 Extractor 上并发推理，热力图 argmax 也在各自的线程里完成。
+// 姿态网络输入固定为单张 3 通道图，无法在 ncnn 中堆叠成 batch 维，因此以并发 Extractor 代替。
+
+struct PoseNetConfig
+{
+    int input_w;                // 网络输入宽高
+    int input_h;
+    int pixel_type;             // ncnn::Mat::PIXEL_*，原图像素格式到网络输入的转换
+    const float* mean_vals;
+    const float* norm_vals;
+    const char* input_name;
+    const char* output_name;
+    int skip_channels;          // 跳过的前若干个热力图通道（面部关键点）
+    float min_prob;             // 低于该置信度的关键点丢弃
+};
+
+// 对 rgb 中的每个 rois[i]（已裁剪到图像内）估计关键点（原图坐标）写入 keypoints[i]，空 ROI 得到空结果
+int detect_pose_batch(const ncnn::Net& net, const PoseNetConfig& config, const cv::Mat& rgb,
+                      const std::vector<cv::Rect>& rois, std::vector<std::vector<PoseKeyPoint> >& keypoints);
+
+#endif // POSE_BATCH_H
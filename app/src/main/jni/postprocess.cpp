@@ -0,0 +1,62 @@
+#include "postprocess.h"
+
+// =============================
+// 排序 / NMS
+// =============================
+
+static void qsort_descent_inplace(std::vector<Object>& objects, int left, int right)
+{
+    int i = left;
+    int j = right;
+    float p = objects[(left + right) / 2].prob;
+
+    while (i <= j)
+    {
+        while (objects[i].prob > p)
+            i++;
+
+        while (objects[j].prob < p)
+            j--;
+
+        if (i <= j)
+        {
+            // swap
+            std::swap(objects[i], objects[j]);
+
+            i++;
+            j--;
+        }
+    }
+
+    if (left < j) qsort_descent_inplace(objects, left, j);
+    if (i < right) qsort_descent_inplace(objects, i, right);
+}
+
+void qsort_descent_inplace(std::vector<Object>& objects)
+{
+    if (objects.empty())
+        return;
+
+    qsort_descent_inplace(objects, 0, objects.size() - 1);
+}
+
+void nms_sorted_bboxes(const std::vector<Object>& objects, std::vector<int>& picked, float nms_threshold)
+{
+    picked.clear();
+
+    const int n = objects.size();
+
+    BoxSoA kept;
+    kept.reserve(n);
+    for (int i = 0; i < n; i++)
+    {
+        const cv::Rect_<float>& r = objects[i].rect;
+        const float x1 = r.x + r.width;
+        const float y1 = r.y + r.height;
+        if (kept.overlaps(r.x, r.y, x1, y1, nms_threshold))
+            continue;
+
+        kept.push(r.x, r.y, x1, y1);
+        picked.push_back(i);
+    }
+}
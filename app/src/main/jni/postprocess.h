@@ -0,0 +1,22 @@
+#ifndef POSTPROCESS_H
+#define POSTPROCESS_H
+
+#include <vector>
+
+#include "vision_base.h"
+#include "postprocess_kernels.h"
+
+// =============================
+// 检测后处理公共函数（各算法共用）
+// =============================
+//
+// 各模型的 sigmoid / 排序 / NMS / 网格生成统一放在这里；
+// 只操作 float 数组的数值内核在 postprocess_kernels.h，这里是基于 Object 的排序与 NMS
+
+// 按置信度从高到低原地排序
+void qsort_descent_inplace(std::vector<Object>& objects);
+
+// 对已排序的候选框做贪心 NMS，picked 为保留下标
+void nms_sorted_bboxes(const std::vector<Object>& objects, std::vector<int>& picked, float nms_threshold);
+
+#endif // POSTPROCESS_H
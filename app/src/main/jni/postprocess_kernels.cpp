@@ -0,0 +1,522 @@
+#include "postprocess_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <float.h>
+#include <list>
+#include <mutex>
+
+#if __ARM_NEON
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// =============================
+// 向量化 exp（Cephes 多项式，与 expf 误差 < 2 ulp 量级）
+// =============================
+
+#if __ARM_NEON
+static inline float32x4_t exp_ps(float32x4_t x)
+{
+    x = vminq_f32(x, vdupq_n_f32(88.3762626647949f));
+    x = vmaxq_f32(x, vdupq_n_f32(-88.3762626647949f));
+
+    // n = floor(x * log2(e) + 0.5)
+    float32x4_t fx = vmlaq_f32(vdupq_n_f32(0.5f), x, vdupq_n_f32(1.44269504088896341f));
+    float32x4_t tmp = vcvtq_f32_s32(vcvtq_s32_f32(fx));
+    uint32x4_t mask = vcgtq_f32(tmp, fx);
+    mask = vandq_u32(mask, vreinterpretq_u32_f32(vdupq_n_f32(1.f)));
+    fx = vsubq_f32(tmp, vreinterpretq_f32_u32(mask));
+
+    // x = x - n * ln2
+    x = vmlsq_f32(x, fx, vdupq_n_f32(0.693359375f));
+    x = vmlsq_f32(x, fx, vdupq_n_f32(-2.12194440e-4f));
+
+    float32x4_t y = vdupq_n_f32(1.9875691500E-4f);
+    y = vmlaq_f32(vdupq_n_f32(1.3981999507E-3f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(8.3334519073E-3f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(4.1665795894E-2f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(1.6666665459E-1f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(5.0000001201E-1f), y, x);
+    y = vmlaq_f32(x, y, vmulq_f32(x, x));
+    y = vaddq_f32(y, vdupq_n_f32(1.f));
+
+    // 2^n
+    int32x4_t mm = vcvtq_s32_f32(fx);
+    mm = vaddq_s32(mm, vdupq_n_s32(0x7f));
+    mm = vshlq_n_s32(mm, 23);
+    return vmulq_f32(y, vreinterpretq_f32_s32(mm));
+}
+
+static inline float reduce_max_ps(float32x4_t v)
+{
+#if __aarch64__
+    return vmaxvq_f32(v);
+#else
+    float32x2_t m = vpmax_f32(vget_low_f32(v), vget_high_f32(v));
+    m = vpmax_f32(m, m);
+    return vget_lane_f32(m, 0);
+#endif
+}
+
+static inline float reduce_sum_ps(float32x4_t v)
+{
+#if __aarch64__
+    return vaddvq_f32(v);
+#else
+    float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    s = vpadd_f32(s, s);
+    return vget_lane_f32(s, 0);
+#endif
+}
+static inline bool any_lane_ps(uint32x4_t m)
+{
+#if __aarch64__
+    return vmaxvq_u32(m) != 0;
+#else
+    uint32x2_t r = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+    return (vget_lane_u32(r, 0) | vget_lane_u32(r, 1)) != 0;
+#endif
+}
+
+static inline float32x4_t div_ps(float32x4_t a, float32x4_t b)
+{
+#if __aarch64__
+    return vdivq_f32(a, b);
+#else
+    // 倒数估计 + 两次牛顿迭代
+    float32x4_t r = vrecpeq_f32(b);
+    r = vmulq_f32(vrecpsq_f32(b, r), r);
+    r = vmulq_f32(vrecpsq_f32(b, r), r);
+    return vmulq_f32(a, r);
+#endif
+}
+#elif defined(__SSE2__)
+static inline __m128 exp_ps(__m128 x)
+{
+    const __m128 one = _mm_set1_ps(1.f);
+
+    x = _mm_min_ps(x, _mm_set1_ps(88.3762626647949f));
+    x = _mm_max_ps(x, _mm_set1_ps(-88.3762626647949f));
+
+    // n = floor(x * log2(e) + 0.5)
+    __m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+    __m128 tmp = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+    __m128 mask = _mm_and_ps(_mm_cmpgt_ps(tmp, fx), one);
+    fx = _mm_sub_ps(tmp, mask);
+
+    // x = x - n * ln2
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+
+    __m128 y = _mm_set1_ps(1.9875691500E-4f);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507E-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073E-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894E-2f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459E-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201E-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, _mm_mul_ps(x, x)), x);
+    y = _mm_add_ps(y, one);
+
+    // 2^n
+    __m128i mm = _mm_cvttps_epi32(fx);
+    mm = _mm_add_epi32(mm, _mm_set1_epi32(0x7f));
+    mm = _mm_slli_epi32(mm, 23);
+    return _mm_mul_ps(y, _mm_castsi128_ps(mm));
+}
+
+static inline float reduce_max_ps(__m128 v)
+{
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+static inline float reduce_sum_ps(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+#endif
+
+// =============================
+// DFL 框解码
+// =============================
+
+// 单条边：softmax 原地写回，返回期望值 sum(l * p[l])
+static float dfl_side(float* p, int reg_max)
+{
+    int l = 0;
+    float max_val = -FLT_MAX;
+#if __ARM_NEON
+    if (reg_max >= 4)
+    {
+        float32x4_t _max = vdupq_n_f32(-FLT_MAX);
+        for (; l + 3 < reg_max; l += 4)
+        {
+            _max = vmaxq_f32(_max, vld1q_f32(p + l));
+        }
+        max_val = reduce_max_ps(_max);
+    }
+#elif defined(__SSE2__)
+    if (reg_max >= 4)
+    {
+        __m128 _max = _mm_set1_ps(-FLT_MAX);
+        for (; l + 3 < reg_max; l += 4)
+        {
+            _max = _mm_max_ps(_max, _mm_loadu_ps(p + l));
+        }
+        max_val = reduce_max_ps(_max);
+    }
+#endif
+    for (; l < reg_max; l++)
+    {
+        max_val = std::max(max_val, p[l]);
+    }
+
+    float sum = 0.f;
+    float dot = 0.f;
+    l = 0;
+#if __ARM_NEON
+    {
+        const float32x4_t _max = vdupq_n_f32(max_val);
+        float32x4_t _sum = vdupq_n_f32(0.f);
+        float32x4_t _dot = vdupq_n_f32(0.f);
+        float32x4_t _idx = {0.f, 1.f, 2.f, 3.f};
+        const float32x4_t _four = vdupq_n_f32(4.f);
+        for (; l + 3 < reg_max; l += 4)
+        {
+            float32x4_t _e = exp_ps(vsubq_f32(vld1q_f32(p + l), _max));
+            vst1q_f32(p + l, _e);
+            _sum = vaddq_f32(_sum, _e);
+            _dot = vmlaq_f32(_dot, _e, _idx);
+            _idx = vaddq_f32(_idx, _four);
+        }
+        sum = reduce_sum_ps(_sum);
+        dot = reduce_sum_ps(_dot);
+    }
+#elif defined(__SSE2__)
+    {
+        const __m128 _max = _mm_set1_ps(max_val);
+        __m128 _sum = _mm_setzero_ps();
+        __m128 _dot = _mm_setzero_ps();
+        __m128 _idx = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+        const __m128 _four = _mm_set1_ps(4.f);
+        for (; l + 3 < reg_max; l += 4)
+        {
+            __m128 _e = exp_ps(_mm_sub_ps(_mm_loadu_ps(p + l), _max));
+            _mm_storeu_ps(p + l, _e);
+            _sum = _mm_add_ps(_sum, _e);
+            _dot = _mm_add_ps(_dot, _mm_mul_ps(_e, _idx));
+            _idx = _mm_add_ps(_idx, _four);
+        }
+        sum = reduce_sum_ps(_sum);
+        dot = reduce_sum_ps(_dot);
+    }
+#endif
+    for (; l < reg_max; l++)
+    {
+        float e = expf(p[l] - max_val);
+        p[l] = e;
+        sum += e;
+        dot += l * e;
+    }
+
+    // 归一化，保持与 ncnn Softmax 原地输出一致
+    const float inv_sum = 1.f / sum;
+    for (l = 0; l < reg_max; l++)
+    {
+        p[l] *= inv_sum;
+    }
+
+    return dot * inv_sum;
+}
+
+void dfl_decode(float* pred, int reg_max, float ltrb[4])
+{
+    for (int k = 0; k < 4; k++)
+    {
+        ltrb[k] = dfl_side(pred + k * reg_max, reg_max);
+    }
+}
+
+// =============================
+// sigmoid / argmax
+// =============================
+
+void sigmoid_inplace(float* data, int n)
+{
+    int i = 0;
+#if __ARM_NEON
+    const float32x4_t _one = vdupq_n_f32(1.f);
+    for (; i + 3 < n; i += 4)
+    {
+        float32x4_t _e = exp_ps(vnegq_f32(vld1q_f32(data + i)));
+        vst1q_f32(data + i, div_ps(_one, vaddq_f32(_one, _e)));
+    }
+#elif defined(__SSE2__)
+    const __m128 _one = _mm_set1_ps(1.f);
+    const __m128 _zero = _mm_setzero_ps();
+    for (; i + 3 < n; i += 4)
+    {
+        __m128 _e = exp_ps(_mm_sub_ps(_zero, _mm_loadu_ps(data + i)));
+        _mm_storeu_ps(data + i, _mm_div_ps(_one, _mm_add_ps(_one, _e)));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        data[i] = 1.f / (1.f + expf(-data[i]));
+    }
+}
+
+int argmax(const float* scores, int n, float* max_score)
+{
+    if (n <= 0)
+        return -1;
+
+    // 先向量求最大值，再顺序找第一个等于最大值的下标，保证与逐个比较 ">" 的结果一致
+    int i = 0;
+    float max_val = -FLT_MAX;
+#if __ARM_NEON
+    if (n >= 4)
+    {
+        float32x4_t _max = vld1q_f32(scores);
+        for (i = 4; i + 3 < n; i += 4)
+        {
+            _max = vmaxq_f32(_max, vld1q_f32(scores + i));
+        }
+        max_val = reduce_max_ps(_max);
+    }
+#elif defined(__SSE2__)
+    if (n >= 4)
+    {
+        __m128 _max = _mm_loadu_ps(scores);
+        for (i = 4; i + 3 < n; i += 4)
+        {
+            _max = _mm_max_ps(_max, _mm_loadu_ps(scores + i));
+        }
+        max_val = reduce_max_ps(_max);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        max_val = std::max(max_val, scores[i]);
+    }
+
+    int label = 0;
+    while (label < n - 1 && scores[label] != max_val)
+        label++;
+
+    if (max_score)
+        *max_score = max_val;
+    return label;
+}
+
+// =============================
+// 网格
+// =============================
+
+static std::shared_ptr<const AnchorTable> build_anchor_table(int target_w, int target_h, const std::vector<int>& strides)
+{
+    std::shared_ptr<AnchorTable> table = std::make_shared<AnchorTable>();
+    table->target_w = target_w;
+    table->target_h = target_h;
+    table->strides = strides;
+
+    size_t total = 0;
+    for (int stride : strides)
+    {
+        total += (size_t)(target_w / stride) * (target_h / stride);
+    }
+    table->cx.resize(total);
+    table->cy.resize(total);
+    table->stride.resize(total);
+
+    size_t i = 0;
+    for (int stride : strides)
+    {
+        int num_grid_w = target_w / stride;
+        int num_grid_h = target_h / stride;
+        for (int g1 = 0; g1 < num_grid_h; g1++)
+        {
+            for (int g0 = 0; g0 < num_grid_w; g0++)
+            {
+                table->cx[i] = (g0 + 0.5f) * stride;
+                table->cy[i] = (g1 + 0.5f) * stride;
+                table->stride[i] = (float)stride;
+                i++;
+            }
+        }
+    }
+    return table;
+}
+
+std::shared_ptr<const AnchorTable> get_anchor_table(int target_w, int target_h, const std::vector<int>& strides)
+{
+    // 最近使用的放在表头；返回 shared_ptr，淘汰时正在使用的调用方不受影响
+    static std::mutex cache_mutex;
+    static std::list<std::shared_ptr<const AnchorTable> > cache;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    for (auto it = cache.begin(); it != cache.end(); ++it)
+    {
+        const AnchorTable& t = **it;
+        if (t.target_w == target_w && t.target_h == target_h && t.strides == strides)
+        {
+            if (it != cache.begin())
+                cache.splice(cache.begin(), cache, it);
+            return cache.front();
+        }
+    }
+
+    cache.push_front(build_anchor_table(target_w, target_h, strides));
+    if (cache.size() > ANCHOR_CACHE_CAPACITY)
+        cache.pop_back();
+    return cache.front();
+}
+
+// =============================
+// BoxSoA
+// =============================
+
+void BoxSoA::clear()
+{
+    x0_.clear();
+    y0_.clear();
+    x1_.clear();
+    y1_.clear();
+    area_.clear();
+}
+
+void BoxSoA::reserve(size_t n)
+{
+    x0_.reserve(n);
+    y0_.reserve(n);
+    x1_.reserve(n);
+    y1_.reserve(n);
+    area_.reserve(n);
+}
+
+void BoxSoA::push(float x0, float y0, float x1, float y1)
+{
+    x0_.push_back(x0);
+    y0_.push_back(y0);
+    x1_.push_back(x1);
+    y1_.push_back(y1);
+    area_.push_back((x1 - x0) * (y1 - y0));
+}
+
+bool BoxSoA::overlaps(float x0, float y0, float x1, float y1, float threshold) const
+{
+    const int n = (int)x0_.size();
+    const float area = (x1 - x0) * (y1 - y0);
+
+    // IoU > t 等价于 inter > t * union，避免逐框做除法
+    int j = 0;
+#if __ARM_NEON
+    {
+        const float32x4_t _x0 = vdupq_n_f32(x0);
+        const float32x4_t _y0 = vdupq_n_f32(y0);
+        const float32x4_t _x1 = vdupq_n_f32(x1);
+        const float32x4_t _y1 = vdupq_n_f32(y1);
+        const float32x4_t _area = vdupq_n_f32(area);
+        const float32x4_t _t = vdupq_n_f32(threshold);
+        const float32x4_t _zero = vdupq_n_f32(0.f);
+        for (; j + 3 < n; j += 4)
+        {
+            float32x4_t _w = vsubq_f32(vminq_f32(_x1, vld1q_f32(&x1_[j])), vmaxq_f32(_x0, vld1q_f32(&x0_[j])));
+            float32x4_t _h = vsubq_f32(vminq_f32(_y1, vld1q_f32(&y1_[j])), vmaxq_f32(_y0, vld1q_f32(&y0_[j])));
+            float32x4_t _inter = vmulq_f32(vmaxq_f32(_w, _zero), vmaxq_f32(_h, _zero));
+            float32x4_t _union = vsubq_f32(vaddq_f32(_area, vld1q_f32(&area_[j])), _inter);
+            if (any_lane_ps(vcgtq_f32(_inter, vmulq_f32(_union, _t))))
+                return true;
+        }
+    }
+#elif defined(__SSE2__)
+    {
+        const __m128 _x0 = _mm_set1_ps(x0);
+        const __m128 _y0 = _mm_set1_ps(y0);
+        const __m128 _x1 = _mm_set1_ps(x1);
+        const __m128 _y1 = _mm_set1_ps(y1);
+        const __m128 _area = _mm_set1_ps(area);
+        const __m128 _t = _mm_set1_ps(threshold);
+        const __m128 _zero = _mm_setzero_ps();
+        for (; j + 3 < n; j += 4)
+        {
+            __m128 _w = _mm_sub_ps(_mm_min_ps(_x1, _mm_loadu_ps(&x1_[j])), _mm_max_ps(_x0, _mm_loadu_ps(&x0_[j])));
+            __m128 _h = _mm_sub_ps(_mm_min_ps(_y1, _mm_loadu_ps(&y1_[j])), _mm_max_ps(_y0, _mm_loadu_ps(&y0_[j])));
+            __m128 _inter = _mm_mul_ps(_mm_max_ps(_w, _zero), _mm_max_ps(_h, _zero));
+            __m128 _union = _mm_sub_ps(_mm_add_ps(_area, _mm_loadu_ps(&area_[j])), _inter);
+            if (_mm_movemask_ps(_mm_cmpgt_ps(_inter, _mm_mul_ps(_union, _t))))
+                return true;
+        }
+    }
+#endif
+    for (; j < n; j++)
+    {
+        float w = std::min(x1, x1_[j]) - std::max(x0, x0_[j]);
+        float h = std::min(y1, y1_[j]) - std::max(y0, y0_[j]);
+        float inter = std::max(w, 0.f) * std::max(h, 0.f);
+        float uni = area + area_[j] - inter;
+        if (inter > uni * threshold)
+            return true;
+    }
+    return false;
+}
+
+void BoxSoA::iou_row(float x0, float y0, float x1, float y1, size_t begin, float* out) const
+{
+    const int n = (int)x0_.size();
+    const float area = (x1 - x0) * (y1 - y0);
+
+    int j = (int)begin;
+#if __ARM_NEON
+    {
+        const float32x4_t _x0 = vdupq_n_f32(x0);
+        const float32x4_t _y0 = vdupq_n_f32(y0);
+        const float32x4_t _x1 = vdupq_n_f32(x1);
+        const float32x4_t _y1 = vdupq_n_f32(y1);
+        const float32x4_t _area = vdupq_n_f32(area);
+        const float32x4_t _zero = vdupq_n_f32(0.f);
+        for (; j + 3 < n; j += 4)
+        {
+            float32x4_t _w = vsubq_f32(vminq_f32(_x1, vld1q_f32(&x1_[j])), vmaxq_f32(_x0, vld1q_f32(&x0_[j])));
+            float32x4_t _h = vsubq_f32(vminq_f32(_y1, vld1q_f32(&y1_[j])), vmaxq_f32(_y0, vld1q_f32(&y0_[j])));
+            float32x4_t _inter = vmulq_f32(vmaxq_f32(_w, _zero), vmaxq_f32(_h, _zero));
+            float32x4_t _union = vsubq_f32(vaddq_f32(_area, vld1q_f32(&area_[j])), _inter);
+            // 退化框 union 为 0 时 IoU 记为 0
+            float32x4_t _iou = div_ps(_inter, vmaxq_f32(_union, vdupq_n_f32(FLT_MIN)));
+            vst1q_f32(out + (j - begin), _iou);
+        }
+    }
+#elif defined(__SSE2__)
+    {
+        const __m128 _x0 = _mm_set1_ps(x0);
+        const __m128 _y0 = _mm_set1_ps(y0);
+        const __m128 _x1 = _mm_set1_ps(x1);
+        const __m128 _y1 = _mm_set1_ps(y1);
+        const __m128 _area = _mm_set1_ps(area);
+        const __m128 _zero = _mm_setzero_ps();
+        for (; j + 3 < n; j += 4)
+        {
+            __m128 _w = _mm_sub_ps(_mm_min_ps(_x1, _mm_loadu_ps(&x1_[j])), _mm_max_ps(_x0, _mm_loadu_ps(&x0_[j])));
+            __m128 _h = _mm_sub_ps(_mm_min_ps(_y1, _mm_loadu_ps(&y1_[j])), _mm_max_ps(_y0, _mm_loadu_ps(&y0_[j])));
+            __m128 _inter = _mm_mul_ps(_mm_max_ps(_w, _zero), _mm_max_ps(_h, _zero));
+            __m128 _union = _mm_sub_ps(_mm_add_ps(_area, _mm_loadu_ps(&area_[j])), _inter);
+            // 退化框 union 为 0 时 IoU 记为 0
+            __m128 _iou = _mm_div_ps(_inter, _mm_max_ps(_union, _mm_set1_ps(FLT_MIN)));
+            _mm_storeu_ps(out + (j - begin), _iou);
+        }
+    }
+#endif
+    for (; j < n; j++)
+    {
+        float w = std::min(x1, x1_[j]) - std::max(x0, x0_[j]);
+        float h = std::min(y1, y1_[j]) - std::max(y0, y0_[j]);
+        float inter = std::max(w, 0.f) * std::max(h, 0.f);
+        float uni = area + area_[j] - inter;
+        out[j - begin] = inter / std::max(uni, FLT_MIN);
+    }
+}
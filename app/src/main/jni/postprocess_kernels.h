@@ -0,0 +1,99 @@
+#ifndef POSTPROCESS_KERNELS_H
+#define POSTPROCESS_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+// =============================
+// 后处理数值内核（不依赖 ncnn / OpenCV）
+// =============================
+//
+// sigmoid / argmax / DFL / anchor 表 / SoA IoU 只操作 float 数组，单独成文件，
+// 可以在 x86 Linux 上直接编译做单测和基准（见 bench/）；热点部分带 NEON / SSE2 实现，无 SIMD 时退回标量
+
+// 特征图网格点表（YOLOv8 系列 anchor-free 解码用），SoA 排布便于顺序/向量访问
+// cx / cy 为网格中心在网络输入上的坐标，stride 为所在特征层步长
+struct AnchorTable
+{
+    int target_w;
+    int target_h;
+    std::vector<int> strides;
+
+    std::vector<float> cx;
+    std::vector<float> cy;
+    std::vector<float> stride;
+
+    int size() const { return (int)cx.size(); }
+};
+
+// anchor 表缓存容量（按输入尺寸 LRU 淘汰；不同宽高比的视频会产生不同的 pad 尺寸）
+#define ANCHOR_CACHE_CAPACITY 4
+
+// 位运算近似 exp，精度较低但足够用于置信度
+inline float fast_exp(float x)
+{
+    union {
+        uint32_t i;
+        float f;
+    } v{};
+    v.i = (1 << 23) * (1.4426950409 * x + 126.93490512f);
+    return v.f;
+}
+
+inline float sigmoid(float x)
+{
+    return 1.0f / (1.0f + fast_exp(-x));
+}
+
+// 向量化 sigmoid，原地计算 n 个元素
+void sigmoid_inplace(float* data, int n);
+
+// 向量化 argmax：返回最大值下标（并列取第一个），最大值写入 max_score；n <= 0 时返回 -1
+int argmax(const float* scores, int n, float* max_score);
+
+// DFL（Distribution Focal Loss）框解码
+// pred 按 [4][reg_max] 排布（l, t, r, b 各 reg_max 个 bin），对每条边做 softmax 并求期望；
+// softmax 结果原地写回 pred，ltrb 输出以 bin 为单位的距离（调用方再乘 stride）
+void dfl_decode(float* pred, int reg_max, float ltrb[4]);
+
+// 取 (target_w, target_h, strides) 对应的 anchor 表，未命中时生成并放入缓存（线程安全）
+std::shared_ptr<const AnchorTable> get_anchor_table(int target_w, int target_h, const std::vector<int>& strides);
+
+// =============================
+// SoA 框缓冲：已保留框按坐标分列存放，一次比较 4 个框的 IoU
+// =============================
+class BoxSoA
+{
+public:
+    void clear();
+    void reserve(size_t n);
+    size_t size() const { return x0_.size(); }
+
+    // 坐标为左上 (x0, y0)、右下 (x1, y1)
+    void push(float x0, float y0, float x1, float y1);
+
+    void box(size_t i, float& x0, float& y0, float& x1, float& y1) const
+    {
+        x0 = x0_[i];
+        y0 = y0_[i];
+        x1 = x1_[i];
+        y1 = y1_[i];
+    }
+
+    // 与缓冲中任意一个框的 IoU 大于 threshold 时返回 true
+    bool overlaps(float x0, float y0, float x1, float y1, float threshold) const;
+
+    // 计算给定框与缓冲中 [begin, size()) 各框的 IoU，写入 out[0 .. size()-begin)
+    void iou_row(float x0, float y0, float x1, float y1, size_t begin, float* out) const;
+
+private:
+    std::vector<float> x0_;
+    std::vector<float> y0_;
+    std::vector<float> x1_;
+    std::vector<float> y1_;
+    std::vector<float> area_;
+};
+
+#endif // POSTPROCESS_KERNELS_H
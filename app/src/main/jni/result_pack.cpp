@@ -0,0 +1,158 @@
+#include "result_pack.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+// 掩码区域（原图坐标，已裁剪到图像范围内）
+static cv::Rect maskRect(const Object& obj, int frame_w, int frame_h)
+{
+    const MaskRLE* mask = obj.markPoint.mask.get();
+    if (!mask || mask->empty())
+        return cv::Rect();
+
+    return cv::Rect(obj.markPoint.origin, cv::Size(mask->width, mask->height)) & cv::Rect(0, 0, frame_w, frame_h);
+}
+
+static size_t keypointCount(const Object& obj)
+{
+    return obj.keyPoints.size() + obj.Face_keyPoints.size();
+}
+
+size_t packedResultSize(const std::vector<Object>& objects, int frame_w, int frame_h)
+{
+    size_t size = RESULT_HEADER_SIZE + objects.size() * sizeof(PackedDetection);
+    for (const Object& obj : objects)
+    {
+        size += keypointCount(obj) * 3 * sizeof(float);
+        size += maskRect(obj, frame_w, frame_h).area();
+    }
+    return size;
+}
+
+size_t packResults(const std::vector<Object>& objects, int frame_w, int frame_h,
+                   uint8_t* dst, size_t capacity)
+{
+    const size_t total = packedResultSize(objects, frame_w, frame_h);
+    if (capacity < total)
+        return 0;
+
+    const int32_t header[4] = {(int32_t)objects.size(), (int32_t)sizeof(PackedDetection), frame_w, frame_h};
+    memcpy(dst, header, sizeof(header));
+
+    PackedDetection* records = (PackedDetection*)(dst + RESULT_HEADER_SIZE);
+    size_t kp_cursor = RESULT_HEADER_SIZE + objects.size() * sizeof(PackedDetection);
+    size_t kp_total = 0;
+    for (const Object& obj : objects)
+        kp_total += keypointCount(obj);
+    size_t mask_cursor = kp_cursor + kp_total * 3 * sizeof(float);
+
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        const Object& obj = objects[i];
+        PackedDetection& r = records[i];
+        r.x1 = obj.rect.x;
+        r.y1 = obj.rect.y;
+        r.x2 = obj.rect.x + obj.rect.width;
+        r.y2 = obj.rect.y + obj.rect.height;
+        r.score = obj.prob;
+        r.label = obj.label;
+        r.track_id = obj.track_id;
+
+        // 关键点
+        const size_t kp_count = keypointCount(obj);
+        r.kp_offset = kp_count ? (int32_t)kp_cursor : -1;
+        r.kp_count = (int32_t)kp_count;
+        float* kp = (float*)(dst + kp_cursor);
+        for (const PoseKeyPoint& p : obj.keyPoints)
+        {
+            *kp++ = p.p.x;
+            *kp++ = p.p.y;
+            *kp++ = p.prob;
+        }
+        for (const FaceKeyPoint& p : obj.Face_keyPoints)
+        {
+            *kp++ = p.p.x;
+            *kp++ = p.p.y;
+            *kp++ = p.prob;
+        }
+        kp_cursor += kp_count * 3 * sizeof(float);
+
+        // 掩码：框内游程解码为 0 / 1
+        const cv::Rect roi = maskRect(obj, frame_w, frame_h);
+        if (roi.area() > 0)
+        {
+            r.mask_offset = (int32_t)mask_cursor;
+            r.mask_x = roi.x;
+            r.mask_y = roi.y;
+            r.mask_w = roi.width;
+            r.mask_h = roi.height;
+
+            const cv::Point& origin = obj.markPoint.origin;
+            rle_decode(*obj.markPoint.mask, roi.x - origin.x, roi.y - origin.y, roi.width, roi.height,
+                       1, dst + mask_cursor, roi.width);
+            mask_cursor += roi.area();
+        }
+        else
+        {
+            r.mask_offset = -1;
+            r.mask_x = r.mask_y = r.mask_w = r.mask_h = 0;
+        }
+    }
+
+    return total;
+}
+
+// =============================
+// 各通道最新结果
+// =============================
+
+// 双缓冲：在锁外打包到 spare，锁内与 latest 交换，稳定后不再分配内存
+struct ResultSlot
+{
+    std::vector<uint8_t> latest;
+    std::vector<uint8_t> spare;
+};
+
+static std::mutex g_results_mutex;
+static std::map<int, ResultSlot> g_results;
+
+void publishResults(int channel, const std::vector<Object>& objects, int frame_w, int frame_h)
+{
+    std::vector<uint8_t> packed;
+    {
+        std::lock_guard<std::mutex> lock(g_results_mutex);
+        packed.swap(g_results[channel].spare);
+    }
+
+    packed.resize(packedResultSize(objects, frame_w, frame_h));
+    packResults(objects, frame_w, frame_h, packed.data(), packed.size());
+
+    std::lock_guard<std::mutex> lock(g_results_mutex);
+    ResultSlot& slot = g_results[channel];
+    slot.latest.swap(packed);
+    slot.spare.swap(packed);
+}
+
+long copyLatestResults(int channel, uint8_t* dst, size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(g_results_mutex);
+    auto it = g_results.find(channel);
+    if (it == g_results.end() || it->second.latest.empty())
+        return 0;
+
+    const std::vector<uint8_t>& packed = it->second.latest;
+    if (capacity < packed.size())
+        return -(long)packed.size();
+
+    memcpy(dst, packed.data(), packed.size());
+    return (long)packed.size();
+}
+
+void clearResults(int channel)
+{
+    std::lock_guard<std::mutex> lock(g_results_mutex);
+    g_results.erase(channel);
+}
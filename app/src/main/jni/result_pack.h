@@ -0,0 +1,61 @@
+#ifndef RESULT_PACK_H
+#define RESULT_PACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "vision_base.h"
+
+// =============================
+// 检测结果打包（JNI 传输用）
+// =============================
+//
+// 每帧结果打包成一段连续字节，Java 侧用 direct ByteBuffer（nativeOrder）按固定偏移读取，
+// 不为每个目标分配对象。所有偏移均为相对缓冲区起始的字节偏移。
+//
+//   [0, 16)        头部：int32 count, int32 record_size, int32 frame_w, int32 frame_h
+//   [16, ...)      count 条 PackedDetection（record_size 字节，见下）
+//   之后           关键点区：每点 float32 x, y, prob（人体关键点与人脸关键点都放这里）
+//   之后           掩码区：每个目标框内的 uint8 掩码（0/1），行主序，mask_w * mask_h 字节
+//
+// 没有关键点 / 掩码时对应 offset 为 -1、count / 宽高为 0；track_id 未开启跟踪时为 -1
+
+#define RESULT_HEADER_SIZE 16
+
+struct PackedDetection
+{
+    float   x1, y1, x2, y2;   // 原图坐标
+    float   score;
+    int32_t label;
+    int32_t track_id;
+    int32_t kp_offset;        // 关键点区字节偏移
+    int32_t kp_count;
+    int32_t mask_offset;      // 掩码字节偏移
+    int32_t mask_x, mask_y;   // 掩码左上角在原图中的位置
+    int32_t mask_w, mask_h;
+};
+
+static_assert(sizeof(PackedDetection) == 56, "PackedDetection layout must match the Java reader");
+
+// 单路画面（相机 / 本地视频 / 单路网络流）使用的结果通道；多路流使用流 id（> 0）
+#define RESULT_CHANNEL_DEFAULT 0
+
+// 打包所需字节数
+size_t packedResultSize(const std::vector<Object>& objects, int frame_w, int frame_h);
+
+// 打包到 dst，返回写入字节数；capacity 不足时不写入并返回 0
+size_t packResults(const std::vector<Object>& objects, int frame_w, int frame_h,
+                   uint8_t* dst, size_t capacity);
+
+// 打包并保存为 channel 的最新结果（渲染线程调用）
+void publishResults(int channel, const std::vector<Object>& objects, int frame_w, int frame_h);
+
+// 把 channel 的最新结果拷贝到 dst（一次 memcpy）
+// 返回写入字节数；capacity 不足时返回所需字节数的相反数；没有结果返回 0
+long copyLatestResults(int channel, uint8_t* dst, size_t capacity);
+
+// 清除 channel 的结果（流停止时调用）
+void clearResults(int channel);
+
+#endif // RESULT_PACK_H
@@ -12,7 +12,10 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 #include "Yolov8Seg.h"
-#include "layer.h"
+#include "trace.h"
+#include "postprocess.h"
+#include "nms.h"
+#include "mask_head.h"
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include <float.h>
@@ -116,297 +119,39 @@ const unsigned char Yolov8Seg::colors_[80][3] = {            {56,  0,   255},
                                                              {0,   255, 75},
                                                              {0,   255, 151},
                                                               {245, 255, 0}};
-static void slice(const ncnn::Mat& in, ncnn::Mat& out, int start, int end, int axis)
-{
-    ncnn::Option opt;
-    opt.num_threads = 4;
-    opt.use_fp16_storage = false;
-    opt.use_packing_layout = false;
-
-    ncnn::Layer* op = ncnn::create_layer("Crop");
-
-    // set param
-    ncnn::ParamDict pd;
-
-    ncnn::Mat axes = ncnn::Mat(1);
-    axes.fill(axis);
-    ncnn::Mat ends = ncnn::Mat(1);
-    ends.fill(end);
-    ncnn::Mat starts = ncnn::Mat(1);
-    starts.fill(start);
-    pd.set(9, starts);// start
-    pd.set(10, ends);// end
-    pd.set(11, axes);//axes
-
-    op->load_param(pd);
 
-    op->create_pipeline(opt);
+// 检测头输出每行：4 * REG_MAX 个 DFL 分布 | NUM_CLASS 个类别分数 | 32 个掩码系数
+static const int NUM_CLASS = 80;
+static const int REG_MAX = 16;
+static const int MASK_COEFF_OFFSET = 4 * REG_MAX + NUM_CLASS;
 
-    // forward
-    op->forward(in, out, opt);
-
-    op->destroy_pipeline(opt);
-
-    delete op;
-}
-static void interp(const ncnn::Mat& in, const float& scale, const int& out_w, const int& out_h, ncnn::Mat& out)
-{
-    ncnn::Option opt;
-    opt.num_threads = 4;
-    opt.use_fp16_storage = false;
-    opt.use_packing_layout = false;
-
-    ncnn::Layer* op = ncnn::create_layer("Interp");
-
-    // set param
-    ncnn::ParamDict pd;
-    pd.set(0, 2);// resize_type
-    pd.set(1, scale);// height_scale
-    pd.set(2, scale);// width_scale
-    pd.set(3, out_h);// height
-    pd.set(4, out_w);// width
-
-    op->load_param(pd);
-
-    op->create_pipeline(opt);
-
-    // forward
-    op->forward(in, out, opt);
-
-    op->destroy_pipeline(opt);
-
-    delete op;
-}
-static void reshape(const ncnn::Mat& in, ncnn::Mat& out, int c, int h, int w, int d)
-{
-    ncnn::Option opt;
-    opt.num_threads = 4;
-    opt.use_fp16_storage = false;
-    opt.use_packing_layout = false;
-
-    ncnn::Layer* op = ncnn::create_layer("Reshape");
-
-    // set param
-    ncnn::ParamDict pd;
-
-    pd.set(0, w);// start
-    pd.set(1, h);// end
-    if (d > 0)
-        pd.set(11, d);//axes
-    pd.set(2, c);//axes
-    op->load_param(pd);
-
-    op->create_pipeline(opt);
-
-    // forward
-    op->forward(in, out, opt);
-
-    op->destroy_pipeline(opt);
-
-    delete op;
-}
-static void sigmoid(ncnn::Mat& bottom)
-{
-    ncnn::Option opt;
-    opt.num_threads = 4;
-    opt.use_fp16_storage = false;
-    opt.use_packing_layout = false;
-
-    ncnn::Layer* op = ncnn::create_layer("Sigmoid");
-
-    op->create_pipeline(opt);
-
-    // forward
-
-    op->forward_inplace(bottom, opt);
-    op->destroy_pipeline(opt);
-
-    delete op;
-}
-static void matmul(const std::vector<ncnn::Mat>& bottom_blobs, ncnn::Mat& top_blob)
+static void generate_proposals(const AnchorTable& anchors, const ncnn::Mat& pred, float prob_threshold, std::vector<Object>& objects)
 {
-    ncnn::Option opt;
-    opt.num_threads = 2;
-    opt.use_fp16_storage = false;
-    opt.use_packing_layout = false;
-
-    ncnn::Layer* op = ncnn::create_layer("MatMul");
-
-    // set param
-    ncnn::ParamDict pd;
-    pd.set(0, 0);// axis
-
-    op->load_param(pd);
-
-    op->create_pipeline(opt);
-    std::vector<ncnn::Mat> top_blobs(1);
-    op->forward(bottom_blobs, top_blobs, opt);
-    top_blob = top_blobs[0];
-
-    op->destroy_pipeline(opt);
-
-    delete op;
-}
-static inline float intersection_area(const Object& a, const Object& b)
-{
-    cv::Rect_<float> inter = a.rect & b.rect;
-    return inter.area();
-}
-
-static void qsort_descent_inplace(std::vector<Object>& faceobjects, int left, int right)
-{
-    int i = left;
-    int j = right;
-    float p = faceobjects[(left + right) / 2].prob;
-
-    while (i <= j)
-    {
-        while (faceobjects[i].prob > p)
-            i++;
-
-        while (faceobjects[j].prob < p)
-            j--;
-
-        if (i <= j)
-        {
-            // swap
-            std::swap(faceobjects[i], faceobjects[j]);
-
-            i++;
-            j--;
-        }
-    }
-
-#pragma omp parallel sections
-    {
-#pragma omp section
-        {
-            if (left < j) qsort_descent_inplace(faceobjects, left, j);
-        }
-#pragma omp section
-        {
-            if (i < right) qsort_descent_inplace(faceobjects, i, right);
-        }
-    }
-}
-
-static void qsort_descent_inplace(std::vector<Object>& faceobjects)
-{
-    if (faceobjects.empty())
-        return;
-
-    qsort_descent_inplace(faceobjects, 0, faceobjects.size() - 1);
-}
-
-static void nms_sorted_bboxes(const std::vector<Object>& faceobjects, std::vector<int>& picked, float nms_threshold)
-{
-    picked.clear();
-
-    const int n = faceobjects.size();
-
-    std::vector<float> areas(n);
-    for (int i = 0; i < n; i++)
-    {
-        areas[i] = faceobjects[i].rect.width * faceobjects[i].rect.height;
-    }
-
-    for (int i = 0; i < n; i++)
-    {
-        const Object& a = faceobjects[i];
-
-        int keep = 1;
-        for (int j = 0; j < (int)picked.size(); j++)
-        {
-            const Object& b = faceobjects[picked[j]];
-
-            // intersection over union
-            float inter_area = intersection_area(a, b);
-            float union_area = areas[i] + areas[picked[j]] - inter_area;
-            // float IoU = inter_area / union_area
-            if (inter_area / union_area > nms_threshold)
-                keep = 0;
-        }
-
-        if (keep)
-            picked.push_back(i);
-    }
-}
-inline float fast_exp(float x)
-{
-    union {
-        uint32_t i;
-        float f;
-    } v{};
-    v.i = (1 << 23) * (1.4426950409 * x + 126.93490512f);
-    return v.f;
-}
-
-inline float sigmoid(float x)
-{
-    return 1.0f / (1.0f + fast_exp(-x));
-}
-static void generate_proposals(std::vector<yolov8seg::GridAndStride> grid_strides, const ncnn::Mat& pred, float prob_threshold, std::vector<Object>& objects)
-{
-    const int num_points = grid_strides.size();
-    const int num_class = 80;
-    const int reg_max_1 = 16;
+    const int num_points = anchors.size();
+    const float* anchor_cx = anchors.cx.data();
+    const float* anchor_cy = anchors.cy.data();
+    const float* anchor_stride = anchors.stride.data();
 
     for (int i = 0; i < num_points; i++)
     {
-        const float* scores = pred.row(i) + 4 * reg_max_1;
+        const float* scores = pred.row(i) + 4 * REG_MAX;
 
         // find label with max score
-        int label = -1;
-        float score = -FLT_MAX;
-        for (int k = 0; k < num_class; k++)
-        {
-            float confidence = scores[k];
-            if (confidence > score)
-            {
-                label = k;
-                score = confidence;
-            }
-        }
+        float score;
+        int label = argmax(scores, NUM_CLASS, &score);
         float box_prob = sigmoid(score);
         if (box_prob >= prob_threshold)
         {
-            ncnn::Mat bbox_pred(reg_max_1, 4, (void*)pred.row(i));
-            {
-                ncnn::Layer* softmax = ncnn::create_layer("Softmax");
-
-                ncnn::ParamDict pd;
-                pd.set(0, 1); // axis
-                pd.set(1, 1);
-                softmax->load_param(pd);
-
-                ncnn::Option opt;
-                opt.num_threads = 1;
-                opt.use_packing_layout = false;
-
-                softmax->create_pipeline(opt);
-
-                softmax->forward_inplace(bbox_pred, opt);
-
-                softmax->destroy_pipeline(opt);
-
-                delete softmax;
-            }
-
+            // DFL 解码：softmax + 期望一次完成，避免逐候选创建 Softmax 层
             float pred_ltrb[4];
+            dfl_decode((float*)pred.row(i), REG_MAX, pred_ltrb);
             for (int k = 0; k < 4; k++)
             {
-                float dis = 0.f;
-                const float* dis_after_sm = bbox_pred.row(k);
-                for (int l = 0; l < reg_max_1; l++)
-                {
-                    dis += l * dis_after_sm[l];
-                }
-
-                pred_ltrb[k] = dis * grid_strides[i].stride;
+                pred_ltrb[k] *= anchor_stride[i];
             }
 
-            float pb_cx = (grid_strides[i].grid0 + 0.5f) * grid_strides[i].stride;
-            float pb_cy = (grid_strides[i].grid1 + 0.5f) * grid_strides[i].stride;
+            float pb_cx = anchor_cx[i];
+            float pb_cy = anchor_cy[i];
 
             float x0 = pb_cx - pred_ltrb[0];
             float y0 = pb_cy - pred_ltrb[1];
@@ -420,78 +165,35 @@ static void generate_proposals(std::vector<yolov8seg::GridAndStride> grid_stride
             obj.rect.height = y1 - y0;
             obj.label = label;
             obj.prob = box_prob;
-            obj.markPoint.mask_feat.resize(32);
-            std::copy(pred.row(i) + 64 + num_class, pred.row(i) + 64 + num_class + 32, obj.markPoint.mask_feat.begin());
+            obj.markPoint.anchor = i;
             objects.push_back(obj);
         }
     }
 }
-static void generate_grids_and_stride(const int target_w, const int target_h, std::vector<int>& strides, std::vector<yolov8seg::GridAndStride>& grid_strides)
-{
-    for (int i = 0; i < (int)strides.size(); i++)
-    {
-        int stride = strides[i];
-        int num_grid_w = target_w / stride;
-        int num_grid_h = target_h / stride;
-        for (int g1 = 0; g1 < num_grid_h; g1++)
-        {
-            for (int g0 = 0; g0 < num_grid_w; g0++)
-            {
-                yolov8seg::GridAndStride gs;
-                gs.grid0 = g0;
-                gs.grid1 = g1;
-                gs.stride = stride;
-                grid_strides.push_back(gs);
-            }
-        }
-    }
-}
-static void decode_mask(const ncnn::Mat& mask_feat, const int& img_w, const int& img_h,
-                        const ncnn::Mat& mask_proto, const ncnn::Mat& in_pad, const int& wpad, const int& hpad,
-                        ncnn::Mat& mask_pred_result)
-{
-    ncnn::Mat masks;
-    matmul(std::vector<ncnn::Mat>{mask_feat, mask_proto}, masks);
-    sigmoid(masks);
-    reshape(masks, masks, masks.h, in_pad.h / 4, in_pad.w / 4, 0);
-    slice(masks, mask_pred_result, (wpad / 2) / 4, (in_pad.w - wpad / 2) / 4, 2);
-    slice(mask_pred_result, mask_pred_result, (hpad / 2) / 4, (in_pad.h - hpad / 2) / 4, 1);
-    interp(mask_pred_result, 4.0, img_w, img_h, mask_pred_result);
-}
 Yolov8Seg::Yolov8Seg()
 {
-//    blob_pool_allocator.set_size_compare_ratio(0.f);
-//    workspace_pool_allocator.set_size_compare_ratio(0.f);
 }
 Yolov8Seg::~Yolov8Seg()
 {
-    yoloseg.clear();
-//    blob_pool_allocator.clear();
-//    workspace_pool_allocator.clear();
 }
 int Yolov8Seg::load(AAssetManager* mgr,  int modelid, int inputsize,bool use_gpu)
 {
     ncnn::set_cpu_powersave(0);
     ncnn::set_omp_num_threads(ncnn::get_big_cpu_count());
-    yoloseg.opt = ncnn::Option();
-#if NCNN_VULKAN
-    yoloseg.opt.use_vulkan_compute = use_gpu;
-#endif
-    // 启用轻量模式，减少内存使用
-    yoloseg.opt.lightmode = true;
-    const char* modeltype = "Yolov8Seg";
-    char parampath[256];
-    char modelpath[256];
-    sprintf(parampath, "%s.param", modeltype);
-    sprintf(modelpath, "%s.bin", modeltype);
-    yoloseg.load_param(mgr, parampath);
-    yoloseg.load_model(mgr, modelpath);
+    yoloseg = acquireNet(mgr, "Yolov8Seg", use_gpu);
+    if (!yoloseg)
+        return -1;
     target_size = (inputsize == 0) ? 320 : 640;
     return 0;
 }
+void Yolov8Seg::getWarmupTargets(std::vector<WarmupTarget>& targets) const
+{
+    addLetterboxWarmupTargets(targets, &yoloseg->net, "images", {"output", "seg"}, target_size);
+}
 // 图像预处理函数：缩放和填充到32的倍数
 ncnn::Mat Yolov8Seg::preprocessImage(const cv::Mat& rgb, float& scale, int& wpad, int& hpad)
 {
+    TRACE_SCOPE(TRACE_PREPROCESS);
     int width = rgb.cols;
     int height = rgb.rows;
     // pad to multiple of 32
@@ -520,48 +222,72 @@ ncnn::Mat Yolov8Seg::preprocessImage(const cv::Mat& rgb, float& scale, int& wpad
 }
 int Yolov8Seg::detect(const cv::Mat& rgb, std::vector<Object>& objects)
 {
-    float prob_threshold =g_threshold;
-    float nms_threshold =g_nms;
-    int width = rgb.cols;
-    int height = rgb.rows;
-
     // 使用封装的预处理函数
     float scale;
     int wpad, hpad;
     ncnn::Mat in_pad = preprocessImage(rgb, scale, wpad, hpad);
-    in_pad.substract_mean_normalize(0, norm_vals);
-    double t3 = ncnn::get_current_time();
-    ncnn::Extractor ex = yoloseg.create_extractor();
+    return detectPadded(in_pad, scale, wpad, hpad, rgb.cols, rgb.rows, objects);
+}
+int Yolov8Seg::detectLetterboxed(const Letterbox& lb, std::vector<Object>& objects)
+{
+    // 解码阶段已完成缩放与填充，直接封装为 ncnn::Mat
+    ncnn::Mat in_pad = ncnn::Mat::from_pixels(lb.image.data, ncnn::Mat::PIXEL_RGB, lb.image.cols, lb.image.rows);
+    return detectPadded(in_pad, lb.scale, lb.wpad, lb.hpad, lb.orig_w, lb.orig_h, objects);
+}
+int Yolov8Seg::detectTensor(const LetterboxTensor& in, std::vector<Object>& objects)
+{
+    // 张量已完成缩放、填充与归一化（浅拷贝，不复制数据）
+    ncnn::Mat in_pad = in.tensor;
+    return detectPadded(in_pad, in.scale, in.wpad, in.hpad, in.orig_w, in.orig_h, objects, true);
+}
+bool Yolov8Seg::getTensorNorm(float mean[3], float norm[3]) const
+{
+    // 与 detectPadded 一致：不减均值，只缩放到 [0, 1]
+    for (int c = 0; c < 3; c++)
+    {
+        mean[c] = 0.f;
+        norm[c] = norm_vals[c];
+    }
+    return true;
+}
+int Yolov8Seg::detectPadded(ncnn::Mat& in_pad, float scale, int wpad, int hpad, int width, int height, std::vector<Object>& objects, bool normalized)
+{
+    float prob_threshold =g_threshold;
+    float nms_threshold =g_nms;
+    if (!normalized)
+        in_pad.substract_mean_normalize(0, norm_vals);
+    const int64_t t3 = trace_now_us();
+    ncnn::Extractor ex = yoloseg->net.create_extractor();
     ex.input("images", in_pad);
     ncnn::Mat out;
     ex.extract("output", out);
     ncnn::Mat mask_proto;
     ex.extract("seg", mask_proto);  //add  seg
-    double t4 = ncnn::get_current_time();
-    std::vector<int> strides = {8, 16, 32}; // might have stride=64
-    std::vector<yolov8seg::GridAndStride> grid_strides;
-    generate_grids_and_stride(in_pad.w, in_pad.h, strides, grid_strides);
+    trace_record(TRACE_FORWARD, t3);
+    const int64_t t4 = trace_now_us();
+    static const std::vector<int> strides = {8, 16, 32}; // might have stride=64
+    // anchor 表按输入尺寸缓存，同一尺寸只生成一次
+    std::shared_ptr<const AnchorTable> anchors = get_anchor_table(in_pad.w, in_pad.h, strides);
     std::vector<Object> proposals;
     std::vector<Object> objects8;
-    generate_proposals(grid_strides, out, prob_threshold, objects8);
+    generate_proposals(*anchors, out, prob_threshold, objects8);
     proposals.insert(proposals.end(), objects8.begin(), objects8.end());
 
     // sort all proposals by score from highest to lowest
     qsort_descent_inplace(proposals);
+    trace_record(TRACE_PROPOSAL, t4);
+    const int64_t t5 = trace_now_us();
     // apply nms with nms_threshold
     std::vector<int> picked;
-    nms_sorted_bboxes(proposals, picked, nms_threshold);
+    nms_dispatch(proposals, picked, nms_threshold, prob_threshold, g_nms_mode);
+    trace_record(TRACE_NMS, t5);
     int count = picked.size();
 
-    ncnn::Mat mask_feat = ncnn::Mat(32, count, sizeof(float));
-    for (int i = 0; i < count; i++) {
-        float* mask_feat_ptr = mask_feat.row(i);
-        std::memcpy(mask_feat_ptr, proposals[picked[i]].markPoint.mask_feat.data(), sizeof(float) * proposals[picked[i]].markPoint.mask_feat.size());
-    }
-    ncnn::Mat mask_pred_result;
-    decode_mask(mask_feat, width, height, mask_proto, in_pad, wpad, hpad, mask_pred_result);
+    const MaskGeometry geo = {scale, wpad, hpad, in_pad.w / 4, in_pad.h / 4};
+    const cv::Rect frame_rect(0, 0, width, height);
 
     objects.resize(count);
+    std::vector<MaskJob> mask_jobs(count);
     for (int i = 0; i < count; i++)
     {
         objects[i] = proposals[picked[i]];
@@ -583,13 +309,15 @@ int Yolov8Seg::detect(const cv::Mat& rgb, std::vector<Object>& objects)
         objects[i].rect.width = x1 - x0;
         objects[i].rect.height = y1 - y0;
 
-        objects[i].markPoint.mask = cv::Mat::zeros(height, width, CV_32FC1);
-        cv::Mat mask = cv::Mat(height, width, CV_32FC1, (float*)mask_pred_result.channel(i));
-        mask(objects[i].rect).copyTo(objects[i].markPoint.mask(objects[i].rect));
+        // 掩码只保存框内部分（与结果打包的取整方式一致）
+        const cv::Rect box = cv::Rect((int)x0, (int)y0, (int)(x1 - x0 + 0.5f), (int)(y1 - y0 + 0.5f)) & frame_rect;
+        objects[i].markPoint.origin = box.tl();
+        mask_jobs[i] = {out.row(objects[i].markPoint.anchor) + MASK_COEFF_OFFSET, box, &objects[i].markPoint.mask};
     }
+    // 系数 x 原型 + sigmoid + 框内采样一次完成，线程数取自模型的 ncnn 选项
+    decode_instance_masks(mask_proto, geo, mask_jobs, yoloseg->net.opt.num_threads);
     // 统计当前帧类别信息，写入g_summary.class_info
     std::lock_guard<std::mutex> lock(g_summary_mutex);
-    g_summary.inferTimeMs = (t4 - t3); // 单位：秒
     {
         std::map<int, int> cls_count;
         for (const auto& obj : objects) cls_count[obj.label]++;
@@ -0,0 +1,134 @@
+#include "mask_head.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "batch_infer.h"
+#include "postprocess.h"
+
+#if __ARM_NEON
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// 每个线程至少分到的目标数，目标较少时开线程的开销比解码本身还大
+#define MASK_JOBS_PER_THREAD 4
+
+// dst[i] += k * src[i]
+static void axpy(float* dst, const float* src, float k, int n)
+{
+    int i = 0;
+#if __ARM_NEON
+    const float32x4_t _k = vdupq_n_f32(k);
+    for (; i + 7 < n; i += 8)
+    {
+        float32x4_t _d0 = vld1q_f32(dst + i);
+        float32x4_t _d1 = vld1q_f32(dst + i + 4);
+        _d0 = vmlaq_f32(_d0, vld1q_f32(src + i), _k);
+        _d1 = vmlaq_f32(_d1, vld1q_f32(src + i + 4), _k);
+        vst1q_f32(dst + i, _d0);
+        vst1q_f32(dst + i + 4, _d1);
+    }
+    for (; i + 3 < n; i += 4)
+    {
+        vst1q_f32(dst + i, vmlaq_f32(vld1q_f32(dst + i), vld1q_f32(src + i), _k));
+    }
+#elif defined(__SSE2__)
+    const __m128 _k = _mm_set1_ps(k);
+    for (; i + 7 < n; i += 8)
+    {
+        __m128 _d0 = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), _k));
+        __m128 _d1 = _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_mul_ps(_mm_loadu_ps(src + i + 4), _k));
+        _mm_storeu_ps(dst + i, _d0);
+        _mm_storeu_ps(dst + i + 4, _d1);
+    }
+    for (; i + 3 < n; i += 4)
+    {
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), _k)));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        dst[i] += k * src[i];
+    }
+}
+
+// 第 q 个原型平面（pw * ph 连续存放）
+static const float* proto_plane(const ncnn::Mat& proto, int q)
+{
+    return proto.dims == 3 ? (const float*)proto.channel(q) : proto.row(q);
+}
+
+void decode_instance_mask(const ncnn::Mat& proto, const MaskGeometry& geo, const MaskJob& job)
+{
+    const cv::Rect& box = job.box;
+    if (box.area() <= 0)
+    {
+        job.mask->reset();
+        return;
+    }
+
+    const int pw = geo.proto_w;
+    const int ph = geo.proto_h;
+    const int num_protos = proto.dims == 3 ? proto.c : proto.h;
+
+    // 框内像素中心 -> 原型坐标：x_p = a * x + bx
+    const float a = geo.scale / 4.f;
+    const float bx = ((box.x + 0.5f) * geo.scale + geo.wpad / 2) / 4.f - 0.5f;
+    const float by = ((box.y + 0.5f) * geo.scale + geo.hpad / 2) / 4.f - 0.5f;
+
+    // 采样覆盖的原型区域，两侧各外扩 1 格（双线性邻点 + 定点坐标取整误差），裁剪到原型范围内；
+    // 越出原型的采样点按 BORDER_REPLICATE 取边缘值，与在整幅原型上采样一致
+    const int rx0 = std::min(pw - 1, std::max(0, (int)floorf(bx) - 1));
+    const int ry0 = std::min(ph - 1, std::max(0, (int)floorf(by) - 1));
+    const int rx1 = std::min(pw - 1, (int)floorf(a * (box.width - 1) + bx) + 2);
+    const int ry1 = std::min(ph - 1, (int)floorf(a * (box.height - 1) + by) + 2);
+    const int rw = std::max(1, rx1 - rx0 + 1);
+    const int rh = std::max(1, ry1 - ry0 + 1);
+
+    // 区域内逐行：32 个系数 x 原型行累加，再 sigmoid
+    cv::Mat prob(rh, rw, CV_32FC1);
+    for (int y = 0; y < rh; y++)
+    {
+        float* row = prob.ptr<float>(y);
+        memset(row, 0, rw * sizeof(float));
+        const int offset = (ry0 + y) * pw + rx0;
+        for (int q = 0; q < num_protos; q++)
+        {
+            axpy(row, proto_plane(proto, q) + offset, job.coeffs[q], rw);
+        }
+        sigmoid_inplace(row, rw);
+    }
+
+    // 双线性采样到框大小（坐标相对区域左上角）后按 0.5 直接编码为游程
+    const cv::Mat m = (cv::Mat_<float>(2, 3) << a, 0.f, bx - rx0, 0.f, a, by - ry0);
+    cv::Mat box_prob;
+    cv::warpAffine(prob, box_prob, m, box.size(), cv::INTER_LINEAR | cv::WARP_INVERSE_MAP, cv::BORDER_REPLICATE);
+
+    std::shared_ptr<MaskRLE> rle = std::make_shared<MaskRLE>();
+    rle_encode_threshold(box_prob.ptr<float>(), box_prob.cols, box_prob.rows, box_prob.step, 0.5f, *rle);
+    *job.mask = rle;
+}
+
+void decode_instance_masks(const ncnn::Mat& proto, const MaskGeometry& geo,
+                           const std::vector<MaskJob>& jobs, int num_threads)
+{
+    const int n = (int)jobs.size();
+    const int workers = std::min(num_threads, n / MASK_JOBS_PER_THREAD);
+    if (workers <= 1)
+    {
+        for (const MaskJob& job : jobs)
+            decode_instance_mask(proto, geo, job);
+        return;
+    }
+
+    const BatchPlan plan = plan_batch(n, workers);
+    run_batch(n, plan, [&](int i) {
+        decode_instance_mask(proto, geo, jobs[i]);
+    });
+}
@@ -0,0 +1,45 @@
+#ifndef MASK_HEAD_H
+#define MASK_HEAD_H
+
+#include <memory>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <mat.h>
+
+#include "mask_rle.h"
+
+// =============================
+// YOLOv8-seg 掩码头（系数 x 原型 + sigmoid + 框内采样融合）
+// =============================
+//
+// 原型 "seg" 为 32 个 pw * ph 的平面（dims == 3 时按通道，dims == 2 时按行存放）。
+// 每个目标只在框对应的原型区域（外扩 1 格供双线性插值）内累加 32 个通道并做 sigmoid，
+// 再采样到框大小后按 0.5 直接编码为游程，不再逐帧创建 MatMul 等 ncnn 层，也不计算整幅原型图。
+
+// 单个目标的解码参数：box 为原图坐标（已裁剪到图像内），coeffs 为 32 个掩码系数
+struct MaskJob
+{
+    const float* coeffs;
+    cv::Rect box;
+    std::shared_ptr<const MaskRLE>* mask;   // 输出：box 大小的游程编码掩码
+};
+
+// 原图 -> 输入：x * scale + wpad / 2；输入 -> 原型：/ 4
+struct MaskGeometry
+{
+    float scale;
+    int wpad;
+    int hpad;
+    int proto_w;        // 输入宽高 / 4
+    int proto_h;
+};
+
+// 解码单个目标的掩码，box 为空时置空 mask
+void decode_instance_mask(const ncnn::Mat& proto, const MaskGeometry& geo, const MaskJob& job);
+
+// 解码全部目标，最多 num_threads 个线程按目标并行（目标较少时在调用线程完成）
+void decode_instance_masks(const ncnn::Mat& proto, const MaskGeometry& geo,
+                           const std::vector<MaskJob>& jobs, int num_threads);
+
+#endif // MASK_HEAD_H
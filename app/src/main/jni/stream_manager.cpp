@@ -0,0 +1,568 @@
+#include "stream_manager.h"
+
+#include <android/log.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "IYoloAlgo.h"
+#include "vision_infer.h"
+#include "jni_cache.h"
+#include "result_pack.h"
+#include "trace.h"
+
+// 默认 worker 数：推理本身由 g_lock 串行，两个 worker 可让格式转换 / 绘制 / 回调与推理重叠
+static const int DEFAULT_STREAM_WORKERS = 2;
+// 默认每批最多合并的流数（同一批在同一 Net 上并发多个 Extractor）
+static const int DEFAULT_STREAM_BATCH = 4;
+static const int STREAM_MAX_CONSECUTIVE_FAILURES = 10;
+
+struct StreamManager::Stream
+{
+    int id = 0;
+    std::string url;
+    DecoderThreadConfig threads;
+
+    // 回调对象（全局引用）及方法
+    jobject callback = nullptr;
+    jmethodID onFrame = nullptr;
+    jmethodID onError = nullptr;
+    jmethodID onConnChanged = nullptr;
+    jmethodID isDetecting = nullptr;
+
+    FFmpegVideoDecoder decoder;
+    std::thread decode_thread;
+    std::atomic<bool> stop{false};
+    std::atomic<bool> running{true};
+
+    // 以下三项由 StreamManager::mutex_ 保护
+    std::shared_ptr<AVFrame> pending;   // 最新待处理帧
+    double pending_time = 0;
+    bool busy = false;                  // 已有 worker 在处理本路
+
+    // 只由处理本路帧的 worker 访问（busy 保证同一时刻只有一个）
+    BYTETracker tracker{25, 30};
+    std::atomic<bool> reset_tracker{false};  // 置位后由处理本路的 worker 在下一帧前重建 tracker
+
+    std::mutex summary_mutex;
+    DetectSummary summary{0.f, 0.f, 0.f, std::string(), std::vector<std::string>()};
+
+    std::atomic<int> decoded{0};
+    std::atomic<int> inferred{0};
+    std::atomic<int> rendered{0};
+    std::atomic<int> dropped{0};
+};
+
+// 回调 Java 层，异常直接清除
+static void notifyConnection(JNIEnv* env, jobject callback, jmethodID onConnChanged, bool connected)
+{
+    env->CallVoidMethod(callback, onConnChanged, connected ? JNI_TRUE : JNI_FALSE);
+    if (env->ExceptionCheck())
+    {
+        env->ExceptionClear();
+    }
+}
+
+static void notifyError(JNIEnv* env, jobject callback, jmethodID onError, const std::string& error)
+{
+    jstring msg = env->NewStringUTF(error.c_str());
+    if (!msg)
+    {
+        env->ExceptionClear();
+        return;
+    }
+    env->CallVoidMethod(callback, onError, msg);
+    if (env->ExceptionCheck())
+    {
+        env->ExceptionClear();
+    }
+    env->DeleteLocalRef(msg);
+}
+
+StreamManager& StreamManager::instance()
+{
+    // 进程退出时不析构，避免仍在运行的线程被销毁
+    static StreamManager* manager = new StreamManager();
+    return *manager;
+}
+
+StreamManager::StreamManager()
+    : jvm_(nullptr), cursor_(0), next_id_(1),
+      worker_count_(DEFAULT_STREAM_WORKERS), max_batch_(DEFAULT_STREAM_BATCH), stopping_(false)
+{}
+
+// =============================
+// 流的增删
+// =============================
+
+int StreamManager::addStream(JNIEnv* env, const std::string& url, jobject callback,
+                             const DecoderThreadConfig& threads)
+{
+    if (url.empty() || !callback)
+        return -1;
+
+    {
+        if (!acquireModel())
+        {
+            __android_log_print(ANDROID_LOG_ERROR, "StreamManager", "model not loaded");
+            return -1;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!jvm_ && env->GetJavaVM(&jvm_) != JNI_OK)
+        {
+            jvm_ = nullptr;
+            return -1;
+        }
+    }
+
+    std::shared_ptr<Stream> stream = std::make_shared<Stream>();
+    stream->url = url;
+    stream->threads = threads;
+
+    jclass cls = env->GetObjectClass(callback);
+    stream->onFrame = env->GetMethodID(cls, "onNetworkFrameReceived",
+                                       "(Landroid/graphics/Bitmap;[Landroid/graphics/RectF;)V");
+    stream->onError = env->GetMethodID(cls, "onNetworkError", "(Ljava/lang/String;)V");
+    stream->onConnChanged = env->GetMethodID(cls, "onConnectionStatusChanged", "(Z)V");
+    stream->isDetecting = env->GetMethodID(cls, "isDetecting", "()Z");
+    env->DeleteLocalRef(cls);
+    if (!stream->onFrame || !stream->onError || !stream->onConnChanged || !stream->isDetecting)
+    {
+        __android_log_print(ANDROID_LOG_ERROR, "StreamManager", "failed to get callback methods");
+        if (env->ExceptionCheck())
+        {
+            env->ExceptionClear();
+        }
+        return -1;
+    }
+    stream->callback = env->NewGlobalRef(callback);
+
+    {
+        // 启动 worker 与登记流在同一 workers_mutex_ 区间内完成：
+        // removeStream 在该锁内复查 streams_ 为空才停 worker，不会停掉刚登记的流所需的 worker
+        std::lock_guard<std::mutex> workers_lock(workers_mutex_);
+        if (workers_.empty())
+        {
+            startWorkersLocked(worker_count_);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stream->id = next_id_++;
+        }
+
+        // 先启动解码线程再登记，保证 removeStream 看到的流 decode_thread 已就绪
+        stream->decode_thread = std::thread(&StreamManager::decodeLoop, this, stream);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            streams_[stream->id] = stream;
+            order_.push_back(stream->id);
+        }
+    }
+    cond_.notify_all();
+
+    __android_log_print(ANDROID_LOG_INFO, "StreamManager", "stream %d added: %s",
+                        stream->id, url.c_str());
+    return stream->id;
+}
+
+bool StreamManager::removeStream(JNIEnv* env, int id)
+{
+    std::shared_ptr<Stream> stream;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = streams_.find(id);
+        if (it == streams_.end())
+            return false;
+
+        stream = it->second;
+        streams_.erase(it);
+        order_.erase(std::remove(order_.begin(), order_.end(), id), order_.end());
+        if (cursor_ >= order_.size())
+            cursor_ = 0;
+    }
+
+    stream->stop.store(true);
+    stream->decoder.stop();
+    if (stream->decode_thread.joinable())
+    {
+        stream->decode_thread.join();
+    }
+
+    // 等待正在处理本路帧的 worker 完成
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [&stream] { return !stream->busy; });
+        stream->pending.reset();
+    }
+
+    env->DeleteGlobalRef(stream->callback);
+    stream->callback = nullptr;
+    releaseBitmapPool(env, id);
+    clearResults(id);
+
+    // 最后一路移除后停掉 worker；持有 workers_mutex_ 时复查，期间新加入的流会让 streams_ 非空
+    {
+        std::lock_guard<std::mutex> workers_lock(workers_mutex_);
+        bool empty;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            empty = streams_.empty();
+        }
+        if (empty && !workers_.empty())
+        {
+            stopWorkers();
+        }
+    }
+
+    __android_log_print(ANDROID_LOG_INFO, "StreamManager", "stream %d removed", id);
+    return true;
+}
+
+void StreamManager::removeAll(JNIEnv* env)
+{
+    for (int id : streamIds())
+    {
+        removeStream(env, id);
+    }
+}
+
+void StreamManager::resetTrackers()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& it : streams_)
+    {
+        it.second->reset_tracker = true;
+    }
+}
+
+std::vector<int> StreamManager::streamIds()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return order_;
+}
+
+bool StreamManager::getStats(int id, StreamStats& stats)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(id);
+    if (it == streams_.end())
+        return false;
+
+    const Stream& stream = *it->second;
+    stats.decoded  = stream.decoded.load();
+    stats.inferred = stream.inferred.load();
+    stats.rendered = stream.rendered.load();
+    stats.dropped  = stream.dropped.load();
+    stats.running  = stream.running.load();
+    return true;
+}
+
+bool StreamManager::getSummary(int id, DetectSummary& summary)
+{
+    std::shared_ptr<Stream> stream;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = streams_.find(id);
+        if (it == streams_.end())
+            return false;
+        stream = it->second;
+    }
+
+    std::lock_guard<std::mutex> lock(stream->summary_mutex);
+    summary = stream->summary;
+    return true;
+}
+
+// =============================
+// worker 池
+// =============================
+
+void StreamManager::setWorkerCount(int count)
+{
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    worker_count_ = count > 0 ? count : DEFAULT_STREAM_WORKERS;
+
+    bool has_streams;
+    {
+        std::lock_guard<std::mutex> stream_lock(mutex_);
+        has_streams = !streams_.empty();
+    }
+    if (!workers_.empty() || has_streams)
+    {
+        stopWorkers();
+        startWorkersLocked(worker_count_);
+    }
+}
+
+void StreamManager::setMaxBatch(int batch)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_batch_ = batch > 0 ? batch : DEFAULT_STREAM_BATCH;
+}
+
+void StreamManager::startWorkersLocked(int count)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        workers_.emplace_back(&StreamManager::workerLoop, this);
+    }
+}
+
+void StreamManager::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cond_.notify_all();
+
+    for (auto& worker : workers_)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+    workers_.clear();
+}
+
+std::shared_ptr<StreamManager::Stream> StreamManager::pickReadyLocked()
+{
+    const size_t n = order_.size();
+    for (size_t k = 0; k < n; k++)
+    {
+        const size_t idx = (cursor_ + k) % n;
+        auto it = streams_.find(order_[idx]);
+        if (it == streams_.end())
+            continue;
+
+        Stream& stream = *it->second;
+        if (stream.pending && !stream.busy)
+        {
+            // 下一次从这一路之后开始找，保证各路轮流被处理
+            cursor_ = (idx + 1) % n;
+            return it->second;
+        }
+    }
+    return nullptr;
+}
+
+void StreamManager::workerLoop()
+{
+    JNIEnv* env = nullptr;
+    if (jvm_->AttachCurrentThread(&env, nullptr) != JNI_OK)
+    {
+        __android_log_print(ANDROID_LOG_ERROR, "StreamManager", "worker attach failed");
+        return;
+    }
+
+    while (true)
+    {
+        // 按轮询顺序一次取出最多 max_batch_ 路的待处理帧
+        std::vector<std::shared_ptr<Stream> > batch;
+        std::vector<std::shared_ptr<AVFrame> > frames;
+        std::vector<double> times;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            std::shared_ptr<Stream> first;
+            cond_.wait(lock, [this, &first] {
+                return stopping_ || (first = pickReadyLocked()) != nullptr;
+            });
+            if (stopping_)
+                break;
+
+            for (std::shared_ptr<Stream> stream = first; stream; )
+            {
+                frames.push_back(std::move(stream->pending));
+                times.push_back(stream->pending_time);
+                stream->busy = true;
+                batch.push_back(std::move(stream));
+
+                if ((int)batch.size() >= max_batch_)
+                    break;
+                stream = pickReadyLocked();
+            }
+        }
+
+        processBatch(env, batch, frames, times);
+        frames.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& stream : batch)
+            {
+                stream->busy = false;
+            }
+        }
+        // 这些流可能已有新帧；removeStream 也在等待 busy 清零
+        cond_.notify_all();
+    }
+
+    jvm_->DetachCurrentThread();
+}
+
+void StreamManager::processBatch(JNIEnv* env, const std::vector<std::shared_ptr<Stream> >& batch,
+                                 const std::vector<std::shared_ptr<AVFrame> >& frames,
+                                 const std::vector<double>& times)
+{
+    const int n = batch.size();
+
+    std::vector<bool> detecting(n, false);
+    for (int i = 0; i < n; i++)
+    {
+        jboolean value = env->CallBooleanMethod(batch[i]->callback, batch[i]->isDetecting);
+        if (env->ExceptionCheck())
+        {
+            env->ExceptionClear();
+            value = JNI_FALSE;
+        }
+        detecting[i] = (value == JNI_TRUE);
+    }
+
+    // 推理：支持 letterbox 的模型整批送入，其余逐帧
+    std::vector<cv::Mat> rgbs(n);
+    std::vector<std::vector<Object> > objects(n);
+    std::vector<std::shared_ptr<IYoloAlgo> > models(n);   // 各帧实际用于推理的模型
+    std::vector<float> forward_ms(n, 0.f);
+    std::vector<Letterbox> letterboxes;
+    std::vector<int> letterbox_index;
+    const int targetSize = getModelTargetSize();
+    for (int i = 0; i < n; i++)
+    {
+        if (!detecting[i])
+            continue;
+
+        Letterbox lb;
+        if (targetSize > 0 && batch[i]->decoder.convert_letterbox(frames[i].get(), targetSize, lb))
+        {
+            letterboxes.push_back(std::move(lb));
+            letterbox_index.push_back(i);
+            continue;
+        }
+        objects[i] = inferDecodedFrame(batch[i]->decoder, frames[i].get(), rgbs[i], models[i]);
+        forward_ms[i] = trace_thread_last_ms(TRACE_FORWARD);
+    }
+    if (!letterboxes.empty())
+    {
+        std::vector<std::vector<Object> > results;
+        std::shared_ptr<IYoloAlgo> model;
+        // 整批的各帧在多个线程上并发前向，各帧记为整批推理的耗时
+        const int64_t t_batch = trace_now_us();
+        if (detectLetterboxedBatch(letterboxes, results, &model))
+        {
+            const float batch_ms = (trace_now_us() - t_batch) / 1000.f;
+            for (size_t k = 0; k < letterbox_index.size(); k++)
+            {
+                objects[letterbox_index[k]] = std::move(results[k]);
+                models[letterbox_index[k]] = model;
+                forward_ms[letterbox_index[k]] = batch_ms;
+            }
+        }
+    }
+
+    // 逐路：转全分辨率 RGB -> 绘制（各自的跟踪器）-> 回调
+    for (int i = 0; i < n; i++)
+    {
+        Stream& stream = *batch[i];
+        if (stream.reset_tracker.exchange(false))
+            stream.tracker = BYTETracker(25, 30);
+        if (detecting[i])
+            stream.inferred++;
+
+        if (rgbs[i].empty() && !stream.decoder.convert_rgb(frames[i].get(), rgbs[i]))
+            continue;
+
+        if (detecting[i])
+        {
+            DetectSummary summary = drawAndSummarize(rgbs[i], objects[i], times[i], forward_ms[i], &stream.tracker, models[i]);
+            publishResults(stream.id, objects[i], rgbs[i].cols, rgbs[i].rows);
+            std::lock_guard<std::mutex> lock(stream.summary_mutex);
+            stream.summary = std::move(summary);
+        }
+
+        deliverNetworkFrame(env, stream.callback, stream.onFrame, rgbs[i], objects[i], stream.id);
+        stream.rendered++;
+    }
+}
+
+// =============================
+// 每路流的解码线程
+// =============================
+
+void StreamManager::decodeLoop(std::shared_ptr<Stream> stream)
+{
+    JNIEnv* env = nullptr;
+    if (jvm_->AttachCurrentThread(&env, nullptr) != JNI_OK)
+    {
+        __android_log_print(ANDROID_LOG_ERROR, "StreamManager", "decode attach failed");
+        stream->running.store(false);
+        return;
+    }
+
+    // 解包 / 码流解析放到小核，FFmpeg 工作线程在 init 中同样绑到小核
+    pinCurrentThreadToLittleCores(nullptr);
+
+    if (!stream->decoder.init(stream->url.c_str(), stream->threads))
+    {
+        std::string error = stream->decoder.getLastError();
+        __android_log_print(ANDROID_LOG_ERROR, "StreamManager", "stream %d init failed: %s",
+                            stream->id, error.c_str());
+        notifyError(env, stream->callback, stream->onError, "无法连接网络流\n\nFFmpeg错误: " + error);
+        notifyConnection(env, stream->callback, stream->onConnChanged, false);
+        stream->running.store(false);
+        jvm_->DetachCurrentThread();
+        return;
+    }
+    notifyConnection(env, stream->callback, stream->onConnChanged, true);
+
+    int consecutiveFailures = 0;
+    while (!stream->stop.load())
+    {
+        // 计时从解码前开始，与单路播放路径一致（allTimeMs / FPS 含解码耗时）
+        const double t_decode = ncnn::get_current_time();
+        if (!stream->decoder.receive_frame())
+        {
+            if (stream->stop.load() || stream->decoder.end_of_stream)
+                break;
+
+            consecutiveFailures++;
+            if (consecutiveFailures >= STREAM_MAX_CONSECUTIVE_FAILURES)
+            {
+                notifyError(env, stream->callback, stream->onError,
+                            "无法解码视频流，可能流已断开或格式不支持");
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        consecutiveFailures = 0;
+
+        std::shared_ptr<AVFrame> frame = stream->decoder.ref_frame();
+        if (!frame)
+            continue;
+        stream->decoded++;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stream->pending)
+                stream->dropped++;
+            stream->pending = std::move(frame);
+            stream->pending_time = t_decode;
+        }
+        cond_.notify_one();
+    }
+
+    stream->running.store(false);
+    notifyConnection(env, stream->callback, stream->onConnChanged, false);
+    jvm_->DetachCurrentThread();
+
+    __android_log_print(ANDROID_LOG_INFO, "StreamManager", "stream %d decode stopped, decoded=%d",
+                        stream->id, stream->decoded.load());
+}
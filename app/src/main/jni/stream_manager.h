@@ -0,0 +1,106 @@
+#ifndef STREAM_MANAGER_H
+#define STREAM_MANAGER_H
+
+#include <jni.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vision_base.h"
+#include "ffmpeg_decoder.h"
+
+// =============================
+// 多路流推理服务
+// =============================
+//
+// - 每路流一个 FFmpegVideoDecoder + 解码线程，解码帧只保留最新一帧（待处理槽），旧帧直接丢弃
+// - 所有流共享一个 worker 池和已加载的模型；worker 按轮询顺序挑选有待处理帧的流，
+//   每路流同一时刻最多一帧在处理，高帧率的流只会覆盖自己的待处理帧，不会挤占其它流
+// - worker 一次最多取 max_batch 路的帧，整批送入 detectLetterboxedBatch（同一 Net 并发多个 Extractor）
+// - 每路流独立的 BYTETracker 与摘要
+// - 回调对象与单路网络流相同（NetworkVideoManager）：
+//   onNetworkFrameReceived(Bitmap, RectF[])（RectF[] 默认为 null，结果按流 id 从 getDetectResults 读取）/
+//   onNetworkError(String) /
+//   onConnectionStatusChanged(boolean) / isDetecting()
+
+// 单路流统计
+struct StreamStats
+{
+    int decoded;    // 已解码帧
+    int inferred;   // 已推理帧
+    int rendered;   // 已回调帧
+    int dropped;    // 未来得及处理被新帧覆盖的帧
+    bool running;   // 解码线程是否仍在运行
+};
+
+class StreamManager
+{
+public:
+    static StreamManager& instance();
+
+    // 启动一路流，返回流 id（> 0）；模型未加载或参数错误返回 -1
+    int addStream(JNIEnv* env, const std::string& url, jobject callback,
+                  const DecoderThreadConfig& threads);
+
+    // 停止并移除一路流（等待解码线程退出、正在处理的帧完成），env 用于释放回调引用
+    bool removeStream(JNIEnv* env, int id);
+
+    // 停止所有流
+    void removeAll(JNIEnv* env);
+
+    // 设置 worker 数量（<= 0 时取默认值），立即重建 worker 池
+    void setWorkerCount(int count);
+
+    // 设置每批最多合并的流数（<= 0 时取默认值），1 表示逐帧推理
+    void setMaxBatch(int batch);
+
+    // 清空各路的轨迹（切换模型后旧轨迹的类别不再适用），在各路下一帧处理前生效
+    void resetTrackers();
+
+    bool getStats(int id, StreamStats& stats);
+    bool getSummary(int id, DetectSummary& summary);
+
+    std::vector<int> streamIds();
+
+private:
+    struct Stream;
+
+    StreamManager();
+    StreamManager(const StreamManager&) = delete;
+    StreamManager& operator=(const StreamManager&) = delete;
+
+    // 以下两个需持有 workers_mutex_
+    void startWorkersLocked(int count);
+    void stopWorkers();
+    void workerLoop();
+    void decodeLoop(std::shared_ptr<Stream> stream);
+    void processBatch(JNIEnv* env, const std::vector<std::shared_ptr<Stream> >& batch,
+                      const std::vector<std::shared_ptr<AVFrame> >& frames,
+                      const std::vector<double>& times);
+
+    // 轮询选出下一路有待处理帧且空闲的流（需持有 mutex_）
+    std::shared_ptr<Stream> pickReadyLocked();
+
+    JavaVM* jvm_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::map<int, std::shared_ptr<Stream> > streams_;
+    std::vector<int> order_;    // 轮询顺序（按加入先后）
+    size_t cursor_;
+    int next_id_;
+
+    std::mutex workers_mutex_;  // 串行化 worker 池的启停
+    std::vector<std::thread> workers_;
+    int worker_count_;
+    int max_batch_;             // 由 mutex_ 保护
+    bool stopping_;
+};
+
+#endif // STREAM_MANAGER_H
@@ -0,0 +1,249 @@
+#include "trace.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+static const char* const g_trace_stage_names[TRACE_STAGE_COUNT] = {
+        "decode", "convert", "preprocess", "forward", "proposal",
+        "nms", "track", "draw", "jni"
+};
+
+static std::atomic<bool> g_trace_enabled(false);
+static std::atomic<int64_t> g_trace_last_us[TRACE_STAGE_COUNT];
+static thread_local int64_t g_trace_thread_last_us[TRACE_STAGE_COUNT];
+
+// =============================
+// 每线程环形缓冲
+// =============================
+//
+// 单写者（所属线程）多读者：事件字段都是原子量，写完后用 release 发布写指针；
+// 读者与正在被覆盖的旧事件可能交错，只影响统计里的个别样本，不会读到撕裂的数值
+
+struct TraceRing
+{
+    int tid = 0;
+    std::atomic<bool> in_use{false};
+    std::atomic<uint64_t> head{0};   // 累计写入的事件数
+    std::atomic<int64_t> begin_us[TRACE_RING_CAPACITY];
+    std::atomic<uint32_t> packed[TRACE_RING_CAPACITY];   // 高 8 位阶段，低 24 位耗时（us，最长约 16.7s）
+
+    void clear()
+    {
+        head.store(0, std::memory_order_release);
+    }
+};
+
+static std::mutex g_trace_rings_mutex;
+static std::vector<std::unique_ptr<TraceRing> > g_trace_rings;
+
+// 线程退出时归还环形缓冲，供后续新线程复用（缓冲本身不释放，导出时仍可读取）
+struct TraceRingHolder
+{
+    TraceRing* ring = nullptr;
+
+    ~TraceRingHolder()
+    {
+        if (ring)
+            ring->in_use.store(false, std::memory_order_release);
+    }
+};
+
+static TraceRing* acquire_ring()
+{
+    static thread_local TraceRingHolder holder;
+    if (holder.ring)
+        return holder.ring;
+
+    std::lock_guard<std::mutex> lock(g_trace_rings_mutex);
+    for (auto& ring : g_trace_rings)
+    {
+        bool expected = false;
+        if (ring->in_use.compare_exchange_strong(expected, true))
+        {
+            holder.ring = ring.get();
+            return holder.ring;
+        }
+    }
+
+    std::unique_ptr<TraceRing> ring(new TraceRing());
+    ring->tid = (int)g_trace_rings.size() + 1;
+    ring->in_use.store(true);
+    holder.ring = ring.get();
+    g_trace_rings.push_back(std::move(ring));
+    return holder.ring;
+}
+
+// =============================
+// 记录
+// =============================
+
+const char* trace_stage_name(int stage)
+{
+    if (stage < 0 || stage >= TRACE_STAGE_COUNT)
+        return "unknown";
+    return g_trace_stage_names[stage];
+}
+
+void trace_set_enabled(bool enabled)
+{
+    g_trace_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool trace_enabled()
+{
+    return g_trace_enabled.load(std::memory_order_relaxed);
+}
+
+int64_t trace_now_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void trace_record(int stage, int64_t begin_us)
+{
+    if (stage < 0 || stage >= TRACE_STAGE_COUNT)
+        return;
+
+    const int64_t duration = std::max<int64_t>(0, trace_now_us() - begin_us);
+    g_trace_last_us[stage].store(duration, std::memory_order_relaxed);
+    g_trace_thread_last_us[stage] = duration;
+
+    if (!g_trace_enabled.load(std::memory_order_relaxed))
+        return;
+
+    TraceRing* ring = acquire_ring();
+    const uint64_t head = ring->head.load(std::memory_order_relaxed);
+    const size_t slot = head % TRACE_RING_CAPACITY;
+    const uint32_t clamped = (uint32_t)std::min<int64_t>(duration, 0xFFFFFF);
+    ring->begin_us[slot].store(begin_us, std::memory_order_relaxed);
+    ring->packed[slot].store(((uint32_t)stage << 24) | clamped, std::memory_order_relaxed);
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+float trace_last_ms(int stage)
+{
+    if (stage < 0 || stage >= TRACE_STAGE_COUNT)
+        return 0.f;
+    return g_trace_last_us[stage].load(std::memory_order_relaxed) / 1000.f;
+}
+
+float trace_thread_last_ms(int stage)
+{
+    if (stage < 0 || stage >= TRACE_STAGE_COUNT)
+        return 0.f;
+    return g_trace_thread_last_us[stage] / 1000.f;
+}
+
+// =============================
+// 汇总 / 导出
+// =============================
+
+struct TraceEvent
+{
+    int tid;
+    int stage;
+    int64_t begin_us;
+    uint32_t duration_us;
+};
+
+static void collect_events(std::vector<TraceEvent>& events)
+{
+    std::lock_guard<std::mutex> lock(g_trace_rings_mutex);
+    for (const auto& ring : g_trace_rings)
+    {
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        const uint64_t count = std::min<uint64_t>(head, TRACE_RING_CAPACITY);
+        for (uint64_t i = head - count; i < head; i++)
+        {
+            const size_t slot = i % TRACE_RING_CAPACITY;
+            const uint32_t packed = ring->packed[slot].load(std::memory_order_relaxed);
+
+            TraceEvent ev;
+            ev.tid = ring->tid;
+            ev.stage = packed >> 24;
+            ev.begin_us = ring->begin_us[slot].load(std::memory_order_relaxed);
+            ev.duration_us = packed & 0xFFFFFF;
+            if (ev.stage < TRACE_STAGE_COUNT)
+                events.push_back(ev);
+        }
+    }
+}
+
+static float percentile(std::vector<uint32_t>& values, float q)
+{
+    const size_t k = std::min(values.size() - 1, (size_t)(q * (values.size() - 1) + 0.5f));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k] / 1000.f;
+}
+
+void trace_stats(float stats[TRACE_STAGE_COUNT * TRACE_STAT_FIELDS])
+{
+    std::vector<TraceEvent> events;
+    collect_events(events);
+
+    std::vector<uint32_t> durations[TRACE_STAGE_COUNT];
+    for (const auto& ev : events)
+    {
+        durations[ev.stage].push_back(ev.duration_us);
+    }
+
+    for (int s = 0; s < TRACE_STAGE_COUNT; s++)
+    {
+        float* out = stats + s * TRACE_STAT_FIELDS;
+        std::vector<uint32_t>& values = durations[s];
+        std::fill(out, out + TRACE_STAT_FIELDS, 0.f);
+        if (values.empty())
+            continue;
+
+        double sum = 0;
+        for (uint32_t v : values)
+            sum += v;
+
+        out[0] = (float)values.size();
+        out[1] = (float)(sum / values.size() / 1000.0);
+        out[2] = percentile(values, 0.50f);
+        out[3] = percentile(values, 0.95f);
+        out[4] = percentile(values, 0.99f);
+    }
+}
+
+void trace_reset()
+{
+    std::lock_guard<std::mutex> lock(g_trace_rings_mutex);
+    for (auto& ring : g_trace_rings)
+    {
+        ring->clear();
+    }
+}
+
+bool trace_dump_chrome(const std::string& path)
+{
+    std::vector<TraceEvent> events;
+    collect_events(events);
+
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (!fp)
+        return false;
+
+    // Complete 事件（ph = X），时间单位为微秒
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const TraceEvent& ev = events[i];
+        fprintf(fp, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%u}%s\n",
+                trace_stage_name(ev.stage), ev.tid, (long long)ev.begin_us, ev.duration_us,
+                i + 1 < events.size() ? "," : "");
+    }
+    fprintf(fp, "],\"displayTimeUnit\":\"ms\"}\n");
+
+    const bool ok = ferror(fp) == 0;
+    fclose(fp);
+    return ok;
+}
@@ -0,0 +1,80 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <string>
+
+// =============================
+// 分阶段耗时追踪
+// =============================
+//
+// - 每个线程一个定长环形缓冲，只有本线程写入（无锁），查询时汇总所有线程的最近事件
+// - TRACE_SCOPE(stage) 在作用域结束时记录一段耗时；未开启追踪时只更新各阶段的最近一次耗时
+// - 可导出 Chrome trace JSON（chrome://tracing / Perfetto 打开）
+
+enum TraceStage
+{
+    TRACE_DECODE = 0,    // 视频解码
+    TRACE_CONVERT,       // 颜色空间转换（YUV -> RGB / letterbox）
+    TRACE_PREPROCESS,    // 缩放、填充
+    TRACE_FORWARD,       // 网络前向
+    TRACE_PROPOSAL,      // 候选框解码、排序
+    TRACE_NMS,           // NMS
+    TRACE_TRACK,         // 跟踪
+    TRACE_DRAW,          // 绘制（含跟踪）
+    TRACE_JNI,           // JNI 数据封送（Bitmap / RectF[]）
+    TRACE_STAGE_COUNT
+};
+
+// 每线程环形缓冲容量（事件数）
+#define TRACE_RING_CAPACITY 4096
+
+// 每个阶段的统计量个数：次数、均值、p50、p95、p99（单位 ms）
+#define TRACE_STAT_FIELDS 5
+
+const char* trace_stage_name(int stage);
+
+void trace_set_enabled(bool enabled);
+bool trace_enabled();
+
+// 单调时钟，微秒
+int64_t trace_now_us();
+
+// 记录一段 [begin_us, now) 的耗时
+void trace_record(int stage, int64_t begin_us);
+
+// 某阶段最近一次耗时（ms，任意线程），未开启追踪时同样更新
+float trace_last_ms(int stage);
+
+// 本线程记录的某阶段最近一次耗时（ms）；多条流水线并发时用它取本帧的耗时，
+// 推理与汇总不在同一线程时由推理线程取出后随结果传递
+float trace_thread_last_ms(int stage);
+
+// 汇总所有线程环形缓冲中的事件，stats 按 [stage][TRACE_STAT_FIELDS] 排布
+void trace_stats(float stats[TRACE_STAGE_COUNT * TRACE_STAT_FIELDS]);
+
+// 清空所有线程的环形缓冲
+void trace_reset();
+
+// 导出 Chrome trace JSON，成功返回 true
+bool trace_dump_chrome(const std::string& path);
+
+class TraceScope
+{
+public:
+    explicit TraceScope(int stage) : stage_(stage), begin_(trace_now_us()) {}
+    ~TraceScope() { trace_record(stage_, begin_); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    int stage_;
+    int64_t begin_;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(stage) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(stage)
+
+#endif // TRACE_H
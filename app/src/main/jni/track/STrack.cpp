@@ -197,4 +197,27 @@ void STrack::multi_predict(vector<STrack*> &stracks, byte_kalman::KalmanFilter &
 		stracks[i]->static_tlwh();
 		stracks[i]->static_tlbr();
 	}
+}
+
+vector<float> STrack::predict_ahead(float steps) const
+{
+	if (this->state == TrackState::New || steps <= 0.f)
+		return tlwh;
+
+	// 卡尔曼运动矩阵为匀速模型，predict k 次的均值即 x + k * v，这里直接线性外推，
+	// 不需要协方差，也支持小数步长（推理间隔跨多个相机帧时）
+	float x = mean[0] + mean[4] * steps;
+	float y = mean[1] + mean[5] * steps;
+	float a = mean[2] + mean[6] * steps;
+	// 非跟踪状态的高度速度不可信，与 multi_predict 一致视为零
+	float h = mean[3] + (this->state == TrackState::Tracked ? mean[7] * steps : 0.f);
+	if (h <= 0.f || a <= 0.f)
+		return tlwh;
+
+	vector<float> out(4);
+	out[2] = a * h;
+	out[3] = h;
+	out[0] = x - out[2] / 2;
+	out[1] = y - out[3] / 2;
+	return out;
 }
\ No newline at end of file
@@ -17,6 +17,8 @@ public:
 
 	vector<float> static tlbr_to_tlwh(vector<float> &tlbr);
 	void static multi_predict(vector<STrack*> &stracks, byte_kalman::KalmanFilter &kalman_filter);
+	// 按匀速运动模型把当前状态外推 steps 个更新周期（可为小数），返回预测框 tlwh，不修改轨迹状态
+	vector<float> predict_ahead(float steps) const;
 	void static_tlwh();
 	void static_tlbr();
 	vector<float> tlwh_to_xyah(vector<float> tlwh_tmp);
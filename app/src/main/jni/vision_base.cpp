@@ -8,21 +8,36 @@ DetectSummary g_summary;
 std::unique_ptr<DetectSummary> g_summary_cache = nullptr;
 std::mutex g_summary_mutex;
 ncnn::Mutex g_lock;
-IYoloAlgo* g_yolo = nullptr;
+static std::shared_ptr<IYoloAlgo> g_yolo;
 float g_threshold = 0.45f;
 float g_nms = 0.65f;
+int g_nms_mode = 0;
 bool trackEnabled = false;
 bool shaderEnabled = false;
 
+std::shared_ptr<IYoloAlgo> acquireModel()
+{
+    return std::atomic_load(&g_yolo);
+}
+
+std::shared_ptr<IYoloAlgo> swapModel(std::shared_ptr<IYoloAlgo> model)
+{
+    return std::atomic_exchange(&g_yolo, std::move(model));
+}
+
 std::pair<std::string, std::vector<std::string>>
-updateDetectSummary(const std::vector<Object>& objects, const char** class_names)
+updateDetectSummary(const std::vector<Object>& objects, const char** class_names, int class_count)
 {
     std::map<int, int> cls_count;
     std::string logText;
     std::vector<std::string> classInfo;
 
+    // 超出类别表的标签（与类别表不属于同一模型时）不计入
     for (const auto& obj : objects)
-        cls_count[obj.label]++;
+    {
+        if (obj.label >= 0 && obj.label < class_count)
+            cls_count[obj.label]++;
+    }
 
     if (!cls_count.empty())
     {
@@ -8,8 +8,11 @@
 
 #include <platform.h>
 #include <benchmark.h>
+#include <mat.h>
 #include <opencv2/core/core.hpp>
 
+#include "mask_rle.h"
+
 // 类别名称与颜色（由各算法实现文件提供）
 extern const char* class_names[10];
 extern const unsigned char colors[10][3];
@@ -33,8 +36,12 @@ struct FaceKeyPoint {
 
 // 分割结果
 struct MarkPoint {
-    cv::Mat mask;
-    std::vector<float> mask_feat;
+    // 实例掩码（游程编码，见 mask_rle.h），只覆盖目标框，左上角位于原图 origin
+    // 解码后只读，Object 拷贝（排序 / NMS / 预览平移）只增加引用计数
+    std::shared_ptr<const MaskRLE> mask;
+    cv::Point origin;
+    // 解码前：候选在检测输出中的行号，掩码系数直接从该行读取
+    int anchor = -1;
 };
 
 // 通用目标检测结果
@@ -42,6 +49,8 @@ struct Object {
     cv::Rect_<float> rect;
     int label;
     float prob;
+    // 跟踪 ID（开启跟踪时由绘制阶段回填，未匹配到轨迹为 -1）
+    int track_id = -1;
 
     // 分割结果
     MarkPoint markPoint;
@@ -51,6 +60,28 @@ struct Object {
     std::vector<FaceKeyPoint> Face_keyPoints;
 };
 
+// 模型输入 letterbox：原图等比缩放后居中填充（114）到 32 的倍数
+// 解码阶段直接生成，推理时无需再从原图缩放
+struct Letterbox {
+    cv::Mat image;   // RGB，CV_8UC3，连续内存
+    float scale;     // 原图 -> 网络输入的缩放比
+    int wpad;        // 水平方向总填充（左侧 wpad / 2）
+    int hpad;        // 垂直方向总填充（上方 hpad / 2）
+    int orig_w;      // 原图宽高（已按旋转元数据矫正）
+    int orig_h;
+};
+
+// 模型输入张量 letterbox：已缩放、填充并归一化的 float 张量（R、G、B 三个平面）
+// 相机路径由 NV21 一次生成（见 nv21_letterbox.h），推理时直接送入网络
+struct LetterboxTensor {
+    ncnn::Mat tensor;
+    float scale;
+    int wpad;
+    int hpad;
+    int orig_w;
+    int orig_h;
+};
+
 // 检测摘要信息（提供给 Java 层）
 struct DetectSummary {
     float allTimeMs;
@@ -58,6 +89,12 @@ struct DetectSummary {
     float fps;
     std::string logText;                  // 目标统计文本
     std::vector<std::string> class_info;  // 各类别计数
+
+    // 相机采集配置（协商结果），非相机来源为 0
+    int captureWidth = 0;
+    int captureHeight = 0;
+    int captureFpsMin = 0;
+    int captureFpsMax = 0;
 };
 
 // =============================
@@ -68,18 +105,23 @@ extern DetectSummary g_summary;
 extern std::unique_ptr<DetectSummary> g_summary_cache;
 extern std::mutex g_summary_mutex;
 
-// ncnn 全局锁（保护 g_yolo / 推理流程）
+// ncnn 全局锁（串行化推理流程）
 extern ncnn::Mutex g_lock;
 
 // 前向声明：算法基类
 class IYoloAlgo;
 
-// 当前加载的算法实例
-extern IYoloAlgo* g_yolo;
+// 当前加载的算法实例（RCU 式读写）：读者取得引用后即使模型被切换也可继续使用，
+// 最后一个引用释放时旧模型才析构；切换只替换指针，不等待正在进行的推理
+std::shared_ptr<IYoloAlgo> acquireModel();
+
+// 原子替换当前模型，返回旧模型
+std::shared_ptr<IYoloAlgo> swapModel(std::shared_ptr<IYoloAlgo> model);
 
 // 推理配置
 extern float g_threshold;
 extern float g_nms;
+extern int g_nms_mode;   // NMS 模式，取值见 nms.h 中的 NmsMode
 extern bool trackEnabled;
 extern bool shaderEnabled;
 
@@ -87,9 +129,9 @@ extern bool shaderEnabled;
 // 与检测/绘制无关的统计与工具函数
 // =============================
 
-// 由检测结果统计各类别数量，生成日志与类别信息列表
+// 由检测结果统计各类别数量，生成日志与类别信息列表；class_count 为 class_names 的长度
 std::pair<std::string, std::vector<std::string>>
-updateDetectSummary(const std::vector<Object>& objects, const char** class_names);
+updateDetectSummary(const std::vector<Object>& objects, const char** class_names, int class_count);
 
 // 生成检测结果日志字符串（仅统计，不做绘制）
 std::string buildDetectLog(const std::vector<Object>& objects, const char* class_names[]);
@@ -4,8 +4,15 @@
 #include <android/log.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
 
 #include "IYoloAlgo.h"
+#include "trace.h"
+#include "jni_cache.h"
+#include "result_pack.h"
+#include "mask_overlay.h"
 
 // 算法头文件
 #include "HighSpeed.h"
@@ -21,55 +28,98 @@
 // Mat / Bitmap 互转
 // =============================
 
-jobject matToBitmap(JNIEnv* env, const cv::Mat& src)
+// RGB / RGBA 直接写入 Bitmap 的像素缓冲（按 Bitmap 行跨度），不经过中间 Mat
+static bool writeMatToBitmap(JNIEnv* env, jobject bitmap, const cv::Mat& src)
 {
-    if (src.empty())
-        return nullptr;
+    AndroidBitmapInfo info;
+    if (AndroidBitmap_getInfo(env, bitmap, &info) < 0)
+        return false;
+    if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888
+        || (int)info.width != src.cols || (int)info.height != src.rows)
+        return false;
 
-    cv::Mat rgba;
+    void* pixels;
+    if (AndroidBitmap_lockPixels(env, bitmap, &pixels) < 0)
+        return false;
+
+    cv::Mat dst(info.height, info.width, CV_8UC4, pixels, info.stride);
     if (src.channels() == 3)
     {
-        cv::cvtColor(src, rgba, cv::COLOR_RGB2RGBA);
+        cv::cvtColor(src, dst, cv::COLOR_RGB2RGBA);
     }
-    else if (src.channels() == 4)
+    else
     {
-        rgba = src;
+        src.copyTo(dst);
+    }
+    const bool ok = dst.data == pixels;   // 尺寸类型一致时 OpenCV 不会重新分配
+
+    AndroidBitmap_unlockPixels(env, bitmap);
+    return ok;
+}
+
+jobject matToBitmap(JNIEnv* env, const cv::Mat& src)
+{
+    TRACE_SCOPE(TRACE_JNI);
+    if (src.empty() || (src.channels() != 3 && src.channels() != 4))
+        return nullptr;
+
+    jobject bitmap = nullptr;
+    const JniCache* c = jni_cache();
+    if (c)
+    {
+        bitmap = env->CallStaticObjectMethod(c->bitmapCls, c->bitmapCreate, src.cols, src.rows, c->argb8888);
     }
     else
     {
+        // 缓存未就绪时回退到逐次查找
+        jclass bitmapCls = env->FindClass("android/graphics/Bitmap");
+        jmethodID createBitmapFunc = env->GetStaticMethodID(
+                bitmapCls, "createBitmap",
+                "(IILandroid/graphics/Bitmap$Config;)Landroid/graphics/Bitmap;");
+        jclass bitmapConfigCls = env->FindClass("android/graphics/Bitmap$Config");
+        jfieldID argbField = env->GetStaticFieldID(
+                bitmapConfigCls, "ARGB_8888", "Landroid/graphics/Bitmap$Config;");
+        jobject argbConfig = env->GetStaticObjectField(bitmapConfigCls, argbField);
+        bitmap = env->CallStaticObjectMethod(bitmapCls, createBitmapFunc, src.cols, src.rows, argbConfig);
+        env->DeleteLocalRef(argbConfig);
+        env->DeleteLocalRef(bitmapConfigCls);
+        env->DeleteLocalRef(bitmapCls);
+    }
+    if (!bitmap || env->ExceptionCheck())
+    {
+        env->ExceptionClear();
         return nullptr;
     }
 
-    jclass bitmapCls = env->FindClass("android/graphics/Bitmap");
-    jmethodID createBitmapFunc = env->GetStaticMethodID(
-            bitmapCls, "createBitmap",
-            "(IILandroid/graphics/Bitmap$Config;)Landroid/graphics/Bitmap;");
-
-    jstring configName = env->NewStringUTF("ARGB_8888");
-    jclass bitmapConfigCls = env->FindClass("android/graphics/Bitmap$Config");
-    jmethodID valueOfFunc = env->GetStaticMethodID(
-            bitmapConfigCls, "valueOf",
-            "(Ljava/lang/String;)Landroid/graphics/Bitmap$Config;");
+    writeMatToBitmap(env, bitmap, src);
+    return bitmap;
+}
 
-    jobject argbConfig = env->CallStaticObjectMethod(bitmapConfigCls, valueOfFunc, configName);
-    jobject bitmap = env->CallStaticObjectMethod(
-            bitmapCls, createBitmapFunc, rgba.cols, rgba.rows, argbConfig);
+jobject matToPooledBitmap(JNIEnv* env, const cv::Mat& src, int channel)
+{
+    TRACE_SCOPE(TRACE_JNI);
+    if (src.empty() || (src.channels() != 3 && src.channels() != 4))
+        return nullptr;
 
-    void* pixels;
-    if (AndroidBitmap_lockPixels(env, bitmap, &pixels) == 0)
+    // 池中没有 Java 已归还的 Bitmap 时新分配，不覆盖 Java 可能仍在显示的
+    jobject bitmap = acquirePooledBitmap(env, channel, src.cols, src.rows);
+    if (!bitmap)
     {
-        memcpy(pixels, rgba.data, rgba.total() * rgba.elemSize());
-        AndroidBitmap_unlockPixels(env, bitmap);
+        return matToBitmap(env, src);
     }
 
-    env->DeleteLocalRef(configName);
-    env->DeleteLocalRef(bitmapConfigCls);
-
+    if (!writeMatToBitmap(env, bitmap, src))
+    {
+        releasePooledBitmap(env, bitmap);
+        env->DeleteLocalRef(bitmap);
+        return nullptr;
+    }
     return bitmap;
 }
 
 cv::Mat bitmapToMat(JNIEnv* env, jobject bitmap)
 {
+    TRACE_SCOPE(TRACE_JNI);
     AndroidBitmapInfo info;
     void* pixels;
 
@@ -86,11 +136,128 @@ cv::Mat bitmapToMat(JNIEnv* env, jobject bitmap)
     return bgr;
 }
 
+// =============================
+// 检测结果回调 Java
+// =============================
+
+static std::atomic<bool> g_legacy_rectf(false);
+
+void setLegacyRectFResults(bool enabled)
+{
+    g_legacy_rectf.store(enabled);
+}
+
+bool legacyRectFResults()
+{
+    return g_legacy_rectf.load();
+}
+
+jobjectArray buildRectFArray(JNIEnv* env, const std::vector<Object>& objects)
+{
+    TRACE_SCOPE(TRACE_JNI);
+    const JniCache* c = jni_cache();
+    jclass rectFCls = c ? c->rectFCls : env->FindClass("android/graphics/RectF");
+    if (!rectFCls)
+    {
+        if (env->ExceptionCheck())
+        {
+            env->ExceptionClear();
+        }
+        return nullptr;
+    }
+
+    jobjectArray rectFArray = nullptr;
+    jmethodID rectCtor = c ? c->rectFCtor : env->GetMethodID(rectFCls, "<init>", "(FFFF)V");
+    if (rectCtor && !env->ExceptionCheck())
+    {
+        rectFArray = env->NewObjectArray((jsize)objects.size(), rectFCls, nullptr);
+        if (rectFArray && !env->ExceptionCheck())
+        {
+            for (jsize i = 0; i < (jsize)objects.size(); ++i)
+            {
+                const Object& obj = objects[i];
+                float left   = obj.rect.x;
+                float top    = obj.rect.y;
+                float right  = obj.rect.x + obj.rect.width;
+                float bottom = obj.rect.y + obj.rect.height;
+                jobject rect = env->NewObject(rectFCls, rectCtor,
+                                              left, top, right, bottom);
+                if (rect && !env->ExceptionCheck())
+                {
+                    env->SetObjectArrayElement(rectFArray, i, rect);
+                    env->DeleteLocalRef(rect);
+                }
+                else if (env->ExceptionCheck())
+                {
+                    env->ExceptionClear();
+                }
+            }
+        }
+    }
+
+    if (env->ExceptionCheck())
+    {
+        env->ExceptionClear();
+        if (rectFArray)
+        {
+            env->DeleteLocalRef(rectFArray);
+        }
+        rectFArray = env->NewObjectArray(0, rectFCls, nullptr);
+        if (env->ExceptionCheck())
+        {
+            env->ExceptionClear();
+            rectFArray = nullptr;
+        }
+    }
+
+    if (!c)
+    {
+        env->DeleteLocalRef(rectFCls);
+    }
+    return rectFArray;
+}
+
+void deliverNetworkFrame(JNIEnv* env, jobject manager, jmethodID onFrame,
+                         const cv::Mat& rgb, const std::vector<Object>& objects, int channel)
+{
+    jobjectArray rectFArray = g_legacy_rectf.load() ? buildRectFArray(env, objects) : nullptr;
+
+    jobject bitmap = matToPooledBitmap(env, rgb, channel);
+    if (env->ExceptionCheck())
+    {
+        env->ExceptionClear();
+        bitmap = nullptr;
+    }
+    if (!bitmap)
+    {
+        if (rectFArray)
+        {
+            env->DeleteLocalRef(rectFArray);
+        }
+        return;
+    }
+
+    env->CallVoidMethod(manager, onFrame, bitmap, rectFArray);
+    if (env->ExceptionCheck())
+    {
+        env->ExceptionClear();
+    }
+
+    env->DeleteLocalRef(bitmap);
+    if (rectFArray)
+    {
+        env->DeleteLocalRef(rectFArray);
+    }
+}
+
 // =============================
 // 绘制相关
 // =============================
 
+// 单路（相机 / 本地视频 / 单路网络流）共用的跟踪器；多路流各自持有自己的跟踪器
+// 相机、视频解码、网络流流水线线程都可能走到它，更新须持有 g_tracker_mutex
 static BYTETracker g_tracker(25, 30);
+static std::mutex g_tracker_mutex;
 
 void drawObjectKeypoints(cv::Mat& frame, const Object& obj, const unsigned char* color)
 {
@@ -172,91 +339,137 @@ void drawObjectFaceKeypoints(cv::Mat& frame, const Object& obj, const unsigned c
     }
 }
 
-void drawDetectionsOnFrame(cv::Mat& frame,
-                           const std::vector<Object>& objects,
-                           const char** class_names,
-                           const unsigned char (*colors)[3],
-                           int class_count)
+// 轨迹 ID 回填：每个检测取同类别、IoU 最大（>= 0.3）的轨迹
+static void assignTrackIds(std::vector<Object>& objects, const std::vector<STrack>& tracks)
+{
+    for (auto& obj : objects)
+    {
+        obj.track_id = -1;
+        float best_iou = 0.3f;
+        for (const auto& track : tracks)
+        {
+            if (track.cls != obj.label)
+                continue;
+
+            const cv::Rect_<float> box(track.tlwh[0], track.tlwh[1], track.tlwh[2], track.tlwh[3]);
+            const float inter = (box & obj.rect).area();
+            const float uni = box.area() + obj.rect.area() - inter;
+            const float iou = uni > 0.f ? inter / uni : 0.f;
+            if (iou > best_iou)
+            {
+                best_iou = iou;
+                obj.track_id = track.track_id;
+            }
+        }
+    }
+}
+
+// 所有目标的分割掩码一次合成到 frame（只访问目标框区域，重叠处后面的目标优先）
+// palette_size 与框颜色取模一致；tracked_only 为 true 时只画已匹配到轨迹的目标
+static void drawMasks(cv::Mat& frame,
+                      const std::vector<Object>& objects,
+                      const unsigned char (*colors)[3],
+                      int class_count,
+                      int palette_size,
+                      bool tracked_only)
+{
+    // 标签图缓冲按线程复用（多路流各自在自己的线程上绘制）
+    static thread_local MaskCompositor compositor;
+    static thread_local std::vector<MaskLayer> layers;
+
+    layers.clear();
+    for (const auto& obj : objects)
+    {
+        if (!obj.markPoint.mask || obj.label < 0 || obj.label >= class_count)
+            continue;
+        if (tracked_only && obj.track_id < 0)
+            continue;
+
+        const unsigned char* color = colors[obj.label % palette_size];
+        layers.push_back({obj.markPoint.mask.get(), obj.markPoint.origin.x, obj.markPoint.origin.y,
+                          {color[2], color[1], color[0]}});
+    }
+    if (layers.empty())
+        return;
+
+    compositor.composite(layers, frame.data, frame.cols, frame.rows, frame.step, 128);
+}
+
+// 检测框 + 文本 + 关键点（掩码由 drawMasks 先行合成）
+static void drawObjects(cv::Mat& frame,
+                        const std::vector<Object>& objects,
+                        const char** class_names,
+                        const unsigned char (*colors)[3],
+                        int class_count)
 {
     float scale = std::max(frame.cols, frame.rows) / 640.0f;
     int box_thickness  = std::max(2, int(2 * scale));
     double font_scale  = 0.5 * scale;
     int font_thickness = std::max(1, int(1 * scale));
 
-    if (!trackEnabled)
+    for (const auto& obj : objects)
     {
-        for (const auto& obj : objects)
-        {
-            int cls = obj.label;
-            if (cls < 0 || cls >= class_count)
-                continue;
-
-            float prob = obj.prob;
-            const unsigned char* color = colors[cls % 10];
-            cv::Scalar box_color(color[0], color[1], color[2]);
-            cv::Rect rect(obj.rect.x, obj.rect.y, obj.rect.width, obj.rect.height);
+        int cls = obj.label;
+        if (cls < 0 || cls >= class_count)
+            continue;
 
-            cv::rectangle(frame, rect, box_color, box_thickness);
+        float prob = obj.prob;
+        const unsigned char* color = colors[cls % 10];
+        cv::Scalar box_color(color[0], color[1], color[2]);
+        cv::Rect rect(obj.rect.x, obj.rect.y, obj.rect.width, obj.rect.height);
 
-            std::string info_text = cv::format("%s %.1f%%", class_names[cls], prob * 100);
-            int baseline = 0;
-            cv::Size info_size = cv::getTextSize(info_text, cv::FONT_HERSHEY_SIMPLEX,
-                                                 font_scale, font_thickness, &baseline);
+        cv::rectangle(frame, rect, box_color, box_thickness);
 
-            int text_x = std::max(0, std::min(rect.x, frame.cols - info_size.width));
-            int text_y = std::max(0, rect.y - info_size.height - 3);
+        std::string info_text = cv::format("%s %.1f%%", class_names[cls], prob * 100);
+        int baseline = 0;
+        cv::Size info_size = cv::getTextSize(info_text, cv::FONT_HERSHEY_SIMPLEX,
+                                             font_scale, font_thickness, &baseline);
 
-            cv::rectangle(frame,
-                          cv::Rect(text_x - 2, text_y - 2,
-                                   info_size.width + 4, info_size.height + 4),
-                          box_color, -1);
+        int text_x = std::max(0, std::min(rect.x, frame.cols - info_size.width));
+        int text_y = std::max(0, rect.y - info_size.height - 3);
 
-            cv::putText(frame, info_text,
-                        cv::Point(text_x, text_y + info_size.height),
-                        cv::FONT_HERSHEY_SIMPLEX, font_scale,
-                        cv::Scalar(255, 255, 255), font_thickness);
+        cv::rectangle(frame,
+                      cv::Rect(text_x - 2, text_y - 2,
+                               info_size.width + 4, info_size.height + 4),
+                      box_color, -1);
 
-            // 分割掩码
-            if (!obj.markPoint.mask.empty())
-            {
-                for (int y = 0; y < frame.rows; y++)
-                {
-                    uchar* image_ptr = frame.ptr(y);
-                    const float* mask_ptr = obj.markPoint.mask.ptr<float>(y);
-                    for (int x = 0; x < frame.cols; x++)
-                    {
-                        if (mask_ptr[x] >= 0.5f)
-                        {
-                            image_ptr[0] = cv::saturate_cast<uchar>(image_ptr[0] * 0.5 + color[2] * 0.5);
-                            image_ptr[1] = cv::saturate_cast<uchar>(image_ptr[1] * 0.5 + color[1] * 0.5);
-                            image_ptr[2] = cv::saturate_cast<uchar>(image_ptr[2] * 0.5 + color[0] * 0.5);
-                        }
-                        image_ptr += 3;
-                    }
-                }
-            }
+        cv::putText(frame, info_text,
+                    cv::Point(text_x, text_y + info_size.height),
+                    cv::FONT_HERSHEY_SIMPLEX, font_scale,
+                    cv::Scalar(255, 255, 255), font_thickness);
 
-            if (!obj.Face_keyPoints.empty())
-            {
-                drawObjectFaceKeypoints(frame, obj, color);
-            }
-            if (!obj.keyPoints.empty())
-            {
-                drawObjectKeypoints(frame, obj, color);
-            }
+        if (!obj.Face_keyPoints.empty())
+        {
+            drawObjectFaceKeypoints(frame, obj, color);
+        }
+        if (!obj.keyPoints.empty())
+        {
+            drawObjectKeypoints(frame, obj, color);
         }
-
-        return;
     }
+}
 
-    std::vector<STrack> output_stracks = g_tracker.update(objects);
-    for (size_t i = 0; i < output_stracks.size(); i++)
+// 轨迹框 + ID + 拖尾
+static void drawTracks(cv::Mat& frame,
+                       const std::vector<STrack>& tracks,
+                       const char** class_names,
+                       const unsigned char (*colors)[3],
+                       int class_count)
+{
+    float scale = std::max(frame.cols, frame.rows) / 640.0f;
+    int box_thickness  = std::max(2, int(2 * scale));
+    double font_scale  = 0.5 * scale;
+    int font_thickness = std::max(1, int(1 * scale));
+
+    for (size_t i = 0; i < tracks.size(); i++)
     {
-        const auto& track = output_stracks[i];
+        const auto& track = tracks[i];
         std::vector<float> tlwh = track.tlwh;
         float prob  = track.score;
         int cls     = track.cls;
         int track_id = track.track_id;
+        if (cls < 0 || cls >= class_count)
+            continue;
 
         // 拖尾（轨迹）
         if (shaderEnabled)
@@ -306,6 +519,48 @@ void drawDetectionsOnFrame(cv::Mat& frame,
     }
 }
 
+std::vector<STrack> updateTracks(std::vector<Object>& objects, BYTETracker* tracker)
+{
+    TRACE_SCOPE(TRACE_TRACK);
+    std::vector<STrack> output_stracks;
+    if (tracker)
+    {
+        output_stracks = tracker->update(objects);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(g_tracker_mutex);
+        output_stracks = g_tracker.update(objects);
+    }
+    assignTrackIds(objects, output_stracks);
+    return output_stracks;
+}
+
+void resetTracker()
+{
+    std::lock_guard<std::mutex> lock(g_tracker_mutex);
+    g_tracker = BYTETracker(25, 30);
+}
+
+void drawDetectionsOnFrame(cv::Mat& frame,
+                           std::vector<Object>& objects,
+                           const char** class_names,
+                           const unsigned char (*colors)[3],
+                           int class_count,
+                           BYTETracker* tracker)
+{
+    if (!trackEnabled)
+    {
+        drawMasks(frame, objects, colors, class_count, 10, false);
+        drawObjects(frame, objects, class_names, colors, class_count);
+        return;
+    }
+
+    const std::vector<STrack> tracks = updateTracks(objects, tracker);
+    drawMasks(frame, objects, colors, class_count, 19, true);
+    drawTracks(frame, tracks, class_names, colors, class_count);
+}
+
 // =============================
 // 模型工厂 & 推理流水线
 // =============================
@@ -350,68 +605,227 @@ IYoloAlgo* createModelInstance(int modelId)
     return model;
 }
 
-std::vector<Object> detectAndUpdateSummary(cv::Mat& frame, double t0, double /*t1*/)
+std::vector<Object> detectAndUpdateSummary(cv::Mat& frame, double t0)
 {
     std::vector<Object> objects;
 
     // 推理
+    std::shared_ptr<IYoloAlgo> model = acquireModel();
+    if (!model)
+    {
+        return objects;
+    }
     {
         ncnn::MutexLockGuard g(g_lock);
-        if (g_yolo)
-        {
-            g_yolo->detect(frame, objects);
-        }
-        else
-        {
-            return objects;
-        }
+        model->detect(frame, objects);
     }
 
-    // 绘制（框 / 分割 / 关键点 / 轨迹）
+    drawAndUpdateSummary(frame, objects, t0, trace_thread_last_ms(TRACE_FORWARD), model);
+    return objects;
+}
+
+bool detectLetterboxed(const Letterbox& lb, std::vector<Object>& objects, std::shared_ptr<IYoloAlgo>* used_model)
+{
+    std::shared_ptr<IYoloAlgo> model = acquireModel();
+    if (!model || model->getTargetSize() <= 0)
     {
-        ncnn::MutexLockGuard g(g_lock);
-        if (g_yolo)
-        {
-            drawDetectionsOnFrame(frame, objects,
-                                  g_yolo->getClassNames(),
-                                  g_yolo->getColors(),
-                                  g_yolo->getClassCount());
-        }
+        return false;
+    }
+    ncnn::MutexLockGuard g(g_lock);
+    if (used_model)
+        *used_model = model;
+    return model->detectLetterboxed(lb, objects) == 0;
+}
+
+bool getModelMemoryStats(ModelMemoryStats& stats)
+{
+    std::shared_ptr<IYoloAlgo> model = acquireModel();
+    return model && model->getMemoryStats(stats);
+}
+
+bool getModelTensorInput(int& target_size, float mean[3], float norm[3])
+{
+    std::shared_ptr<IYoloAlgo> model = acquireModel();
+    if (!model || model->getTargetSize() <= 0 || !model->getTensorNorm(mean, norm))
+    {
+        return false;
+    }
+    target_size = model->getTargetSize();
+    return true;
+}
+
+bool detectTensor(const LetterboxTensor& in, std::vector<Object>& objects, std::shared_ptr<IYoloAlgo>* used_model)
+{
+    std::shared_ptr<IYoloAlgo> model = acquireModel();
+    if (!model)
+    {
+        return false;
     }
+    ncnn::MutexLockGuard g(g_lock);
+    if (used_model)
+        *used_model = model;
+    return model->detectTensor(in, objects) == 0;
+}
+
+bool detectBatch(const std::vector<cv::Mat>& frames, std::vector<std::vector<Object> >& objects)
+{
+    std::shared_ptr<IYoloAlgo> model = acquireModel();
+    if (!model)
+    {
+        return false;
+    }
+    ncnn::MutexLockGuard g(g_lock);
+    return model->detectBatch(frames, objects) == 0;
+}
+
+bool detectLetterboxedBatch(const std::vector<Letterbox>& inputs, std::vector<std::vector<Object> >& objects,
+                            std::shared_ptr<IYoloAlgo>* used_model)
+{
+    std::shared_ptr<IYoloAlgo> model = acquireModel();
+    if (!model || model->getTargetSize() <= 0)
+    {
+        return false;
+    }
+    ncnn::MutexLockGuard g(g_lock);
+    if (used_model)
+        *used_model = model;
+    return model->detectLetterboxedBatch(inputs, objects) == 0;
+}
+
+int getModelTargetSize()
+{
+    std::shared_ptr<IYoloAlgo> model = acquireModel();
+    return model ? model->getTargetSize() : 0;
+}
 
-    // 计算 FPS & 更新摘要
+// 取执行推理的那个模型的类别名称 / 颜色 / 类别数，保证与本帧标签一致
+// （推理后模型可能已被后台加载替换，不能再取当前模型）；model 为空时返回 false
+static bool modelClassTable(const std::shared_ptr<IYoloAlgo>& model,
+                            const char**& names, const unsigned char (*&palette)[3], int& class_count)
+{
+    if (!model)
+        return false;
+
+    names = model->getClassNames();
+    palette = model->getColors();
+    class_count = model->getClassCount();
+    return names != nullptr;
+}
+
+// FPS / 前向耗时 / 类别统计
+static DetectSummary summarizeDetections(const std::vector<Object>& objects, double t0, float forward_ms,
+                                         const char** names, int class_count)
+{
+    DetectSummary summary{0.f, 0.f, 0.f, std::string(), std::vector<std::string>()};
+
+    // 计算 FPS
     double t2 = ncnn::get_current_time();
     double allTime = (t2 - t0);
-    float fps = allTime > 0 ? 1000.0f / (float)allTime : 0.0f;
+    summary.allTimeMs = (float)allTime;
+    summary.fps = allTime > 0 ? 1000.0f / (float)allTime : 0.0f;
+    // 前向耗时取自追踪层最近一次记录（各检测器在前向结束时写入）
+    summary.inferTimeMs = forward_ms;
 
-    std::lock_guard<std::mutex> lock(g_summary_mutex);
-    g_summary.allTimeMs = (float)allTime;
-    // inferTimeMs 在当前实现中暂未单独统计
-    float inferTimeMs = g_summary.inferTimeMs;
-    g_summary.fps = fps;
+    // 类别统计文本
+    if (names)
+    {
+        auto result = updateDetectSummary(objects, names, class_count);
+        summary.logText = result.first;
+        summary.class_info = result.second;
+    }
+
+    return summary;
+}
+
+DetectSummary drawAndSummarize(cv::Mat& frame, std::vector<Object>& objects, double t0, float forward_ms,
+                               BYTETracker* tracker, const std::shared_ptr<IYoloAlgo>& model)
+{
+    const char** names = nullptr;
+    const unsigned char (*palette)[3] = nullptr;
+    int class_count = 0;
+    modelClassTable(model, names, palette, class_count);
 
-    // 更新类别统计文本
-    std::string logText;
-    std::vector<std::string> classInfo;
+    // 绘制（框 / 分割 / 关键点 / 轨迹）
+    if (names)
     {
-        ncnn::MutexLockGuard g(g_lock);
-        if (g_yolo)
-        {
-            auto result = updateDetectSummary(objects, g_yolo->getClassNames());
-            logText = result.first;
-            classInfo = result.second;
-        }
+        TRACE_SCOPE(TRACE_DRAW);
+        drawDetectionsOnFrame(frame, objects, names, palette, class_count, tracker);
     }
 
-    g_summary_cache = std::make_unique<DetectSummary>(DetectSummary{
-            g_summary.allTimeMs,
-            inferTimeMs,
-            g_summary.fps,
-            logText,
-            classInfo
-    });
+    return summarizeDetections(objects, t0, forward_ms, names, class_count);
+}
 
-    return objects;
+void drawPredictedOnFrame(cv::Mat& frame, const std::vector<Object>& objects,
+                          const std::vector<STrack>& tracks, bool draw_tracks,
+                          const std::shared_ptr<IYoloAlgo>& model)
+{
+    const char** names = nullptr;
+    const unsigned char (*palette)[3] = nullptr;
+    int class_count = 0;
+    if (!modelClassTable(model, names, palette, class_count))
+        return;
+
+    TRACE_SCOPE(TRACE_DRAW);
+    if (draw_tracks)
+    {
+        drawMasks(frame, objects, palette, class_count, 19, true);
+        drawTracks(frame, tracks, names, palette, class_count);
+    }
+    else
+    {
+        drawMasks(frame, objects, palette, class_count, 10, false);
+        drawObjects(frame, objects, names, palette, class_count);
+    }
+}
+
+bool detectFrame(const cv::Mat& frame, std::vector<Object>& objects, std::shared_ptr<IYoloAlgo>* used_model)
+{
+    std::shared_ptr<IYoloAlgo> model = acquireModel();
+    if (!model)
+    {
+        return false;
+    }
+    ncnn::MutexLockGuard g(g_lock);
+    if (used_model)
+        *used_model = model;
+    return model->detect(frame, objects) == 0;
+}
+
+// 写全局摘要（Java 侧 getDetectSummary 读取）
+static void storeSummary(DetectSummary&& summary)
+{
+    std::lock_guard<std::mutex> lock(g_summary_mutex);
+    g_summary.allTimeMs = summary.allTimeMs;
+    g_summary.fps = summary.fps;
+    g_summary.inferTimeMs = summary.inferTimeMs;
+    // 采集配置由相机打开时写入 g_summary
+    summary.captureWidth = g_summary.captureWidth;
+    summary.captureHeight = g_summary.captureHeight;
+    summary.captureFpsMin = g_summary.captureFpsMin;
+    summary.captureFpsMax = g_summary.captureFpsMax;
+
+    g_summary_cache = std::make_unique<DetectSummary>(std::move(summary));
+}
+
+void drawAndUpdateSummary(cv::Mat& frame, std::vector<Object>& objects, double t0, float forward_ms,
+                          const std::shared_ptr<IYoloAlgo>& model)
+{
+    DetectSummary summary = drawAndSummarize(frame, objects, t0, forward_ms, nullptr, model);
+    publishResults(RESULT_CHANNEL_DEFAULT, objects, frame.cols, frame.rows);
+    storeSummary(std::move(summary));
+}
+
+void updateSummary(const std::vector<Object>& objects, int frame_w, int frame_h, double t0, float forward_ms,
+                   const std::shared_ptr<IYoloAlgo>& model)
+{
+    const char** names = nullptr;
+    const unsigned char (*palette)[3] = nullptr;
+    int class_count = 0;
+    modelClassTable(model, names, palette, class_count);
+
+    DetectSummary summary = summarizeDetections(objects, t0, forward_ms, names, class_count);
+    publishResults(RESULT_CHANNEL_DEFAULT, objects, frame_w, frame_h);
+    storeSummary(std::move(summary));
 }
 
 jobject createDetectSummaryJObject(JNIEnv* env, const char* className)
@@ -420,9 +834,16 @@ jobject createDetectSummaryJObject(JNIEnv* env, const char* className)
     if (!g_summary_cache)
         return nullptr;
 
-    const DetectSummary& summary = *g_summary_cache;
+    return createDetectSummaryJObject(env, className, *g_summary_cache);
+}
+
+jobject createDetectSummaryJObject(JNIEnv* env, const char* className, const DetectSummary& summary)
+{
+    // 默认摘要类使用 JNI_OnLoad 中缓存的类与构造函数
+    const JniCache* c = jni_cache();
+    const bool cached = c && strcmp(className, JNI_DETECT_SUMMARY_CLASS) == 0;
 
-    jclass cls = env->FindClass(className);
+    jclass cls = cached ? c->summaryCls : env->FindClass(className);
     if (cls == nullptr)
     {
         __android_log_print(ANDROID_LOG_ERROR, "ncnn",
@@ -431,13 +852,14 @@ jobject createDetectSummaryJObject(JNIEnv* env, const char* className)
         return nullptr;
     }
 
-    jmethodID ctor = env->GetMethodID(cls, "<init>", "(FFFLjava/lang/String;)V");
+    jmethodID ctor = cached ? c->summaryCtor : env->GetMethodID(cls, "<init>", JNI_DETECT_SUMMARY_CTOR_SIG);
     if (ctor == nullptr)
     {
         __android_log_print(ANDROID_LOG_ERROR, "ncnn",
                             "Failed to find DetectSummary constructor");
         env->ExceptionClear();
-        env->DeleteLocalRef(cls);
+        if (!cached)
+            env->DeleteLocalRef(cls);
         return nullptr;
     }
 
@@ -447,7 +869,8 @@ jobject createDetectSummaryJObject(JNIEnv* env, const char* className)
         __android_log_print(ANDROID_LOG_ERROR, "ncnn",
                             "Failed to create jstring");
         env->ExceptionClear();
-        env->DeleteLocalRef(cls);
+        if (!cached)
+            env->DeleteLocalRef(cls);
         return nullptr;
     }
 
@@ -455,10 +878,15 @@ jobject createDetectSummaryJObject(JNIEnv* env, const char* className)
                                     summary.allTimeMs,
                                     summary.inferTimeMs,
                                     summary.fps,
-                                    jlog);
+                                    jlog,
+                                    (jint)summary.captureWidth,
+                                    (jint)summary.captureHeight,
+                                    (jint)summary.captureFpsMin,
+                                    (jint)summary.captureFpsMax);
 
     env->DeleteLocalRef(jlog);
-    env->DeleteLocalRef(cls);
+    if (!cached)
+        env->DeleteLocalRef(cls);
 
     if (result == nullptr)
     {
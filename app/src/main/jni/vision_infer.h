@@ -2,11 +2,13 @@
 #define VISION_INFER_H
 
 #include <jni.h>
+#include <memory>
 #include <vector>
 
 #include <opencv2/core/core.hpp>
 
 #include "vision_base.h"
+#include "pool_allocator.h"
 #include "BYTETracker.h"
 
 // 前向声明算法接口
@@ -16,12 +18,28 @@ class IYoloAlgo;
 // JNI / OpenCV 相关基础转换
 // =============================
 
-// Mat 转 Bitmap（JNI 环境）
+// Mat（RGB / RGBA）转新分配的 Bitmap（JNI 环境），调用方独占
 jobject matToBitmap(JNIEnv* env, const cv::Mat& src);
 
+// Mat 转 Bitmap，Bitmap 取自 channel 对应的复用池（见 jni_cache.h），用于逐帧回调；
+// Java 不再显示后须调用 JniBridge.releaseFrameBitmap 归还
+jobject matToPooledBitmap(JNIEnv* env, const cv::Mat& src, int channel);
+
 // Bitmap 转 Mat（JNI 环境）
 cv::Mat bitmapToMat(JNIEnv* env, jobject bitmap);
 
+// 检测结果转 RectF[]，异常时退化为空数组（仅兼容旧回调时使用，每个目标分配一个对象）
+jobjectArray buildRectFArray(JNIEnv* env, const std::vector<Object>& objects);
+
+// 帧回调是否仍附带 RectF[]（默认关闭，回调中传 null；检测结果通过 getDetectResults 的打包缓冲区读取）
+void setLegacyRectFResults(bool enabled);
+bool legacyRectFResults();
+
+// 帧回调给 Java 层（onFrame 签名为 (Bitmap, RectF[])V），Bitmap 取自 channel 的复用池；
+// RectF[] 只在开启 setLegacyRectFResults 时构建，否则为 null，帧路径上不做逐目标分配
+void deliverNetworkFrame(JNIEnv* env, jobject manager, jmethodID onFrame,
+                         const cv::Mat& rgb, const std::vector<Object>& objects, int channel);
+
 // =============================
 // 绘制相关
 // =============================
@@ -32,12 +50,27 @@ void drawObjectKeypoints(cv::Mat& frame, const Object& obj, const unsigned char*
 // 绘制人脸关键点
 void drawObjectFaceKeypoints(cv::Mat& frame, const Object& obj, const unsigned char* color);
 
-// 画检测框 + 文本 + 轨迹
+// 画检测框 + 文本 + 轨迹；tracker 为空时使用全局跟踪器（多路流各自传入自己的跟踪器）
+// 开启跟踪时把匹配到的轨迹 ID 回填到 objects[i].track_id
 void drawDetectionsOnFrame(cv::Mat& frame,
-                           const std::vector<Object>& objects,
+                           std::vector<Object>& objects,
                            const char** class_names,
                            const unsigned char (*colors)[3],
-                           int class_count);
+                           int class_count,
+                           BYTETracker* tracker = nullptr);
+
+// 更新跟踪器并把轨迹 ID 回填到 objects[i].track_id，返回本帧输出轨迹；tracker 为空时使用全局跟踪器（加锁，可从多个线程调用）
+std::vector<STrack> updateTracks(std::vector<Object>& objects, BYTETracker* tracker);
+
+// 清空全局跟踪器的轨迹（切换模型时）
+void resetTracker();
+
+// 绘制已外推到当前帧的结果，不更新跟踪器（异步预览渲染侧使用）
+// draw_tracks 为 true 时画轨迹框 / ID / 拖尾，否则画检测框 / 掩码 / 关键点
+// model 为产生这些结果的模型（类别名称 / 颜色取自它），为空时不绘制
+void drawPredictedOnFrame(cv::Mat& frame, const std::vector<Object>& objects,
+                          const std::vector<STrack>& tracks, bool draw_tracks,
+                          const std::shared_ptr<IYoloAlgo>& model);
 
 // =============================
 // 检测算法与推理流水线
@@ -47,11 +80,59 @@ void drawDetectionsOnFrame(cv::Mat& frame,
 IYoloAlgo* createModelInstance(int modelId);
 
 // 统一推理流程：推理 -> 绘制 -> 统计摘要
-std::vector<Object> detectAndUpdateSummary(cv::Mat& frame, double t0, double t1);
+std::vector<Object> detectAndUpdateSummary(cv::Mat& frame, double t0);
+
+// 以下推理函数的 used_model 非空时写入执行推理的模型实例：后台加载可能在推理之后替换模型，
+// 绘制 / 摘要须传回这个实例，保证类别表与本帧标签来自同一模型
+
+// 仅推理，不绘制；模型未加载或推理失败时返回 false
+bool detectFrame(const cv::Mat& frame, std::vector<Object>& objects,
+                 std::shared_ptr<IYoloAlgo>* used_model = nullptr);
+
+// 批量推理（多路 / 多块一起送入模型）；模型未加载时返回 false
+bool detectBatch(const std::vector<cv::Mat>& frames, std::vector<std::vector<Object> >& objects);
 
-// 构造 DetectSummary 的 Java 对象
+// 批量 letterbox 推理；模型未加载或不支持 letterbox 时返回 false
+bool detectLetterboxedBatch(const std::vector<Letterbox>& inputs, std::vector<std::vector<Object> >& objects,
+                            std::shared_ptr<IYoloAlgo>* used_model = nullptr);
+
+// 当前模型支持的 letterbox 目标边长，0 表示不支持（需走原图 detect）
+int getModelTargetSize();
+
+// 当前模型的内存池统计；模型未加载或未使用模型内存池时返回 false
+bool getModelMemoryStats(ModelMemoryStats& stats);
+
+// 当前模型的张量输入参数（letterbox 目标边长与归一化参数）；模型未加载或不支持 detectTensor 时返回 false
+bool getModelTensorInput(int& target_size, float mean[3], float norm[3]);
+
+// 对预处理好的张量推理（相机路径由 NV21 直接生成）；模型未加载或不支持时返回 false
+bool detectTensor(const LetterboxTensor& in, std::vector<Object>& objects,
+                  std::shared_ptr<IYoloAlgo>* used_model = nullptr);
+
+// 对解码阶段生成的 letterbox 输入推理；模型未加载或不支持时返回 false
+bool detectLetterboxed(const Letterbox& lb, std::vector<Object>& objects,
+                       std::shared_ptr<IYoloAlgo>* used_model = nullptr);
+
+// 绘制检测结果并更新摘要，同时发布打包结果到 RESULT_CHANNEL_DEFAULT（推理与绘制分离时使用）
+// 以下 model 均为产生 objects 的模型（见 detectFrame 的 used_model），为空时只统计耗时；
+// forward_ms 为本帧的前向耗时，由推理线程在推理后用 trace_thread_last_ms(TRACE_FORWARD) 取得
+void drawAndUpdateSummary(cv::Mat& frame, std::vector<Object>& objects, double t0, float forward_ms,
+                          const std::shared_ptr<IYoloAlgo>& model);
+
+// 只更新摘要并发布打包结果，不绘制（异步预览推理线程使用，绘制由相机线程完成）
+void updateSummary(const std::vector<Object>& objects, int frame_w, int frame_h, double t0, float forward_ms,
+                   const std::shared_ptr<IYoloAlgo>& model);
+
+// 绘制检测结果并返回摘要，不写全局摘要（多路流各自保存）
+DetectSummary drawAndSummarize(cv::Mat& frame, std::vector<Object>& objects, double t0, float forward_ms,
+                               BYTETracker* tracker, const std::shared_ptr<IYoloAlgo>& model);
+
+// 构造 DetectSummary 的 Java 对象（全局摘要）
 jobject createDetectSummaryJObject(JNIEnv* env, const char* className);
 
+// 构造 DetectSummary 的 Java 对象（指定摘要）
+jobject createDetectSummaryJObject(JNIEnv* env, const char* className, const DetectSummary& summary);
+
 #endif // VISION_INFER_H
 
 
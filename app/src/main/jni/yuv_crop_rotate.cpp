@@ -0,0 +1,15 @@
+#include "yuv_repack.h"
+
+#include "mat.h"
+
+void nv21_crop_rotate(const uint8_t* nv21, int nv21_width, int nv21_height,
+                      int roi_x, int roi_y, int roi_w, int roi_h,
+                      uint8_t* dst, int dst_w, int dst_h, int rotate_type)
+{
+    const uint8_t* srcY = nv21 + roi_y * nv21_width + roi_x;
+    ncnn::kanna_rotate_c1(srcY, roi_w, roi_h, nv21_width, dst, dst_w, dst_h, dst_w, rotate_type);
+
+    const uint8_t* srcUV = nv21 + nv21_width * nv21_height + roi_y * nv21_width / 2 + roi_x;
+    uint8_t* dstUV = dst + dst_w * dst_h;
+    ncnn::kanna_rotate_c2(srcUV, roi_w / 2, roi_h / 2, nv21_width, dstUV, dst_w / 2, dst_h / 2, dst_w, rotate_type);
+}
@@ -0,0 +1,171 @@
+#include "yuv_repack.h"
+
+#include <string.h>
+
+#if __ARM_NEON
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+bool yuv420_is_nv21(const Yuv420Planes& p)
+{
+    return p.u == p.v + 1 && p.v == p.y + p.width * p.height
+           && p.y_pixel_stride == 1 && p.u_pixel_stride == 2 && p.v_pixel_stride == 2
+           && p.y_row_stride == p.width && p.u_row_stride == p.width && p.v_row_stride == p.width;
+}
+
+// 取偶数位置字节：src 2 * n 字节 -> dst n 字节
+static void deinterleave_even(const uint8_t* src, uint8_t* dst, int n)
+{
+    int x = 0;
+#if __ARM_NEON
+    for (; x + 15 < n; x += 16)
+    {
+        uint8x16x2_t _p = vld2q_u8(src + x * 2);
+        vst1q_u8(dst + x, _p.val[0]);
+    }
+#elif defined(__SSE2__)
+    const __m128i _mask = _mm_set1_epi16(0x00ff);
+    for (; x + 15 < n; x += 16)
+    {
+        __m128i _a = _mm_and_si128(_mm_loadu_si128((const __m128i*)(src + x * 2)), _mask);
+        __m128i _b = _mm_and_si128(_mm_loadu_si128((const __m128i*)(src + x * 2 + 16)), _mask);
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(_a, _b));
+    }
+#endif
+    for (; x < n; x++)
+    {
+        dst[x] = src[x * 2];
+    }
+}
+
+void copy_plane_strided(const uint8_t* src, int row_stride, int pixel_stride,
+                        uint8_t* dst, int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        const uint8_t* s = src + (size_t)row_stride * y;
+        uint8_t* d = dst + (size_t)width * y;
+
+        if (pixel_stride == 1)
+        {
+            memcpy(d, s, width);
+        }
+        else if (pixel_stride == 2 && y + 1 < height)
+        {
+            // 最后一行可能不含末尾的填充字节，向量版本会多读一个字节，交给标量处理
+            deinterleave_even(s, d, width);
+        }
+        else
+        {
+            for (int x = 0; x < width; x++)
+            {
+                d[x] = s[x * pixel_stride];
+            }
+        }
+    }
+}
+
+// 两个紧密平面交错：dst = v0 u0 v1 u1 ...
+static void interleave_packed(const uint8_t* u, const uint8_t* v, uint8_t* dst, int n)
+{
+    int x = 0;
+#if __ARM_NEON
+    for (; x + 15 < n; x += 16)
+    {
+        uint8x16x2_t _vu;
+        _vu.val[0] = vld1q_u8(v + x);
+        _vu.val[1] = vld1q_u8(u + x);
+        vst2q_u8(dst + x * 2, _vu);
+    }
+#elif defined(__SSE2__)
+    for (; x + 15 < n; x += 16)
+    {
+        __m128i _v = _mm_loadu_si128((const __m128i*)(v + x));
+        __m128i _u = _mm_loadu_si128((const __m128i*)(u + x));
+        _mm_storeu_si128((__m128i*)(dst + x * 2), _mm_unpacklo_epi8(_v, _u));
+        _mm_storeu_si128((__m128i*)(dst + x * 2 + 16), _mm_unpackhi_epi8(_v, _u));
+    }
+#endif
+    for (; x < n; x++)
+    {
+        dst[x * 2] = v[x];
+        dst[x * 2 + 1] = u[x];
+    }
+}
+
+// UV 交错行 -> VU：每两个字节互换，n 为像素对数
+static void swap_pairs(const uint8_t* uv, uint8_t* dst, int n)
+{
+    int x = 0;
+#if __ARM_NEON
+    for (; x + 15 < n; x += 16)
+    {
+        uint8x16_t _a = vld1q_u8(uv + x * 2);
+        uint8x16_t _b = vld1q_u8(uv + x * 2 + 16);
+        vst1q_u8(dst + x * 2, vrev16q_u8(_a));
+        vst1q_u8(dst + x * 2 + 16, vrev16q_u8(_b));
+    }
+#elif defined(__SSE2__)
+    for (; x + 15 < n; x += 16)
+    {
+        __m128i _a = _mm_loadu_si128((const __m128i*)(uv + x * 2));
+        __m128i _b = _mm_loadu_si128((const __m128i*)(uv + x * 2 + 16));
+        _a = _mm_or_si128(_mm_slli_epi16(_a, 8), _mm_srli_epi16(_a, 8));
+        _b = _mm_or_si128(_mm_slli_epi16(_b, 8), _mm_srli_epi16(_b, 8));
+        _mm_storeu_si128((__m128i*)(dst + x * 2), _a);
+        _mm_storeu_si128((__m128i*)(dst + x * 2 + 16), _b);
+    }
+#endif
+    for (; x < n; x++)
+    {
+        dst[x * 2] = uv[x * 2 + 1];
+        dst[x * 2 + 1] = uv[x * 2];
+    }
+}
+
+void interleave_vu(const uint8_t* u, int u_row_stride, const uint8_t* v, int v_row_stride,
+                   int pixel_stride, uint8_t* dst, int w2, int h2)
+{
+    // 半平面交错（NV21 / NV12 布局，像素跨度 2）：V 在前时整行就是 VU，可以直接按行拷贝
+    const bool vu_interleaved = pixel_stride == 2 && u == v + 1 && u_row_stride == v_row_stride;
+    // U 在前（NV12 布局）时逐对互换
+    const bool uv_interleaved = pixel_stride == 2 && v == u + 1 && u_row_stride == v_row_stride;
+
+    for (int y = 0; y < h2; y++)
+    {
+        const uint8_t* us = u + (size_t)u_row_stride * y;
+        const uint8_t* vs = v + (size_t)v_row_stride * y;
+        uint8_t* d = dst + (size_t)w2 * 2 * y;
+
+        if (vu_interleaved)
+        {
+            // 行末字节 vs[2 * w2 - 1] 即 U 平面本行最后一个像素，始终在有效范围内
+            memcpy(d, vs, w2 * 2);
+        }
+        else if (uv_interleaved)
+        {
+            swap_pairs(us, d, w2);
+        }
+        else if (pixel_stride == 1)
+        {
+            interleave_packed(us, vs, d, w2);
+        }
+        else
+        {
+            for (int x = 0; x < w2; x++)
+            {
+                d[x * 2] = vs[x * pixel_stride];
+                d[x * 2 + 1] = us[x * pixel_stride];
+            }
+        }
+    }
+}
+
+void yuv420_to_nv21(const Yuv420Planes& p, uint8_t* nv21)
+{
+    copy_plane_strided(p.y, p.y_row_stride, p.y_pixel_stride, nv21, p.width, p.height);
+    interleave_vu(p.u, p.u_row_stride, p.v, p.v_row_stride, p.u_pixel_stride,
+                  nv21 + p.width * p.height, p.width / 2, p.height / 2);
+}
@@ -0,0 +1,59 @@
+#ifndef YUV_REPACK_H
+#define YUV_REPACK_H
+
+#include <stdint.h>
+
+// =============================
+// YUV_420_888 -> NV21 重排
+// =============================
+//
+// 相机输出的三个平面带行跨度 / 像素跨度（常见为 Y 紧密、UV 像素跨度 2 且 VU 交错），
+// 这里按跨度逐行拷贝并交错成 NV21（Y 平面 + VU 交错平面），带 NEON / SSE2 实现。
+// 不依赖 Android 头文件，可在 Linux 上用构造的平面数据验证（见 bench/）；
+// 裁剪旋转在 yuv_crop_rotate.cpp，只依赖 ncnn。
+
+struct Yuv420Planes
+{
+    int width;
+    int height;
+
+    const uint8_t* y;
+    const uint8_t* u;
+    const uint8_t* v;
+
+    int y_row_stride;
+    int u_row_stride;
+    int v_row_stride;
+
+    int y_pixel_stride;
+    int u_pixel_stride;   // U / V 像素跨度相同（YUV_420_888 约定）
+    int v_pixel_stride;
+};
+
+// NV21 缓冲区所需字节数
+inline int nv21_size(int width, int height)
+{
+    return width * height + width * height / 2;
+}
+
+// 平面是否已经是紧密排布的 NV21（可直接使用，无需拷贝）
+bool yuv420_is_nv21(const Yuv420Planes& planes);
+
+// 按像素跨度拷贝单个平面：src 每行 width 个像素，像素间隔 pixel_stride 字节
+void copy_plane_strided(const uint8_t* src, int row_stride, int pixel_stride,
+                        uint8_t* dst, int width, int height);
+
+// U / V 平面交错为 VU（NV21 色度平面），w2 / h2 为色度平面宽高，dst 每行 2 * w2 字节
+void interleave_vu(const uint8_t* u, int u_row_stride, const uint8_t* v, int v_row_stride,
+                   int pixel_stride, uint8_t* dst, int w2, int h2);
+
+// 三平面 -> NV21，nv21 至少 nv21_size(width, height) 字节
+void yuv420_to_nv21(const Yuv420Planes& planes, uint8_t* nv21);
+
+// NV21 裁剪 + 旋转：取源图 (roi_x, roi_y, roi_w, roi_h) 区域（均为偶数），
+// 按 kanna rotate_type（1~8，同 ncnn::kanna_rotate_*）旋转写入 dst（dst_w * dst_h 的 NV21）
+void nv21_crop_rotate(const uint8_t* nv21, int nv21_width, int nv21_height,
+                      int roi_x, int roi_y, int roi_w, int roi_h,
+                      uint8_t* dst, int dst_w, int dst_h, int rotate_type);
+
+#endif // YUV_REPACK_H